@@ -0,0 +1,371 @@
+
+/*                       C O P Y R I G H T   N O T I C E
+ *
+ * Copyright ©2021. Institute of Science and Technology Austria (IST Austria).
+ * All Rights Reserved. The underlying technology is protected by PCT Patent
+ * Application No. PCT/EP2021/054650.
+ *
+ * This file is part of the AP Demodulation library, which is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation in version 2.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY, without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE. See the GNU General Public License v2 for more details. You
+ * should have received a copy of the GNU General Public License v2 along with this
+ * program. If not, see https://www.gnu.org/licenses/.
+ *
+ * Contact the Technology Transfer Office, IST Austria, Am Campus 1,
+ * A-3400 Klosterneuburg, Austria, +43-(0)2243 9000, twist@ist.ac.at, for commercial
+ * licensing opportunities.
+ *
+ * See https://github.com/mgabriel-lt/ap-demodulation for the latest version of the
+ * code and user-friendly explanations on the working principle, domains of
+ * application, and advice on the usage of different AP Demodulation algorithms in
+ * practice.
+ */
+
+
+/* BENCHMARK: MEMORY TRAFFIC OF AN AP-ACCELERATED ITERATION
+ *
+ * This program compares the memory traffic and the time of one iteration of the
+ * AP-Accelerated algorithm (projection onto Mw, factor λ, projection onto Cd) for
+ * two ways of calculating the denominator of λ, i.e., the sum of squares of b
+ * after the projection onto Mw:
+ *
+ *   "before" - a separate pass over the whole array b after the backward DFT;
+ *
+ *   "after" - Parseval's theorem applied to the Fourier coefficients in the
+ *             passband, which are the only nonzero coefficients of b (see
+ *             f_apd_dft_power). This is the way of the library.
+ *
+ * The modeled numbers of bytes moved per iteration count the elementwise passes
+ * only (the DFTs are the same in both cases): 7 arrays of 8-byte elements before
+ * (the pass over b, and 3 arrays read and 3 written by the projection onto Cd) and
+ * 6 arrays plus the passband coefficients after. The relative difference of the
+ * infeasibility errors after n_rep iterations shows that both ways agree up to
+ * rounding. The results are printed to stdout as a table. Compile this program by
+ * using Option 1 described in the documentation.
+ */
+
+
+#ifndef _WIN32
+
+    #define _POSIX_C_SOURCE 200809L
+
+#endif
+
+
+#include <stdlib.h>
+
+#include <stdio.h>
+
+#include <math.h>
+
+#include <time.h>
+
+#include "h_bench.h"
+
+#include "f_apd_demodulation.c"
+
+
+
+
+static int f_bench_iter ( const int fused, \
+
+                          const int D, \
+
+                          const long* N, \
+
+                          const long n_rep, \
+
+                          double* t_out, \
+
+                          double* E_out )
+{
+/* Average time of an AP-A iteration with the denominator of λ calculated by a
+ * separate pass over b (fused = 0) or by the projection onto Mw (fused = 1), and
+ * the infeasibility error after n_rep iterations */
+
+    int exitflag = 0;
+
+    long i, j, r;
+
+    long nx_2;
+
+    long n_i;
+
+    long iL[3];
+
+    long iR[3];
+
+    double t0;
+
+    double nom = 0;
+
+    double denom;
+
+    double lambda;
+
+    double *s = NULL;
+
+    double *s_abs = NULL;
+
+    double *a = NULL;
+
+    double *b = NULL;
+
+    struct strAPD_DFT dft = {0};
+
+    const struct strAPD_Kern *kern = f_apd_kernels (APD_KERN_LEVEL);
+
+
+    /* Signal arrays in the DFT layout */
+
+    nx_2 = 2*(N[D-1]/2+1);
+
+    for (j=0; j<D-1; j++)
+
+        nx_2 = nx_2 * N[j];
+
+
+    s = (double*) malloc(nx_2*sizeof(double));
+
+    s_abs = (double*) malloc(nx_2*sizeof(double));
+
+    a = (double*) malloc(nx_2*sizeof(double));
+
+    b = (double*) malloc(nx_2*sizeof(double));
+
+    if (s == NULL || s_abs == NULL || a == NULL || b == NULL)
+    {
+        f_apd_set_error(APD_ERR_ID_MEM,__LINE__,APD_ERR_FILE);
+
+        f_apd_get_error(&exitflag, NULL, NULL, NULL);
+
+        goto finish;
+    }
+
+
+    /* Initial estimates of a and b (the additional elements of the last dimension
+     * are zero) */
+
+    n_i = N[D-1];
+
+    for (i=0; i<nx_2; i++)
+    {
+        s_abs[i] = (i % (2*(N[D-1]/2+1)) < n_i) ? \
+                   fabs(cos(0.37*i) * (1.1 + sin(1e-3*i))) : 0;
+
+        a[i] = 0;
+
+        b[i] = s_abs[i];
+
+        nom = nom + b[i] * b[i];
+    }
+
+
+
+    /* Cutoff frequency indexes (Fc = Fs/64 in every dimension) */
+
+    for (j=0; j<D; j++)
+    {
+        iL[j] = 1 + (long) ceil(N[j] / 64.0);
+
+        iR[j] = N[j] - iL[j];
+    }
+
+
+
+    /* DFT of the default backend */
+
+    exitflag = f_apd_dft_init (D, N, 0, 1, APD_PREC_DOUBLE, &dft);
+
+    if (exitflag != 0)
+
+        goto finish;
+
+
+
+    /* Iterations */
+
+    t0 = f_bench_time();
+
+    for (r=0; r<n_rep; r++)
+    {
+        exitflag = f_apd_dft_PMw (b, D, N, iL, iR, &dft, (fused) ? &denom : NULL);
+
+        if (exitflag != 0)
+
+            goto finish;
+
+        if (!fused)
+
+            denom = kern->sum_sq (b, nx_2);
+
+        lambda = (denom != 0) ? nom / denom : 1;
+
+        nom = kern->cd_a (s, s_abs, a, b, lambda, nx_2);
+    }
+
+    *t_out = (f_bench_time() - t0) / n_rep;
+
+    *E_out = nom;
+
+
+
+    finish:
+
+        f_apd_dft_free (&dft);
+
+        free(s);
+
+        free(s_abs);
+
+        free(a);
+
+        free(b);
+
+        return exitflag;
+}
+
+
+
+
+int main(void)
+{
+
+    /* Exit flag */
+
+    int exitflag = 0;
+
+
+
+    /* Sets f_apd_demodulation to return control to the calling f-tion upon error */
+
+    f_apd_set_errexit(0);
+
+
+
+    /* Iteration variables */
+
+    long k;
+
+    long j;
+
+
+
+    /* Benchmarked signal sizes (unused dimensions are ignored) */
+
+    const int n_cases = 6;
+
+    const int D[] = {1, 1, 2, 2, 3, 3};
+
+    const long N[][3] = {{1048576, 1, 1}, {4194304, 1, 1}, {1024, 1024, 1}, \
+                         {2048, 2048, 1}, {128, 128, 128}, {256, 256, 256}};
+
+    const long n_rep = 10;
+
+
+
+    /* Benchmark variables */
+
+    long nx_2;
+
+    long n_pass;
+
+    long iL;
+
+    double t_sep;
+
+    double t_fus;
+
+    double E_sep;
+
+    double E_fus;
+
+    double mb_sep;
+
+    double mb_fus;
+
+    char str_N[64];
+
+
+
+    printf(STR_NL "%-4s %-16s %-14s %-14s %-12s %-12s %-9s %-10s" STR_NL, "D", \
+           "N", "before [MB]", "after [MB]", "before [ms]", "after [ms]", \
+           "speedup", "E rel diff");
+
+
+    for (k=0; k<n_cases; k++)
+    {
+        exitflag = f_bench_iter (0, D[k], N[k], n_rep, &t_sep, &E_sep);
+
+        if (exitflag != 0)
+
+            goto failed;
+
+        exitflag = f_bench_iter (1, D[k], N[k], n_rep, &t_fus, &E_fus);
+
+        if (exitflag != 0)
+
+            goto failed;
+
+
+        /* Modeled bytes per iteration (the passband has n_pass coefficients) */
+
+        nx_2 = 2*(N[k][D[k]-1]/2+1);
+
+        iL = 1 + (long) ceil(N[k][D[k]-1] / 64.0);
+
+        n_pass = (iL < N[k][D[k]-1]/2+1) ? iL : N[k][D[k]-1]/2+1;
+
+        for (j=0; j<D[k]-1; j++)
+        {
+            nx_2 = nx_2 * N[k][j];
+
+            iL = 1 + (long) ceil(N[k][j] / 64.0);
+
+            n_pass = n_pass * ((2*iL-1 < N[k][j]) ? 2*iL-1 : N[k][j]);
+        }
+
+        mb_sep = 7.0 * 8 * nx_2 / 1048576;
+
+        mb_fus = (6.0 * 8 * nx_2 + 16.0 * n_pass) / 1048576;
+
+
+        if (D[k] == 1)
+
+            sprintf(str_N, "%ld", N[k][0]);
+
+        else if (D[k] == 2)
+
+            sprintf(str_N, "%ldx%ld", N[k][0], N[k][1]);
+
+        else
+
+            sprintf(str_N, "%ldx%ldx%ld", N[k][0], N[k][1], N[k][2]);
+
+
+        printf("%-4d %-16s %-14.2f %-14.2f %-12.3f %-12.3f %-9.2f %-10.1e" STR_NL, \
+               D[k], str_N, mb_sep, mb_fus, 1e3*t_sep, 1e3*t_fus, t_sep/t_fus, \
+               fabs(E_fus - E_sep) / E_sep);
+    }
+
+    printf(STR_NL);
+
+
+
+    /* Output */
+
+    finish:
+
+        return exitflag;
+
+    failed:
+
+        f_apd_print_error(exitflag);
+
+        goto finish;
+
+}
@@ -0,0 +1,338 @@
+
+/*                       C O P Y R I G H T   N O T I C E
+ *
+ * Copyright ©2021. Institute of Science and Technology Austria (IST Austria).
+ * All Rights Reserved. The underlying technology is protected by PCT Patent
+ * Application No. PCT/EP2021/054650.
+ *
+ * This file is part of the AP Demodulation library, which is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation in version 2.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY, without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE. See the GNU General Public License v2 for more details. You
+ * should have received a copy of the GNU General Public License v2 along with this
+ * program. If not, see https://www.gnu.org/licenses/.
+ *
+ * Contact the Technology Transfer Office, IST Austria, Am Campus 1,
+ * A-3400 Klosterneuburg, Austria, +43-(0)2243 9000, twist@ist.ac.at, for commercial
+ * licensing opportunities.
+ *
+ * See https://github.com/mgabriel-lt/ap-demodulation for the latest version of the
+ * code and user-friendly explanations on the working principle, domains of
+ * application, and advice on the usage of different AP Demodulation algorithms in
+ * practice.
+ */
+
+
+/* BENCHMARK: BATCH DEMODULATION
+ *
+ * This program measures the throughput (demodulated segments per second) of
+ * f_apd_demodulation_batch for many independent 1D segments of mixed lengths and
+ * different numbers of threads. The reference is one call of f_apd_demodulation
+ * per segment in a single thread. All runs must give identical modulators and
+ * iteration numbers, which is checked as well. The results are printed to stdout as
+ * a table. Compile this program by using Option 1 described in the documentation
+ * (with -lpthread added on Linux and macOS); the maximum number of threads can be
+ * given as the first command-line argument (default: number of online processors).
+ */
+
+
+#ifndef _WIN32
+
+    #define _POSIX_C_SOURCE 200809L
+
+#endif
+
+
+#include <stdlib.h>
+
+#include <stdio.h>
+
+#include <math.h>
+
+#include <time.h>
+
+#include "h_bench.h"
+
+#include "f_apd_demodulation.c"
+
+
+
+
+int main(int argc, char** argv)
+{
+
+    /* Exit flag */
+
+    int exitflag = 0;
+
+
+
+    /* Sets f_apd_demodulation to return control to the calling f-tion upon error */
+
+    f_apd_set_errexit(0);
+
+
+
+    /* Iteration variables */
+
+    long i;
+
+    long j;
+
+    int k;
+
+
+
+    /* Segments: n_seg segments with lengths cycling through n[] */
+
+    const int n_len = 5;
+
+    const long n[] = {256, 1000, 512, 4096, 1500};
+
+    const long n_seg = 20000;
+
+    int n_thr_max = (argc > 1) ? atoi(argv[1]) : 0;
+
+
+
+    /* Benchmark variables */
+
+    double t0;
+
+    double t_ref;
+
+    double t_bat;
+
+    int n_thr;
+
+    long n_tot = 0;
+
+    long n_bad;
+
+    long *off = NULL;
+
+    long *it_ref = NULL;
+
+    double *s = NULL;
+
+    double *m_ref = NULL;
+
+    double *m_bat = NULL;
+
+    double *e_out = NULL;
+
+    struct strAPD_Job *jobs = NULL;
+
+
+
+    /* Demodulation parameters (AP-Basic, 20 iterations, Fc = Fs/64), one per
+     * segment length */
+
+    struct strAPD_Par Par[5];
+
+    long im[2] = {1, 20};
+
+    long ie[2] = {1, 20};
+
+    for (k=0; k<n_len; k++)
+    {
+        Par[k].Al = 'B';
+
+        Par[k].D = 1;
+
+        Par[k].Fs[0] = 1;
+
+        Par[k].Fc[0] = 1.0/64;
+
+        Par[k].Et = 0;
+
+        Par[k].Ni = 20;
+
+        Par[k].Ns[0] = n[k];
+
+        Par[k].Cp = 1;
+
+        Par[k].im = im;
+
+        Par[k].ie = ie;
+    }
+
+    #ifndef APD_NO_PTHREADS
+
+        #ifdef _SC_NPROCESSORS_ONLN
+
+            if (n_thr_max < 1)
+
+                n_thr_max = (int) sysconf(_SC_NPROCESSORS_ONLN);
+
+        #endif
+
+    #endif
+
+    if (n_thr_max < 1)
+
+        n_thr_max = 1;
+
+
+
+    /* Memory allocation */
+
+    off = (long*) malloc((n_seg+1)*sizeof(long));
+
+    it_ref = (long*) malloc(n_seg*sizeof(long));
+
+    e_out = (double*) malloc(n_seg*sizeof(double));
+
+    jobs = (struct strAPD_Job*) malloc(n_seg*sizeof(struct strAPD_Job));
+
+    if (off == NULL || it_ref == NULL || e_out == NULL || jobs == NULL)
+    {
+        f_apd_set_error(APD_ERR_ID_MEM,__LINE__,APD_ERR_FILE);
+
+        f_apd_get_error(&exitflag, NULL, NULL, NULL);
+
+        goto failed;
+    }
+
+    off[0] = 0;
+
+    for (j=0; j<n_seg; j++)
+
+        off[j+1] = off[j] + n[j%n_len];
+
+    n_tot = off[n_seg];
+
+
+    s = (double*) malloc(n_tot*sizeof(double));
+
+    m_ref = (double*) malloc(n_tot*sizeof(double));
+
+    m_bat = (double*) malloc(n_tot*sizeof(double));
+
+    if (s == NULL || m_ref == NULL || m_bat == NULL)
+    {
+        f_apd_set_error(APD_ERR_ID_MEM,__LINE__,APD_ERR_FILE);
+
+        f_apd_get_error(&exitflag, NULL, NULL, NULL);
+
+        goto failed;
+    }
+
+
+    /* Segments of an amplitude-modulated harmonic signal */
+
+    for (i=0; i<n_tot; i++)
+
+        s[i] = (1.1 + sin(2*M_PI*i/(8.0*n[0]))) * cos(0.37*i);
+
+
+
+    /* Reference: one f_apd_demodulation call per segment */
+
+    t0 = f_bench_time();
+
+    for (j=0; j<n_seg; j++)
+    {
+        exitflag = f_apd_demodulation (s+off[j], Par+(j%n_len), NULL, NULL, \
+                m_ref+off[j], e_out+j, it_ref+j);
+
+        if (exitflag != 0)
+
+            goto failed;
+    }
+
+    t_ref = f_bench_time() - t0;
+
+
+    printf(STR_NL "%-10s %-14s %-18s %-10s %-10s" STR_NL, "threads", \
+           "time [s]", "segments per s", "speedup", "mismatches");
+
+    printf("%-10s %-14.3f %-18.0f %-10.2f %-10d" STR_NL, "serial", t_ref, \
+           n_seg/t_ref, 1.0, 0);
+
+
+
+    /* Batch demodulation with 1, 2, 4, ..., n_thr_max threads */
+
+    for (n_thr=1; ; n_thr = (2*n_thr < n_thr_max) ? 2*n_thr : n_thr_max)
+    {
+        for (j=0; j<n_seg; j++)
+        {
+            jobs[j].s = s + off[j];
+
+            jobs[j].Par = Par + (j%n_len);
+
+            jobs[j].Ub = NULL;
+
+            jobs[j].t = NULL;
+
+            jobs[j].out_m = m_bat + off[j];
+
+            jobs[j].out_e = e_out + j;
+
+            jobs[j].opt = NULL;
+        }
+
+        t0 = f_bench_time();
+
+        exitflag = f_apd_demodulation_batch (jobs, n_seg, n_thr);
+
+        t_bat = f_bench_time() - t0;
+
+        if (exitflag != 0)
+
+            goto failed;
+
+
+        n_bad = 0;
+
+        for (j=0; j<n_seg; j++)
+        {
+            if (jobs[j].exitflag != 0 || jobs[j].iter != it_ref[j] || \
+                    memcmp(m_bat+off[j], m_ref+off[j], n[j%n_len]*sizeof(double)))
+
+                n_bad++;
+        }
+
+        printf("%-10d %-14.3f %-18.0f %-10.2f %-10ld" STR_NL, n_thr, t_bat, \
+               n_seg/t_bat, t_ref/t_bat, n_bad);
+
+        if (n_thr == n_thr_max)
+
+            break;
+    }
+
+    printf(STR_NL);
+
+
+
+    /* Output & Memory deallocation */
+
+    finish:
+
+        free(off);
+
+        free(it_ref);
+
+        free(e_out);
+
+        free(jobs);
+
+        free(s);
+
+        free(m_ref);
+
+        free(m_bat);
+
+        return exitflag;
+
+    failed:
+
+        f_apd_print_error(exitflag);
+
+        goto finish;
+
+}
@@ -0,0 +1,432 @@
+
+/*                       C O P Y R I G H T   N O T I C E
+ *
+ * Copyright ©2021. Institute of Science and Technology Austria (IST Austria).
+ * All Rights Reserved. The underlying technology is protected by PCT Patent
+ * Application No. PCT/EP2021/054650.
+ *
+ * This file is part of the AP Demodulation library, which is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation in version 2.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY, without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE. See the GNU General Public License v2 for more details. You
+ * should have received a copy of the GNU General Public License v2 along with this
+ * program. If not, see https://www.gnu.org/licenses/.
+ *
+ * Contact the Technology Transfer Office, IST Austria, Am Campus 1,
+ * A-3400 Klosterneuburg, Austria, +43-(0)2243 9000, twist@ist.ac.at, for commercial
+ * licensing opportunities.
+ *
+ * See https://github.com/mgabriel-lt/ap-demodulation for the latest version of the
+ * code and user-friendly explanations on the working principle, domains of
+ * application, and advice on the usage of different AP Demodulation algorithms in
+ * practice.
+ */
+
+
+
+/* BENCHMARK: DFT PROJECTION ONTO Mw
+ *
+ * This program measures the time per AP iteration spent in the projection onto the
+ * set Mw (forward DFT, masking in the Fourier domain, backward DFT) for 2D and 3D
+ * signals of several sizes. Two implementations are compared:
+ *
+ *   "recommit" - a single DFT descriptor whose input and output strides are
+ *                swapped and which is recommitted twice per projection (the scheme
+ *                used by f_apd_mkl_dft_PMw before the forward and backward
+ *                descriptors were separated);
+ *
+ *   "precommit" - f_apd_mkl_dft_PMw with the two descriptors committed once by
+ *                 f_apd_mkl_dft_init.
+ *
+ * The results are printed to stdout as a table. Compile this program by using
+ * Option 1 described in the documentation. Both implementations use the Intel MKL
+ * DFT, so that the program only prints a message that it is skipped if compiled
+ * with the macro APD_NO_MKL.
+ */
+
+
+#ifndef _WIN32
+
+    #define _POSIX_C_SOURCE 200809L
+
+#endif
+
+
+#include <stdlib.h>
+
+#include <stdio.h>
+
+#include <math.h>
+
+#include <time.h>
+
+#include "h_bench.h"
+
+#include "f_apd_demodulation.c"
+
+
+
+
+#ifndef APD_NO_MKL
+
+
+
+static int f_bench_PMw_recommit ( double* s, \
+
+                                  const int D, \
+
+                                  const long* N, \
+
+                                  const long* iL, \
+
+                                  const long* iR, \
+
+                                  DFTI_DESCRIPTOR_HANDLE dft_handle )
+{
+/* Projection onto Mw with a single descriptor recommitted for every transform */
+
+    long i1, i2, i3;
+
+    MKL_LONG rs[4], cs[4];
+
+
+    cs[D] = 1;
+
+    rs[D] = 1;
+
+    cs[D-1] = (N[D-1]/2+1);
+
+    rs[D-1] = cs[D-1]*2;
+
+    for (i1=D-2; i1>0; i1--)
+    {
+        cs[i1] = cs[i1+1] * N[i1];
+
+        rs[i1] = rs[i1+1] * N[i1];
+    }
+
+    cs[0] = 0;
+
+    rs[0] = 0;
+
+
+    if (DftiSetValue(dft_handle, DFTI_INPUT_STRIDES, rs) != DFTI_NO_ERROR || \
+        DftiSetValue(dft_handle, DFTI_OUTPUT_STRIDES, cs) != DFTI_NO_ERROR || \
+        DftiCommitDescriptor(dft_handle) != DFTI_NO_ERROR || \
+        DftiComputeForward(dft_handle, s) != DFTI_NO_ERROR)
+
+        return 1;
+
+
+    if (D == 2)
+    {
+        for (i2 = 2*iL[1]; i2 < 2*(N[1]/2+1); i2++)
+
+            for (i1 = 0; i1 < N[0]; i1++)
+
+                s[rs[1]*i1+rs[2]*i2] = 0;
+
+        for (i2 = 0; i2 < 2*iL[1]; i2++)
+
+            for (i1 = iL[0]; i1 <= iR[0]; i1++)
+
+                s[rs[1]*i1+rs[2]*i2] = 0;
+    }
+
+    else
+    {
+        for (i3 = 2*iL[2]; i3 < 2*(N[2]/2+1); i3++)
+
+            for (i2 = 0; i2 < N[1]; i2++)
+
+                for (i1 = 0; i1 < N[0]; i1++)
+
+                    s[rs[1]*i1+rs[2]*i2+rs[3]*i3] = 0;
+
+        for (i3 = 0; i3 < 2*iL[2]; i3++)
+
+            for (i2 = iL[1]; i2 <= iR[1]; i2++)
+
+                for (i1 = 0; i1 < N[0]; i1++)
+
+                    s[rs[1]*i1+rs[2]*i2+rs[3]*i3] = 0;
+
+        for (i3 = 0; i3 < 2*iL[2]; i3++)
+
+            for (i1 = iL[0]; i1 <= iR[0]; i1++)
+            {
+                for (i2 = 0; i2 < iL[1]; i2++)
+
+                    s[rs[1]*i1+rs[2]*i2+rs[3]*i3] = 0;
+
+                for (i2 = iR[1]+1; i2 < N[1]; i2++)
+
+                    s[rs[1]*i1+rs[2]*i2+rs[3]*i3] = 0;
+            }
+    }
+
+
+    if (DftiSetValue(dft_handle, DFTI_INPUT_STRIDES, cs) != DFTI_NO_ERROR || \
+        DftiSetValue(dft_handle, DFTI_OUTPUT_STRIDES, rs) != DFTI_NO_ERROR || \
+        DftiCommitDescriptor(dft_handle) != DFTI_NO_ERROR || \
+        DftiComputeBackward(dft_handle, s) != DFTI_NO_ERROR)
+
+        return 1;
+
+
+    return 0;
+}
+
+
+
+
+int main(void)
+{
+
+    /* Exit flag */
+
+    int exitflag = 0;
+
+
+
+    /* Sets f_apd_demodulation to return control to the calling f-tion upon error */
+
+    f_apd_set_errexit(0);
+
+
+
+    /* Iteration variables */
+
+    long i;
+
+    long j;
+
+    long k;
+
+
+
+    /* Benchmarked signal sizes (the third dimension is ignored for D=2) */
+
+    const int n_cases = 6;
+
+    const int D[] = {2, 2, 2, 3, 3, 3};
+
+    const long N[][3] = {{256, 256, 1}, {1024, 1024, 1}, {2048, 2048, 1}, \
+                         {64, 64, 64}, {128, 128, 128}, {256, 256, 256}};
+
+    const long n_rep = 20;
+
+
+
+    /* Benchmark variables */
+
+    long nx_2;
+
+    long iL[3];
+
+    long iR[3];
+
+    double t0;
+
+    double t_old;
+
+    double t_new;
+
+    double *s = NULL;
+
+    char str_N[64];
+
+    DFTI_DESCRIPTOR_HANDLE dft_handle[2] = {0, 0};
+
+
+
+    printf(STR_NL "%-4s %-18s %-16s %-16s %-8s" STR_NL, "D", "N", \
+           "recommit [ms]", "precommit [ms]", "speedup");
+
+
+    for (k=0; k<n_cases; k++)
+    {
+        /* Signal array in the MKL DFT layout */
+
+        nx_2 = 2*(N[k][D[k]-1]/2+1);
+
+        for (j=0; j<D[k]-1; j++)
+
+            nx_2 = nx_2 * N[k][j];
+
+
+        s = (double*) malloc(nx_2*sizeof(double));
+
+        if (s == NULL)
+        {
+            f_apd_set_error(APD_ERR_ID_MEM,__LINE__,APD_ERR_FILE);
+
+            f_apd_get_error(&exitflag, NULL, NULL, NULL);
+
+            goto failed;
+        }
+
+        for (i=0; i<nx_2; i++)
+
+            s[i] = fabs(cos(0.37*i) * (1.1 + sin(1e-3*i)));
+
+
+
+        /* Cutoff frequency indexes (Fc = Fs/64 in every dimension) */
+
+        for (j=0; j<D[k]; j++)
+        {
+            iL[j] = 1 + (long) ceil(N[k][j] / 64.0);
+
+            iR[j] = N[k][j] - iL[j];
+        }
+
+
+
+        /* Descriptors */
+
+        exitflag = f_apd_mkl_dft_init (D[k], N[k], 0, 1, APD_PREC_DOUBLE, \
+                                       dft_handle);
+
+        if (exitflag != 0)
+
+            goto failed;
+
+
+
+        /* Old scheme: one descriptor recommitted twice per projection */
+
+        t0 = f_bench_time();
+
+        for (i=0; i<n_rep; i++)
+        {
+            if (f_bench_PMw_recommit(s, D[k], N[k], iL, iR, dft_handle[0]) != 0)
+            {
+                f_apd_set_error(APD_ERR_ID_FT4,__LINE__,APD_ERR_FILE);
+
+                f_apd_get_error(&exitflag, NULL, NULL, NULL);
+
+                goto failed;
+            }
+        }
+
+        t_old = (f_bench_time() - t0) / n_rep;
+
+
+
+        /* The forward descriptor has been modified above */
+
+        DftiFreeDescriptor (dft_handle);
+
+        DftiFreeDescriptor (dft_handle+1);
+
+        dft_handle[0] = 0;
+
+        dft_handle[1] = 0;
+
+        exitflag = f_apd_mkl_dft_init (D[k], N[k], 0, 1, APD_PREC_DOUBLE, \
+                                       dft_handle);
+
+        if (exitflag != 0)
+
+            goto failed;
+
+
+
+        /* New scheme: pre-committed forward and backward descriptors */
+
+        t0 = f_bench_time();
+
+        for (i=0; i<n_rep; i++)
+        {
+            exitflag = f_apd_mkl_dft_PMw (s, D[k], N[k], iL, iR, dft_handle, NULL);
+
+            if (exitflag != 0)
+
+                goto failed;
+        }
+
+        t_new = (f_bench_time() - t0) / n_rep;
+
+
+
+        if (D[k] == 2)
+
+            sprintf(str_N, "%ldx%ld", N[k][0], N[k][1]);
+
+        else
+
+            sprintf(str_N, "%ldx%ldx%ld", N[k][0], N[k][1], N[k][2]);
+
+
+        printf("%-4d %-18s %-16.3f %-16.3f %-8.2f" STR_NL, D[k], str_N, \
+               1e3*t_old, 1e3*t_new, t_old/t_new);
+
+
+        DftiFreeDescriptor (dft_handle);
+
+        DftiFreeDescriptor (dft_handle+1);
+
+        dft_handle[0] = 0;
+
+        dft_handle[1] = 0;
+
+        free(s);
+
+        s = NULL;
+    }
+
+    printf(STR_NL);
+
+
+
+    /* Output & Memory deallocation */
+
+    finish:
+
+        free(s);
+
+        if (dft_handle[0] != 0)
+
+            DftiFreeDescriptor (dft_handle);
+
+        if (dft_handle[1] != 0)
+
+            DftiFreeDescriptor (dft_handle+1);
+
+        return exitflag;
+
+    failed:
+
+        f_apd_print_error(exitflag);
+
+        goto finish;
+
+}
+
+
+
+
+#else
+
+
+
+
+int main(void)
+{
+/* The compared implementations of the projection onto Mw are based on the Intel
+ * MKL DFT */
+
+    printf(STR_NL "benchmark_dft: skipped (the library is compiled with " \
+           "APD_NO_MKL)" STR_NL STR_NL);
+
+    return 0;
+}
+
+
+
+
+#endif
@@ -0,0 +1,298 @@
+
+/*                       C O P Y R I G H T   N O T I C E
+ *
+ * Copyright ©2021. Institute of Science and Technology Austria (IST Austria).
+ * All Rights Reserved. The underlying technology is protected by PCT Patent
+ * Application No. PCT/EP2021/054650.
+ *
+ * This file is part of the AP Demodulation library, which is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation in version 2.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY, without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE. See the GNU General Public License v2 for more details. You
+ * should have received a copy of the GNU General Public License v2 along with this
+ * program. If not, see https://www.gnu.org/licenses/.
+ *
+ * Contact the Technology Transfer Office, IST Austria, Am Campus 1,
+ * A-3400 Klosterneuburg, Austria, +43-(0)2243 9000, twist@ist.ac.at, for commercial
+ * licensing opportunities.
+ *
+ * See https://github.com/mgabriel-lt/ap-demodulation for the latest version of the
+ * code and user-friendly explanations on the working principle, domains of
+ * application, and advice on the usage of different AP Demodulation algorithms in
+ * practice.
+ */
+
+/* BENCHMARK: PRE-FLIGHT ESTIMATE OF THE DEMODULATION
+ *
+ * This program estimates the resources of the demodulation of 1D, 2D, and 3D
+ * amplitude-modulated signals by AP-Basic, AP-Accelerated, and AP-Projected before
+ * it is started (see f_apd_estimate), then demodulates the signals, and compares
+ * the estimate with the statistics of the demodulation (see f_apd_get_stats). For
+ * every case, it prints the time of the estimate with the calibration of the host
+ * and of a repeated estimate (which reuses the calibration), the estimated peak
+ * memory and the peak memory allocated by the library in f_apd_demodulation
+ * (counted by a hook on its allocations), the estimated and the allocated memory
+ * of the plan, the floating-point operations per iteration, and the estimated and
+ * the measured time per iteration and their ratio. The results are printed to
+ * stdout as a table. With the built-in FFT, the estimated and the counted peak
+ * memory must be equal, and the program returns a nonzero value otherwise (with
+ * oneMKL, whose internal memory is not counted, they are not compared). Compile
+ * this program by using Option 1 described in the documentation.
+ */
+
+
+#ifndef _WIN32
+
+    #define _POSIX_C_SOURCE 200809L
+
+#endif
+
+
+#include <stdlib.h>
+
+#include <stdio.h>
+
+#include <math.h>
+
+#include <string.h>
+
+#include <time.h>
+
+
+
+/* Allocation-counting hook of h_bench.h on the library */
+
+#define BENCH_ALLOC_HOOK
+
+#include "h_bench.h"
+
+#include "f_apd_demodulation.c"
+
+
+
+
+int main(void)
+{
+
+    /* Exit flag */
+
+    int exitflag = 0;
+
+
+
+    /* Sets f_apd_demodulation to return control to the calling f-tion upon error */
+
+    f_apd_set_errexit(0);
+
+
+
+    /* Iteration variables */
+
+    long i;
+
+    int k;
+
+    int a;
+
+
+
+    /* Benchmarked signal shapes (a power of two, a prime, and square and cubic
+     * grids) and algorithms */
+
+    const int n_cases = 4;
+
+    const int D[] = {1, 1, 2, 3};
+
+    const long N[][3] = {{1048576, 0, 0}, {1000003, 0, 0}, {1024, 1024, 0}, \
+                         {128, 128, 128}};
+
+    const char *str_N[] = {"1048576", "1000003", "1024^2", "128^3"};
+
+    const char Al[] = {'B', 'A', 'P'};
+
+
+
+    /* Benchmark variables */
+
+    long n;
+
+    long iter;
+
+    double t_est;
+
+    double t_rep;
+
+    double e;
+
+    size_t peak;
+
+    int n_check = 0;
+
+    int n_fail = 0;
+
+    double *s = NULL;
+
+    double *m = NULL;
+
+    struct strAPD_Est Est;
+
+    struct strAPD_Stats St;
+
+
+
+    /* Demodulation parameters (a fixed number of 20 iterations, Fc = Fs/512 in
+     * every dimension; the final modulator and error are saved) */
+
+    struct strAPD_Par Par;
+
+    long im[2] = {1, 20};
+
+    long ie[2] = {1, 20};
+
+    for (i=0; i<3; i++)
+    {
+        Par.Fs[i] = 1;
+
+        Par.Fc[i] = 1.0/512;
+    }
+
+    Par.Et = 0;
+
+    Par.Ni = 20;
+
+    Par.Br = 0;
+
+    Par.Cp = 1;
+
+    Par.im = im;
+
+    Par.ie = ie;
+
+
+
+    printf(STR_NL "%-8s %-3s %-9s %-9s %-11s %-11s %-11s %-11s %-9s %-9s %-9s " \
+           "%-6s %s" STR_NL, "N", "Al", "est [ms]", "rep [ms]", "peak est", "peak", \
+           "plan est", "plan", "MFLOP/it", "est [ms]", "t/it [ms]", "ratio", \
+           "peak");
+
+
+    for (k=0; k<n_cases; k++)
+    {
+        Par.D = D[k];
+
+        n = 1;
+
+        for (i=0; i<D[k]; i++)
+        {
+            Par.Ns[i] = N[k][i];
+
+            n = n * N[k][i];
+        }
+
+        s = (double*) malloc(n*sizeof(double));
+
+        m = (double*) malloc(n*sizeof(double));
+
+        if (s == NULL || m == NULL)
+        {
+            f_apd_set_error(APD_ERR_ID_MEM,__LINE__,APD_ERR_FILE);
+
+            f_apd_get_error(&exitflag, NULL, NULL, NULL);
+
+            goto failed;
+        }
+
+
+        /* Amplitude-modulated harmonic signal (the modulator varies along every
+         * dimension) */
+
+        f_bench_am (D[k], N[k], 2000.0, s);
+
+
+        for (a=0; a<3; a++)
+        {
+            Par.Al = Al[a];
+
+
+            /* Estimate with the calibration of the host (cold) and repeated */
+
+            t_est = f_bench_time();
+
+            exitflag = f_apd_estimate (&Par, 0, 0, 1, NULL, &Est);
+
+            t_est = f_bench_time() - t_est;
+
+            if (exitflag != 0)
+
+                goto failed;
+
+            t_rep = f_bench_time();
+
+            exitflag = f_apd_estimate (&Par, 0, 0, 1, NULL, &Est);
+
+            t_rep = f_bench_time() - t_rep;
+
+            if (exitflag != 0)
+
+                goto failed;
+
+
+            /* Demodulation, its statistics, and the peak memory allocated by the
+             * library */
+
+            sgBENCH_PEAK = sgBENCH_USE;
+
+            exitflag = f_apd_demodulation (s, &Par, NULL, NULL, m, &e, &iter);
+
+            peak = sgBENCH_PEAK - sgBENCH_USE;
+
+            if (exitflag != 0)
+
+                goto failed;
+
+            f_apd_get_stats (&St);
+
+
+            printf("%-8s %-3c %-9.1f %-9.2f %-11.0f %-11.0f %-11.0f %-11.0f " \
+                   "%-9.1f %-9.2f %-9.2f %-6.2f %s" STR_NL, str_N[k], Al[a], \
+                   1e3*t_est, 1e3*t_rep, (double) Est.bytes, (double) peak, \
+                   (double) Est.bytes_plan, (double) St.bytes, 1e-6*Est.flops, \
+                   1e3*Est.t_iter, 1e3*St.t_iter, Est.t_iter/St.t_iter, \
+                   (Est.dft != APD_DFT_BUILTIN) ? "-" : \
+                   f_bench_check (peak == Est.bytes, &n_check, &n_fail));
+        }
+
+
+        free(s);
+
+        free(m);
+
+        s = NULL;
+
+        m = NULL;
+    }
+
+    exitflag = f_bench_verdict (n_fail, n_check, "peaks differ from the estimate");
+
+
+
+    /* Output & Memory deallocation */
+
+    finish:
+
+        free(s);
+
+        free(m);
+
+        return exitflag;
+
+    failed:
+
+        f_apd_print_error(exitflag);
+
+        goto finish;
+
+}
@@ -0,0 +1,296 @@
+
+/*                       C O P Y R I G H T   N O T I C E
+ *
+ * Copyright ©2021. Institute of Science and Technology Austria (IST Austria).
+ * All Rights Reserved. The underlying technology is protected by PCT Patent
+ * Application No. PCT/EP2021/054650.
+ *
+ * This file is part of the AP Demodulation library, which is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation in version 2.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY, without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE. See the GNU General Public License v2 for more details. You
+ * should have received a copy of the GNU General Public License v2 along with this
+ * program. If not, see https://www.gnu.org/licenses/.
+ *
+ * Contact the Technology Transfer Office, IST Austria, Am Campus 1,
+ * A-3400 Klosterneuburg, Austria, +43-(0)2243 9000, twist@ist.ac.at, for commercial
+ * licensing opportunities.
+ *
+ * See https://github.com/mgabriel-lt/ap-demodulation for the latest version of the
+ * code and user-friendly explanations on the working principle, domains of
+ * application, and advice on the usage of different AP Demodulation algorithms in
+ * practice.
+ */
+
+
+/* BENCHMARK: DFT BACKENDS
+ *
+ * This program measures the time of one projection onto the set Mw (forward DFT,
+ * masking in the Fourier domain, backward DFT) with the DFT backends available in
+ * AP Demodulation (see f_apd_set_dft_backend):
+ *
+ *   "MKL" - Intel MKL DFT (skipped if compiled with the macro APD_NO_MKL);
+ *
+ *   "built-in" - the mixed-radix FFT of l_apd_fft.c.
+ *
+ * Power-of-two, 5-smooth, and prime (Bluestein's algorithm) signal lengths are
+ * tested in 1D, and power-of-two and 5-smooth sizes in 2D and 3D. The results are
+ * printed to stdout as a table. Compile this program by using Option 1 described in
+ * the documentation (add -DAPD_NO_MKL to compile without Intel MKL).
+ */
+
+
+#ifndef _WIN32
+
+    #define _POSIX_C_SOURCE 200809L
+
+#endif
+
+
+#include <stdlib.h>
+
+#include <stdio.h>
+
+#include <math.h>
+
+#include <time.h>
+
+#include "h_bench.h"
+
+#include "f_apd_demodulation.c"
+
+
+
+
+static int f_bench_PMw ( const int backend, \
+
+                         const int D, \
+
+                         const long* N, \
+
+                         const long n_rep, \
+
+                         double* t_out )
+{
+/* Average time of the projection onto Mw with the given DFT backend */
+
+    int exitflag = 0;
+
+    long i, j;
+
+    long nx_2;
+
+    long iL[3];
+
+    long iR[3];
+
+    double t0;
+
+    double *s = NULL;
+
+    struct strAPD_DFT dft = {0};
+
+
+    /* Signal array in the DFT layout */
+
+    nx_2 = 2*(N[D-1]/2+1);
+
+    for (j=0; j<D-1; j++)
+
+        nx_2 = nx_2 * N[j];
+
+
+    s = (double*) malloc(nx_2*sizeof(double));
+
+    if (s == NULL)
+    {
+        f_apd_set_error(APD_ERR_ID_MEM,__LINE__,APD_ERR_FILE);
+
+        f_apd_get_error(&exitflag, NULL, NULL, NULL);
+
+        goto finish;
+    }
+
+    for (i=0; i<nx_2; i++)
+
+        s[i] = fabs(cos(0.37*i) * (1.1 + sin(1e-3*i)));
+
+
+
+    /* Cutoff frequency indexes (Fc = Fs/64 in every dimension) */
+
+    for (j=0; j<D; j++)
+    {
+        iL[j] = 1 + (long) ceil(N[j] / 64.0);
+
+        iR[j] = N[j] - iL[j];
+    }
+
+
+
+    /* DFT of the selected backend (one warm-up projection) */
+
+    exitflag = f_apd_set_dft_backend (backend);
+
+    if (exitflag != 0)
+
+        goto finish;
+
+    exitflag = f_apd_dft_init (D, N, 0, 1, APD_PREC_DOUBLE, &dft);
+
+    if (exitflag != 0)
+
+        goto finish;
+
+    exitflag = f_apd_dft_PMw (s, D, N, iL, iR, &dft, NULL);
+
+    if (exitflag != 0)
+
+        goto finish;
+
+
+
+    t0 = f_bench_time();
+
+    for (i=0; i<n_rep; i++)
+    {
+        exitflag = f_apd_dft_PMw (s, D, N, iL, iR, &dft, NULL);
+
+        if (exitflag != 0)
+
+            goto finish;
+    }
+
+    *t_out = (f_bench_time() - t0) / n_rep;
+
+
+
+    finish:
+
+        f_apd_dft_free (&dft);
+
+        free(s);
+
+        return exitflag;
+}
+
+
+
+
+int main(void)
+{
+
+    /* Exit flag */
+
+    int exitflag = 0;
+
+
+
+    /* Sets f_apd_demodulation to return control to the calling f-tion upon error */
+
+    f_apd_set_errexit(0);
+
+
+
+    /* Iteration variable */
+
+    long k;
+
+
+
+    /* Benchmarked signal sizes (unused dimensions are ignored) */
+
+    const int n_cases = 10;
+
+    const int D[] = {1, 1, 1, 1, 2, 2, 2, 3, 3, 3};
+
+    const long N[][3] = {{1048576, 1, 1}, {1000000, 1, 1}, {1000003, 1, 1}, \
+                         {65536, 1, 1}, {1024, 1024, 1}, {1000, 1000, 1}, \
+                         {2048, 2048, 1}, {128, 128, 128}, {100, 120, 150}, \
+                         {256, 256, 256}};
+
+    const char* type[] = {"pow2", "5-smooth", "prime", "pow2", "pow2", "5-smooth", \
+                          "pow2", "pow2", "5-smooth", "pow2"};
+
+    const long n_rep = 10;
+
+
+
+    /* Benchmark variables */
+
+    double t_mkl = 0;
+
+    double t_bi = 0;
+
+    char str_N[64];
+
+
+
+    printf(STR_NL "%-4s %-18s %-10s %-16s %-16s %-8s" STR_NL, "D", "N", "type", \
+           "MKL [ms]", "built-in [ms]", "ratio");
+
+
+    for (k=0; k<n_cases; k++)
+    {
+        #ifndef APD_NO_MKL
+
+            exitflag = f_bench_PMw (APD_DFT_MKL, D[k], N[k], n_rep, &t_mkl);
+
+            if (exitflag != 0)
+
+                goto failed;
+
+        #endif
+
+
+        exitflag = f_bench_PMw (APD_DFT_BUILTIN, D[k], N[k], n_rep, &t_bi);
+
+        if (exitflag != 0)
+
+            goto failed;
+
+
+        if (D[k] == 1)
+
+            sprintf(str_N, "%ld", N[k][0]);
+
+        else if (D[k] == 2)
+
+            sprintf(str_N, "%ldx%ld", N[k][0], N[k][1]);
+
+        else
+
+            sprintf(str_N, "%ldx%ldx%ld", N[k][0], N[k][1], N[k][2]);
+
+
+        if (t_mkl > 0)
+
+            printf("%-4d %-18s %-10s %-16.3f %-16.3f %-8.2f" STR_NL, D[k], str_N, \
+                   type[k], 1e3*t_mkl, 1e3*t_bi, t_bi/t_mkl);
+
+        else
+
+            printf("%-4d %-18s %-10s %-16s %-16.3f %-8s" STR_NL, D[k], str_N, \
+                   type[k], "-", 1e3*t_bi, "-");
+    }
+
+    printf(STR_NL);
+
+
+
+    /* Output */
+
+    finish:
+
+        return exitflag;
+
+    failed:
+
+        f_apd_print_error(exitflag);
+
+        goto finish;
+
+}
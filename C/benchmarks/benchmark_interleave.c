@@ -0,0 +1,453 @@
+/*                       C O P Y R I G H T   N O T I C E
+ *
+ * Copyright ©2021. Institute of Science and Technology Austria (IST Austria).
+ * All Rights Reserved. The underlying technology is protected by PCT Patent
+ * Application No. PCT/EP2021/054650.
+ *
+ * This file is part of the AP Demodulation library, which is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation in version 2.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY, without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE. See the GNU General Public License v2 for more details. You
+ * should have received a copy of the GNU General Public License v2 along with this
+ * program. If not, see https://www.gnu.org/licenses/.
+ *
+ * Contact the Technology Transfer Office, IST Austria, Am Campus 1,
+ * A-3400 Klosterneuburg, Austria, +43-(0)2243 9000, twist@ist.ac.at, for commercial
+ * licensing opportunities.
+ *
+ * See https://github.com/mgabriel-lt/ap-demodulation for the latest version of the
+ * code and user-friendly explanations on the working principle, domains of
+ * application, and advice on the usage of different AP Demodulation algorithms in
+ * practice.
+ */
+
+
+/* BENCHMARK: INTERLEAVED MULTICHANNEL SIGNALS
+ *
+ * This program demodulates channel-interleaved 1D recordings (frames of n_ch
+ * samples, e.g., L R L R ... for stereo audio) by AP-Accelerated with a
+ * multichannel plan in two ways:
+ *
+ *   "copies" - the channels are deinterleaved into a separate array before the
+ *              demodulation and the modulators are interleaved again afterwards;
+ *
+ *   "strided" - the plan reads and writes the interleaved arrays directly (the
+ *               numbers of interleaved channels of the arrays are given in the
+ *               options of the plan, see f_apd_plan_create).
+ *
+ * It then demodulates the interleaved recording into modulators stored one after
+ * another ("mixed"). For every recording, it prints the times of the three ways
+ * (the best of N_REP repetitions, including the copies), the time of the copies
+ * alone, the memory of the separate arrays, and whether all ways, and the
+ * single-channel demodulation of the last channel by a plan of the interleaved
+ * arrays, give identical modulators. The results are printed to stdout as a table,
+ * and the program returns a nonzero value if the modulators differ. Compile this
+ * program by using Option 1 described in the documentation.
+ */
+
+
+#ifndef _WIN32
+
+    #define _POSIX_C_SOURCE 200809L
+
+#endif
+
+
+#include <stdlib.h>
+
+#include <stdio.h>
+
+#include <string.h>
+
+#include <math.h>
+
+#include <time.h>
+
+#include "h_bench.h"
+
+#include "f_apd_demodulation.c"
+
+
+
+#define N_REP 3
+
+
+
+
+int main(void)
+{
+
+    /* Exit flag */
+
+    int exitflag = 0;
+
+
+
+    /* Sets f_apd_demodulation to return control to the calling f-tion upon error */
+
+    f_apd_set_errexit(0);
+
+
+
+    /* Iteration variables */
+
+    long i;
+
+    long k;
+
+    int c;
+
+    int r;
+
+
+
+    /* Benchmarked recordings (channels, samples per channel, compression) */
+
+    const int n_cases = 3;
+
+    const long n_ch[] = {2, 16, 16};
+
+    const long N[] = {1L << 20, 1L << 16, 1L << 16};
+
+    const double Cp[] = {1, 1, 2};
+
+
+
+    /* Benchmark variables */
+
+    double t_cp;
+
+    double t_st;
+
+    double t_mv;
+
+    double t_mx;
+
+    double t, t_1, t_2, t_3;
+
+    int equal;
+
+    int n_check = 0;
+
+    int n_fail = 0;
+
+    long n;
+
+    long iter[16];
+
+    double e[16];
+
+    double *s = NULL;
+
+    double *m = NULL;
+
+    double *m_il = NULL;
+
+    double *s_d = NULL;
+
+    double *m_d = NULL;
+
+    double *m_s = NULL;
+
+    struct strAPD_Opt opt;
+
+    struct strAPD_Plan *plan = NULL;
+
+
+
+    /* Demodulation parameters (AP-Accelerated, Et = 10^-4, at most 1000
+     * iterations, Fc = 100 Hz at 48 kHz; the final modulator and error are saved) */
+
+    struct strAPD_Par Par;
+
+    long im[2] = {1, 1000};
+
+    long ie[2] = {1, 1000};
+
+    Par.Al = 'A';
+
+    Par.D = 1;
+
+    Par.Fs[0] = 48000;
+
+    Par.Fc[0] = 100;
+
+    Par.Et = 1e-4;
+
+    Par.Ni = 1000;
+
+    Par.Br = 1;
+
+    Par.im = im;
+
+    Par.ie = ie;
+
+
+
+    printf(STR_NL "%-6s %-10s %-4s %-12s %-12s %-12s %-12s %-10s %-6s" STR_NL, \
+           "n_ch", "N", "Cp", "copies [ms]", "strided [ms]", "mixed [ms]", \
+           "moves [ms]", "extra [MB]", "equal");
+
+
+    for (c=0; c<n_cases; c++)
+    {
+        /* Interleaved recording (amplitude-modulated harmonics, one per channel) */
+
+        n = n_ch[c] * N[c];
+
+        Par.Ns[0] = N[c];
+
+        Par.Cp = Cp[c];
+
+        s = (double*) malloc(n*sizeof(double));
+
+        m = (double*) malloc(n*sizeof(double));
+
+        m_il = (double*) malloc(n*sizeof(double));
+
+        s_d = (double*) malloc(n*sizeof(double));
+
+        m_d = (double*) malloc(n*sizeof(double));
+
+        m_s = (double*) malloc(n*sizeof(double));
+
+        if (s == NULL || m == NULL || m_il == NULL || s_d == NULL || m_d == NULL || \
+                m_s == NULL)
+        {
+            f_apd_set_error(APD_ERR_ID_MEM,__LINE__,APD_ERR_FILE);
+
+            f_apd_get_error(&exitflag, NULL, NULL, NULL);
+
+            goto failed;
+        }
+
+        for (i=0; i<N[c]; i++)
+
+            for (k=0; k<n_ch[c]; k++)
+
+                s[i*n_ch[c] + k] = (1.2 + 0.4 * sin(2*M_PI*(2.0 + k)*i / 48000)) * \
+                                   cos(2*M_PI*(600.0 + 50*k)*i / 48000 + 0.1*k);
+
+
+
+        /* Deinterleaving copies around a plan of channels stored one after
+         * another */
+
+        exitflag = f_apd_plan_create_multichannel (&Par, NULL, 0, n_ch[c], NULL, \
+                                                   &plan);
+
+        if (exitflag != 0)
+
+            goto failed;
+
+        t_cp = INFINITY;
+
+        t_mv = INFINITY;
+
+        for (r=0; r<N_REP; r++)
+        {
+            t = f_bench_time();
+
+            for (i=0; i<N[c]; i++)
+
+                for (k=0; k<n_ch[c]; k++)
+
+                    s_d[k*N[c] + i] = s[i*n_ch[c] + k];
+
+            t_1 = f_bench_time();
+
+            exitflag = f_apd_plan_execute (plan, s_d, NULL, m_d, e, iter);
+
+            if (exitflag != 0)
+
+                goto failed;
+
+            t_2 = f_bench_time();
+
+            for (i=0; i<N[c]; i++)
+
+                for (k=0; k<n_ch[c]; k++)
+
+                    m[i*n_ch[c] + k] = m_d[k*N[c] + i];
+
+            t_3 = f_bench_time();
+
+            t_cp = fmin(t_cp, t_3 - t);
+
+            t_mv = fmin(t_mv, (t_1 - t) + (t_3 - t_2));
+        }
+
+        f_apd_plan_destroy (plan);
+
+        plan = NULL;
+
+
+
+        /* Plan of the interleaved arrays */
+
+        f_apd_get_options (&opt);
+
+        opt.Il[0] = n_ch[c];
+
+        opt.Il[1] = n_ch[c];
+
+        opt.Il[2] = n_ch[c];
+
+        exitflag = f_apd_plan_create_multichannel (&Par, NULL, 0, n_ch[c], &opt, \
+                                                   &plan);
+
+        if (exitflag != 0)
+
+            goto failed;
+
+        t_st = INFINITY;
+
+        for (r=0; r<N_REP; r++)
+        {
+            t = f_bench_time();
+
+            exitflag = f_apd_plan_execute (plan, s, NULL, m_il, e, iter);
+
+            if (exitflag != 0)
+
+                goto failed;
+
+            t_st = fmin(t_st, f_bench_time() - t);
+        }
+
+        f_apd_plan_destroy (plan);
+
+        plan = NULL;
+
+        equal = (memcmp(m, m_il, n*sizeof(double)) == 0);
+
+
+
+        /* Plan of the interleaved signal and of the modulators stored one after
+         * another */
+
+        opt.Il[2] = 1;
+
+        exitflag = f_apd_plan_create_multichannel (&Par, NULL, 0, n_ch[c], &opt, \
+                                                   &plan);
+
+        if (exitflag != 0)
+
+            goto failed;
+
+        t_mx = INFINITY;
+
+        for (r=0; r<N_REP; r++)
+        {
+            t = f_bench_time();
+
+            exitflag = f_apd_plan_execute (plan, s, NULL, m_s, e, iter);
+
+            if (exitflag != 0)
+
+                goto failed;
+
+            t_mx = fmin(t_mx, f_bench_time() - t);
+        }
+
+        f_apd_plan_destroy (plan);
+
+        plan = NULL;
+
+        equal = equal && (memcmp(m_d, m_s, n*sizeof(double)) == 0);
+
+
+
+        /* Single-channel demodulation of the last channel in place of its
+         * interleaved modulator */
+
+        for (i=0; i<N[c]; i++)
+
+            m_il[i*n_ch[c] + n_ch[c]-1] = 0;
+
+        opt.Il[2] = n_ch[c];
+
+        exitflag = f_apd_plan_create (&Par, NULL, 0, &opt, &plan);
+
+        if (exitflag != 0)
+
+            goto failed;
+
+        exitflag = f_apd_plan_execute (plan, s + n_ch[c]-1, NULL, \
+                                       m_il + n_ch[c]-1, e, iter);
+
+        f_apd_plan_destroy (plan);
+
+        plan = NULL;
+
+        if (exitflag != 0)
+
+            goto failed;
+
+        equal = equal && (memcmp(m, m_il, n*sizeof(double)) == 0);
+
+
+        printf("%-6ld %-10ld %-4.0f %-12.1f %-12.1f %-12.1f %-12.1f %-10.1f %-6s" \
+               STR_NL, n_ch[c], N[c], Cp[c], 1e3*t_cp, 1e3*t_st, 1e3*t_mx, \
+               1e3*t_mv, 2*n*sizeof(double) / 1048576.0, \
+               f_bench_check (equal, &n_check, &n_fail));
+
+        free(s);
+
+        free(m);
+
+        free(m_il);
+
+        free(s_d);
+
+        free(m_d);
+
+        free(m_s);
+
+        s = NULL;
+
+        m = NULL;
+
+        m_il = NULL;
+
+        s_d = NULL;
+
+        m_d = NULL;
+
+        m_s = NULL;
+    }
+
+    exitflag = f_bench_verdict (n_fail, n_check, "checks failed");
+
+
+
+    /* Output & Memory deallocation */
+
+    finish:
+
+        f_apd_plan_destroy (plan);
+
+        free(s);
+
+        free(m);
+
+        free(m_il);
+
+        free(s_d);
+
+        free(m_d);
+
+        free(m_s);
+
+        return exitflag;
+
+    failed:
+
+        f_apd_print_error(exitflag);
+
+        goto finish;
+
+}
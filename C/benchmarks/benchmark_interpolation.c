@@ -0,0 +1,313 @@
+
+/*                       C O P Y R I G H T   N O T I C E
+ *
+ * Copyright ©2021. Institute of Science and Technology Austria (IST Austria).
+ * All Rights Reserved. The underlying technology is protected by PCT Patent
+ * Application No. PCT/EP2021/054650.
+ *
+ * This file is part of the AP Demodulation library, which is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation in version 2.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY, without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE. See the GNU General Public License v2 for more details. You
+ * should have received a copy of the GNU General Public License v2 along with this
+ * program. If not, see https://www.gnu.org/licenses/.
+ *
+ * Contact the Technology Transfer Office, IST Austria, Am Campus 1,
+ * A-3400 Klosterneuburg, Austria, +43-(0)2243 9000, twist@ist.ac.at, for commercial
+ * licensing opportunities.
+ *
+ * See https://github.com/mgabriel-lt/ap-demodulation for the latest version of the
+ * code and user-friendly explanations on the working principle, domains of
+ * application, and advice on the usage of different AP Demodulation algorithms in
+ * practice.
+ */
+
+
+/* BENCHMARK: INTERPOLATION
+ *
+ * This program measures the time of f_apd_interpolation, which maps the sample
+ * points of a nonuniformly sampled 1D signal to the closest points of a uniform
+ * grid with the same number of points (Nr = ns), for ns = 10^3, ..., 10^8. The
+ * sampling coordinates are jittered randomly around a uniform grid, so that many
+ * grid points are claimed by two sample points and some by none. For ns <= 10^5,
+ * the result is compared with a reference that searches all sample points for
+ * every grid point (O(ns^2) operations, as the former implementation of
+ * f_apd_interpolation), and the number of grid points with a different assigned
+ * sample point is reported. The results are printed to stdout as a table, and the
+ * program returns a nonzero value if any grid point differs. Compile this program
+ * by using Option 1 described in the documentation; the maximum ns can be given as
+ * the first command-line argument (default: 10^8, which needs about 3.2 GB of
+ * memory).
+ */
+
+
+#ifndef _WIN32
+
+    #define _POSIX_C_SOURCE 200809L
+
+#endif
+
+
+#include <stdlib.h>
+
+#include <stdio.h>
+
+#include <math.h>
+
+#include <time.h>
+
+#include "h_bench.h"
+
+#include "f_apd_demodulation.c"
+
+
+
+
+static long f_bench_reference ( const long ns, \
+
+                               const double* t, \
+
+                               const long* ix, \
+
+                               const long nr, \
+
+                               const long* iw, \
+
+                               const long nw )
+{
+/* Number of grid points whose closest sample point (the earliest one if several
+ * sample points are equally close) differs from iw, found by a quadratic search */
+
+    long i1, i2;
+
+    long n_mis = 0;
+
+    long n_own = 0;
+
+    int log_own;
+
+    double tmin, tmax, dt;
+
+    double r2_1, r2_2;
+
+
+    f_apd_minmax (t, ns, &tmin, &tmax);
+
+    dt = (tmax - tmin) / (nr - 1);
+
+
+    for (i1=0; i1<ns; i1++)
+    {
+        r2_1 = (t[i1]-tmin-ix[i1]*dt) * (t[i1]-tmin-ix[i1]*dt);
+
+        log_own = 1;
+
+        for (i2=0; i2<ns && log_own; i2++)
+        {
+            if (i2 == i1 || ix[i2] != ix[i1])
+
+                continue;
+
+            r2_2 = (t[i2]-tmin-ix[i2]*dt) * (t[i2]-tmin-ix[i2]*dt);
+
+            if (r2_2 < r2_1 || (r2_2 == r2_1 && i2 < i1))
+
+                log_own = 0;
+        }
+
+        if (log_own)
+        {
+            /* iw is ordered by the grid points */
+
+            for (i2=0; i2<nw; i2++)
+
+                if (iw[i2] == i1)
+
+                    break;
+
+            n_mis = n_mis + (i2 == nw);
+
+            n_own = n_own + 1;
+        }
+    }
+
+    return n_mis + labs(nw - n_own);
+}
+
+
+
+
+int main(int argc, char** argv)
+{
+
+    /* Exit flag */
+
+    int exitflag = 0;
+
+
+
+    /* Sets f_apd_demodulation to return control to the calling f-tion upon error */
+
+    f_apd_set_errexit(0);
+
+
+
+    /* Iteration variables */
+
+    long i;
+
+    long ns;
+
+
+
+    /* Benchmarked numbers of sample points */
+
+    const long ns_max = (argc > 1) ? atol(argv[1]) : 100000000;
+
+    const long ns_ref = 100000;
+
+
+
+    /* Benchmark variables */
+
+    unsigned long long seed = 1;
+
+    long nw;
+
+    long n_mis;
+
+    int n_check = 0;
+
+    int n_fail = 0;
+
+    double t0;
+
+    double t_int;
+
+    double t_ref;
+
+    double *t = NULL;
+
+    long *ix = NULL;
+
+    long *iw = NULL;
+
+    long *own = NULL;
+
+    struct strAPD_Par Par = {0};
+
+
+
+    printf(STR_NL "%-11s %-11s %-14s %-14s %-14s %-10s %-6s" STR_NL, "ns", "used", \
+           "time [ms]", "ns/ms", "ref. [ms]", "mismatch", "equal");
+
+
+    for (ns=1000; ns<=ns_max; ns=ns*10)
+    {
+        t = (double*) malloc(ns*sizeof(double));
+
+        ix = (long*) malloc(ns*sizeof(long));
+
+        iw = (long*) malloc(ns*sizeof(long));
+
+        own = (long*) malloc(ns*sizeof(long));
+
+        if (t == NULL || ix == NULL || iw == NULL || own == NULL)
+        {
+            f_apd_set_error(APD_ERR_ID_MEM,__LINE__,APD_ERR_FILE);
+
+            f_apd_get_error(&exitflag, NULL, NULL, NULL);
+
+            goto failed;
+        }
+
+
+        /* Sampling coordinates jittered by up to 0.7 of the mean step */
+
+        for (i=0; i<ns; i++)
+
+            t[i] = i + 0.7 * (f_bench_rand (&seed) - 0.5);
+
+
+        Par.D = 1;
+
+        Par.ns = ns;
+
+        Par.Nr[0] = ns;
+
+
+        t0 = f_bench_time();
+
+        exitflag = f_apd_interpolation (&Par, t, own, ix, iw, &nw);
+
+        if (exitflag != 0)
+
+            goto failed;
+
+        t_int = f_bench_time() - t0;
+
+
+        if (ns <= ns_ref)
+        {
+            t0 = f_bench_time();
+
+            n_mis = f_bench_reference (ns, t, ix, Par.Nr[0], iw, nw);
+
+            t_ref = f_bench_time() - t0;
+
+            printf("%-11ld %-11ld %-14.3f %-14.0f %-14.3f %-10ld %-6s" STR_NL, ns, \
+                   nw, 1e3*t_int, 1e-3*ns/t_int, 1e3*t_ref, n_mis, \
+                   f_bench_check (n_mis == 0, &n_check, &n_fail));
+        }
+
+        else
+
+            printf("%-11ld %-11ld %-14.3f %-14.0f %-14s %-10s %-6s" STR_NL, ns, nw, \
+                   1e3*t_int, 1e-3*ns/t_int, "-", "-", "-");
+
+
+        free(t);
+
+        free(ix);
+
+        free(iw);
+
+        free(own);
+
+        t = NULL;
+
+        ix = NULL;
+
+        iw = NULL;
+
+        own = NULL;
+    }
+
+    exitflag = f_bench_verdict (n_fail, n_check, "sizes differ from the reference");
+
+
+
+    /* Output */
+
+    finish:
+
+        free(t);
+
+        free(ix);
+
+        free(iw);
+
+        free(own);
+
+        return exitflag;
+
+    failed:
+
+        f_apd_print_error(exitflag);
+
+        goto finish;
+
+}
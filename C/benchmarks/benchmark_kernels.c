@@ -0,0 +1,417 @@
+
+/*                       C O P Y R I G H T   N O T I C E
+ *
+ * Copyright ©2021. Institute of Science and Technology Austria (IST Austria).
+ * All Rights Reserved. The underlying technology is protected by PCT Patent
+ * Application No. PCT/EP2021/054650.
+ *
+ * This file is part of the AP Demodulation library, which is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation in version 2.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY, without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE. See the GNU General Public License v2 for more details. You
+ * should have received a copy of the GNU General Public License v2 along with this
+ * program. If not, see https://www.gnu.org/licenses/.
+ *
+ * Contact the Technology Transfer Office, IST Austria, Am Campus 1,
+ * A-3400 Klosterneuburg, Austria, +43-(0)2243 9000, twist@ist.ac.at, for commercial
+ * licensing opportunities.
+ *
+ * See https://github.com/mgabriel-lt/ap-demodulation for the latest version of the
+ * code and user-friendly explanations on the working principle, domains of
+ * application, and advice on the usage of different AP Demodulation algorithms in
+ * practice.
+ */
+
+
+/* BENCHMARK: ELEMENTWISE KERNELS
+ *
+ * This program measures the time per array element of the elementwise kernels of
+ * the AP algorithms (projections onto Cd with the updates and sums, see
+ * l_apd_kernels.c) for every instruction set supported by the CPU (scalar, AVX2,
+ * AVX-512) and compares them with the original loops of the AP algorithms (with
+ * data-dependent branches and sequential sums, compiled without FMA contraction
+ * as the kernels). The kernels must reproduce the arrays of the original loops
+ * exactly and must return bitwise identical sums for all instruction sets; their
+ * sums differ from the sequential sums of the original loops only by rounding.
+ * Both are checked as well. The results are printed to stdout as a table, and the
+ * program returns a nonzero value if a kernel does not reproduce the original
+ * loops or its sum differs between instruction sets. Compile this program by
+ * using Option 1 described in the documentation.
+ */
+
+
+#ifndef _WIN32
+
+    #define _POSIX_C_SOURCE 200809L
+
+#endif
+
+
+#include <stdlib.h>
+
+#include <stdio.h>
+
+#include <math.h>
+
+#include <time.h>
+
+#include "h_bench.h"
+
+#include "f_apd_demodulation.c"
+
+
+
+
+/* The original loops are compiled without contraction to FMA instructions, as the
+ * kernels are. */
+
+#if defined(__clang__)
+
+    #pragma STDC FP_CONTRACT OFF
+
+#elif defined(__GNUC__)
+
+    #pragma GCC optimize ("fp-contract=off")
+
+#endif
+
+
+
+
+static double f_bench_reference (const int id, double* s, const double* s_abs, \
+                                  const double* Ub, double* a, double* b, \
+                                  const long n)
+{
+/* The original loops of the AP algorithms (id = 0, 1, 2, 3, 4, 5, 6 - AP-B, AP-B
+ * with Ub, AP-A, AP-A with Ub, AP-P, AP-P with Ub, sum of squares) */
+
+    long i;
+
+    double E = 0;
+
+    double s_old;
+
+    double aux;
+
+    double aux2;
+
+    const double *U = (id % 2 == 1) ? Ub : NULL;
+
+
+    for (i=0; i<n; i++)
+    {
+        if (id == 6)
+        {
+            E = E + a[i] * a[i];
+
+            continue;
+        }
+
+        s_old = s[i];
+
+        if (id == 2 || id == 3)
+        {
+            a[i] = a[i] + 0.75 * b[i];
+
+            s[i] = a[i];
+        }
+
+        if (id == 4 || id == 5)
+
+            s[i] = a[i] - b[i];
+
+        if (s[i] < s_abs[i])
+
+            s[i] = s_abs[i];
+
+        else if (U != NULL && s[i] > U[i])
+
+            s[i] = U[i];
+
+        if (id == 0 || id == 1)
+        {
+            aux = s[i] - s_old;
+
+            E = E + aux * aux;
+        }
+        else if (id == 2 || id == 3)
+        {
+            b[i] = s[i] - a[i];
+
+            E = E + b[i] * b[i];
+        }
+        else
+        {
+            aux = s_old - a[i];
+
+            aux2 = s[i] - a[i];
+
+            b[i] = b[i] + aux2;
+
+            a[i] = s[i];
+
+            E = E + aux * aux + aux2 * aux2;
+        }
+    }
+
+    return E;
+}
+
+
+
+
+static double f_bench_kernel (const struct strAPD_Kern* kern, const int id, \
+                              double* s, const double* s_abs, const double* Ub, \
+                              double* a, double* b, const long n)
+{
+/* The kernel with the same id as in f_bench_reference */
+
+    switch (id)
+    {
+        case 0: return kern->cd_b (s, s_abs, n);
+
+        case 1: return kern->cd_b_ub (s, s_abs, Ub, n);
+
+        case 2: return kern->cd_a (s, s_abs, a, b, 0.75, n);
+
+        case 3: return kern->cd_a_ub (s, s_abs, Ub, a, b, 0.75, n);
+
+        case 4: return kern->cd_p (s, s_abs, a, b, n);
+
+        case 5: return kern->cd_p_ub (s, s_abs, Ub, a, b, n);
+
+        default: return kern->sum_sq (a, n);
+    }
+}
+
+
+
+
+int main(void)
+{
+
+    /* Exit flag */
+
+    int exitflag = 0;
+
+
+
+    /* Iteration variables */
+
+    long i;
+
+    long r;
+
+    int id;
+
+    int lv;
+
+
+
+    /* Array length, number of repetitions, and the kernels */
+
+    const long n = 1000003;
+
+    const long n_rep = 50;
+
+    const char* name[] = {"AP-B", "AP-B (Ub)", "AP-A", "AP-A (Ub)", "AP-P", \
+                          "AP-P (Ub)", "sum of squares"};
+
+    const struct strAPD_Kern *kern;
+
+    const struct strAPD_Kern *kern_prev = NULL;
+
+
+
+    /* Benchmark variables */
+
+    double t0;
+
+    double t_ref[7];
+
+    double t_k;
+
+    double t_1;
+
+    double E_ref[7];
+
+    double E_sc[7];
+
+    double E_k;
+
+    long n_bad;
+
+    double *s_abs = NULL;
+
+    double *Ub = NULL;
+
+    double *in = NULL;
+
+    double *ref = NULL;
+
+    double *out = NULL;
+
+
+
+    /* Memory allocation */
+
+    s_abs = (double*) malloc(n*sizeof(double));
+
+    Ub = (double*) malloc(n*sizeof(double));
+
+    in = (double*) malloc(3*n*sizeof(double));
+
+    ref = (double*) malloc(3*n*sizeof(double));
+
+    out = (double*) malloc(3*n*sizeof(double));
+
+    if (s_abs == NULL || Ub == NULL || in == NULL || ref == NULL || out == NULL)
+    {
+        f_apd_set_error(APD_ERR_ID_MEM,__LINE__,APD_ERR_FILE);
+
+        f_apd_get_error(&exitflag, NULL, NULL, NULL);
+
+        goto failed;
+    }
+
+
+    /* Pseudo-random arrays (s, a, b) around s_abs ≤ Ub, including equal values and
+     * signed zeros */
+
+    srand(1);
+
+    for (i=0; i<n; i++)
+    {
+        s_abs[i] = (i % 97 == 0) ? 0 : (double) rand() / RAND_MAX;
+
+        Ub[i] = s_abs[i] + ((i % 5 == 0) ? 0 : 0.5 * rand() / RAND_MAX);
+
+        in[i] = (i % 89 == 0) ? -0.0 : 2.0 * rand() / RAND_MAX - 0.3;
+
+        in[i+n] = (i % 13 == 0) ? s_abs[i] : 1.5 * rand() / RAND_MAX;
+
+        in[i+2*n] = 0.6 * rand() / RAND_MAX - 0.3;
+    }
+
+
+    printf(STR_NL "%-16s %-10s %-16s %-10s %-12s %-12s %-10s" STR_NL, "kernel", \
+           "ISA", "time [ns/elem]", "speedup", "mismatches", "sum rel diff", \
+           "same sum");
+
+
+
+    /* Original loops */
+
+    for (id=0; id<7; id++)
+    {
+        t_ref[id] = 0;
+
+        for (r=0; r<n_rep; r++)
+        {
+            memcpy(ref, in, 3*n*sizeof(double));
+
+            t0 = f_bench_time();
+
+            E_ref[id] = f_bench_reference (id, ref, s_abs, Ub, ref+n, ref+2*n, n);
+
+            t_1 = f_bench_time() - t0;
+
+            t_ref[id] = t_ref[id] + t_1 / n_rep / n;
+        }
+
+        printf("%-16s %-10s %-16.3f %-10.2f %-12d %-12.1e %-10s" STR_NL, name[id], \
+               "original", 1e9*t_ref[id], 1.0, 0, 0.0, "-");
+    }
+
+
+
+    /* Kernels of every instruction set supported by the CPU */
+
+    for (lv=0; lv<3; lv++)
+    {
+        kern = f_apd_kernels (lv);
+
+        if (kern == kern_prev)
+
+            continue;
+
+        kern_prev = kern;
+
+        for (id=0; id<7; id++)
+        {
+            memcpy(ref, in, 3*n*sizeof(double));
+
+            f_bench_reference (id, ref, s_abs, Ub, ref+n, ref+2*n, n);
+
+            t_k = 0;
+
+            for (r=0; r<n_rep; r++)
+            {
+                memcpy(out, in, 3*n*sizeof(double));
+
+                t0 = f_bench_time();
+
+                E_k = f_bench_kernel (kern, id, out, s_abs, Ub, out+n, out+2*n, n);
+
+                t_1 = f_bench_time() - t0;
+
+                t_k = t_k + t_1 / n_rep / n;
+            }
+
+            if (lv == 0)
+
+                E_sc[id] = E_k;
+
+
+            /* Bitwise comparison of the arrays with the original loops */
+
+            n_bad = 0;
+
+            for (i=0; i<3*n; i++)
+
+                if (memcmp(out+i, ref+i, sizeof(double)) != 0)
+
+                    n_bad++;
+
+
+            printf("%-16s %-10s %-16.3f %-10.2f %-12ld %-12.1e %-10s" STR_NL, \
+                   name[id], kern->name, 1e9*t_k, t_ref[id]/t_k, n_bad, \
+                   fabs(E_k - E_ref[id]) / E_ref[id], \
+                   (memcmp(&E_k, E_sc+id, sizeof(double)) == 0) ? "yes" : "NO");
+
+            if (n_bad > 0 || memcmp(&E_k, E_sc+id, sizeof(double)) != 0)
+
+                exitflag = 1;
+        }
+    }
+
+    printf(STR_NL);
+
+
+
+    /* Output & Memory deallocation */
+
+    finish:
+
+        free(s_abs);
+
+        free(Ub);
+
+        free(in);
+
+        free(ref);
+
+        free(out);
+
+        return exitflag;
+
+    failed:
+
+        f_apd_print_error(exitflag);
+
+        goto finish;
+
+}
@@ -0,0 +1,553 @@
+/*                       C O P Y R I G H T   N O T I C E
+ *
+ * Copyright ©2021. Institute of Science and Technology Austria (IST Austria).
+ * All Rights Reserved. The underlying technology is protected by PCT Patent
+ * Application No. PCT/EP2021/054650.
+ *
+ * This file is part of the AP Demodulation library, which is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation in version 2.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY, without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE. See the GNU General Public License v2 for more details. You
+ * should have received a copy of the GNU General Public License v2 along with this
+ * program. If not, see https://www.gnu.org/licenses/.
+ *
+ * Contact the Technology Transfer Office, IST Austria, Am Campus 1,
+ * A-3400 Klosterneuburg, Austria, +43-(0)2243 9000, twist@ist.ac.at, for commercial
+ * licensing opportunities.
+ *
+ * See https://github.com/mgabriel-lt/ap-demodulation for the latest version of the
+ * code and user-friendly explanations on the working principle, domains of
+ * application, and advice on the usage of different AP Demodulation algorithms in
+ * practice.
+ */
+
+
+/* BENCHMARK: LAYOUT OF THE INPUT SIGNAL
+ *
+ * This program measures the time of the placement of 2D and 3D signals on the DFT
+ * grid and of the readout of the modulator from the grid (f_apd_s_Ub_load and
+ * f_apd_m_readout) for three ways of mapping the signal to the grid:
+ *
+ *   "index map" - a column-major signal scattered through the index array of
+ *                 f_apd_ix_remap (the mapping used for all signals before the
+ *                 layouts of the plan options were introduced);
+ *
+ *   "col tiles" - a column-major signal transposed in tiles (APD_LAYOUT_COL);
+ *
+ *   "row copy" - a row-major signal copied row by row (APD_LAYOUT_ROW).
+ *
+ * For every size, it prints the times of the placement and the readout (the best
+ * of N_REP repetitions), the memory of the index array, and whether the grids and
+ * the read out arrays of all mappings are identical. Finally, it demodulates a 2D
+ * and a 3D signal given in the three layouts (the third one by strides, with the
+ * dimensions in the order 2, 1 and 2, 1, 3, respectively) and checks that the
+ * modulators are identical up to their layout, also when the three signals are
+ * demodulated as jobs of one batch with the layouts given in their options (see
+ * f_apd_plan_create). The results are printed to stdout, and the program returns a
+ * nonzero value if any check fails. Compile this program by using Option 1
+ * described in the documentation.
+ */
+
+
+#ifndef _WIN32
+
+    #define _POSIX_C_SOURCE 200809L
+
+#endif
+
+
+#include <stdlib.h>
+
+#include <stdio.h>
+
+#include <string.h>
+
+#include <math.h>
+
+#include <time.h>
+
+#include "h_bench.h"
+
+#include "f_apd_demodulation.c"
+
+
+
+#define N_REP 5
+
+
+
+
+static long f_bench_index ( const int D, \
+
+                            const long* N, \
+
+                            const long* St, \
+
+                            const long i )
+{
+/* Index of the column-major element i of a signal in the layout of strides St */
+
+    long d;
+
+    long r = i;
+
+    long k = 0;
+
+
+    for (d=0; d<D; d++)
+    {
+        k = k + (r % N[d]) * St[d];
+
+        r = r / N[d];
+    }
+
+    return k;
+}
+
+
+
+
+int main(void)
+{
+
+    /* Exit flag */
+
+    int exitflag = 0;
+
+
+
+    /* Sets f_apd_demodulation to return control to the calling f-tion upon error */
+
+    f_apd_set_errexit(0);
+
+
+
+    /* Iteration variables */
+
+    long i;
+
+    int j;
+
+    int k;
+
+    int r;
+
+
+
+    /* Benchmarked signal shapes */
+
+    const int n_cases = 4;
+
+    const int D[] = {2, 2, 3, 3};
+
+    const long N[][3] = {{1024, 1024, 0}, {4096, 4096, 0}, {128, 128, 128}, \
+                         {256, 256, 256}};
+
+    const char *N_str[] = {"1024^2", "4096^2", "128^3", "256^3"};
+
+    const char *L_str[] = {"index map", "col tiles", "row copy"};
+
+
+
+    /* Demodulated signal shapes and strides of their third layout */
+
+    const long Nd[][3] = {{192, 320, 0}, {40, 56, 72}};
+
+    const long St_d[][3] = {{320, 1, 0}, {56, 1, 2240}};
+
+    const int layout[3] = {APD_LAYOUT_COL, APD_LAYOUT_ROW, APD_LAYOUT_STRIDED};
+
+
+
+    /* Benchmark variables */
+
+    long n;
+
+    long n_2;
+
+    long St[3][3];
+
+    double t_ld[3];
+
+    double t_rd[3];
+
+    double t;
+
+    int equal;
+
+    int n_check = 0;
+
+    int n_fail = 0;
+
+    double *s = NULL;
+
+    double *m = NULL;
+
+    double *g = NULL;
+
+    double *g_ref = NULL;
+
+    long *ix = NULL;
+
+    double *m_l[3] = {NULL, NULL, NULL};
+
+    double *s_l[3] = {NULL, NULL, NULL};
+
+    double *m_b[3] = {NULL, NULL, NULL};
+
+    struct strAPD_Opt opt[3];
+
+    struct strAPD_Plan *plan = NULL;
+
+    struct strAPD_Job jobs[3];
+
+    long im[2] = {1, 50};
+
+    long ie[2] = {1, 50};
+
+    long iter;
+
+    double e;
+
+    double e_b[3];
+
+    struct strAPD_Par Par;
+
+
+
+    printf(STR_NL "%-8s %-10s %-10s %-10s %-10s %-6s" STR_NL, "N", "mapping", \
+           "load [ms]", "read [ms]", "ix [MB]", "equal");
+
+
+    for (k=0; k<n_cases; k++)
+    {
+        /* Signal, grid, and strides of the column-major (also of the index map)
+         * and row-major layouts */
+
+        n = 1;
+
+        for (j=0; j<D[k]; j++)
+
+            n = n * N[k][j];
+
+        n_2 = (n / N[k][D[k]-1]) * 2*(N[k][D[k]-1]/2+1);
+
+        for (j=0; j<D[k]; j++)
+        {
+            St[0][j] = (j == 0) ? 1 : St[0][j-1] * N[k][j-1];
+
+            St[1][j] = St[0][j];
+        }
+
+        for (j=D[k]-1; j>=0; j--)
+
+            St[2][j] = (j == D[k]-1) ? 1 : St[2][j+1] * N[k][j+1];
+
+        s = (double*) malloc(n*sizeof(double));
+
+        m = (double*) malloc(n*sizeof(double));
+
+        g = (double*) malloc(n_2*sizeof(double));
+
+        g_ref = (double*) malloc(n_2*sizeof(double));
+
+        ix = (long*) malloc(n*sizeof(long));
+
+        if (s == NULL || m == NULL || g == NULL || g_ref == NULL || ix == NULL)
+        {
+            f_apd_set_error(APD_ERR_ID_MEM,__LINE__,APD_ERR_FILE);
+
+            f_apd_get_error(&exitflag, NULL, NULL, NULL);
+
+            goto failed;
+        }
+
+        for (i=0; i<n; i++)
+
+            ix[i] = i;
+
+        f_apd_ix_remap (D[k], N[k], n, ix);
+
+        Par.D = D[k];
+
+        Par.Nx = (long*) N[k];
+
+        Par.ns = n;
+
+
+        for (j=0; j<3; j++)
+        {
+            /* Signal in the layout of the mapping */
+
+            for (i=0; i<n; i++)
+
+                s[f_bench_index(D[k], N[k], St[j], i)] = sin(0.001*i) + 0.01*(i % 7);
+
+
+            /* Placement and readout (the best time of N_REP repetitions) */
+
+            t_ld[j] = INFINITY;
+
+            t_rd[j] = INFINITY;
+
+            for (r=0; r<N_REP; r++)
+            {
+                t = f_bench_time();
+
+                f_apd_s_Ub_load (s, APD_TYPE_F64, NULL, (j == 0) ? ix : NULL, NULL, \
+                                 n, D[k], N[k], St[j], 1, 1, 1, 0, g, NULL, NULL, \
+                                 NULL);
+
+                t_ld[j] = fmin(t_ld[j], f_bench_time() - t);
+
+                t = f_bench_time();
+
+                f_apd_m_readout (g, (j == 0) ? ix : NULL, &Par, St[j], 1, 1, 0, m);
+
+                t_rd[j] = fmin(t_rd[j], f_bench_time() - t);
+            }
+
+
+            /* Comparison of the grid with that of the index map and of the read
+             * out array with the signal */
+
+            if (j == 0)
+
+                memcpy(g_ref, g, n_2*sizeof(double));
+
+            equal = (memcmp(g, g_ref, n_2*sizeof(double)) == 0) && \
+                    (memcmp(m, s, n*sizeof(double)) == 0);
+
+            printf("%-8s %-10s %-10.2f %-10.2f %-10.1f %-6s" STR_NL, \
+                   (j == 0) ? N_str[k] : "", L_str[j], 1e3*t_ld[j], 1e3*t_rd[j], \
+                   (j == 0) ? n*sizeof(long) / 1048576.0 : 0.0, \
+                   f_bench_check (equal, &n_check, &n_fail));
+        }
+
+        free(s);
+
+        free(m);
+
+        free(g);
+
+        free(g_ref);
+
+        free(ix);
+
+        s = NULL;
+
+        m = NULL;
+
+        g = NULL;
+
+        g_ref = NULL;
+
+        ix = NULL;
+    }
+
+    printf(STR_NL);
+
+
+
+    /* Demodulation of the signals in the three layouts (AP-Basic, 50 iterations) */
+
+    Par.Al = 'B';
+
+    Par.Et = 0;
+
+    Par.Ni = 50;
+
+    Par.Cp = 1;
+
+    Par.im = im;
+
+    Par.ie = ie;
+
+    for (k=0; k<2; k++)
+    {
+        Par.D = k + 2;
+
+        n = 1;
+
+        for (j=0; j<(Par.D); j++)
+        {
+            Par.Fs[j] = 1;
+
+            Par.Fc[j] = 0.05;
+
+            Par.Ns[j] = Nd[k][j];
+
+            n = n * Nd[k][j];
+
+            St[0][j] = (j == 0) ? 1 : St[0][j-1] * Nd[k][j-1];
+
+            St[2][j] = St_d[k][j];
+        }
+
+        for (j=Par.D-1; j>=0; j--)
+
+            St[1][j] = (j == Par.D-1) ? 1 : St[1][j+1] * Nd[k][j+1];
+
+        for (j=0; j<3; j++)
+        {
+            s_l[j] = (double*) malloc(n*sizeof(double));
+
+            m_l[j] = (double*) malloc(n*sizeof(double));
+
+            m_b[j] = (double*) malloc(n*sizeof(double));
+
+            if (s_l[j] == NULL || m_l[j] == NULL || m_b[j] == NULL)
+            {
+                f_apd_set_error(APD_ERR_ID_MEM,__LINE__,APD_ERR_FILE);
+
+                f_apd_get_error(&exitflag, NULL, NULL, NULL);
+
+                goto failed;
+            }
+        }
+
+
+        /* Demodulation by plans with the layouts given in their options */
+
+        for (j=0; j<3; j++)
+        {
+            f_apd_get_options (&(opt[j]));
+
+            opt[j].Ly = layout[j];
+
+            for (i=0; i<3; i++)
+
+                opt[j].St[i] = St[2][i];
+
+            for (i=0; i<n; i++)
+
+                s_l[j][f_bench_index(Par.D, Nd[k], St[j], i)] = \
+                        (1.5 + sin(0.01*i)) * cos(0.9*i + 0.3*(i % 5));
+
+            exitflag = f_apd_plan_create (&Par, NULL, 0, &(opt[j]), &plan);
+
+            if (exitflag == 0)
+
+                exitflag = f_apd_plan_execute (plan, s_l[j], NULL, m_l[j], &e, \
+                                               &iter);
+
+            f_apd_plan_destroy (plan);
+
+            plan = NULL;
+
+            if (exitflag != 0)
+
+                goto failed;
+        }
+
+
+        /* Demodulation of the three layouts in one batch (the layout of every job
+         * given by its options) */
+
+        for (j=0; j<3; j++)
+        {
+            jobs[j].s = s_l[j];
+
+            jobs[j].Par = &Par;
+
+            jobs[j].Ub = NULL;
+
+            jobs[j].t = NULL;
+
+            jobs[j].out_m = m_b[j];
+
+            jobs[j].out_e = e_b + j;
+
+            jobs[j].opt = &(opt[j]);
+        }
+
+        exitflag = f_apd_demodulation_batch (jobs, 3, 0);
+
+        if (exitflag != 0)
+
+            goto failed;
+
+
+        /* Modulators compared in the column-major order */
+
+        equal = 1;
+
+        for (i=0; i<n; i++)
+
+            for (j=1; j<3; j++)
+
+                if (m_l[j][f_bench_index(Par.D, Nd[k], St[j], i)] != m_l[0][i])
+
+                    equal = 0;
+
+        printf("%dD demodulation in the three layouts identical: %s" STR_NL, \
+               Par.D, f_bench_check (equal, &n_check, &n_fail));
+
+        equal = 1;
+
+        for (j=0; j<3; j++)
+
+            if (memcmp(m_b[j], m_l[j], n*sizeof(double)) != 0)
+
+                equal = 0;
+
+        printf("%dD batch of the three layouts identical: %s" STR_NL, Par.D, \
+               f_bench_check (equal, &n_check, &n_fail));
+
+        for (j=0; j<3; j++)
+        {
+            free(s_l[j]);
+
+            free(m_l[j]);
+
+            free(m_b[j]);
+
+            s_l[j] = NULL;
+
+            m_l[j] = NULL;
+
+            m_b[j] = NULL;
+        }
+    }
+
+    exitflag = f_bench_verdict (n_fail, n_check, "checks failed");
+
+
+
+    /* Output & Memory deallocation */
+
+    finish:
+
+        f_apd_plan_destroy (plan);
+
+        free(s);
+
+        free(m);
+
+        free(g);
+
+        free(g_ref);
+
+        free(ix);
+
+        for (j=0; j<3; j++)
+        {
+            free(s_l[j]);
+
+            free(m_l[j]);
+
+            free(m_b[j]);
+        }
+
+        return exitflag;
+
+    failed:
+
+        f_apd_print_error(exitflag);
+
+        goto finish;
+
+}
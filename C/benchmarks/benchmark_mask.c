@@ -0,0 +1,363 @@
+
+/*                       C O P Y R I G H T   N O T I C E
+ *
+ * Copyright ©2021. Institute of Science and Technology Austria (IST Austria).
+ * All Rights Reserved. The underlying technology is protected by PCT Patent
+ * Application No. PCT/EP2021/054650.
+ *
+ * This file is part of the AP Demodulation library, which is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation in version 2.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY, without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE. See the GNU General Public License v2 for more details. You
+ * should have received a copy of the GNU General Public License v2 along with this
+ * program. If not, see https://www.gnu.org/licenses/.
+ *
+ * Contact the Technology Transfer Office, IST Austria, Am Campus 1,
+ * A-3400 Klosterneuburg, Austria, +43-(0)2243 9000, twist@ist.ac.at, for commercial
+ * licensing opportunities.
+ *
+ * See https://github.com/mgabriel-lt/ap-demodulation for the latest version of the
+ * code and user-friendly explanations on the working principle, domains of
+ * application, and advice on the usage of different AP Demodulation algorithms in
+ * practice.
+ */
+
+
+/* BENCHMARK: MASK OF THE PROJECTION ONTO Mw
+ *
+ * This program measures the time of the mask of the projection onto the set Mw
+ * (zeroing the Fourier coefficients outside the passband) for 2D and 3D signals up
+ * to 512 x 512 x 512 sample points. Two implementations are compared:
+ *
+ *   "strided" - the loops over the coefficients with the first index innermost
+ *               (the scheme used by f_apd_dft_mask before the coefficients were
+ *               zeroed in memory order), whose every store touches a new row;
+ *
+ *   "runs" - f_apd_dft_mask, which zeroes contiguous runs in memory order.
+ *
+ * For every size, it prints the times of both masks, the speedup, whether both
+ * masks give identical arrays, and the time of the whole projection onto Mw
+ * (f_apd_dft_PMw with the built-in FFT) for comparison. The cutoff index is
+ * N/64 in every dimension. The results are printed to stdout as a table, and the
+ * program returns a nonzero value if the arrays differ. Compile this program by
+ * using Option 1 described in the documentation.
+ */
+
+
+#ifndef _WIN32
+
+    #define _POSIX_C_SOURCE 200809L
+
+#endif
+
+
+#include <stdlib.h>
+
+#include <stdio.h>
+
+#include <string.h>
+
+#include <math.h>
+
+#include <time.h>
+
+#include "h_bench.h"
+
+#include "f_apd_demodulation.c"
+
+
+
+#define N_REP 5
+
+
+
+
+static void f_bench_mask_strided ( double* s, \
+
+                                   const int D, \
+
+                                   const long* N, \
+
+                                   const long* iL, \
+
+                                   const long* iR )
+{
+/* Mask of the projection onto Mw with the first index innermost (2D and 3D) */
+
+    long i1, i2, i3;
+
+    long rs[4];
+
+
+    rs[D] = 1;
+
+    rs[D-1] = (N[D-1]/2+1)*2;
+
+    for (i1=D-2; i1>0; i1--)
+
+        rs[i1] = rs[i1+1] * N[i1];
+
+
+    if (D == 2)
+    {
+        for (i2 = 2*iL[1]; i2 < N[1]+2-(N[1]%2); i2++)
+
+            for (i1 = 0; i1 < N[0]; i1++)
+
+                s[rs[1]*i1+rs[2]*i2] = 0;
+
+        for (i2 = 0; i2 < 2*iL[1]; i2++)
+
+            for (i1 = iL[0]; i1 <= iR[0]; i1++)
+
+                s[rs[1]*i1+rs[2]*i2] = 0;
+    }
+
+    else
+    {
+        for (i3 = 2*iL[2]; i3 < N[2]+2-(N[2]%2); i3++)
+
+            for (i2 = 0; i2 < N[1]; i2++)
+
+                for (i1 = 0; i1 < N[0]; i1++)
+
+                    s[rs[1]*i1+rs[2]*i2+rs[3]*i3] = 0;
+
+        for (i3 = 0; i3 < 2*iL[2]; i3++)
+
+            for (i2 = iL[1]; i2 <= iR[1]; i2++)
+
+                for (i1 = 0; i1 < N[0]; i1++)
+
+                    s[rs[1]*i1+rs[2]*i2+rs[3]*i3] = 0;
+
+        for (i3 = 0; i3 < 2*iL[2]; i3++)
+
+            for (i1 = iL[0]; i1 <= iR[0]; i1++)
+            {
+                for (i2 = 0; i2 < iL[1]; i2++)
+
+                    s[rs[1]*i1+rs[2]*i2+rs[3]*i3] = 0;
+
+                for (i2 = iR[1]+1; i2 < N[1]; i2++)
+
+                    s[rs[1]*i1+rs[2]*i2+rs[3]*i3] = 0;
+            }
+    }
+}
+
+
+
+
+int main(void)
+{
+
+    /* Exit flag */
+
+    int exitflag = 0;
+
+
+
+    /* Sets f_apd_demodulation to return control to the calling f-tion upon error */
+
+    f_apd_set_errexit(0);
+
+    f_apd_set_dft_backend(APD_DFT_BUILTIN);
+
+
+
+    /* Iteration variables */
+
+    long i;
+
+    int j;
+
+    int k;
+
+    int r;
+
+
+
+    /* Benchmarked signal shapes */
+
+    const int n_cases = 4;
+
+    const int D[] = {2, 2, 3, 3};
+
+    const long N[][3] = {{1024, 1024, 0}, {4096, 4096, 0}, {256, 256, 256}, \
+                         {512, 512, 512}};
+
+    const char *N_str[] = {"1024^2", "4096^2", "256^3", "512^3"};
+
+
+
+    /* Benchmark variables */
+
+    long n;
+
+    long iL[3];
+
+    long iR[3];
+
+    double t_str;
+
+    double t_run;
+
+    double t_pmw;
+
+    double t;
+
+    int equal;
+
+    int n_check = 0;
+
+    int n_fail = 0;
+
+    double *s = NULL;
+
+    double *s_ref = NULL;
+
+    struct strAPD_DFT dft;
+
+    int dft_ok = 0;
+
+
+
+    printf(STR_NL "%-8s %-12s %-12s %-8s %-6s %-12s" STR_NL, "N", \
+           "strided [ms]", "runs [ms]", "speedup", "equal", "PMw [ms]");
+
+
+    for (k=0; k<n_cases; k++)
+    {
+        /* Padded signal and cutoff indexes */
+
+        n = 1;
+
+        for (j=0; j<D[k]; j++)
+        {
+            n = n * ((j == D[k]-1) ? 2*(N[k][j]/2+1) : N[k][j]);
+
+            iL[j] = 1 + N[k][j] / 64;
+
+            iR[j] = N[k][j] - iL[j];
+        }
+
+        s = (double*) malloc(n*sizeof(double));
+
+        s_ref = (double*) malloc(n*sizeof(double));
+
+        if (s == NULL || s_ref == NULL)
+        {
+            f_apd_set_error(APD_ERR_ID_MEM,__LINE__,APD_ERR_FILE);
+
+            f_apd_get_error(&exitflag, NULL, NULL, NULL);
+
+            goto failed;
+        }
+
+
+        /* Masks (the arrays are refilled before every repetition, so that both
+         * masks write to memory that is not in the cache; the best time of N_REP
+         * repetitions is taken) */
+
+        t_str = INFINITY;
+
+        t_run = INFINITY;
+
+        for (r=0; r<N_REP; r++)
+        {
+            for (i=0; i<n; i++)
+
+                s_ref[i] = 1 + (i % 13);
+
+            t = f_bench_time();
+
+            f_bench_mask_strided (s_ref, D[k], N[k], iL, iR);
+
+            t_str = fmin(t_str, f_bench_time() - t);
+
+
+            for (i=0; i<n; i++)
+
+                s[i] = 1 + (i % 13);
+
+            t = f_bench_time();
+
+            exitflag = f_apd_dft_mask (s, D[k], N[k], iL, iR);
+
+            t_run = fmin(t_run, f_bench_time() - t);
+
+            if (exitflag != 0)
+
+                goto failed;
+        }
+
+        equal = (memcmp(s, s_ref, n*sizeof(double)) == 0);
+
+        free(s_ref);
+
+        s_ref = NULL;
+
+
+        /* Projection onto Mw (built-in FFT) */
+
+        exitflag = f_apd_dft_init (D[k], N[k], 0, 1, APD_PREC_DOUBLE, &dft);
+
+        if (exitflag != 0)
+
+            goto failed;
+
+        dft_ok = 1;
+
+        t = f_bench_time();
+
+        exitflag = f_apd_dft_PMw (s, D[k], N[k], iL, iR, &dft, NULL);
+
+        t_pmw = f_bench_time() - t;
+
+        if (exitflag != 0)
+
+            goto failed;
+
+        f_apd_dft_free (&dft);
+
+        dft_ok = 0;
+
+
+        printf("%-8s %-12.2f %-12.2f %-8.2f %-6s %-12.1f" STR_NL, N_str[k], \
+               1e3*t_str, 1e3*t_run, t_str/t_run, \
+               f_bench_check (equal, &n_check, &n_fail), 1e3*t_pmw);
+
+        free(s);
+
+        s = NULL;
+    }
+
+    exitflag = f_bench_verdict (n_fail, n_check, "checks failed");
+
+
+
+    /* Output & Memory deallocation */
+
+    finish:
+
+        if (dft_ok)
+
+            f_apd_dft_free (&dft);
+
+        free(s);
+
+        free(s_ref);
+
+        return exitflag;
+
+    failed:
+
+        f_apd_print_error(exitflag);
+
+        goto finish;
+
+}
@@ -0,0 +1,349 @@
+
+/*                       C O P Y R I G H T   N O T I C E
+ *
+ * Copyright ©2021. Institute of Science and Technology Austria (IST Austria).
+ * All Rights Reserved. The underlying technology is protected by PCT Patent
+ * Application No. PCT/EP2021/054650.
+ *
+ * This file is part of the AP Demodulation library, which is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation in version 2.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY, without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE. See the GNU General Public License v2 for more details. You
+ * should have received a copy of the GNU General Public License v2 along with this
+ * program. If not, see https://www.gnu.org/licenses/.
+ *
+ * Contact the Technology Transfer Office, IST Austria, Am Campus 1,
+ * A-3400 Klosterneuburg, Austria, +43-(0)2243 9000, twist@ist.ac.at, for commercial
+ * licensing opportunities.
+ *
+ * See https://github.com/mgabriel-lt/ap-demodulation for the latest version of the
+ * code and user-friendly explanations on the working principle, domains of
+ * application, and advice on the usage of different AP Demodulation algorithms in
+ * practice.
+ */
+
+
+/* BENCHMARK: MIXED-PRECISION AP ALGORITHMS
+ *
+ * This program demodulates 1D and 2D amplitude-modulated signals by AP-Basic and
+ * AP-Projected with a tolerance of the infeasibility error below the float
+ * resolution in double and in mixed precision (see f_apd_plan_create). For every
+ * case, it prints the numbers of iterations in both precisions, the switchover
+ * point of the mixed precision (the number of iterations computed in single
+ * precision, see f_apd_get_precision), the total times, the final infeasibility
+ * errors, the maximum difference between the modulators relative to the maximum
+ * of the modulator, and the peak memory allocated by the library in both
+ * precisions (counted by a hook on its allocations, without the internal memory of
+ * oneMKL). The results are printed to stdout as a table. Compile this program by
+ * using Option 1 described in the documentation.
+ */
+
+
+#ifndef _WIN32
+
+    #define _POSIX_C_SOURCE 200809L
+
+#endif
+
+
+#include <stdlib.h>
+
+#include <stdio.h>
+
+#include <math.h>
+
+#include <string.h>
+
+#include <time.h>
+
+
+
+/* Allocation-counting hook of h_bench.h on the library */
+
+#define BENCH_ALLOC_HOOK
+
+#include "h_bench.h"
+
+#include "f_apd_demodulation.c"
+
+
+
+
+static int f_bench_run ( const struct strAPD_Par* Par, \
+
+                         const int prec, \
+
+                         const double* s, \
+
+                         double* m, \
+
+                         double* t_out, \
+
+                         double* e_out, \
+
+                         long* iter, \
+
+                         long* iter_sw, \
+
+                         double* mb_out )
+{
+/* Demodulation of s in the precision prec: total time, final infeasibility error,
+ * number of iterations, number of iterations in single precision, and peak memory
+ * allocated by the library in MB */
+
+    int exitflag = 0;
+
+    struct strAPD_Plan *plan = NULL;
+
+    struct strAPD_Opt opt;
+
+
+    f_apd_get_options (&opt);
+
+    opt.Pr = prec;
+
+    sgBENCH_PEAK = sgBENCH_USE;
+
+    *t_out = f_bench_time();
+
+    exitflag = f_apd_plan_create (Par, NULL, 0, &opt, &plan);
+
+    if (exitflag == 0)
+
+        exitflag = f_apd_plan_execute (plan, s, NULL, m, e_out, iter);
+
+    f_apd_plan_destroy (plan);
+
+    *t_out = f_bench_time() - *t_out;
+
+    *mb_out = (sgBENCH_PEAK - sgBENCH_USE) / 1048576.0;
+
+    f_apd_get_precision (NULL, iter_sw);
+
+
+    return exitflag;
+}
+
+
+
+
+int main(void)
+{
+
+    /* Exit flag */
+
+    int exitflag = 0;
+
+
+
+    /* Sets f_apd_demodulation to return control to the calling f-tion upon error */
+
+    f_apd_set_errexit(0);
+
+
+
+    /* Iteration variables */
+
+    long i;
+
+    int k;
+
+    int a;
+
+
+
+    /* Benchmarked signal shapes and algorithms */
+
+    const int n_cases = 2;
+
+    const int D[] = {1, 2};
+
+    const long N[][2] = {{262144, 0}, {256, 256}};
+
+    const char Al[] = {'B', 'P'};
+
+
+
+    /* Benchmark variables */
+
+    long n;
+
+    long it_d;
+
+    long it_m;
+
+    long it_sw;
+
+    double t_d;
+
+    double t_m;
+
+    double e_d;
+
+    double e_m;
+
+    double mb_d;
+
+    double mb_m;
+
+    double diff;
+
+    double m_max;
+
+    double *s = NULL;
+
+    double *m_d = NULL;
+
+    double *m_m = NULL;
+
+
+
+    /* Demodulation parameters (Et = 10^-8, at most 5000 iterations, Fc = Fs/64 in
+     * every dimension; the final modulator and error are saved) */
+
+    struct strAPD_Par Par;
+
+    long im[2] = {1, 5000};
+
+    long ie[2] = {1, 5000};
+
+    Par.Fs[0] = 1;
+
+    Par.Fs[1] = 1;
+
+    Par.Fc[0] = 1.0/64;
+
+    Par.Fc[1] = 1.0/64;
+
+    Par.Et = 1e-8;
+
+    Par.Ni = 5000;
+
+    Par.Br = 0;
+
+    Par.Cp = 1;
+
+    Par.im = im;
+
+    Par.ie = ie;
+
+
+
+    printf(STR_NL "%-14s %-3s %-8s %-8s %-8s %-10s %-10s %-8s %-10s %-10s %-10s " \
+           "%-10s %-10s" STR_NL, "N", "Al", "it d", "it m", "it sw", "double [s]", \
+           "mixed [s]", "speedup", "e double", "e mixed", "max diff", "MB double", \
+           "MB mixed");
+
+
+    for (k=0; k<n_cases; k++)
+    {
+        Par.D = D[k];
+
+        n = 1;
+
+        for (i=0; i<D[k]; i++)
+        {
+            Par.Ns[i] = N[k][i];
+
+            n = n * N[k][i];
+        }
+
+        s = (double*) malloc(n*sizeof(double));
+
+        m_d = (double*) malloc(n*sizeof(double));
+
+        m_m = (double*) malloc(n*sizeof(double));
+
+        if (s == NULL || m_d == NULL || m_m == NULL)
+        {
+            f_apd_set_error(APD_ERR_ID_MEM,__LINE__,APD_ERR_FILE);
+
+            f_apd_get_error(&exitflag, NULL, NULL, NULL);
+
+            goto failed;
+        }
+
+
+        /* Amplitude-modulated harmonic signal (the modulator varies along every
+         * dimension) */
+
+        f_bench_am (D[k], N[k], 200.0, s);
+
+
+        for (a=0; a<2; a++)
+        {
+            Par.Al = Al[a];
+
+            exitflag = f_bench_run (&Par, APD_PREC_DOUBLE, s, m_d, &t_d, &e_d, \
+                                    &it_d, NULL, &mb_d);
+
+            if (exitflag != 0)
+
+                goto failed;
+
+            exitflag = f_bench_run (&Par, APD_PREC_MIXED, s, m_m, &t_m, &e_m, \
+                                    &it_m, &it_sw, &mb_m);
+
+            if (exitflag != 0)
+
+                goto failed;
+
+
+            diff = 0;
+
+            m_max = 0;
+
+            for (i=0; i<n; i++)
+            {
+                diff = fmax(diff, fabs(m_d[i] - m_m[i]));
+
+                m_max = fmax(m_max, fabs(m_d[i]));
+            }
+
+
+            printf("%-14s %-3c %-8ld %-8ld %-8ld %-10.2f %-10.2f %-8.2f %-10.3e " \
+                   "%-10.3e %-10.1e %-10.2f %-10.2f" STR_NL, \
+                   (D[k] == 1) ? "262144" : "256 x 256", Al[a], it_d, it_m, it_sw, \
+                   t_d, t_m, t_d/t_m, e_d, e_m, diff/m_max, mb_d, mb_m);
+        }
+
+
+        free(s);
+
+        free(m_d);
+
+        free(m_m);
+
+        s = NULL;
+
+        m_d = NULL;
+
+        m_m = NULL;
+    }
+
+    printf(STR_NL);
+
+
+
+    /* Output & Memory deallocation */
+
+    finish:
+
+        free(s);
+
+        free(m_d);
+
+        free(m_m);
+
+        return exitflag;
+
+    failed:
+
+        f_apd_print_error(exitflag);
+
+        goto finish;
+
+}
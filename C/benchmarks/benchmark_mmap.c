@@ -0,0 +1,345 @@
+/*                       C O P Y R I G H T   N O T I C E
+ *
+ * Copyright ©2021. Institute of Science and Technology Austria (IST Austria).
+ * All Rights Reserved. The underlying technology is protected by PCT Patent
+ * Application No. PCT/EP2021/054650.
+ *
+ * This file is part of the AP Demodulation library, which is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation in version 2.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY, without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE. See the GNU General Public License v2 for more details. You
+ * should have received a copy of the GNU General Public License v2 along with this
+ * program. If not, see https://www.gnu.org/licenses/.
+ *
+ * Contact the Technology Transfer Office, IST Austria, Am Campus 1,
+ * A-3400 Klosterneuburg, Austria, +43-(0)2243 9000, twist@ist.ac.at, for commercial
+ * licensing opportunities.
+ *
+ * See https://github.com/mgabriel-lt/ap-demodulation for the latest version of the
+ * code and user-friendly explanations on the working principle, domains of
+ * application, and advice on the usage of different AP Demodulation algorithms in
+ * practice.
+ */
+
+
+/* BENCHMARK: OUT-OF-CORE DEMODULATION
+ *
+ * This program writes a long 1D audio-rate signal (2^23 samples at 48 kHz,
+ * modulator below 100 Hz) to a binary file and demodulates it by AP-Accelerated
+ * from the file into another file (see f_apd_demodulation_mmap) with several memory
+ * budgets. Every demodulation runs in a child process, so that its peak resident
+ * memory is measured separately. For every budget, it prints the segment length,
+ * the time, the peak resident memory of the child process, and the maximum
+ * difference between the modulator in the file and that of f_apd_demodulation of
+ * the whole signal (the budget "all"), relative to the maximum of the modulator,
+ * away from the ends of the signal. The results are
+ * printed to stdout as a table. This benchmark runs on POSIX systems only. Compile
+ * this program by using Option 1 described in the documentation.
+ */
+
+
+#define _DEFAULT_SOURCE
+
+
+#include <stdlib.h>
+
+#include <stdio.h>
+
+#include <math.h>
+
+#include <time.h>
+
+#include <sys/resource.h>
+
+#include <sys/wait.h>
+
+#include "h_bench.h"
+
+#include "f_apd_demodulation.c"
+
+
+
+#define FS 48000
+
+#define N (1L << 23)
+
+#define ACC 1e-2
+
+#define FILE_S "apd_bench_s.bin"
+
+#define FILE_M "apd_bench_m.bin"
+
+#define FILE_R "apd_bench_r.bin"
+
+
+
+
+int main(void)
+{
+
+    /* Exit flag */
+
+    int exitflag = 0;
+
+
+
+    /* Sets f_apd_demodulation to return control to the calling f-tion upon error */
+
+    f_apd_set_errexit(0);
+
+
+
+    /* Iteration variables */
+
+    long i;
+
+    long j;
+
+    int b;
+
+
+
+    /* Benchmark variables (memory budgets in MB; the first demodulation, with a
+     * budget for the whole signal, is f_apd_demodulation, i.e., the reference) */
+
+    const long mem[] = {0, 16, 64, 256};
+
+    long *L = NULL;
+
+    int status;
+
+    pid_t pid;
+
+    struct rusage ru;
+
+    double t;
+
+    double diff;
+
+    double m_max;
+
+    double buf[4096];
+
+    double buf_m[4096];
+
+    FILE *f = NULL;
+
+    FILE *f_m = NULL;
+
+
+
+    /* Demodulation parameters (Et = 10^-3, at most 5000 iterations, Fc = 100 Hz;
+     * the final modulator and error are saved) */
+
+    struct strAPD_Par Par;
+
+    long im[2] = {1, 5000};
+
+    long ie[2] = {1, 5000};
+
+    Par.Al = 'A';
+
+    Par.D = 1;
+
+    Par.Fs[0] = FS;
+
+    Par.Fc[0] = 100;
+
+    Par.Ns[0] = N;
+
+    Par.Et = 1e-3;
+
+    Par.Ni = 5000;
+
+    Par.Br = 0;
+
+    Par.Cp = 1;
+
+    Par.im = im;
+
+    Par.ie = ie;
+
+
+
+    /* Segment length (shared with the child processes) */
+
+    L = (long*) mmap(NULL, sizeof(long), PROT_READ | PROT_WRITE, \
+                     MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+
+    if (L == MAP_FAILED)
+    {
+        L = NULL;
+
+        f_apd_set_error(APD_ERR_ID_MEM,__LINE__,APD_ERR_FILE);
+
+        f_apd_get_error(&exitflag, NULL, NULL, NULL);
+
+        goto failed;
+    }
+
+
+
+    /* Amplitude-modulated harmonic signal (modulator of 2 Hz, carrier of 1 kHz),
+     * written to the signal file in chunks */
+
+    f = fopen(FILE_S, "wb");
+
+    if (f == NULL)
+    {
+        f_apd_set_error(APD_ERR_ID_MMF,__LINE__,APD_ERR_FILE);
+
+        f_apd_get_error(&exitflag, NULL, NULL, NULL);
+
+        goto failed;
+    }
+
+    for (i=0; i<N; i++)
+    {
+        buf[i % 4096] = (1.1 + 0.3 * sin(2*M_PI*2.0*i / FS)) * \
+                        cos(2*M_PI*1000.0*i / FS + 0.11*(i % 7));
+
+        if (i % 4096 == 4095)
+
+            fwrite(buf, sizeof(double), 4096, f);
+    }
+
+    fclose(f);
+
+    f = NULL;
+
+
+
+    printf(STR_NL "%-10s %-10s %-10s %-12s %-10s" STR_NL, "mem [MB]", "L", \
+           "time [s]", "peak RSS [MB]", "max diff");
+
+
+    for (b=0; b<4; b++)
+    {
+        /* Out-of-core demodulation in a child process (the exit status is the exit
+         * flag) */
+
+        fflush(stdout);
+
+        t = f_bench_time();
+
+        pid = fork();
+
+        if (pid == 0)
+
+            _exit(f_apd_demodulation_mmap (FILE_S, (b == 0) ? FILE_R : FILE_M, \
+                  &Par, 1, ACC, (b > 0) ? mem[b] << 20 : N*(long) APD_MMAP_BYTES, \
+                  NULL, L));
+
+        if (pid < 0 || wait4(pid, &status, 0, &ru) != pid || !WIFEXITED(status) || \
+                WEXITSTATUS(status) != 0)
+        {
+            exitflag = (pid > 0 && WIFEXITED(status)) ? WEXITSTATUS(status) : 1;
+
+            goto failed;
+        }
+
+        t = f_bench_time() - t;
+
+
+        if (b == 0)
+        {
+            printf("%-10s %-10ld %-10.2f %-12.1f %-10s" STR_NL, "all", *L, t, \
+                   ru.ru_maxrss / 1024.0, "-");
+
+            continue;
+        }
+
+
+        /* Difference from the reference (without the first and the last segment),
+         * read from the files in chunks */
+
+        f = fopen(FILE_R, "rb");
+
+        f_m = fopen(FILE_M, "rb");
+
+        if (f == NULL || f_m == NULL)
+        {
+            f_apd_set_error(APD_ERR_ID_MMF,__LINE__,APD_ERR_FILE);
+
+            f_apd_get_error(&exitflag, NULL, NULL, NULL);
+
+            goto failed;
+        }
+
+        diff = 0;
+
+        m_max = 0;
+
+        for (i=0; i<N; i=i+4096)
+        {
+            if (fread(buf, sizeof(double), 4096, f) != 4096 || \
+                    fread(buf_m, sizeof(double), 4096, f_m) != 4096)
+            {
+                f_apd_set_error(APD_ERR_ID_MMF,__LINE__,APD_ERR_FILE);
+
+                f_apd_get_error(&exitflag, NULL, NULL, NULL);
+
+                goto failed;
+            }
+
+            for (j=0; j<4096; j++)
+            {
+                m_max = fmax(m_max, fabs(buf[j]));
+
+                if (i+j >= *L && i+j < N - *L)
+
+                    diff = fmax(diff, fabs(buf_m[j] - buf[j]));
+            }
+        }
+
+        fclose(f);
+
+        fclose(f_m);
+
+        f = NULL;
+
+        f_m = NULL;
+
+
+        printf("%-10ld %-10ld %-10.2f %-12.1f %-10.1e" STR_NL, mem[b], *L, t, \
+               ru.ru_maxrss / 1024.0, diff/m_max);
+    }
+
+    printf(STR_NL);
+
+
+
+    /* Output & Memory deallocation */
+
+    finish:
+
+        if (f != NULL)
+
+            fclose(f);
+
+        if (f_m != NULL)
+
+            fclose(f_m);
+
+        if (L != NULL)
+
+            munmap(L, sizeof(long));
+
+        remove(FILE_S);
+
+        remove(FILE_M);
+
+        remove(FILE_R);
+
+        return exitflag;
+
+    failed:
+
+        f_apd_print_error(exitflag);
+
+        goto finish;
+
+}
@@ -0,0 +1,283 @@
+
+/*                       C O P Y R I G H T   N O T I C E
+ *
+ * Copyright ©2021. Institute of Science and Technology Austria (IST Austria).
+ * All Rights Reserved. The underlying technology is protected by PCT Patent
+ * Application No. PCT/EP2021/054650.
+ *
+ * This file is part of the AP Demodulation library, which is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation in version 2.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY, without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE. See the GNU General Public License v2 for more details. You
+ * should have received a copy of the GNU General Public License v2 along with this
+ * program. If not, see https://www.gnu.org/licenses/.
+ *
+ * Contact the Technology Transfer Office, IST Austria, Am Campus 1,
+ * A-3400 Klosterneuburg, Austria, +43-(0)2243 9000, twist@ist.ac.at, for commercial
+ * licensing opportunities.
+ *
+ * See https://github.com/mgabriel-lt/ap-demodulation for the latest version of the
+ * code and user-friendly explanations on the working principle, domains of
+ * application, and advice on the usage of different AP Demodulation algorithms in
+ * practice.
+ */
+
+
+/* BENCHMARK: DEMODULATION PLAN
+ *
+ * This program measures the time per demodulated segment when many short 1D signals
+ * of the same length are demodulated one after another. Two approaches are
+ * compared:
+ *
+ *   "f_apd_demodulation" - one call of f_apd_demodulation per segment (input
+ *                          validation, memory allocation, and DFT initialization
+ *                          repeated for every segment);
+ *
+ *   "plan" - one f_apd_plan_create call followed by one f_apd_plan_execute call
+ *            per segment.
+ *
+ * Both approaches must give identical modulators, which is checked as well. The
+ * results are printed to stdout as a table. Compile this program by using Option 1
+ * described in the documentation.
+ */
+
+
+#ifndef _WIN32
+
+    #define _POSIX_C_SOURCE 200809L
+
+#endif
+
+
+#include <stdlib.h>
+
+#include <stdio.h>
+
+#include <math.h>
+
+#include <time.h>
+
+#include "h_bench.h"
+
+#include "f_apd_demodulation.c"
+
+
+
+
+int main(void)
+{
+
+    /* Exit flag */
+
+    int exitflag = 0;
+
+
+
+    /* Sets f_apd_demodulation to return control to the calling f-tion upon error */
+
+    f_apd_set_errexit(0);
+
+
+
+    /* Iteration variables */
+
+    long i;
+
+    long j;
+
+    long k;
+
+    long iter;
+
+
+
+    /* Benchmarked segment lengths and the number of segments */
+
+    const int n_cases = 4;
+
+    const long n[] = {128, 512, 2048, 8192};
+
+    const long n_seg = 2000;
+
+
+
+    /* Benchmark variables */
+
+    double t0;
+
+    double t_old;
+
+    double t_new;
+
+    double diff;
+
+    double e_out;
+
+    double *s = NULL;
+
+    double *m_old = NULL;
+
+    double *m_new = NULL;
+
+    struct strAPD_Plan *plan = NULL;
+
+
+
+    /* Demodulation parameters (AP-Basic, 20 iterations, Fc = Fs/64) */
+
+    struct strAPD_Par Par;
+
+    long im[2] = {1, 20};
+
+    long ie[2] = {1, 20};
+
+    Par.Al = 'B';
+
+    Par.D = 1;
+
+    Par.Fs[0] = 1;
+
+    Par.Fc[0] = 1.0/64;
+
+    Par.Et = 0;
+
+    Par.Ni = 20;
+
+    Par.Cp = 1;
+
+    Par.im = im;
+
+    Par.ie = ie;
+
+
+
+    printf(STR_NL "%-10s %-26s %-16s %-8s %-10s" STR_NL, "n", \
+           "f_apd_demodulation [us]", "plan [us]", "speedup", "max diff");
+
+
+    for (k=0; k<n_cases; k++)
+    {
+        Par.Ns[0] = n[k];
+
+        s = (double*) malloc(n[k]*n_seg*sizeof(double));
+
+        m_old = (double*) malloc(n[k]*n_seg*sizeof(double));
+
+        m_new = (double*) malloc(n[k]*n_seg*sizeof(double));
+
+        if (s == NULL || m_old == NULL || m_new == NULL)
+        {
+            f_apd_set_error(APD_ERR_ID_MEM,__LINE__,APD_ERR_FILE);
+
+            f_apd_get_error(&exitflag, NULL, NULL, NULL);
+
+            goto failed;
+        }
+
+
+        /* Segments of an amplitude-modulated harmonic signal */
+
+        for (i=0; i<n[k]*n_seg; i++)
+
+            s[i] = (1.1 + sin(2*M_PI*i/(8.0*n[k]))) * cos(0.37*i);
+
+
+
+        /* One f_apd_demodulation call per segment */
+
+        t0 = f_bench_time();
+
+        for (j=0; j<n_seg; j++)
+        {
+            exitflag = f_apd_demodulation (s+j*n[k], &Par, NULL, NULL, \
+                    m_old+j*n[k], &e_out, &iter);
+
+            if (exitflag != 0)
+
+                goto failed;
+        }
+
+        t_old = (f_bench_time() - t0) / n_seg;
+
+
+
+        /* One plan for all segments */
+
+        t0 = f_bench_time();
+
+        exitflag = f_apd_plan_create (&Par, NULL, 0, NULL, &plan);
+
+        if (exitflag != 0)
+
+            goto failed;
+
+        for (j=0; j<n_seg; j++)
+        {
+            exitflag = f_apd_plan_execute (plan, s+j*n[k], NULL, m_new+j*n[k], \
+                    &e_out, &iter);
+
+            if (exitflag != 0)
+
+                goto failed;
+        }
+
+        f_apd_plan_destroy (plan);
+
+        plan = NULL;
+
+        t_new = (f_bench_time() - t0) / n_seg;
+
+
+
+        diff = 0;
+
+        for (i=0; i<n[k]*n_seg; i++)
+
+            diff = fmax(diff, fabs(m_old[i] - m_new[i]));
+
+
+        printf("%-10ld %-26.2f %-16.2f %-8.2f %-10.1e" STR_NL, n[k], 1e6*t_old, \
+               1e6*t_new, t_old/t_new, diff);
+
+
+        free(s);
+
+        free(m_old);
+
+        free(m_new);
+
+        s = NULL;
+
+        m_old = NULL;
+
+        m_new = NULL;
+    }
+
+    printf(STR_NL);
+
+
+
+    /* Output & Memory deallocation */
+
+    finish:
+
+        free(s);
+
+        free(m_old);
+
+        free(m_new);
+
+        f_apd_plan_destroy (plan);
+
+        return exitflag;
+
+    failed:
+
+        f_apd_print_error(exitflag);
+
+        goto finish;
+
+}
@@ -0,0 +1,335 @@
+
+/*                       C O P Y R I G H T   N O T I C E
+ *
+ * Copyright ©2021. Institute of Science and Technology Austria (IST Austria).
+ * All Rights Reserved. The underlying technology is protected by PCT Patent
+ * Application No. PCT/EP2021/054650.
+ *
+ * This file is part of the AP Demodulation library, which is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation in version 2.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY, without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE. See the GNU General Public License v2 for more details. You
+ * should have received a copy of the GNU General Public License v2 along with this
+ * program. If not, see https://www.gnu.org/licenses/.
+ *
+ * Contact the Technology Transfer Office, IST Austria, Am Campus 1,
+ * A-3400 Klosterneuburg, Austria, +43-(0)2243 9000, twist@ist.ac.at, for commercial
+ * licensing opportunities.
+ *
+ * See https://github.com/mgabriel-lt/ap-demodulation for the latest version of the
+ * code and user-friendly explanations on the working principle, domains of
+ * application, and advice on the usage of different AP Demodulation algorithms in
+ * practice.
+ */
+
+
+/* BENCHMARK: SINGLE-PRECISION AP ALGORITHMS
+ *
+ * This program demodulates large 2D and 3D amplitude-modulated signals by the three
+ * AP algorithms (a fixed number of iterations) with the work arrays of the plan in
+ * double and in single precision (see f_apd_plan_create). For every case, it
+ * prints the time per iteration in both precisions, the memory of the work arrays
+ * of the plan (the signal, the absolute-value signal, and the auxiliary arrays of
+ * AP-A and AP-P), the maximum difference between the modulators relative to the
+ * maximum of the modulator, and the infeasibility errors of both precisions. The
+ * results are printed to stdout as a table. Compile this program by using Option 1
+ * described in the documentation.
+ */
+
+
+#ifndef _WIN32
+
+    #define _POSIX_C_SOURCE 200809L
+
+#endif
+
+
+#include <stdlib.h>
+
+#include <stdio.h>
+
+#include <math.h>
+
+#include <time.h>
+
+#include "h_bench.h"
+
+#include "f_apd_demodulation.c"
+
+
+
+
+static int f_bench_run ( const struct strAPD_Par* Par, \
+
+                         const int prec, \
+
+                         const double* s, \
+
+                         double* m, \
+
+                         double* t_out, \
+
+                         double* mem_out, \
+
+                         double* e_out )
+{
+/* Demodulation of s with the work arrays in the precision prec: time per
+ * iteration, memory of the work arrays of the plan, and the infeasibility error */
+
+    int exitflag = 0;
+
+    long iter;
+
+    double t0;
+
+    struct strAPD_Plan *plan = NULL;
+
+    struct strAPD_Opt opt;
+
+
+    f_apd_get_options (&opt);
+
+    opt.Pr = prec;
+
+    exitflag = f_apd_plan_create (Par, NULL, 0, &opt, &plan);
+
+    if (exitflag != 0)
+
+        return exitflag;
+
+
+    *mem_out = (double) (2 + 2*(plan->w1 != NULL)) * plan->nx_2 * \
+               ((prec == APD_PREC_SINGLE) ? sizeof(float) : sizeof(double));
+
+
+    t0 = f_bench_time();
+
+    exitflag = f_apd_plan_execute (plan, s, NULL, m, e_out, &iter);
+
+    *t_out = (f_bench_time() - t0) / iter;
+
+
+    f_apd_plan_destroy (plan);
+
+    return exitflag;
+}
+
+
+
+
+int main(void)
+{
+
+    /* Exit flag */
+
+    int exitflag = 0;
+
+
+
+    /* Sets f_apd_demodulation to return control to the calling f-tion upon error */
+
+    f_apd_set_errexit(0);
+
+
+
+    /* Iteration variables */
+
+    long i;
+
+    int k;
+
+    int a;
+
+
+
+    /* Benchmarked signal shapes and algorithms */
+
+    const int n_cases = 2;
+
+    const int D[] = {2, 3};
+
+    const long N[][3] = {{2048, 2048, 0}, {160, 160, 160}};
+
+    const char Al[] = {'B', 'A', 'P'};
+
+
+
+    /* Benchmark variables */
+
+    long n;
+
+    double t_d;
+
+    double t_s;
+
+    double mem_d;
+
+    double mem_s;
+
+    double e_d;
+
+    double e_s;
+
+    double diff;
+
+    double m_max;
+
+    double *s = NULL;
+
+    double *m_d = NULL;
+
+    double *m_s = NULL;
+
+
+
+    /* Demodulation parameters (30 iterations, Fc = Fs/64 in every dimension) */
+
+    struct strAPD_Par Par;
+
+    long im[2] = {1, 30};
+
+    long ie[2] = {1, 30};
+
+    Par.Fs[0] = 1;
+
+    Par.Fs[1] = 1;
+
+    Par.Fs[2] = 1;
+
+    Par.Fc[0] = 1.0/64;
+
+    Par.Fc[1] = 1.0/64;
+
+    Par.Fc[2] = 1.0/64;
+
+    Par.Et = 0;
+
+    Par.Ni = 30;
+
+    Par.Br = 0;
+
+    Par.Cp = 1;
+
+    Par.im = im;
+
+    Par.ie = ie;
+
+
+
+    printf(STR_NL "%-16s %-3s %-12s %-12s %-8s %-10s %-10s %-10s %-10s %-10s" \
+           STR_NL, "N", "Al", "double [ms]", "single [ms]", "speedup", \
+           "mem d [MB]", "mem s [MB]", "max diff", "e double", "e single");
+
+
+    for (k=0; k<n_cases; k++)
+    {
+        Par.D = D[k];
+
+        n = 1;
+
+        for (i=0; i<D[k]; i++)
+        {
+            Par.Ns[i] = N[k][i];
+
+            n = n * N[k][i];
+        }
+
+        s = (double*) malloc(n*sizeof(double));
+
+        m_d = (double*) malloc(n*sizeof(double));
+
+        m_s = (double*) malloc(n*sizeof(double));
+
+        if (s == NULL || m_d == NULL || m_s == NULL)
+        {
+            f_apd_set_error(APD_ERR_ID_MEM,__LINE__,APD_ERR_FILE);
+
+            f_apd_get_error(&exitflag, NULL, NULL, NULL);
+
+            goto failed;
+        }
+
+
+        /* Amplitude-modulated harmonic signal (the modulator varies along every
+         * dimension) */
+
+        f_bench_am (D[k], N[k], 200.0, s);
+
+
+        for (a=0; a<3; a++)
+        {
+            Par.Al = Al[a];
+
+            exitflag = f_bench_run (&Par, APD_PREC_DOUBLE, s, m_d, &t_d, &mem_d, \
+                                    &e_d);
+
+            if (exitflag != 0)
+
+                goto failed;
+
+            exitflag = f_bench_run (&Par, APD_PREC_SINGLE, s, m_s, &t_s, &mem_s, \
+                                    &e_s);
+
+            if (exitflag != 0)
+
+                goto failed;
+
+
+            diff = 0;
+
+            m_max = 0;
+
+            for (i=0; i<n; i++)
+            {
+                diff = fmax(diff, fabs(m_d[i] - m_s[i]));
+
+                m_max = fmax(m_max, fabs(m_d[i]));
+            }
+
+
+            printf("%-16s %-3c %-12.2f %-12.2f %-8.2f %-10.1f %-10.1f %-10.1e " \
+                   "%-10.3e %-10.3e" STR_NL, (D[k] == 2) ? "2048 x 2048" : \
+                   "160 x 160 x 160", Al[a], 1e3*t_d, 1e3*t_s, t_d/t_s, \
+                   mem_d/1048576, mem_s/1048576, diff/m_max, e_d, e_s);
+        }
+
+
+        free(s);
+
+        free(m_d);
+
+        free(m_s);
+
+        s = NULL;
+
+        m_d = NULL;
+
+        m_s = NULL;
+    }
+
+    printf(STR_NL);
+
+
+
+    /* Output & Memory deallocation */
+
+    finish:
+
+        free(s);
+
+        free(m_d);
+
+        free(m_s);
+
+        return exitflag;
+
+    failed:
+
+        f_apd_print_error(exitflag);
+
+        goto finish;
+
+}
@@ -0,0 +1,335 @@
+
+/*                       C O P Y R I G H T   N O T I C E
+ *
+ * Copyright ©2021. Institute of Science and Technology Austria (IST Austria).
+ * All Rights Reserved. The underlying technology is protected by PCT Patent
+ * Application No. PCT/EP2021/054650.
+ *
+ * This file is part of the AP Demodulation library, which is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation in version 2.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY, without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE. See the GNU General Public License v2 for more details. You
+ * should have received a copy of the GNU General Public License v2 along with this
+ * program. If not, see https://www.gnu.org/licenses/.
+ *
+ * Contact the Technology Transfer Office, IST Austria, Am Campus 1,
+ * A-3400 Klosterneuburg, Austria, +43-(0)2243 9000, twist@ist.ac.at, for commercial
+ * licensing opportunities.
+ *
+ * See https://github.com/mgabriel-lt/ap-demodulation for the latest version of the
+ * code and user-friendly explanations on the working principle, domains of
+ * application, and advice on the usage of different AP Demodulation algorithms in
+ * practice.
+ */
+
+
+/* BENCHMARK: PRUNED FFT
+ *
+ * This program measures the time of one projection onto the set Mw of a 1D signal
+ * computed by the full FFT of the DFT backend in use and by the pruned FFT of
+ * l_apd_fft.c, which computes only the iL Fourier coefficients in the passband
+ * (see f_apd_dft_prune). The length p of the short DFTs of the pruned FFT is
+ * selected automatically (p = 1 stands for direct sums over the signal, "full"
+ * means that the pruned FFT is not estimated to be clearly faster and the plan
+ * falls back to the full FFT, see f_apd_pfft_select). Power-of-two, 5-smooth, and
+ * prime signal lengths are tested with cutoff frequencies Fc = Fs*10^-5, ...,
+ * Fs*10^-2. The maximum difference between both projections (relative to the
+ * maximum of the projected signal) is reported as well. The results are printed
+ * to stdout as a table. Compile this program by using Option 1 described in the
+ * documentation (add -DAPD_NO_MKL to compile without Intel MKL).
+ */
+
+
+#ifndef _WIN32
+
+    #define _POSIX_C_SOURCE 200809L
+
+#endif
+
+
+#include <stdlib.h>
+
+#include <stdio.h>
+
+#include <math.h>
+
+#include <time.h>
+
+#include "h_bench.h"
+
+#include "f_apd_demodulation.c"
+
+
+
+
+static int f_bench_PMw ( const int prune, \
+
+                         const long n, \
+
+                         const long iL, \
+
+                         const long n_rep, \
+
+                         double* s, \
+
+                         long* p_out, \
+
+                         double* t_out )
+{
+/* Average time of the projection onto Mw of the signal s (the projected signal is
+ * returned in s) computed by the full FFT (prune = 0) or by the pruned FFT if it is
+ * selected (prune = 1) */
+
+    int exitflag = 0;
+
+    long i;
+
+    long N[1] = {n};
+
+    long iL_1[1] = {iL};
+
+    long iR_1[1] = {n - iL};
+
+    double t0;
+
+    double *s_0 = NULL;
+
+    struct strAPD_DFT dft = {0};
+
+
+    s_0 = (double*) malloc((n+2)*sizeof(double));
+
+    if (s_0 == NULL)
+    {
+        f_apd_set_error(APD_ERR_ID_MEM,__LINE__,APD_ERR_FILE);
+
+        f_apd_get_error(&exitflag, NULL, NULL, NULL);
+
+        goto finish;
+    }
+
+    memcpy(s_0, s, (n+2)*sizeof(double));
+
+
+    exitflag = f_apd_dft_init (1, N, 0, 1, APD_PREC_DOUBLE, &dft);
+
+    if (exitflag != 0)
+
+        goto finish;
+
+    if (prune)
+    {
+        exitflag = f_apd_dft_prune (&dft, 1, N, iL_1);
+
+        if (exitflag != 0)
+
+            goto finish;
+    }
+
+    *p_out = (dft.pfft != NULL) ? dft.pfft->p : 0;
+
+
+    t0 = f_bench_time();
+
+    for (i=0; i<n_rep; i++)
+    {
+        memcpy(s, s_0, (n+2)*sizeof(double));
+
+        exitflag = f_apd_dft_PMw (s, 1, N, iL_1, iR_1, &dft, NULL);
+
+        if (exitflag != 0)
+
+            goto finish;
+    }
+
+    *t_out = (f_bench_time() - t0) / n_rep;
+
+
+
+    finish:
+
+        f_apd_dft_free (&dft);
+
+        free(s_0);
+
+        return exitflag;
+}
+
+
+
+
+int main(void)
+{
+
+    /* Exit flag */
+
+    int exitflag = 0;
+
+
+
+    /* Sets f_apd_demodulation to return control to the calling f-tion upon error */
+
+    f_apd_set_errexit(0);
+
+
+
+    /* Iteration variables */
+
+    long i;
+
+    int j;
+
+    int k;
+
+
+
+    /* Benchmarked signal lengths and ratios Fc/Fs */
+
+    const int n_len = 3;
+
+    const long n[] = {1048576, 1000000, 1000003};
+
+    const char* type[] = {"pow2", "5-smooth", "prime"};
+
+    const int n_fc = 4;
+
+    const double fc[] = {1e-5, 1e-4, 1e-3, 1e-2};
+
+    const long n_rep = 5;
+
+
+
+    /* Benchmark variables */
+
+    long iL;
+
+    long p;
+
+    long p_full;
+
+    double t_full;
+
+    double t_pr;
+
+    double d;
+
+    double d_max;
+
+    double s_max;
+
+    double *s = NULL;
+
+    double *s_pr = NULL;
+
+
+
+    printf(STR_NL "%-10s %-10s %-8s %-8s %-8s %-12s %-12s %-9s %-10s" STR_NL, \
+           "N", "type", "Fc/Fs", "iL", "p", "full [ms]", "pruned [ms]", \
+           "speedup", "max diff");
+
+
+    for (j=0; j<n_len; j++)
+    {
+        s = (double*) malloc((n[j]+2)*sizeof(double));
+
+        s_pr = (double*) malloc((n[j]+2)*sizeof(double));
+
+        if (s == NULL || s_pr == NULL)
+        {
+            f_apd_set_error(APD_ERR_ID_MEM,__LINE__,APD_ERR_FILE);
+
+            f_apd_get_error(&exitflag, NULL, NULL, NULL);
+
+            goto failed;
+        }
+
+
+        for (k=0; k<n_fc; k++)
+        {
+            /* Slowly modulated signal with noise */
+
+            for (i=0; i<n[j]+2; i++)
+
+                s[i] = (i < n[j]) ? fabs(cos(0.37*i) * (1.1 + sin(1e-5*i))) : 0;
+
+            memcpy(s_pr, s, (n[j]+2)*sizeof(double));
+
+
+            iL = 1 + (long) ceil(fc[k] * n[j]);
+
+            exitflag = f_bench_PMw (0, n[j], iL, n_rep, s, &p_full, &t_full);
+
+            if (exitflag != 0)
+
+                goto failed;
+
+            exitflag = f_bench_PMw (1, n[j], iL, n_rep, s_pr, &p, &t_pr);
+
+            if (exitflag != 0)
+
+                goto failed;
+
+
+            d_max = 0;
+
+            s_max = 0;
+
+            for (i=0; i<n[j]; i++)
+            {
+                d = fabs(s_pr[i] - s[i]);
+
+                d_max = (d > d_max) ? d : d_max;
+
+                s_max = (fabs(s[i]) > s_max) ? fabs(s[i]) : s_max;
+            }
+
+
+            /* The projection of a plan that falls back to the full FFT (p = 0) is
+             * the full FFT itself */
+
+            if (p == 0)
+
+                printf("%-10ld %-10s %-8.0e %-8ld %-8s %-12.3f %-12s %-9s %-10s" \
+                       STR_NL, n[j], type[j], fc[k], iL, "full", 1e3*t_full, "-", \
+                       "-", "-");
+
+            else
+
+                printf("%-10ld %-10s %-8.0e %-8ld %-8ld %-12.3f %-12.3f %-9.2f " \
+                       "%-10.1e" STR_NL, n[j], type[j], fc[k], iL, p, 1e3*t_full, \
+                       1e3*t_pr, t_full/t_pr, d_max/s_max);
+        }
+
+        free(s);
+
+        free(s_pr);
+
+        s = NULL;
+
+        s_pr = NULL;
+    }
+
+    printf(STR_NL);
+
+
+
+    /* Output */
+
+    finish:
+
+        free(s);
+
+        free(s_pr);
+
+        return exitflag;
+
+    failed:
+
+        f_apd_print_error(exitflag);
+
+        goto finish;
+
+}
@@ -0,0 +1,255 @@
+
+/*                       C O P Y R I G H T   N O T I C E
+ *
+ * Copyright ©2021. Institute of Science and Technology Austria (IST Austria).
+ * All Rights Reserved. The underlying technology is protected by PCT Patent
+ * Application No. PCT/EP2021/054650.
+ *
+ * This file is part of the AP Demodulation library, which is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation in version 2.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY, without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE. See the GNU General Public License v2 for more details. You
+ * should have received a copy of the GNU General Public License v2 along with this
+ * program. If not, see https://www.gnu.org/licenses/.
+ *
+ * Contact the Technology Transfer Office, IST Austria, Am Campus 1,
+ * A-3400 Klosterneuburg, Austria, +43-(0)2243 9000, twist@ist.ac.at, for commercial
+ * licensing opportunities.
+ *
+ * See https://github.com/mgabriel-lt/ap-demodulation for the latest version of the
+ * code and user-friendly explanations on the working principle, domains of
+ * application, and advice on the usage of different AP Demodulation algorithms in
+ * practice.
+ */
+
+
+/* BENCHMARK: STATISTICS OF THE DEMODULATION
+ *
+ * This program demodulates 1D and 2D amplitude-modulated signals by AP-Basic,
+ * AP-Accelerated, and AP-Projected and, for every case, prints the statistics of
+ * the demodulation (see f_apd_get_stats): the wall time of the setup (validation,
+ * memory allocation, interpolation, and DFT initialization), of the placement of
+ * the signal on the DFT grid, of the iterations and of the projections onto Mw
+ * within them, the number of DFTs, the memory allocated, the number of iterations,
+ * the average time per iteration, and the final factor lambda of AP-Accelerated.
+ * The results are printed to stdout as a table. The phases of the last case are
+ * written to the file apd_trace.json in the Chrome trace-event format (see
+ * f_apd_write_trace). Compile this program by using Option 1 described in the
+ * documentation.
+ */
+
+
+#ifndef _WIN32
+
+    #define _POSIX_C_SOURCE 200809L
+
+#endif
+
+
+#include <stdlib.h>
+
+#include <stdio.h>
+
+#include <math.h>
+
+#include "h_bench.h"
+
+#include "f_apd_demodulation.c"
+
+
+
+#define FILE_TR "apd_trace.json"
+
+
+
+
+int main(void)
+{
+
+    /* Exit flag */
+
+    int exitflag = 0;
+
+
+
+    /* Sets f_apd_demodulation to return control to the calling f-tion upon error */
+
+    f_apd_set_errexit(0);
+
+
+
+    /* Iteration variables */
+
+    long i;
+
+    int k;
+
+    int a;
+
+
+
+    /* Benchmarked signal shapes and algorithms */
+
+    const int n_cases = 2;
+
+    const int D[] = {1, 2};
+
+    const long N[][2] = {{262144, 0}, {256, 256}};
+
+    const char Al[] = {'B', 'A', 'P'};
+
+
+
+    /* Benchmark variables */
+
+    long n;
+
+    long iter;
+
+    double t_set;
+
+    double e;
+
+    double *s = NULL;
+
+    double *m = NULL;
+
+    struct strAPD_Stats St;
+
+
+
+    /* Demodulation parameters (Et = 10^-4, at most 5000 iterations, Fc = Fs/64 in
+     * every dimension; the final modulator and error are saved) */
+
+    struct strAPD_Par Par;
+
+    long im[2] = {1, 5000};
+
+    long ie[2] = {1, 5000};
+
+    Par.Fs[0] = 1;
+
+    Par.Fs[1] = 1;
+
+    Par.Fc[0] = 1.0/64;
+
+    Par.Fc[1] = 1.0/64;
+
+    Par.Et = 1e-4;
+
+    Par.Ni = 5000;
+
+    Par.Br = 0;
+
+    Par.Cp = 1;
+
+    Par.im = im;
+
+    Par.ie = ie;
+
+
+
+    printf(STR_NL "%-10s %-3s %-10s %-10s %-10s %-10s %-8s %-10s %-6s %-10s %-10s" \
+           STR_NL, "N", "Al", "setup [ms]", "load [ms]", "iter [ms]", "dft [ms]", \
+           "n dft", "bytes", "iter", "t/it [us]", "lambda");
+
+
+    for (k=0; k<n_cases; k++)
+    {
+        Par.D = D[k];
+
+        n = 1;
+
+        for (i=0; i<D[k]; i++)
+        {
+            Par.Ns[i] = N[k][i];
+
+            n = n * N[k][i];
+        }
+
+        s = (double*) malloc(n*sizeof(double));
+
+        m = (double*) malloc(n*sizeof(double));
+
+        if (s == NULL || m == NULL)
+        {
+            f_apd_set_error(APD_ERR_ID_MEM,__LINE__,APD_ERR_FILE);
+
+            f_apd_get_error(&exitflag, NULL, NULL, NULL);
+
+            goto failed;
+        }
+
+
+        /* Amplitude-modulated harmonic signal (the modulator varies along every
+         * dimension) */
+
+        f_bench_am (D[k], N[k], 200.0, s);
+
+
+        for (a=0; a<3; a++)
+        {
+            Par.Al = Al[a];
+
+            exitflag = f_apd_demodulation (s, &Par, NULL, NULL, m, &e, &iter);
+
+            if (exitflag != 0)
+
+                goto failed;
+
+            f_apd_get_stats (&St);
+
+
+            t_set = St.t[APD_STATS_VALID] + St.t[APD_STATS_ALLOC] + \
+                    St.t[APD_STATS_INTERP] + St.t[APD_STATS_DFT_INIT];
+
+            printf("%-10s %-3c %-10.2f %-10.2f %-10.2f %-10.2f %-8ld %-10.0f %-6ld " \
+                   "%-10.1f %-10.4f" STR_NL, (D[k] == 1) ? "262144" : "256 x 256", \
+                   Al[a], 1e3*t_set, 1e3*St.t[APD_STATS_LOAD], \
+                   1e3*St.t[APD_STATS_ITER], 1e3*St.t[APD_STATS_DFT], St.n_dft, \
+                   (double) St.bytes, St.iter, 1e6*St.t_iter, St.lambda);
+        }
+
+
+        free(s);
+
+        free(m);
+
+        s = NULL;
+
+        m = NULL;
+    }
+
+    printf(STR_NL);
+
+
+    exitflag = f_apd_write_trace (FILE_TR);
+
+    if (exitflag != 0)
+
+        goto failed;
+
+    printf("Trace of the last case written to " FILE_TR STR_NL STR_NL);
+
+
+
+    /* Output & Memory deallocation */
+
+    finish:
+
+        free(s);
+
+        free(m);
+
+        return exitflag;
+
+    failed:
+
+        f_apd_print_error(exitflag);
+
+        goto finish;
+
+}
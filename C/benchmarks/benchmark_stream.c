@@ -0,0 +1,381 @@
+
+/*                       C O P Y R I G H T   N O T I C E
+ *
+ * Copyright ©2021. Institute of Science and Technology Austria (IST Austria).
+ * All Rights Reserved. The underlying technology is protected by PCT Patent
+ * Application No. PCT/EP2021/054650.
+ *
+ * This file is part of the AP Demodulation library, which is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation in version 2.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY, without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE. See the GNU General Public License v2 for more details. You
+ * should have received a copy of the GNU General Public License v2 along with this
+ * program. If not, see https://www.gnu.org/licenses/.
+ *
+ * Contact the Technology Transfer Office, IST Austria, Am Campus 1,
+ * A-3400 Klosterneuburg, Austria, +43-(0)2243 9000, twist@ist.ac.at, for commercial
+ * licensing opportunities.
+ *
+ * See https://github.com/mgabriel-lt/ap-demodulation for the latest version of the
+ * code and user-friendly explanations on the working principle, domains of
+ * application, and advice on the usage of different AP Demodulation algorithms in
+ * practice.
+ */
+
+
+/* BENCHMARK: STREAMING DEMODULATION
+ *
+ * This program demodulates a multichannel audio-rate signal (8 channels at 48 kHz,
+ * modulators below 100 Hz) by the three AP algorithms in a stream (see
+ * f_apd_stream_create), to which the signal is pushed, and from which the modulator
+ * is pulled, in chunks of 10 ms. The blocks of the stream are started from the
+ * absolute-value signal (cold) and from the modulator of the previous block
+ * (warm). For both starts, it prints the latency of the stream, the total time and
+ * the real-time factor (the duration of the signal divided by the time), and the
+ * maximum difference between the modulators of the stream and of
+ * f_apd_demodulation of the whole signal, relative to the maximum of the modulator,
+ * away from the ends of the signal. The results are printed to stdout as a table.
+ * The difference is checked against the tolerance TOL (2 % of the maximum, above
+ * the boundary error of the edges of 1792 samples and the tolerance Par.Et, and
+ * the difference of warm starts, see f_apd_stream_create), and the program
+ * returns a nonzero value if any difference exceeds it. AP-A is started cold in
+ * both rows (the stream uses no warm start for it).
+ * Compile this program by using Option 1 described in the documentation.
+ */
+
+
+#ifndef _WIN32
+
+    #define _POSIX_C_SOURCE 200809L
+
+#endif
+
+
+#include <stdlib.h>
+
+#include <stdio.h>
+
+#include <math.h>
+
+#include <time.h>
+
+#include "h_bench.h"
+
+#include "f_apd_demodulation.c"
+
+
+
+#define N_CH 8
+
+#define FS 48000
+
+#define DUR 10
+
+#define CHUNK 480
+
+#define TOL 2e-2
+
+
+
+
+static int f_bench_stream ( const struct strAPD_Par* Par, \
+
+                            const long hop, \
+
+                            const long xfade, \
+
+                            const int warm, \
+
+                            const double* s, \
+
+                            const long n, \
+
+                            double* m, \
+
+                            double* t_out )
+{
+/* Streaming demodulation of the n frames of s in chunks of CHUNK frames: the
+ * modulator and the total time */
+
+    int exitflag = 0;
+
+    long i;
+
+    long n_in;
+
+    long n_out;
+
+    long n_m = 0;
+
+    struct strAPD_Stream *S = NULL;
+
+
+    exitflag = f_apd_stream_create (Par, N_CH, hop, xfade, warm, NULL, &S);
+
+    if (exitflag != 0)
+
+        return exitflag;
+
+
+    *t_out = f_bench_time();
+
+    for (i=0; i<n; i=i+n_in)
+    {
+        exitflag = f_apd_stream_push (S, s + i*N_CH, (n-i < CHUNK) ? n-i : CHUNK, \
+                                      &n_in);
+
+        if (exitflag != 0)
+
+            goto finish;
+
+        f_apd_stream_pull (S, m + n_m*N_CH, n - n_m, &n_out);
+
+        n_m = n_m + n_out;
+    }
+
+    f_apd_stream_pull (S, m + n_m*N_CH, n - n_m, &n_out);
+
+    n_m = n_m + n_out;
+
+    exitflag = f_apd_stream_flush (S);
+
+    if (exitflag != 0)
+
+        goto finish;
+
+    f_apd_stream_pull (S, m + n_m*N_CH, n - n_m, &n_out);
+
+    *t_out = f_bench_time() - *t_out;
+
+
+    finish:
+
+        f_apd_stream_destroy (S);
+
+        return exitflag;
+}
+
+
+
+
+int main(void)
+{
+
+    /* Exit flag */
+
+    int exitflag = 0;
+
+
+
+    /* Sets f_apd_demodulation to return control to the calling f-tion upon error */
+
+    f_apd_set_errexit(0);
+
+
+
+    /* Iteration variables */
+
+    long i;
+
+    int k;
+
+    int a;
+
+    int w;
+
+
+
+    /* Benchmarked algorithms */
+
+    const char Al[] = {'B', 'A', 'P'};
+
+
+
+    /* Benchmark variables */
+
+    const long n = DUR*FS;
+
+    const long L = 8192;
+
+    const long hop = 4096;
+
+    const long xfade = 512;
+
+    long iter;
+
+    double t;
+
+    double e;
+
+    double diff;
+
+    double m_max;
+
+    int n_check = 0;
+
+    int n_fail = 0;
+
+    double *s = NULL;
+
+    double *m = NULL;
+
+    double *s_k = NULL;
+
+    double *m_k = NULL;
+
+
+
+    /* Demodulation parameters (Et = 10^-3, at most 5000 iterations, Fc = 100 Hz;
+     * the final modulator and error are saved) */
+
+    struct strAPD_Par Par;
+
+    long im[2] = {1, 5000};
+
+    long ie[2] = {1, 5000};
+
+    Par.D = 1;
+
+    Par.Fs[0] = FS;
+
+    Par.Fc[0] = 100;
+
+    Par.Ns[0] = n;
+
+    Par.Et = 1e-3;
+
+    Par.Ni = 5000;
+
+    Par.Br = 0;
+
+    Par.Cp = 1;
+
+    Par.im = im;
+
+    Par.ie = ie;
+
+
+
+    s = (double*) malloc(n*N_CH*sizeof(double));
+
+    m = (double*) malloc(n*N_CH*sizeof(double));
+
+    s_k = (double*) malloc(n*sizeof(double));
+
+    m_k = (double*) malloc(n*N_CH*sizeof(double));
+
+    if (s == NULL || m == NULL || s_k == NULL || m_k == NULL)
+    {
+        f_apd_set_error(APD_ERR_ID_MEM,__LINE__,APD_ERR_FILE);
+
+        f_apd_get_error(&exitflag, NULL, NULL, NULL);
+
+        goto failed;
+    }
+
+
+
+    /* Amplitude-modulated harmonic signals (frames of N_CH channels, modulators of
+     * 2-13 Hz, carriers of 0.5-4 kHz) */
+
+    for (i=0; i<n; i++)
+
+        for (k=0; k<N_CH; k++)
+
+            s[i*N_CH+k] = (1.1 + 0.3 * sin(2*M_PI*(2.0+1.5*k)*i / FS)) * \
+                          cos(2*M_PI*(500.0+500*k)*i / FS + 0.11*(i % 7));
+
+
+
+    printf(STR_NL "%-6s %-6s %-12s %-10s %-10s %-10s %s" STR_NL, "start", "Al", \
+           "latency [ms]", "time [s]", "RT factor", "max diff", "check");
+
+
+    for (a=0; a<3; a++)
+    {
+        Par.Al = Al[a];
+
+
+        /* Reference: f_apd_demodulation of the whole signal of every channel (m_k
+         * holds the channels one after another) */
+
+        Par.Ns[0] = n;
+
+        for (k=0; k<N_CH; k++)
+        {
+            for (i=0; i<n; i++)
+
+                s_k[i] = s[i*N_CH+k];
+
+            exitflag = f_apd_demodulation (s_k, &Par, NULL, NULL, m_k + k*n, &e, \
+                                           &iter);
+
+            if (exitflag != 0)
+
+                goto failed;
+        }
+
+
+        Par.Ns[0] = L;
+
+        for (w=0; w<2; w++)
+        {
+            exitflag = f_bench_stream (&Par, hop, xfade, w, s, n, m, &t);
+
+            if (exitflag != 0)
+
+                goto failed;
+
+
+            /* Difference from the reference (without the first and the last
+             * block) */
+
+            diff = 0;
+
+            m_max = 0;
+
+            for (k=0; k<N_CH; k++)
+
+                for (i=L; i<n-L; i++)
+                {
+                    diff = fmax(diff, fabs(m[i*N_CH+k] - m_k[k*n+i]));
+
+                    m_max = fmax(m_max, fabs(m_k[k*n+i]));
+                }
+
+
+            printf("%-6s %-6c %-12.1f %-10.3f %-10.1f %-10.1e %s" STR_NL, \
+                   (w == 0) ? "cold" : "warm", Al[a], \
+                   1e3*(L - (L-hop-xfade)/2) / FS, t, DUR/t, diff/m_max, \
+                   f_bench_check (diff <= TOL*m_max, &n_check, &n_fail));
+        }
+    }
+
+    exitflag = f_bench_verdict (n_fail, n_check, "differences above the tolerance");
+
+
+
+    /* Output & Memory deallocation */
+
+    finish:
+
+        free(s);
+
+        free(m);
+
+        free(s_k);
+
+        free(m_k);
+
+        return exitflag;
+
+    failed:
+
+        f_apd_print_error(exitflag);
+
+        goto finish;
+
+}
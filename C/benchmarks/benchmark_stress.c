@@ -0,0 +1,636 @@
+/*                       C O P Y R I G H T   N O T I C E
+ *
+ * Copyright ©2021. Institute of Science and Technology Austria (IST Austria).
+ * All Rights Reserved. The underlying technology is protected by PCT Patent
+ * Application No. PCT/EP2021/054650.
+ *
+ * This file is part of the AP Demodulation library, which is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation in version 2.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY, without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE. See the GNU General Public License v2 for more details. You
+ * should have received a copy of the GNU General Public License v2 along with this
+ * program. If not, see https://www.gnu.org/licenses/.
+ *
+ * Contact the Technology Transfer Office, IST Austria, Am Campus 1,
+ * A-3400 Klosterneuburg, Austria, +43-(0)2243 9000, twist@ist.ac.at, for commercial
+ * licensing opportunities.
+ *
+ * See https://github.com/mgabriel-lt/ap-demodulation for the latest version of the
+ * code and user-friendly explanations on the working principle, domains of
+ * application, and advice on the usage of different AP Demodulation algorithms in
+ * practice.
+ */
+
+
+/* BENCHMARK: CONCURRENT DEMODULATIONS (STRESS TEST)
+ *
+ * This program runs hundreds of concurrent calls to f_apd_demodulation on a pool
+ * of POSIX threads and checks them against the same calls made one after another
+ * in a single thread. The calls cycle through seven cases: 1D AP-Basic, 1D
+ * AP-Accelerated with an upper bound, 2D AP-Projected, and 1D AP-Basic of a
+ * nonuniformly sampled signal, which succeed, and calls with a non-finite signal
+ * element, with a cutoff frequency above the Nyquist frequency, and with an upper
+ * bound below the absolute value of the signal, which fail. All calls share the
+ * parameter structures of their cases. For every call, the exit flag, the error id
+ * and the line and the file of the error state of the calling thread (see
+ * f_apd_get_error), the number of iterations, the infeasibility errors, and the
+ * modulators must be identical to those of the serial run, in every one of several
+ * rounds. The results are printed to stdout as a table, and the program returns a
+ * nonzero value if any call does not match. Compile this program by using Option 1
+ * described in the documentation (with -lpthread added on Linux and macOS); the
+ * number of threads can be given as the first command-line argument (default:
+ * twice the number of online processors, at least 8).
+ */
+
+
+#ifndef _WIN32
+
+    #define _POSIX_C_SOURCE 200809L
+
+#endif
+
+
+#include <stdlib.h>
+
+#include <stdio.h>
+
+#include <math.h>
+
+#include <time.h>
+
+#include "h_bench.h"
+
+#include "f_apd_demodulation.c"
+
+
+
+
+/* Numbers of cases, calls, and rounds, and the length of the file names of the
+ * error states */
+
+#define BENCH_NCASE 7
+
+#define BENCH_NCALL 700
+
+#define BENCH_NROUND 5
+
+#define BENCH_NFILE 200
+
+
+
+
+#ifndef APD_NO_PTHREADS
+
+
+
+/* Outcome of one call to f_apd_demodulation */
+
+struct strBench_Call {
+
+                    const double*             s;
+
+                    const struct strAPD_Par*  Par;
+
+                    const double*             Ub;
+
+                    const double*             t;
+
+                    double*                   out_m;
+
+                    double*                   out_e;
+
+                    long                      n_m;
+
+                    long                      n_e;
+
+                    int                       exitflag;
+
+                    int                       err_id;
+
+                    long                      err_line;
+
+                    char                      err_file[BENCH_NFILE];
+
+                    long                      iter;
+
+                   };
+
+
+/* Thread pool: the calls are taken one by one through a shared counter */
+
+struct strBench_Pool {
+
+                    struct strBench_Call*     calls;
+
+                    long                      n_calls;
+
+                    long                      next;
+
+                    pthread_mutex_t           lock;
+
+                   };
+
+
+
+
+static void f_bench_call (struct strBench_Call* C)
+{
+/* One call to f_apd_demodulation followed by a readout of the error state of the
+ * calling thread */
+
+    C->iter = -1;
+
+    C->exitflag = f_apd_demodulation (C->s, C->Par, C->Ub, C->t, C->out_m, \
+                                      C->out_e, &(C->iter));
+
+    f_apd_get_error (&(C->err_id), &(C->err_line), C->err_file, NULL);
+}
+
+
+
+
+static void* f_bench_worker (void* arg)
+{
+/* Worker of the thread pool */
+
+    struct strBench_Pool *Q = (struct strBench_Pool*) arg;
+
+    long i;
+
+
+    for (;;)
+    {
+        pthread_mutex_lock (&(Q->lock));
+
+        i = Q->next++;
+
+        pthread_mutex_unlock (&(Q->lock));
+
+        if (i >= Q->n_calls)
+
+            break;
+
+        f_bench_call (Q->calls + i);
+    }
+
+    return NULL;
+}
+
+
+
+
+static int f_bench_same ( const struct strBench_Call* A, \
+
+                          const struct strBench_Call* B )
+{
+/* 1 if the outcomes of two calls are identical (the outputs are compared only for
+ * successful calls) */
+
+    if (A->exitflag != B->exitflag || A->err_id != B->err_id || \
+            A->err_line != B->err_line || strcmp(A->err_file, B->err_file) != 0)
+
+        return 0;
+
+    if (A->exitflag != APD_ERR_ID_NON)
+
+        return 1;
+
+    return A->iter == B->iter && \
+           memcmp(A->out_m, B->out_m, (A->n_m)*sizeof(double)) == 0 && \
+           memcmp(A->out_e, B->out_e, (A->n_e)*sizeof(double)) == 0;
+}
+
+
+
+
+int main(int argc, char** argv)
+{
+
+    /* Exit flag */
+
+    int exitflag = 0;
+
+
+
+    /* Sets f_apd_demodulation to return control to the calling f-tion upon error */
+
+    f_apd_set_errexit(0);
+
+
+
+    /* Iteration variables */
+
+    long i;
+
+    long j;
+
+    int k;
+
+    int r;
+
+
+
+    /* Cases: lengths (numbers of sample points) of the signals, 0 - valid,
+     * 1 - invalid */
+
+    const long n[BENCH_NCASE] = {3000, 2048, 64*48, 1500, 1000, 1200, 800};
+
+    const int bad[BENCH_NCASE] = {0, 0, 0, 0, 1, 1, 1};
+
+    const char *name[BENCH_NCASE] = {"1D AP-B", "1D AP-A + Ub", "2D AP-P", \
+            "1D AP-B nonuniform", "non-finite s", "Fc > Fs/2", "Ub < |s|"};
+
+    int n_thr = (argc > 1) ? atoi(argv[1]) : 0;
+
+
+
+    /* Benchmark variables */
+
+    double t0;
+
+    double t_ser;
+
+    double t_par;
+
+    long n_bad;
+
+    long n_fail = 0;
+
+    long n_m;
+
+    long n_e;
+
+    long off_s[BENCH_NCASE+1];
+
+    double *s = NULL;
+
+    double *Ub = NULL;
+
+    double *t = NULL;
+
+    double *m_ref = NULL;
+
+    double *e_ref = NULL;
+
+    double *m_par = NULL;
+
+    double *e_par = NULL;
+
+    struct strBench_Call *ref = NULL;
+
+    struct strBench_Call *par = NULL;
+
+    struct strBench_Pool Q;
+
+    pthread_t *thr = NULL;
+
+    int n_run = 0;
+
+    long n_case[BENCH_NCASE] = {0};
+
+
+
+    /* Demodulation parameters (30 iterations, the modulators of the last
+     * iteration and the errors of five iterations are output) */
+
+    struct strAPD_Par Par[BENCH_NCASE];
+
+    long im[2] = {1, 30};
+
+    long ie[6] = {5, 1, 2, 10, 20, 30};
+
+    memset(Par, 0, sizeof(Par));
+
+    for (k=0; k<BENCH_NCASE; k++)
+    {
+        Par[k].Al = 'B';
+
+        Par[k].D = 1;
+
+        Par[k].Fs[0] = 1;
+
+        Par[k].Fc[0] = 1.0/32;
+
+        Par[k].Et = 0;
+
+        Par[k].Ni = 30;
+
+        Par[k].Ns[0] = n[k];
+
+        Par[k].Cp = 1;
+
+        Par[k].Br = 1;
+
+        Par[k].im = im;
+
+        Par[k].ie = ie;
+    }
+
+    Par[1].Al = 'A';
+
+    Par[2].Al = 'P';
+
+    Par[2].D = 2;
+
+    Par[2].Ns[0] = 64; Par[2].Ns[1] = 48;
+
+    Par[2].Fs[1] = 1; Par[2].Fc[1] = 1.0/16;
+
+    Par[3].Nr[0] = 2*n[3];
+
+    Par[5].Fc[0] = 0.75;
+
+    #ifdef _SC_NPROCESSORS_ONLN
+
+        if (n_thr < 1)
+
+            n_thr = 2 * (int) sysconf(_SC_NPROCESSORS_ONLN);
+
+    #endif
+
+    if (n_thr < 8)
+
+        n_thr = (argc > 1 && n_thr > 0) ? n_thr : 8;
+
+
+
+    /* Memory allocation */
+
+    off_s[0] = 0;
+
+    for (k=0; k<BENCH_NCASE; k++)
+
+        off_s[k+1] = off_s[k] + n[k];
+
+    n_m = 0;
+
+    for (j=0; j<BENCH_NCALL; j++)
+
+        n_m = n_m + n[j%BENCH_NCASE];
+
+    n_e = BENCH_NCALL * ie[0];
+
+
+    s = (double*) malloc(off_s[BENCH_NCASE]*sizeof(double));
+
+    Ub = (double*) malloc(off_s[BENCH_NCASE]*sizeof(double));
+
+    t = (double*) malloc(n[3]*sizeof(double));
+
+    m_ref = (double*) calloc(n_m, sizeof(double));
+
+    m_par = (double*) calloc(n_m, sizeof(double));
+
+    e_ref = (double*) calloc(n_e, sizeof(double));
+
+    e_par = (double*) calloc(n_e, sizeof(double));
+
+    ref = (struct strBench_Call*) calloc(BENCH_NCALL, sizeof(struct strBench_Call));
+
+    par = (struct strBench_Call*) calloc(BENCH_NCALL, sizeof(struct strBench_Call));
+
+    thr = (pthread_t*) malloc(n_thr*sizeof(pthread_t));
+
+    if (s == NULL || Ub == NULL || t == NULL || m_ref == NULL || m_par == NULL || \
+            e_ref == NULL || e_par == NULL || ref == NULL || par == NULL || \
+            thr == NULL)
+    {
+        f_apd_set_error(APD_ERR_ID_MEM,__LINE__,APD_ERR_FILE);
+
+        f_apd_get_error(&exitflag, NULL, NULL, NULL);
+
+        goto failed;
+    }
+
+
+
+    /* Signals of the cases: amplitude-modulated harmonic signals, an upper bound
+     * 10% above the modulator (40% below it in the last case), a non-finite element
+     * in the signal of case 4, and sampling coordinates with jittered intervals */
+
+    for (k=0; k<BENCH_NCASE; k++)
+
+        for (i=0; i<n[k]; i++)
+        {
+            s[off_s[k]+i] = (1.1 + sin(2*M_PI*i/(0.37*n[k]))) * cos(0.41*i + k);
+
+            Ub[off_s[k]+i] = ((k == 6) ? 0.6 : 1.1) * (1.1 + sin(2*M_PI*i/ \
+                             (0.37*n[k])));
+        }
+
+    s[off_s[4] + n[4]/2] = NAN;
+
+    for (i=0; i<n[3]; i++)
+
+        t[i] = i + 0.3*sin(1.7*i);
+
+
+
+    /* Calls cycling through the cases (the outputs of different calls do not
+     * overlap) */
+
+    n_m = 0;
+
+    for (j=0; j<BENCH_NCALL; j++)
+    {
+        k = (int) (j % BENCH_NCASE);
+
+        ref[j].s = s + off_s[k];
+
+        ref[j].Par = Par + k;
+
+        ref[j].Ub = (k == 1 || k == 6) ? Ub + off_s[k] : NULL;
+
+        ref[j].t = (k == 3) ? t : NULL;
+
+        ref[j].n_m = n[k];
+
+        ref[j].n_e = ie[0];
+
+        ref[j].out_m = m_ref + n_m;
+
+        ref[j].out_e = e_ref + j*ie[0];
+
+        par[j] = ref[j];
+
+        par[j].out_m = m_par + n_m;
+
+        par[j].out_e = e_par + j*ie[0];
+
+        n_m = n_m + n[k];
+    }
+
+
+
+    /* Reference: the calls one after another in the calling thread */
+
+    t0 = f_bench_time();
+
+    for (j=0; j<BENCH_NCALL; j++)
+    {
+        f_bench_call (ref + j);
+
+        if ((ref[j].exitflag != APD_ERR_ID_NON) != bad[j%BENCH_NCASE])
+        {
+            printf("Unexpected exit flag %d of the case \"%s\"" STR_NL, \
+                   ref[j].exitflag, name[j%BENCH_NCASE]);
+
+            exitflag = 1;
+
+            goto finish;
+        }
+
+        n_fail = n_fail + (ref[j].exitflag != APD_ERR_ID_NON);
+    }
+
+    t_ser = f_bench_time() - t0;
+
+
+    printf(STR_NL "%-8s %-10s %-8s %-8s %-14s %-10s" STR_NL, "round", "threads", \
+           "calls", "failing", "time [s]", "mismatches");
+
+    printf("%-8s %-10d %-8d %-8ld %-14.3f %-10d" STR_NL, "serial", 1, \
+           BENCH_NCALL, n_fail, t_ser, 0);
+
+
+
+    /* Concurrent calls on the thread pool (the outputs and error states are reset
+     * before every round) */
+
+    for (r=0; r<BENCH_NROUND; r++)
+    {
+        for (j=0; j<BENCH_NCALL; j++)
+        {
+            memset(par[j].out_m, 0, (par[j].n_m)*sizeof(double));
+
+            memset(par[j].out_e, 0, (par[j].n_e)*sizeof(double));
+
+            par[j].exitflag = -1;
+
+            par[j].err_id = -1;
+
+            par[j].err_line = -1;
+
+            par[j].err_file[0] = '\0';
+        }
+
+        Q.calls = par;
+
+        Q.n_calls = BENCH_NCALL;
+
+        Q.next = 0;
+
+        pthread_mutex_init (&(Q.lock), NULL);
+
+
+        t0 = f_bench_time();
+
+        for (n_run=0; n_run<n_thr; n_run++)
+
+            if (pthread_create (thr + n_run, NULL, f_bench_worker, &Q) != 0)
+
+                break;
+
+        f_bench_worker (&Q);
+
+        for (i=0; i<n_run; i++)
+
+            pthread_join (thr[i], NULL);
+
+        t_par = f_bench_time() - t0;
+
+        pthread_mutex_destroy (&(Q.lock));
+
+
+        n_bad = 0;
+
+        for (j=0; j<BENCH_NCALL; j++)
+
+            if (f_bench_same (ref + j, par + j) == 0)
+            {
+                n_bad++;
+
+                n_case[j%BENCH_NCASE]++;
+            }
+
+        printf("%-8d %-10d %-8d %-8ld %-14.3f %-10ld" STR_NL, r+1, n_run+1, \
+               BENCH_NCALL, n_fail, t_par, n_bad);
+
+        if (n_bad > 0)
+
+            exitflag = 1;
+    }
+
+    printf(STR_NL);
+
+    for (k=0; k<BENCH_NCASE; k++)
+
+        if (n_case[k] > 0)
+
+            printf("Mismatches of the case \"%s\": %ld" STR_NL, name[k], n_case[k]);
+
+    if (exitflag != 0)
+
+        printf(STR_NL);
+
+
+
+    /* Output & Memory deallocation */
+
+    finish:
+
+        free(s);
+
+        free(Ub);
+
+        free(t);
+
+        free(m_ref);
+
+        free(m_par);
+
+        free(e_ref);
+
+        free(e_par);
+
+        free(ref);
+
+        free(par);
+
+        free(thr);
+
+        return exitflag;
+
+    failed:
+
+        f_apd_print_error(exitflag);
+
+        goto finish;
+
+}
+
+
+
+
+#else
+
+
+
+
+int main(void)
+{
+/* The thread pool of this program is based on POSIX threads */
+
+    printf(STR_NL "benchmark_stress: skipped (the library is compiled with " \
+           "APD_NO_PTHREADS)" STR_NL STR_NL);
+
+    return 0;
+}
+
+
+
+
+#endif
@@ -0,0 +1,485 @@
+
+/*                       C O P Y R I G H T   N O T I C E
+ *
+ * Copyright ©2021. Institute of Science and Technology Austria (IST Austria).
+ * All Rights Reserved. The underlying technology is protected by PCT Patent
+ * Application No. PCT/EP2021/054650.
+ *
+ * This file is part of the AP Demodulation library, which is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation in version 2.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY, without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE. See the GNU General Public License v2 for more details. You
+ * should have received a copy of the GNU General Public License v2 along with this
+ * program. If not, see https://www.gnu.org/licenses/.
+ *
+ * Contact the Technology Transfer Office, IST Austria, Am Campus 1,
+ * A-3400 Klosterneuburg, Austria, +43-(0)2243 9000, twist@ist.ac.at, for commercial
+ * licensing opportunities.
+ *
+ * See https://github.com/mgabriel-lt/ap-demodulation for the latest version of the
+ * code and user-friendly explanations on the working principle, domains of
+ * application, and advice on the usage of different AP Demodulation algorithms in
+ * practice.
+ */
+
+
+/* BENCHMARK: SUITE OF THE AP DEMODULATION
+ *
+ * This program sweeps the AP algorithms (AP-Basic, AP-Accelerated, AP-Projected),
+ * the dimensions of the signal (D = 1, 2, 3), the total numbers of sample points
+ * (2^10, 2^12, ..., up to 2^k_max, default k_max = 20), and the options of the
+ * demodulation, which are switched on one at a time: none, an upper bound on the
+ * modulator (Ub), nonuniform sampling (t and Par.Nr), and compression (Cp = 2). The
+ * signals are built from the LP-random modulator of example4.c and the harmonic
+ * carrier of example1.c, extended to D dimensions. Sizes whose estimated memory
+ * (the plan, see f_apd_plan_workspace_size, and the input and output arrays)
+ * exceeds the limit (default one half of the physical memory, or mem_max MB) are
+ * skipped. Every demodulation runs in a child process, so that its peak resident
+ * memory is measured separately. For every run, the time per iteration, the total
+ * time, the number of iterations and whether the tolerance .Et was reached, the
+ * peak resident memory, the memory of the plan, and the number of sample points
+ * demodulated per second are printed to stdout as JSON. This benchmark runs on
+ * POSIX systems only. Compile this program by using Option 1 described in the
+ * documentation and run it as
+ *
+ *   ./benchmark_suite [k_max [mem_max]] > results.json
+ */
+
+
+#define _DEFAULT_SOURCE
+
+
+#include <stdlib.h>
+
+#include <stdio.h>
+
+#include <math.h>
+
+#include <time.h>
+
+#include <sys/resource.h>
+
+#include <sys/wait.h>
+
+#include "h_bench.h"
+
+#include "f_apd_demodulation.c"
+
+
+
+#define ET 1e-3
+
+#define NI 500
+
+#define FC 10
+
+#define CP 2
+
+#define OPT_NONE 0
+
+#define OPT_UB 1
+
+#define OPT_NONUNIFORM 2
+
+#define OPT_CP 3
+
+
+
+
+static double f_bench_modulator (const double u)
+{
+/* LP-random modulator of example4.c at the normalized coordinate u in [0, 1) */
+
+    const double w[] = {1.5648, 0.5312, 0.1413, 0.7588, -0.8616, -0.3586, 0.9106, \
+                        -0.1787, -0.0108, -0.0989, -0.3559, -0.4015, 0.2917, \
+                        -0.3458, -1.1990, 0.7651, -0.9884, -1.1668, 0.6584, \
+                        -1.3693};
+
+    double m = 0;
+
+    int j;
+
+
+    for (j=0; j<10; j++)
+
+        m = m + w[2*j] * cos(2*M_PI*j*u+w[1+2*j]);
+
+    return (m + 2.131185657756246) / 7.926671964919291;
+}
+
+
+
+
+static double f_bench_carrier (const double x)
+{
+/* Harmonic carrier of example1.c at the coordinate x in samples (the frequencies
+ * of the ten harmonics and their side lines are scaled to 0.04, ..., 0.4 and 0.06,
+ * ..., 0.42 cycles per sample, so that they do not depend on the signal length) */
+
+    const double w[] = {0.4170, 0.7203, 0.0001, 0.3023, 0.1468, 0.0923, 0.1863, \
+                        0.3456, 0.3968, 0.5388, 0.4192, 0.6852, 0.2045, 0.8781, \
+                        0.0274, 0.6705, 0.4173, 0.5587, 0.1404, 0.1981, 0.8007, \
+                        0.9683, 0.3134, 0.6923, 0.8764, 0.8946, 0.0850, 0.0391, \
+                        0.1698, 0.8781, 0.0983, 0.4211, 0.9579, 0.5332, 0.6919, \
+                        0.3155, 0.6865, 0.8346, 0.0183, 0.7501};
+
+    double c = 0;
+
+    int j;
+
+
+    for (j=0; j<10; j++)
+
+        c = c + w[4*j] * cos(2*M_PI*(0.04*(j+1)*x+w[1+4*j])) + \
+            0.01*w[2+4*j] * cos(2*M_PI*((0.04*(j+1)+0.02)*x+w[3+4*j]));
+
+    return c / 2.628456776936774;
+}
+
+
+
+
+static int f_bench_run ( struct strAPD_Par* Par, \
+
+                         const long* N, \
+
+                         const int opt, \
+
+                         const long n )
+{
+/* Generates the signal of N[0] x ... x N[D-1] sample points (with sampling
+ * coordinates jittered by up to 0.3 of the step for OPT_NONUNIFORM), demodulates
+ * it, and prints the JSON record of the run (without the closing brace) */
+
+    int exitflag = 0;
+
+    long i;
+
+    long r;
+
+    long iter = 0;
+
+    int d;
+
+    double x;
+
+    double u;
+
+    double m;
+
+    double e = 0;
+
+    double t_run;
+
+    double *s = NULL;
+
+    double *Ub = NULL;
+
+    double *t = NULL;
+
+    double *out_m = NULL;
+
+    struct strAPD_Stats St;
+
+    struct rusage ru;
+
+    unsigned long long seed = 12345;
+
+
+    s = (double*) malloc(n*sizeof(double));
+
+    out_m = (double*) malloc(n*sizeof(double));
+
+    if (opt == OPT_UB)
+
+        Ub = (double*) malloc(n*sizeof(double));
+
+    if (opt == OPT_NONUNIFORM)
+
+        t = (double*) malloc((Par->D)*n*sizeof(double));
+
+    if (s == NULL || out_m == NULL || (opt == OPT_UB && Ub == NULL) || \
+            (opt == OPT_NONUNIFORM && t == NULL))
+    {
+        f_apd_set_error(APD_ERR_ID_MEM,__LINE__,APD_ERR_FILE);
+
+        f_apd_get_error(&exitflag, NULL, NULL, NULL);
+
+        goto finish;
+    }
+
+
+    /* Amplitude-modulated signal (the modulator is the mean of the modulators along
+     * the dimensions, and the carrier depends on the sum of the coordinates) */
+
+    for (i=0; i<n; i++)
+    {
+        r = i;
+
+        x = 0;
+
+        m = 0;
+
+        for (d=0; d<(Par->D); d++)
+        {
+            u = r % N[d];
+
+            if (t != NULL)
+            {
+                u = u + 0.6 * (f_bench_rand (&seed) - 0.5);
+
+                t[i + d*n] = u / N[d];
+            }
+
+            x = x + u;
+
+            m = m + f_bench_modulator (u / N[d]);
+
+            r = r / N[d];
+        }
+
+        s[i] = m / (Par->D) * f_bench_carrier (x);
+
+        if (Ub != NULL)
+
+            Ub[i] = 1;
+    }
+
+
+    /* Demodulation */
+
+    t_run = f_bench_time();
+
+    exitflag = f_apd_demodulation (s, Par, Ub, t, out_m, &e, &iter);
+
+    t_run = f_bench_time() - t_run;
+
+    if (exitflag != 0)
+
+        goto finish;
+
+    f_apd_get_stats (&St);
+
+    getrusage(RUSAGE_SELF, &ru);
+
+
+    printf(",\"iter\":%ld,\"converged\":%s,\"e\":%.3e,\"t_total_s\":%.6f," \
+           "\"t_iter_s\":%.6e,\"peak_rss_bytes\":%.0f,\"plan_bytes\":%.0f," \
+           "\"samples_per_s\":%.6e,\"exitflag\":0", iter, (e <= ET) ? "true" : \
+           "false", e, t_run, St.t_iter, 1024.0 * ru.ru_maxrss, (double) St.bytes, \
+           n / t_run);
+
+
+    finish:
+
+        free(s);
+
+        free(Ub);
+
+        free(t);
+
+        free(out_m);
+
+        return exitflag;
+}
+
+
+
+
+int main(int argc, char** argv)
+{
+
+    /* Exit flag */
+
+    int exitflag = 0;
+
+
+
+    /* Sets f_apd_demodulation to return control to the calling f-tion upon error */
+
+    f_apd_set_errexit(0);
+
+
+
+    /* Iteration variables */
+
+    int k;
+
+    int d;
+
+    int a;
+
+    int o;
+
+
+
+    /* Sweep: algorithms, options, largest total number of sample points (2^k_max),
+     * and the memory limit in bytes */
+
+    const char Al[] = {'B', 'A', 'P'};
+
+    const char *opt_name[] = {"none", "ub", "nonuniform", "cp"};
+
+    const int k_max = (argc > 1) ? atoi(argv[1]) : 20;
+
+    const double mem_max = (argc > 2) ? atof(argv[2]) * 1048576.0 : \
+            0.5 * sysconf(_SC_PHYS_PAGES) * (double) sysconf(_SC_PAGESIZE);
+
+
+
+    /* Benchmark variables */
+
+    long N[3];
+
+    long n;
+
+    size_t ws;
+
+    double mem;
+
+    int n_run = 0;
+
+    int status;
+
+    pid_t pid;
+
+
+
+    /* Demodulation parameters (Et = 10^-3, at most 500 iterations, unit length
+     * along every dimension with Fc = 10, or N/8 for short dimensions; the final
+     * modulator and error are saved) */
+
+    struct strAPD_Par Par;
+
+    long im[2] = {1, NI};
+
+    long ie[2] = {1, NI};
+
+    Par.Et = ET;
+
+    Par.Ni = NI;
+
+    Par.Br = 1;
+
+    Par.im = im;
+
+    Par.ie = ie;
+
+
+    printf("{\"benchmark\":\"suite\",\"Et\":%g,\"Ni\":%d,\"threads\":%d," \
+           "\"mem_max_bytes\":%.0f,\"runs\":[", ET, NI,
+           #ifdef _OPENMP
+               omp_get_max_threads(),
+           #else
+               1,
+           #endif
+           mem_max);
+
+
+    for (d=1; d<=3; d++)
+
+        for (k=10; k<=k_max; k=k+2)
+
+            for (o=0; o<4; o++)
+
+                for (a=0; a<3; a++)
+                {
+                    /* Shape of the signal (2^k sample points distributed over the
+                     * dimensions) and parameters of the option */
+
+                    Par.Al = Al[a];
+
+                    Par.D = d;
+
+                    Par.Cp = (o == OPT_CP) ? CP : 1;
+
+                    n = 1;
+
+                    for (int i=0; i<d; i++)
+                    {
+                        N[i] = 1L << (k/d + (i < k%d));
+
+                        n = n * N[i];
+
+                        Par.Ns[i] = N[i];
+
+                        Par.Nr[i] = (o == OPT_NONUNIFORM && i == 0) ? 2*N[i] : N[i];
+
+                        Par.Fs[i] = (o == OPT_NONUNIFORM) ? Par.Nr[i] : N[i];
+
+                        Par.Fc[i] = fmin(FC, N[i] / 8.0);
+                    }
+
+
+                    /* Estimated memory (the plan of the uniform grid, scaled to
+                     * the interpolation grid, and the input and output arrays) */
+
+                    if (f_apd_plan_workspace_size (&Par, NULL, o == OPT_UB, 1, \
+                            NULL, &ws) != 0)
+
+                        continue;
+
+                    mem = ws * ((o == OPT_NONUNIFORM) ? 2.0 : 1.0) + \
+                          (4.0 + d) * n * sizeof(double);
+
+                    if (mem > mem_max)
+
+                        continue;
+
+                    if (o == OPT_NONUNIFORM)
+
+                        Par.Ns[0] = n;
+
+
+                    /* Run in a child process */
+
+                    printf("%s" STR_NL "{\"al\":\"%c\",\"D\":%d,\"N\":[%ld,%ld,%ld]," \
+                           "\"n\":%ld,\"option\":\"%s\"", (n_run > 0) ? "," : "", \
+                           Al[a], d, N[0], (d > 1) ? N[1] : 1, (d > 2) ? N[2] : 1, n, \
+                           opt_name[o]);
+
+                    fflush(stdout);
+
+                    pid = fork();
+
+                    if (pid == 0)
+                    {
+                        exitflag = f_bench_run (&Par, N, o, n);
+
+                        fflush(stdout);
+
+                        _exit(exitflag);
+                    }
+
+                    if (pid < 0 || waitpid(pid, &status, 0) != pid)
+                    {
+                        exitflag = 1;
+
+                        goto finish;
+                    }
+
+                    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+
+                        printf(",\"exitflag\":%d", WIFEXITED(status) ? \
+                               WEXITSTATUS(status) : -1);
+
+                    printf("}");
+
+                    n_run = n_run + 1;
+                }
+
+
+    printf(STR_NL "]}" STR_NL);
+
+
+
+    /* Output */
+
+    finish:
+
+        return exitflag;
+
+}
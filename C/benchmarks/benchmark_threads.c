@@ -0,0 +1,286 @@
+
+/*                       C O P Y R I G H T   N O T I C E
+ *
+ * Copyright ©2021. Institute of Science and Technology Austria (IST Austria).
+ * All Rights Reserved. The underlying technology is protected by PCT Patent
+ * Application No. PCT/EP2021/054650.
+ *
+ * This file is part of the AP Demodulation library, which is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation in version 2.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY, without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE. See the GNU General Public License v2 for more details. You
+ * should have received a copy of the GNU General Public License v2 along with this
+ * program. If not, see https://www.gnu.org/licenses/.
+ *
+ * Contact the Technology Transfer Office, IST Austria, Am Campus 1,
+ * A-3400 Klosterneuburg, Austria, +43-(0)2243 9000, twist@ist.ac.at, for commercial
+ * licensing opportunities.
+ *
+ * See https://github.com/mgabriel-lt/ap-demodulation for the latest version of the
+ * code and user-friendly explanations on the working principle, domains of
+ * application, and advice on the usage of different AP Demodulation algorithms in
+ * practice.
+ */
+
+
+/* BENCHMARK: THREAD SCALING OF THE AP ALGORITHMS
+ *
+ * This program measures the time per AP iteration of the three AP algorithms for a
+ * 3D signal of 256 x 256 x 256 (about 16M) samples and 1, 2, 4, ..., n_thr_max
+ * OpenMP threads, which process the projection onto Cd and the error reductions
+ * (and, with Intel MKL, the DFTs). The modulators must not depend on the number of
+ * threads (see f_apd_blocks), which is checked as well. The results are printed to
+ * stdout as a table. Compile this program by using Option 1 described in the
+ * documentation with OpenMP enabled (e.g., -fopenmp for GCC); the maximum number of
+ * threads can be given as the first command-line argument (default: number of
+ * processors).
+ */
+
+
+#ifndef _WIN32
+
+    #define _POSIX_C_SOURCE 200809L
+
+#endif
+
+
+#include <stdlib.h>
+
+#include <stdio.h>
+
+#include <math.h>
+
+#include <time.h>
+
+#include "h_bench.h"
+
+#include "f_apd_demodulation.c"
+
+
+
+
+int main(int argc, char** argv)
+{
+
+    /* Exit flag */
+
+    int exitflag = 0;
+
+
+
+    /* Sets f_apd_demodulation to return control to the calling f-tion upon error */
+
+    f_apd_set_errexit(0);
+
+
+
+    /* Iteration variables */
+
+    long i;
+
+    int k;
+
+
+
+    /* Signal size and the algorithms */
+
+    const long N[3] = {256, 256, 256};
+
+    const long n = N[0]*N[1]*N[2];
+
+    const char Al[3] = {'B', 'A', 'P'};
+
+    int n_thr_max = (argc > 1) ? atoi(argv[1]) : 0;
+
+
+
+    /* Benchmark variables */
+
+    double t0;
+
+    double t_1 = 0;
+
+    double t_n;
+
+    double diff;
+
+    int n_thr;
+
+    long iter;
+
+    double e_out;
+
+    double *s = NULL;
+
+    double *m_1 = NULL;
+
+    double *m_n = NULL;
+
+    struct strAPD_Plan *plan = NULL;
+
+
+
+    /* Demodulation parameters (10 iterations, Fc = Fs/32 in every dimension) */
+
+    struct strAPD_Par Par;
+
+    long im[2] = {1, 10};
+
+    long ie[2] = {1, 10};
+
+    Par.D = 3;
+
+    Par.Et = 0;
+
+    Par.Ni = 10;
+
+    Par.Cp = 1;
+
+    Par.Br = 0;
+
+    Par.im = im;
+
+    Par.ie = ie;
+
+    for (k=0; k<3; k++)
+    {
+        Par.Fs[k] = 1;
+
+        Par.Fc[k] = 1.0/32;
+
+        Par.Ns[k] = N[k];
+    }
+
+
+    #ifndef _OPENMP
+
+        printf(STR_NL "Compile this benchmark with OpenMP enabled." STR_NL STR_NL);
+
+        return 0;
+
+    #else
+
+        if (n_thr_max < 1)
+
+            n_thr_max = omp_get_num_procs();
+
+    #endif
+
+
+
+    /* Memory allocation */
+
+    s = (double*) malloc(n*sizeof(double));
+
+    m_1 = (double*) malloc(n*sizeof(double));
+
+    m_n = (double*) malloc(n*sizeof(double));
+
+    if (s == NULL || m_1 == NULL || m_n == NULL)
+    {
+        f_apd_set_error(APD_ERR_ID_MEM,__LINE__,APD_ERR_FILE);
+
+        f_apd_get_error(&exitflag, NULL, NULL, NULL);
+
+        goto failed;
+    }
+
+
+    /* Amplitude-modulated harmonic signal */
+
+    for (i=0; i<n; i++)
+
+        s[i] = (1.1 + sin(2*M_PI*i/(8.0*N[2]*N[1]))) * cos(0.37*i);
+
+
+    printf(STR_NL "%-10s %-10s %-20s %-10s %-12s %-10s" STR_NL, "algorithm", \
+           "threads", "time per iter [ms]", "speedup", "efficiency", "max diff");
+
+
+
+    /* Every algorithm with 1, 2, 4, ..., n_thr_max threads */
+
+    for (k=0; k<3; k++)
+    {
+        Par.Al = Al[k];
+
+        exitflag = f_apd_plan_create (&Par, NULL, 0, NULL, &plan);
+
+        if (exitflag != 0)
+
+            goto failed;
+
+        for (n_thr=1; ; n_thr = (2*n_thr < n_thr_max) ? 2*n_thr : n_thr_max)
+        {
+            #ifdef _OPENMP
+
+                omp_set_num_threads(n_thr);
+
+            #endif
+
+            t0 = f_bench_time();
+
+            exitflag = f_apd_plan_execute (plan, s, NULL, (n_thr == 1) ? m_1 : m_n, \
+                    &e_out, &iter);
+
+            t_n = (f_bench_time() - t0) / iter;
+
+            if (exitflag != 0)
+
+                goto failed;
+
+
+            diff = 0;
+
+            if (n_thr == 1)
+
+                t_1 = t_n;
+
+            else
+
+                for (i=0; i<n; i++)
+
+                    diff = fmax(diff, fabs(m_1[i] - m_n[i]));
+
+
+            printf("%-10c %-10d %-20.2f %-10.2f %-12.2f %-10.1e" STR_NL, Al[k], \
+                   n_thr, 1e3*t_n, t_1/t_n, t_1/t_n/n_thr, diff);
+
+            if (n_thr >= n_thr_max)
+
+                break;
+        }
+
+        f_apd_plan_destroy (plan);
+
+        plan = NULL;
+    }
+
+    printf(STR_NL);
+
+
+
+    /* Output & Memory deallocation */
+
+    finish:
+
+        free(s);
+
+        free(m_1);
+
+        free(m_n);
+
+        f_apd_plan_destroy (plan);
+
+        return exitflag;
+
+    failed:
+
+        f_apd_print_error(exitflag);
+
+        goto finish;
+
+}
@@ -0,0 +1,367 @@
+/*                       C O P Y R I G H T   N O T I C E
+ *
+ * Copyright ©2021. Institute of Science and Technology Austria (IST Austria).
+ * All Rights Reserved. The underlying technology is protected by PCT Patent
+ * Application No. PCT/EP2021/054650.
+ *
+ * This file is part of the AP Demodulation library, which is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation in version 2.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY, without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE. See the GNU General Public License v2 for more details. You
+ * should have received a copy of the GNU General Public License v2 along with this
+ * program. If not, see https://www.gnu.org/licenses/.
+ *
+ * Contact the Technology Transfer Office, IST Austria, Am Campus 1,
+ * A-3400 Klosterneuburg, Austria, +43-(0)2243 9000, twist@ist.ac.at, for commercial
+ * licensing opportunities.
+ *
+ * See https://github.com/mgabriel-lt/ap-demodulation for the latest version of the
+ * code and user-friendly explanations on the working principle, domains of
+ * application, and advice on the usage of different AP Demodulation algorithms in
+ * practice.
+ */
+
+
+/* BENCHMARK: TYPED INPUT SIGNALS
+ *
+ * This program demodulates 1D and 2D signals given as 16-bit integers, 32-bit
+ * integers, and floats (e.g., PCM audio and camera frames) by AP-Basic with a
+ * demodulation plan in two ways:
+ *
+ *   "copy" - the signal is converted into a separate array of doubles, which is
+ *            demodulated by f_apd_plan_execute;
+ *
+ *   "typed" - the signal is read directly by f_apd_plan_execute_typed, which
+ *             converts, validates, and places it on the DFT grid in one pass.
+ *
+ * For every signal, it prints the times of both ways (the best of N_REP
+ * repetitions of N_IT iterations), the times before the first iteration (the
+ * conversion and the validation and placement phases of f_apd_get_stats), the
+ * memory of the array of doubles, and whether both ways give identical
+ * modulators. The results are printed to stdout as a table, and the program
+ * returns a nonzero value if the modulators differ. Compile this program by using
+ * Option 1 described in the documentation.
+ */
+
+
+#ifndef _WIN32
+
+    #define _POSIX_C_SOURCE 200809L
+
+#endif
+
+
+#include <stdlib.h>
+
+#include <stdio.h>
+
+#include <string.h>
+
+#include <math.h>
+
+#include <time.h>
+
+#include "h_bench.h"
+
+#include "f_apd_demodulation.c"
+
+
+
+#define N_REP 3
+
+#define N_IT 5
+
+
+
+
+int main(void)
+{
+
+    /* Exit flag */
+
+    int exitflag = 0;
+
+
+
+    /* Sets f_apd_demodulation to return control to the calling f-tion upon error */
+
+    f_apd_set_errexit(0);
+
+
+
+    /* Iteration variables */
+
+    long i;
+
+    int c;
+
+    int j;
+
+    int r;
+
+
+
+    /* Benchmarked signals (dimensions, numbers of sample points) and types */
+
+    const int n_cases = 2;
+
+    const int D[] = {1, 2};
+
+    const long N[][2] = {{1L << 22, 0}, {2048, 2048}};
+
+    const char *N_str[] = {"2^22", "2048^2"};
+
+    const int n_types = 3;
+
+    const int type[] = {APD_TYPE_I16, APD_TYPE_I32, APD_TYPE_F32};
+
+    const char *T_str[] = {"int16", "int32", "float"};
+
+
+
+
+    /* Benchmark variables */
+
+    double t_cp, t_ty;
+
+    double t_cp0, t_ty0;
+
+    double t, t_1;
+
+    struct strAPD_Stats stats;
+
+    int equal;
+
+    int n_check = 0;
+
+    int n_fail = 0;
+
+    long n;
+
+    long iter;
+
+    double e;
+
+    void *s_t = NULL;
+
+    double *s_d = NULL;
+
+    double *m = NULL;
+
+    double *m_t = NULL;
+
+    struct strAPD_Plan *plan = NULL;
+
+
+
+    /* Demodulation parameters (AP-Basic, N_IT iterations, Fc = 100 Hz at 48 kHz in
+     * 1D and 0.02 of the sampling frequency in 2D) */
+
+    struct strAPD_Par Par;
+
+    long im[2] = {1, N_IT};
+
+    long ie[2] = {1, N_IT};
+
+    Par.Al = 'B';
+
+    Par.Et = 0;
+
+    Par.Ni = N_IT;
+
+    Par.Cp = 1;
+
+    Par.im = im;
+
+    Par.ie = ie;
+
+
+
+    printf(STR_NL "%-8s %-6s %-10s %-10s %-14s %-14s %-10s %-6s" STR_NL, "N", \
+           "type", "copy [ms]", "typed [ms]", "copy pre [ms]", "typed pre [ms]", \
+           "extra [MB]", "equal");
+
+
+    for (c=0; c<n_cases; c++)
+    {
+        /* Plan of the signal */
+
+        Par.D = D[c];
+
+        n = 1;
+
+        for (j=0; j<D[c]; j++)
+        {
+            Par.Fs[j] = (D[c] == 1) ? 48000 : 1;
+
+            Par.Fc[j] = (D[c] == 1) ? 100 : 0.02;
+
+            Par.Ns[j] = N[c][j];
+
+            n = n * N[c][j];
+        }
+
+        exitflag = f_apd_plan_create (&Par, NULL, 0, NULL, &plan);
+
+        if (exitflag != 0)
+
+            goto failed;
+
+        s_t = malloc(n*sizeof(double));
+
+        s_d = (double*) malloc(n*sizeof(double));
+
+        m = (double*) malloc(n*sizeof(double));
+
+        m_t = (double*) malloc(n*sizeof(double));
+
+        if (s_t == NULL || s_d == NULL || m == NULL || m_t == NULL)
+        {
+            f_apd_set_error(APD_ERR_ID_MEM,__LINE__,APD_ERR_FILE);
+
+            f_apd_get_error(&exitflag, NULL, NULL, NULL);
+
+            goto failed;
+        }
+
+
+        for (j=0; j<n_types; j++)
+        {
+            /* Amplitude-modulated signal in the type (a 12-bit range for the
+             * integers) */
+
+            for (i=0; i<n; i++)
+            {
+                t = (2000 + 1000 * sin(2*M_PI*3.0*i / n)) * cos(0.7*i + 0.2*(i % 5));
+
+                if (type[j] == APD_TYPE_I16)
+
+                    ((int16_t*) s_t)[i] = (int16_t) t;
+
+                else if (type[j] == APD_TYPE_I32)
+
+                    ((int32_t*) s_t)[i] = (int32_t) t;
+
+                else
+
+                    ((float*) s_t)[i] = (float) t;
+            }
+
+
+            /* Conversion into doubles and f_apd_plan_execute */
+
+            t_cp = INFINITY;
+
+            t_cp0 = INFINITY;
+
+            for (r=0; r<N_REP; r++)
+            {
+                t = f_bench_time();
+
+                for (i=0; i<n; i++)
+
+                    s_d[i] = (type[j] == APD_TYPE_I16) ? ((int16_t*) s_t)[i] : \
+                             (type[j] == APD_TYPE_I32) ? ((int32_t*) s_t)[i] : \
+                             ((float*) s_t)[i];
+
+                t_1 = f_bench_time();
+
+                exitflag = f_apd_plan_execute (plan, s_d, NULL, m, &e, &iter);
+
+                if (exitflag != 0)
+
+                    goto failed;
+
+                t_cp = fmin(t_cp, f_bench_time() - t);
+
+                f_apd_get_stats (&stats);
+
+                t_cp0 = fmin(t_cp0, (t_1 - t) + stats.t[APD_STATS_CHECK] + \
+                             stats.t[APD_STATS_LOAD]);
+            }
+
+
+            /* f_apd_plan_execute_typed */
+
+            t_ty = INFINITY;
+
+            t_ty0 = INFINITY;
+
+            for (r=0; r<N_REP; r++)
+            {
+                t = f_bench_time();
+
+                exitflag = f_apd_plan_execute_typed (plan, s_t, type[j], NULL, m_t, \
+                                                     &e, &iter);
+
+                if (exitflag != 0)
+
+                    goto failed;
+
+                t_ty = fmin(t_ty, f_bench_time() - t);
+
+                f_apd_get_stats (&stats);
+
+                t_ty0 = fmin(t_ty0, stats.t[APD_STATS_CHECK] + \
+                             stats.t[APD_STATS_LOAD]);
+            }
+
+            equal = (memcmp(m, m_t, n*sizeof(double)) == 0);
+
+            printf("%-8s %-6s %-10.1f %-10.1f %-14.2f %-14.2f %-10.1f %-6s" STR_NL, \
+                   (j == 0) ? N_str[c] : "", T_str[j], 1e3*t_cp, 1e3*t_ty, \
+                   1e3*t_cp0, 1e3*t_ty0, n*sizeof(double) / 1048576.0, \
+                   f_bench_check (equal, &n_check, &n_fail));
+        }
+
+        f_apd_plan_destroy (plan);
+
+        plan = NULL;
+
+        free(s_t);
+
+        free(s_d);
+
+        free(m);
+
+        free(m_t);
+
+        s_t = NULL;
+
+        s_d = NULL;
+
+        m = NULL;
+
+        m_t = NULL;
+    }
+
+    exitflag = f_bench_verdict (n_fail, n_check, "checks failed");
+
+
+
+    /* Output & Memory deallocation */
+
+    finish:
+
+        f_apd_plan_destroy (plan);
+
+        free(s_t);
+
+        free(s_d);
+
+        free(m);
+
+        free(m_t);
+
+        return exitflag;
+
+    failed:
+
+        f_apd_print_error(exitflag);
+
+        goto finish;
+
+}
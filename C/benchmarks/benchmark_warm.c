@@ -0,0 +1,342 @@
+
+/*                       C O P Y R I G H T   N O T I C E
+ *
+ * Copyright ©2021. Institute of Science and Technology Austria (IST Austria).
+ * All Rights Reserved. The underlying technology is protected by PCT Patent
+ * Application No. PCT/EP2021/054650.
+ *
+ * This file is part of the AP Demodulation library, which is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation in version 2.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY, without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE. See the GNU General Public License v2 for more details. You
+ * should have received a copy of the GNU General Public License v2 along with this
+ * program. If not, see https://www.gnu.org/licenses/.
+ *
+ * Contact the Technology Transfer Office, IST Austria, Am Campus 1,
+ * A-3400 Klosterneuburg, Austria, +43-(0)2243 9000, twist@ist.ac.at, for commercial
+ * licensing opportunities.
+ *
+ * See https://github.com/mgabriel-lt/ap-demodulation for the latest version of the
+ * code and user-friendly explanations on the working principle, domains of
+ * application, and advice on the usage of different AP Demodulation algorithms in
+ * practice.
+ */
+
+
+/* BENCHMARK: WARM START OF THE AP ALGORITHMS
+ *
+ * This program demodulates a long 1D amplitude-modulated signal in overlapping
+ * windows (of WIN samples, shifted by HOP samples) by the three AP algorithms with
+ * a tolerance of the infeasibility error, once with a cold start (from the
+ * absolute-value signal, see f_apd_plan_execute) and once with a warm start from
+ * the modulator of the previous window shifted by HOP samples and completed by the
+ * absolute value of the HOP new samples (see f_apd_plan_execute_warm). For every
+ * algorithm, it prints the mean numbers of iterations of the windows after the
+ * first one, the total times of both starts, the mean final infeasibility errors,
+ * and the maximum difference between the modulators of both starts relative to
+ * the maximum of the modulator (both modulators meet the tolerance, but differ
+ * near the edges of the previous window). The results are printed to stdout as a
+ * table. Compile this program by using Option 1 described in the documentation.
+ */
+
+
+#ifndef _WIN32
+
+    #define _POSIX_C_SOURCE 200809L
+
+#endif
+
+
+#include <stdlib.h>
+
+#include <stdio.h>
+
+#include <math.h>
+
+#include <time.h>
+
+#include "h_bench.h"
+
+#include "f_apd_demodulation.c"
+
+
+
+#define WIN 16384
+
+#define HOP 4096
+
+#define N_WIN 16
+
+
+
+
+int main(void)
+{
+
+    /* Exit flag */
+
+    int exitflag = 0;
+
+
+
+    /* Sets f_apd_demodulation to return control to the calling f-tion upon error */
+
+    f_apd_set_errexit(0);
+
+
+
+    /* Iteration variables */
+
+    long i;
+
+    long w;
+
+    int a;
+
+
+
+    /* Benchmarked algorithms */
+
+    const char Al[] = {'B', 'A', 'P'};
+
+
+
+    /* Benchmark variables */
+
+    const long n = WIN + (N_WIN-1)*HOP;
+
+    long it;
+
+    long it_c;
+
+    long it_w;
+
+    double t0;
+
+    double t_c;
+
+    double t_w;
+
+    double e;
+
+    double e_c;
+
+    double e_w;
+
+    double diff;
+
+    double m_max;
+
+    double *s = NULL;
+
+    double *m_c = NULL;
+
+    double *m_w = NULL;
+
+    double *m0 = NULL;
+
+    struct strAPD_Plan *plan = NULL;
+
+
+
+    /* Demodulation parameters (Et = 10^-3, at most 10000 iterations, Fc = Fs/64;
+     * the final modulator and error are saved) */
+
+    struct strAPD_Par Par;
+
+    long im[2] = {1, 10000};
+
+    long ie[2] = {1, 10000};
+
+    Par.D = 1;
+
+    Par.Fs[0] = 1;
+
+    Par.Fc[0] = 1.0/64;
+
+    Par.Ns[0] = WIN;
+
+    Par.Et = 1e-3;
+
+    Par.Ni = 10000;
+
+    Par.Br = 0;
+
+    Par.Cp = 1;
+
+    Par.im = im;
+
+    Par.ie = ie;
+
+
+
+    s = (double*) malloc(n*sizeof(double));
+
+    m_c = (double*) malloc(WIN*sizeof(double));
+
+    m_w = (double*) malloc(WIN*sizeof(double));
+
+    m0 = (double*) malloc(WIN*sizeof(double));
+
+    if (s == NULL || m_c == NULL || m_w == NULL || m0 == NULL)
+    {
+        f_apd_set_error(APD_ERR_ID_MEM,__LINE__,APD_ERR_FILE);
+
+        f_apd_get_error(&exitflag, NULL, NULL, NULL);
+
+        goto failed;
+    }
+
+
+
+    /* Amplitude-modulated harmonic signal (the modulator is a sum of two slowly
+     * varying harmonics, so that consecutive windows differ) */
+
+    for (i=0; i<n; i++)
+
+        s[i] = (1.1 + 0.3 * sin(2*M_PI*i / 1500.0) + 0.2 * sin(2*M_PI*i / 4100.0)) \
+               * cos(0.37*i + 0.11*(i % 7));
+
+
+
+    printf(STR_NL "%-10s %-3s %-8s %-8s %-10s %-10s %-8s %-10s %-10s %-10s" STR_NL, \
+           "windows", "Al", "it cold", "it warm", "cold [s]", "warm [s]", \
+           "speedup", "e cold", "e warm", "max diff");
+
+
+    for (a=0; a<3; a++)
+    {
+        Par.Al = Al[a];
+
+        exitflag = f_apd_plan_create (&Par, NULL, 0, NULL, &plan);
+
+        if (exitflag != 0)
+
+            goto failed;
+
+
+        it_c = 0;
+
+        it_w = 0;
+
+        t_c = 0;
+
+        t_w = 0;
+
+        e_c = 0;
+
+        e_w = 0;
+
+        diff = 0;
+
+        m_max = 0;
+
+        for (w=0; w<N_WIN; w++)
+        {
+            /* Cold start */
+
+            t0 = f_bench_time();
+
+            exitflag = f_apd_plan_execute (plan, s + w*HOP, NULL, m_c, &e, &it);
+
+            t0 = f_bench_time() - t0;
+
+            if (exitflag != 0)
+
+                goto failed;
+
+            if (w > 0)
+            {
+                it_c = it_c + it;
+
+                t_c = t_c + t0;
+
+                e_c = e_c + e;
+            }
+
+
+            /* Warm start from the shifted modulator of the previous window and from
+             * the absolute value of the new samples, as in a cold start (the
+             * first window is demodulated with a cold start) */
+
+            t0 = f_bench_time();
+
+            if (w == 0)
+
+                exitflag = f_apd_plan_execute (plan, s, NULL, m_w, &e, &it);
+
+            else
+            {
+                for (i=0; i<WIN; i++)
+
+                    m0[i] = (i < WIN-HOP) ? m_w[i+HOP] : fabs(s[w*HOP+i]);
+
+                exitflag = f_apd_plan_execute_warm (plan, s + w*HOP, NULL, m0, \
+                                                    m_w, &e, &it);
+            }
+
+            t0 = f_bench_time() - t0;
+
+            if (exitflag != 0)
+
+                goto failed;
+
+            if (w > 0)
+            {
+                it_w = it_w + it;
+
+                t_w = t_w + t0;
+
+                e_w = e_w + e;
+            }
+
+
+            for (i=0; i<WIN; i++)
+            {
+                diff = fmax(diff, fabs(m_c[i] - m_w[i]));
+
+                m_max = fmax(m_max, fabs(m_c[i]));
+            }
+        }
+
+
+        printf("%-10d %-3c %-8ld %-8ld %-10.3f %-10.3f %-8.2f %-10.3e %-10.3e " \
+               "%-10.1e" STR_NL, N_WIN, Al[a], it_c/(N_WIN-1), it_w/(N_WIN-1), \
+               t_c, t_w, t_c/t_w, e_c/(N_WIN-1), e_w/(N_WIN-1), diff/m_max);
+
+
+        f_apd_plan_destroy (plan);
+
+        plan = NULL;
+    }
+
+    printf(STR_NL);
+
+
+
+    /* Output & Memory deallocation */
+
+    finish:
+
+        f_apd_plan_destroy (plan);
+
+        free(s);
+
+        free(m_c);
+
+        free(m_w);
+
+        free(m0);
+
+        return exitflag;
+
+    failed:
+
+        f_apd_print_error(exitflag);
+
+        goto finish;
+
+}
@@ -0,0 +1,364 @@
+
+/*                       C O P Y R I G H T   N O T I C E
+ *
+ * Copyright ©2021. Institute of Science and Technology Austria (IST Austria).
+ * All Rights Reserved. The underlying technology is protected by PCT Patent
+ * Application No. PCT/EP2021/054650.
+ *
+ * This file is part of the AP Demodulation library, which is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation in version 2.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY, without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE. See the GNU General Public License v2 for more details. You
+ * should have received a copy of the GNU General Public License v2 along with this
+ * program. If not, see https://www.gnu.org/licenses/.
+ *
+ * Contact the Technology Transfer Office, IST Austria, Am Campus 1,
+ * A-3400 Klosterneuburg, Austria, +43-(0)2243 9000, twist@ist.ac.at, for commercial
+ * licensing opportunities.
+ *
+ * See https://github.com/mgabriel-lt/ap-demodulation for the latest version of the
+ * code and user-friendly explanations on the working principle, domains of
+ * application, and advice on the usage of different AP Demodulation algorithms in
+ * practice.
+ */
+
+
+/* BENCHMARK: WORKSPACE OF THE DEMODULATION PLAN
+ *
+ * This program measures the latency of the demodulation of short 1D signals of the
+ * same length that arrive one after another, as in a real-time service. Two
+ * approaches are compared:
+ *
+ *   "f_apd_demodulation" - one call of f_apd_demodulation per segment (memory
+ *                          allocation and DFT initialization repeated for every
+ *                          segment);
+ *
+ *   "workspace" - one plan created by f_apd_plan_create_ws in a workspace
+ *                 allocated by the user (of the size given by
+ *                 f_apd_plan_workspace_size), followed by one f_apd_plan_execute
+ *                 call per segment, which allocates no memory.
+ *
+ * For every segment length, it prints the workspace size and the median, the 99th
+ * percentile, and the maximum of the time per segment of both approaches, and
+ * checks that their modulators are identical. The results are printed to stdout as
+ * a table. Compile this program by using Option 1 described in the documentation.
+ */
+
+
+
+
+#ifndef _WIN32
+
+    #define _POSIX_C_SOURCE 200809L
+
+#endif
+
+
+#include <stdlib.h>
+
+#include <stdio.h>
+
+#include <math.h>
+
+#include <time.h>
+
+#include "h_bench.h"
+
+#include "f_apd_demodulation.c"
+
+
+
+
+static int f_bench_cmp (const void* a, const void* b)
+{
+/* Comparison of doubles for qsort */
+
+    const double x = *(const double*) a;
+
+    const double y = *(const double*) b;
+
+    return (x > y) - (x < y);
+}
+
+
+
+
+int main(void)
+{
+
+    /* Exit flag */
+
+    int exitflag = 0;
+
+
+
+    /* Sets f_apd_demodulation to return control to the calling f-tion upon error */
+
+    f_apd_set_errexit(0);
+
+
+
+    /* Iteration variables */
+
+    long i;
+
+    long j;
+
+    long k;
+
+    long iter;
+
+
+
+    /* Benchmarked segment lengths and the number of segments */
+
+    const int n_cases = 4;
+
+    const long n[] = {256, 1024, 4096, 16384};
+
+    const long n_seg = 2000;
+
+
+
+    /* Benchmark variables */
+
+    size_t size;
+
+    double t0;
+
+    double diff;
+
+    double e_out;
+
+    double *s = NULL;
+
+    double *m_old = NULL;
+
+    double *m_new = NULL;
+
+    double *t_old = NULL;
+
+    double *t_new = NULL;
+
+    void *mem = NULL;
+
+    void *work;
+
+    struct strAPD_Plan *plan = NULL;
+
+
+
+    /* Demodulation parameters (AP-Accelerated, Et = 10^-4, at most 100 iterations,
+     * Fc = Fs/64) */
+
+    struct strAPD_Par Par;
+
+    long im[2] = {1, 100};
+
+    long ie[2] = {1, 100};
+
+    Par.Al = 'A';
+
+    Par.D = 1;
+
+    Par.Fs[0] = 1;
+
+    Par.Fc[0] = 1.0/64;
+
+    Par.Et = 1e-4;
+
+    Par.Ni = 100;
+
+    Par.Br = 1;
+
+    Par.Cp = 1;
+
+    Par.im = im;
+
+    Par.ie = ie;
+
+
+
+    t_old = (double*) malloc(n_seg*sizeof(double));
+
+    t_new = (double*) malloc(n_seg*sizeof(double));
+
+    if (t_old == NULL || t_new == NULL)
+    {
+        f_apd_set_error(APD_ERR_ID_MEM,__LINE__,APD_ERR_FILE);
+
+        f_apd_get_error(&exitflag, NULL, NULL, NULL);
+
+        goto failed;
+    }
+
+
+    printf(STR_NL "%-8s %-12s %-30s %-30s %-10s" STR_NL, "", "", \
+           "f_apd_demodulation [us]", "workspace [us]", "");
+
+    printf("%-8s %-12s %-9s %-9s %-10s %-9s %-9s %-10s %-10s" STR_NL, "n", \
+           "size [kB]", "median", "99%", "max", "median", "99%", "max", \
+           "max diff");
+
+
+    for (k=0; k<n_cases; k++)
+    {
+        Par.Ns[0] = n[k];
+
+        s = (double*) malloc(n[k]*n_seg*sizeof(double));
+
+        m_old = (double*) malloc(n[k]*n_seg*sizeof(double));
+
+        m_new = (double*) malloc(n[k]*n_seg*sizeof(double));
+
+        if (s == NULL || m_old == NULL || m_new == NULL)
+        {
+            f_apd_set_error(APD_ERR_ID_MEM,__LINE__,APD_ERR_FILE);
+
+            f_apd_get_error(&exitflag, NULL, NULL, NULL);
+
+            goto failed;
+        }
+
+
+        /* Segments of an amplitude-modulated harmonic signal */
+
+        for (i=0; i<n[k]*n_seg; i++)
+
+            s[i] = (1.1 + sin(2*M_PI*i/(8.0*n[k]))) * cos(0.37*i);
+
+
+
+        /* One f_apd_demodulation call per segment */
+
+        for (j=0; j<n_seg; j++)
+        {
+            t0 = f_bench_time();
+
+            exitflag = f_apd_demodulation (s+j*n[k], &Par, NULL, NULL, \
+                    m_old+j*n[k], &e_out, &iter);
+
+            t_old[j] = f_bench_time() - t0;
+
+            if (exitflag != 0)
+
+                goto failed;
+        }
+
+
+
+        /* One plan in a workspace (aligned to 64 bytes) for all segments */
+
+        exitflag = f_apd_plan_workspace_size (&Par, NULL, 0, 1, NULL, &size);
+
+        if (exitflag != 0)
+
+            goto failed;
+
+        mem = malloc(size + 64);
+
+        if (mem == NULL)
+        {
+            f_apd_set_error(APD_ERR_ID_MEM,__LINE__,APD_ERR_FILE);
+
+            f_apd_get_error(&exitflag, NULL, NULL, NULL);
+
+            goto failed;
+        }
+
+        work = (char*) mem + (64 - (uintptr_t) mem % 64) % 64;
+
+        exitflag = f_apd_plan_create_ws (&Par, NULL, 0, 1, NULL, work, size, &plan);
+
+        if (exitflag != 0)
+
+            goto failed;
+
+        for (j=0; j<n_seg; j++)
+        {
+            t0 = f_bench_time();
+
+            exitflag = f_apd_plan_execute (plan, s+j*n[k], NULL, m_new+j*n[k], \
+                    &e_out, &iter);
+
+            t_new[j] = f_bench_time() - t0;
+
+            if (exitflag != 0)
+
+                goto failed;
+        }
+
+        f_apd_plan_destroy (plan);
+
+        plan = NULL;
+
+        free(mem);
+
+        mem = NULL;
+
+
+
+        diff = 0;
+
+        for (i=0; i<n[k]*n_seg; i++)
+
+            diff = fmax(diff, fabs(m_old[i] - m_new[i]));
+
+        qsort(t_old, n_seg, sizeof(double), f_bench_cmp);
+
+        qsort(t_new, n_seg, sizeof(double), f_bench_cmp);
+
+
+        printf("%-8ld %-12.1f %-9.1f %-9.1f %-10.1f %-9.1f %-9.1f %-10.1f %-10.1e" \
+               STR_NL, n[k], size/1024.0, 1e6*t_old[n_seg/2], \
+               1e6*t_old[(99*n_seg)/100], 1e6*t_old[n_seg-1], 1e6*t_new[n_seg/2], \
+               1e6*t_new[(99*n_seg)/100], 1e6*t_new[n_seg-1], diff);
+
+
+        free(s);
+
+        free(m_old);
+
+        free(m_new);
+
+        s = NULL;
+
+        m_old = NULL;
+
+        m_new = NULL;
+    }
+
+    printf(STR_NL);
+
+
+
+    /* Output & Memory deallocation */
+
+    finish:
+
+        free(s);
+
+        free(m_old);
+
+        free(m_new);
+
+        free(t_old);
+
+        free(t_new);
+
+        f_apd_plan_destroy (plan);
+
+        free(mem);
+
+        return exitflag;
+
+    failed:
+
+        f_apd_print_error(exitflag);
+
+        goto finish;
+
+}
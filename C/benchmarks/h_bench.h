@@ -0,0 +1,290 @@
+
+/*                       C O P Y R I G H T   N O T I C E
+ *
+ * Copyright ©2021. Institute of Science and Technology Austria (IST Austria).
+ * All Rights Reserved. The underlying technology is protected by PCT Patent
+ * Application No. PCT/EP2021/054650.
+ *
+ * This file is part of the AP Demodulation library, which is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation in version 2.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY, without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE. See the GNU General Public License v2 for more details. You
+ * should have received a copy of the GNU General Public License v2 along with this
+ * program. If not, see https://www.gnu.org/licenses/.
+ *
+ * Contact the Technology Transfer Office, IST Austria, Am Campus 1,
+ * A-3400 Klosterneuburg, Austria, +43-(0)2243 9000, twist@ist.ac.at, for commercial
+ * licensing opportunities.
+ *
+ * See https://github.com/mgabriel-lt/ap-demodulation for the latest version of the
+ * code and user-friendly explanations on the working principle, domains of
+ * application, and advice on the usage of different AP Demodulation algorithms in
+ * practice.
+ */
+
+
+/* C O N T E N T S
+ *
+ * This is the header file shared by the benchmarks of the AP Demodulation library,
+ * which include it before the library itself (f_apd_demodulation.c). It:
+ *
+ * (1) Includes the headers of the C standard library used by the benchmarks (and
+ *     windows.h on Windows) and defines the operating-system-dependent new-line
+ *     macro STR_NL of their tables and the constant Pi (if not defined).
+ *
+ * (2) Defines f_bench_time, the wall-clock time in seconds.
+ *
+ * (3) Defines f_bench_rand, the uniform pseudo-random generator of the benchmarks
+ *     (a 64-bit linear congruential generator, reproducible on every platform),
+ *     and f_bench_am, the amplitude-modulated harmonic test signal of the
+ *     benchmarks of 1D, 2D, and 3D signals.
+ *
+ * (4) Defines f_bench_check and f_bench_verdict, which print the checked columns
+ *     and the closing line of the tables of the self-checking benchmarks and
+ *     return their exit status (see the target check of Makefile).
+ *
+ * (5) Defines, if the macro BENCH_ALLOC_HOOK is defined, a hook that counts the
+ *     bytes allocated by malloc and calloc and their peak (sgBENCH_USE and
+ *     sgBENCH_PEAK), and redirects malloc, calloc, and free of the library and
+ *     of the rest of the benchmark to it.
+ *
+ * The functions are static inline, so that a benchmark compiles without warnings
+ * if it uses only some of them.
+ */
+
+
+#ifndef H_BENCH_H
+
+#define H_BENCH_H
+
+
+#include <stdlib.h>
+
+#include <stdio.h>
+
+#include <string.h>
+
+#include <math.h>
+
+#include <time.h>
+
+
+
+#ifdef _WIN32
+
+    #include <windows.h>
+
+    #define STR_NL "\r"
+
+#else
+
+    #define STR_NL "\n"
+
+#endif
+
+
+#ifndef M_PI
+
+    #define M_PI 3.14159265358979323846
+
+#endif
+
+
+
+
+static inline double f_bench_time (void)
+{
+/* Wall-clock time in seconds */
+
+    #ifdef _WIN32
+
+        LARGE_INTEGER cnt, frq;
+
+        QueryPerformanceCounter(&cnt);
+
+        QueryPerformanceFrequency(&frq);
+
+        return (double) cnt.QuadPart / (double) frq.QuadPart;
+
+    #else
+
+        struct timespec ts;
+
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+
+        return ts.tv_sec + 1e-9 * ts.tv_nsec;
+
+    #endif
+}
+
+
+
+
+static inline double f_bench_rand (unsigned long long* seed)
+{
+/* Uniform pseudo-random number in [0, 1), which advances the state seed of a 64-bit
+ * linear congruential generator */
+
+    *seed = *seed * 6364136223846793005ULL + 1442695040888963407ULL;
+
+    return (double) (*seed >> 11) / 9007199254740992.0;
+}
+
+
+
+
+static inline void f_bench_am (const int D, \
+
+                               const long* N, \
+
+                               const double per, \
+
+                               double* s)
+{
+/* Amplitude-modulated harmonic signal s of D dimensions N (row-major order), whose
+ * modulator varies along every dimension with the period per */
+
+    long n = 1;
+
+    long i, r;
+
+    double x;
+
+    int j;
+
+
+    for (j=0; j<D; j++)
+
+        n = n * N[j];
+
+    for (i=0; i<n; i++)
+    {
+        x = 1.1;
+
+        r = i;
+
+        for (j=D-1; j>=0; j--)
+        {
+            x = x + 0.3 * sin(2*M_PI*(r % N[j]) / per);
+
+            r = r / N[j];
+        }
+
+        s[i] = x * cos(0.37*i + 0.11*(i % 7));
+    }
+}
+
+
+
+
+static inline const char* f_bench_check (const int ok, \
+
+                                         int* n_check, \
+
+                                         int* n_fail)
+{
+/* Entry of a checked column of a table, "yes" or "NO"; the checks are counted in
+ * n_check and the failed ones in n_fail */
+
+    *n_check = *n_check + 1;
+
+    if (!ok)
+
+        *n_fail = *n_fail + 1;
+
+    return ok ? "yes" : "NO";
+}
+
+
+
+
+static inline int f_bench_verdict (const int n_fail, \
+
+                                   const int n_check, \
+
+                                   const char* what)
+{
+/* Closing line of a table of checks ("n_fail of n_check what"), and the exit status
+ * of the benchmark: 1 if a check failed, 0 otherwise */
+
+    printf(STR_NL "%d of %d %s" STR_NL STR_NL, n_fail, n_check, what);
+
+    return (n_fail > 0);
+}
+
+
+
+
+#ifdef BENCH_ALLOC_HOOK
+
+
+/* Allocation-counting hook: every allocation of the library, which is compiled into
+ * the benchmark, is preceded by a header of BENCH_HDR bytes with its size, so that
+ * the bytes in use and their peak are counted (the library allocates from one
+ * thread at a time in the benchmarks that define BENCH_ALLOC_HOOK) */
+
+#define BENCH_HDR 16
+
+static size_t sgBENCH_USE = 0;
+
+static size_t sgBENCH_PEAK = 0;
+
+
+static inline void* f_bench_malloc (size_t n)
+{
+    char *p = (char*) malloc(n + BENCH_HDR);
+
+    if (p == NULL)
+
+        return NULL;
+
+    *(size_t*) p = n;
+
+    sgBENCH_USE = sgBENCH_USE + n;
+
+    if (sgBENCH_USE > sgBENCH_PEAK)
+
+        sgBENCH_PEAK = sgBENCH_USE;
+
+    return p + BENCH_HDR;
+}
+
+
+static inline void* f_bench_calloc (size_t n, size_t sz)
+{
+    void *p = f_bench_malloc (n*sz);
+
+    if (p != NULL)
+
+        memset(p, 0, n*sz);
+
+    return p;
+}
+
+
+static inline void f_bench_free (void* p)
+{
+    if (p == NULL)
+
+        return;
+
+    sgBENCH_USE = sgBENCH_USE - *(size_t*) ((char*) p - BENCH_HDR);
+
+    free((char*) p - BENCH_HDR);
+}
+
+
+#define malloc(n) f_bench_malloc(n)
+
+#define calloc(n, sz) f_bench_calloc(n, sz)
+
+#define free(p) f_bench_free(p)
+
+
+#endif
+
+
+#endif
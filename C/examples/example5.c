@@ -42,6 +42,16 @@
 
 
 
+/* POSIX interfaces of the library (see h_apd.h), requested before the first system
+ * header */
+
+#ifndef _WIN32
+
+    #define _POSIX_C_SOURCE 200112L
+
+#endif
+
+
 #include <stdlib.h>
 
 #include <stdio.h>
@@ -28,10 +28,12 @@
 
 /* C O N T E N T S
  * 
- * A function that performs amplitude demodulation by using a selected alternating
+ * Functions that perform amplitude demodulation by using a selected alternating
  * projection algorithm:
  *
- * (1) f_apd_demodulation.
+ * (1) f_apd_demodulation,
+ *
+ * (2) f_apd_demodulation_typed.
  */
 
 
@@ -46,19 +48,71 @@
 
 #include "l_apd_error_handling.c"
 
+#include "l_apd_stats.c"
+
+
+/* The files with the functions on the arrays of the AP algorithms are included
+ * twice: for arrays of doubles and, with APD_SINGLE defined, for arrays of floats
+ * (see f_apd_plan_create). tAPD_Real is the element type of the arrays, and
+ * APD_RF appends the suffix _f to the names of the single-precision versions. */
+
+#define tAPD_Real double
+
+#define APD_RF(name) name
+
+#include "l_apd_fft.c"
+
+#include "l_apd_auxiliary.c"
+
+#include "l_apd_kernels.c"
+
+#include "l_apd_algorithms.c"
+
+#undef tAPD_Real
+
+#undef APD_RF
+
+
+#define APD_SINGLE
+
+#define tAPD_Real float
+
+#define APD_RF(name) name ## _f
+
+#include "l_apd_fft.c"
+
 #include "l_apd_auxiliary.c"
 
+#include "l_apd_kernels.c"
+
 #include "l_apd_algorithms.c"
 
+#undef tAPD_Real
+
+#undef APD_RF
+
+#undef APD_SINGLE
+
+
+#include "l_apd_plan.c"
+
+#include "l_apd_batch.c"
+
+#include "l_apd_stream.c"
+
+#include "l_apd_mmap.c"
+
+#include "l_apd_estimate.c"
+
 
 
-int f_apd_demodulation ( double* s, \
+int f_apd_demodulation ( const double* s, \
 
-                         struct strAPD_Par* Par, \
+                         const struct strAPD_Par* Par, \
                         
-                         double* Ub, \
+                         const double* Ub, \
 
-                         double* t, \
+                         const double* t, \
                         
                          double* out_m, \
                         
@@ -78,7 +132,9 @@ int f_apd_demodulation ( double* s, \
 
 /* I N P U T   A R G U M E N T S
  *
- * [s] - input signal.
+ * [s] - input signal. A uniformly sampled signal is given in column-major order
+ *       (other layouts are given by the options of a plan, see
+ *       f_apd_plan_create).
  *
  * [Par] - pointer to the structure with demodulation parameters:
  *
@@ -139,10 +195,10 @@ int f_apd_demodulation ( double* s, \
  *               is the length of the array (excluding the first element itself).
  *               At least one iteration has to be assigned to .ie. {Type: long}
  *
- *         Two additional fields, .ns (number of sample points of the original
- *         signal) and .Nx (dimensions of the actual, possibly interpolated signal)
- *         are assigned values in this function. No other fields of Par or other
- *         input arguments of this function are modified inplace.
+ *         The fields .ns and .Nx are not used. Neither Par nor other input
+ *         arguments of this function are modified inplace, so that the same Par
+ *         may be shared by demodulations running concurrently in different
+ *         threads.
  *
  * [Ub] - upper bound on the modulator. This array must have the same number of
  *        elements as the input signal or must be set to NULL (if no upper bound on
@@ -161,8 +217,9 @@ int f_apd_demodulation ( double* s, \
  *
  * [out_m] - array with modulator estimates at algorithm iterations indicated by
  *           Par.im (memory allocated  externally). The modulator estimates are
- *           arranged columnwise. out_m has to point to a memory block sufficient to
- *          hold at least one instance of the modulator estimate.
+ *           arranged columnwise (each in the layout of s). out_m has to point to
+ *           a memory block sufficient to hold at least one instance of the
+ *           modulator estimate.
  *
  * [out_e] - array with error estimates at algorithm iterations indicated by Par.ie
  *           (memory allocated  externally). out_e has to point to a memory block
@@ -183,11 +240,7 @@ int f_apd_demodulation ( double* s, \
     
 /* N O N S T A N D A R D   F U N C T I O N S   U S E D
  *
- * (1) f_apd_compression, (2) f_apd_interpolation, (3) f_apd_s_Ub_init,
- * 
- * (4) f_apd_mkl_dft_init, (5) f_apd_input_validation, (6) DftiFreeDescriptor,
- * 
- * (7) f_apd_basic, (8) f_apd_accelerated, (9) f_apd_projected.
+ * (1) f_apd_plan_create, (2) f_apd_plan_execute, (3) f_apd_plan_destroy.
  */
     
 
@@ -202,292 +255,116 @@ int f_apd_demodulation ( double* s, \
     f_apd_set_error (exitflag, __LINE__, APD_ERR_FILE);
     
     
-    
-    /* Basic variables */
-    
-    long i;
-    
-    long nx = 1;
-    
-    long nx_2;
-    
-    long *ix_map = NULL;
-    
-    
-    DFTI_DESCRIPTOR_HANDLE dft_handle = 0;
+    struct strAPD_Plan *plan = NULL;
     
     
-    double *s_local = NULL;
-    
-    double *Ub_local = NULL;
-    
-    double *s_local2 = NULL;
-    
-    double *Ub_local2 = NULL;
-    
-    double *s_local3 = NULL;
-    
-    double *Ub_local3 = NULL;
-    
-    double *pr_s = s;
-    
-    double *pr_Ub = Ub;
     
+/***********************************************************************************/
+/********************************* CALCULATION *************************************/
+/***********************************************************************************/
 
 
-    /* Validation of the input data */
+    /* Validation of the parameters, interpolation mapping, work arrays, and DFT */
 
-    exitflag = f_apd_input_validation (s, Par, Ub, t);
+    exitflag = f_apd_plan_create (Par, t, (Ub != NULL), NULL, &plan);
     
     if (exitflag != APD_ERR_ID_NON) goto finish;
     
     
     
-    /* Dimensions of the actual signal to be demodulated */
-    
-    if (t != NULL)
-        
-        Par->Nx = Par->Nr;
-    
-    else
-        
-        Par->Nx = Par->Ns;
-
-    
-    
-    /* Numbers of sample points */
-    
-    if (t != NULL)
-    {
-        Par->ns = Par->Ns[0]; /* original signal */
-
-        for (i=0; i<(Par->D); i++)
-            
-            nx = nx * Par->Nx[i]; /* actual signal */
-    }
-    
-    else
-    {
-        Par->ns = 1;
-        
-        for (i=0; i<(Par->D); i++)
-        {
-            Par->ns = Par->ns * Par->Ns[i]; /* original signal */
+    /* Demodulation */
 
-            nx = nx * Par->Nx[i]; /* actual signal */
-        }
-    }
-    
-    nx_2 = (nx / Par->Nx[Par->D-1]) * (Par->Nx[Par->D-1]+2-(Par->Nx[Par->D-1]%2));
+    exitflag = f_apd_plan_execute (plan, s, Ub, out_m, out_e, iter);
     
     
     
 /***********************************************************************************/
-/********************************* CALCULATION *************************************/
+/************************** OUTPUT & MEMORY DEALLOCATION ***************************/
 /***********************************************************************************/
-
     
-    /* Compression */
     
-    if (Par->Cp > 1)
-    {
-       
-        s_local = (double*) malloc(Par->ns*sizeof(double));
-
-        if (s_local==NULL)
-        {
-            f_apd_set_error(APD_ERR_ID_MEM,__LINE__,APD_ERR_FILE); goto failed;}
-
-        memcpy(s_local, pr_s, Par->ns*sizeof(double));
+    finish:
         
+        f_apd_plan_destroy (plan);
         
-        f_apd_compression (s_local, Par->ns, 1/(Par->Cp));
+        return exitflag;
+        
+}
 
 
-        if (Ub != NULL)
-        {
-            Ub_local = (double*) malloc(Par->ns*sizeof(double));
 
-            if (Ub_local==NULL)
-            {
-                f_apd_set_error(APD_ERR_ID_MEM,__LINE__,APD_ERR_FILE); goto failed;}
 
-            memcpy(Ub_local, pr_Ub, Par->ns*sizeof(double));
-            
-            
-            f_apd_compression (Ub_local, Par->ns, 1/(Par->Cp));
-        }
+int f_apd_demodulation_typed ( const void* s, \
 
-        else
+                               const int type, \
 
-            Ub_local = NULL;
-        
-        
-        pr_s = s_local;
-    
-        pr_Ub = Ub_local;
-    }
-    
-    
-    
-    /* Interpolation */
-    
-    ix_map = (long*) malloc(Par->ns*sizeof(long));
-        
-    if (ix_map==NULL)
-    {
-        f_apd_set_error(APD_ERR_ID_MEM,__LINE__,APD_ERR_FILE); goto failed;}
+                               const struct strAPD_Par* Par, \
 
-    
-    if (t != NULL)
-    {
-        s_local2 = (double*) malloc(nx*sizeof(double));
-        
-        if (s_local2==NULL)
-        {
-            f_apd_set_error(APD_ERR_ID_MEM,__LINE__,APD_ERR_FILE); goto failed;}
-        
-        
-        if (Ub != NULL)
-        {
-            Ub_local2 = (double*) malloc(nx*sizeof(double));
-
-            if (Ub_local2==NULL)
-            {
-                f_apd_set_error(APD_ERR_ID_MEM,__LINE__,APD_ERR_FILE); goto failed;}
-        }
-        
-        else
+                               const double* Ub, \
 
-            Ub_local2 = NULL;
-       
+                               const double* t, \
 
-        exitflag = f_apd_interpolation (pr_s, Par, pr_Ub, t, s_local2, Ub_local2, \
-                ix_map);
-        
-        if (exitflag != APD_ERR_ID_NON) goto finish;
+                               double* out_m, \
 
-        
-        pr_s = s_local2;
-        
-        pr_Ub = Ub_local2;
-        
-    }
-    
-    else
-    {
-        for (i=0; i<(Par->ns); i++)
-            
-            ix_map[i] = i;
-    }
+                               double* out_e, \
 
-    
-    
-    /* Local copies of the signal and upper bound arrays with the element placement
-     * replaced from the standard to the Intel MKL DFT's. The last dimension of the
-     * arrays is complemented by one or two elements as required by the MKL DFT
-     * routine. The mapping between the two conventions is provided as well. */
-       
-    s_local3 = (double*) malloc(nx_2*sizeof(double));
-        
-    if (s_local3==NULL)
-    {
-        f_apd_set_error(APD_ERR_ID_MEM,__LINE__,APD_ERR_FILE); goto failed;}
-    
-    
-    if (Ub != NULL)
-    {
-        Ub_local3 = (double*) malloc(nx_2*sizeof(double));
-
-        if (Ub_local3==NULL)
-        {
-            f_apd_set_error(APD_ERR_ID_MEM,__LINE__,APD_ERR_FILE); goto failed;}
-    }
-    else
-        
-        Ub_local3 = NULL;
+                               long* iter )
+{
+/* P U R P O S E
+ *
+ * Performs demodulation of the input signal of the given element type (e.g., 16-bit
+ * PCM audio), which is read directly without a copy in doubles (see
+ * f_apd_plan_execute_typed).
+ */
 
+/* I N P U T   A R G U M E N T S
+ *
+ * [s] - input signal (see f_apd_demodulation) with elements of the given type.
+ *
+ * [type] - type of the elements of s: APD_TYPE_F64, APD_TYPE_F32, APD_TYPE_I16, or
+ *          APD_TYPE_I32 (see f_apd_plan_execute_typed).
+ *
+ * [Par], [Ub], [t] - see f_apd_demodulation.
+ */
 
-    exitflag = f_apd_s_Ub_init (pr_s, pr_Ub, ix_map, Par->D, Par->Nx, Par->ns, \
-            s_local3, Ub_local3);
-    
-    if (exitflag != APD_ERR_ID_NON) goto finish;
+/* O U T P U T   A R G U M E N T S
+ *
+ * [out_m], [out_e], [iter] - see f_apd_demodulation. The modulator is output in
+ *                             doubles in the units of the signal.
+ */
 
+/* R E T U R N   V A L U E
+ *
+ * [exitflag] - exit flag (see f_apd_demodulation).
+ */
     
-    pr_s = s_local3;
-    
-    pr_Ub = Ub_local3;
-    
+/* N O N S T A N D A R D   F U N C T I O N S   U S E D
+ *
+ * (1) f_apd_plan_create, (2) f_apd_plan_execute_typed, (3) f_apd_plan_destroy.
+ */
 
 
-    /* Intel MKL DFT's descriptor */
+    int exitflag = 0;
 
-    exitflag = f_apd_mkl_dft_init (Par->D, Par->Nx, &dft_handle);
-    
-    if (exitflag != APD_ERR_ID_NON) goto finish;
+    f_apd_set_error (exitflag, __LINE__, APD_ERR_FILE);
 
-    
-    
-    /* Demodulation */
 
-    if (Par->Al == 'B')
-    
-        exitflag = f_apd_basic (pr_s, Par, pr_Ub, ix_map, &dft_handle, out_m, out_e, \
-                iter);
-    
-    else if (Par->Al == 'A')
-        
-        exitflag = f_apd_accelerated (pr_s, Par, pr_Ub, ix_map, &dft_handle, out_m, \
-                out_e, iter);
-    
-    else if (Par->Al == 'P')
-        
-        exitflag = f_apd_projected (pr_s, Par, pr_Ub, ix_map, &dft_handle, out_m, \
-                out_e, iter);
-    
-    if (exitflag != APD_ERR_ID_NON) goto finish;
+    struct strAPD_Plan *plan = NULL;
 
-    
 
-    /* Decompression */
-    
-    if (Par->Cp > 1)
-    
-        f_apd_compression (out_m, Par->ns*(Par->im[0]), Par->Cp);
-    
-    
-    
-/***********************************************************************************/
-/************************** OUTPUT & MEMORY DEALLOCATION ***************************/
-/***********************************************************************************/
-    
-    
-    finish:
-        
-        free(s_local);
-    
-        free(Ub_local);
+    exitflag = f_apd_plan_create (Par, t, (Ub != NULL), NULL, &plan);
 
-        free(ix_map);
+    if (exitflag != APD_ERR_ID_NON) goto finish;
 
-        free(s_local2);
+    exitflag = f_apd_plan_execute_typed (plan, s, type, Ub, out_m, out_e, iter);
 
-        free(Ub_local2);
 
-        free(s_local3);
+    finish:
 
-        free(Ub_local3);
+        f_apd_plan_destroy (plan);
 
-        DftiFreeDescriptor (&dft_handle);
-        
         return exitflag;
 
-    failed:
-
-        f_apd_get_error (&exitflag, NULL, NULL, NULL);
-
-        goto finish;
-        
 }
 
 
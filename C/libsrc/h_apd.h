@@ -30,10 +30,20 @@
  *
  * This is the header file for the AP Demodulation library. It:
  * 
- * (1) Includes headers of all needed external libraries.
+ * (1) Includes headers of all needed external libraries (the Intel MKL headers are
+ *     omitted if the macro APD_NO_MKL is defined, the POSIX threads headers if the
+ *     macro APD_NO_PTHREADS is defined, the OpenMP header if the library is not
+ *     compiled with OpenMP, and the POSIX memory-mapping headers on Windows) and
+ *     requests the POSIX.1-2001 interfaces (_POSIX_C_SOURCE) if no feature test
+ *     macro is defined.
  * 
  * (2) Declares the input parameter structure for the f_apd_demodulation and other
- *     functions of this library.
+ *     functions of this library, the (opaque) demodulation plan structure, the
+ *     options structure of the plans, the job structure of the batch
+ *     demodulation, the statistics structure of the last demodulation (with the
+ *     macros of its phases), the (opaque) stream structure of the streaming
+ *     demodulation, and the structure of the pre-flight estimate of a
+ *     demodulation.
  * 
  * (3) Defines constant Pi (if not defined).
  * 
@@ -49,6 +59,20 @@
  * (7) Defines a macro with the error message prefix.
  * 
  * (8) Defines macros for error ids.
+ *
+ * (9) Defines macros for DFT backends.
+ *
+ * (10) Defines macros for the partition of the loops of the AP algorithms.
+ *
+ * (11) Defines macros for the precision of the arrays of the AP algorithms.
+ *
+ * (12) Defines macros for the initialization of the AP algorithms (warm start).
+ *
+ * (13) Defines macros for the layout of the input and output arrays.
+ *
+ * (14) Defines macros for the types of the input signal.
+ *
+ * (15) Defines macros for the calibration of the pre-flight estimate.
  */
 
 
@@ -59,7 +83,18 @@
 
 
 
-    /* (1) EXTERNAL LIBRARIES */
+    /* (1) EXTERNAL LIBRARIES (the POSIX interfaces of the out-of-core demodulation,
+     * e.g., ftruncate and posix_madvise, are requested also in strict ISO C
+     * compilation such as -std=c99; the request takes effect only if no system
+     * header is included before this header) */
+
+    #if !defined(_WIN32) && !defined(_POSIX_C_SOURCE) && !defined(_XOPEN_SOURCE) \
+            && !defined(_GNU_SOURCE)
+
+        #define _POSIX_C_SOURCE 200112L
+
+    #endif
+
 
     #include <stdlib.h>
 
@@ -71,10 +106,51 @@
 
     #include <string.h>
 
+    #include <stdint.h>
+
+    #include <time.h>
+
+
+    #ifndef APD_NO_MKL
+
+        #include "mkl.h"
+
+        #include "mkl_dfti.h"
+
+    #endif
+
+
+    #ifndef APD_NO_PTHREADS
+
+        #include <pthread.h>
+
+        #ifndef _WIN32
+
+            #include <unistd.h>
+
+        #endif
+
+    #endif
+
 
-    #include "mkl.h"
+    #ifndef _WIN32
 
-    #include "mkl_dfti.h"
+        #include <fcntl.h>
+
+        #include <sys/mman.h>
+
+        #include <sys/stat.h>
+
+        #include <unistd.h>
+
+    #endif
+
+
+    #ifdef _OPENMP
+
+        #include <omp.h>
+
+    #endif
 
 
 
@@ -112,6 +188,131 @@
                         long*        ie;
 
                       };
+
+
+    /* Demodulation plan (opaque; see f_apd_plan_create) */
+
+    struct strAPD_Plan;
+
+
+    /* Options of a demodulation plan (see f_apd_plan_create) */
+
+    struct strAPD_Opt {
+
+                        int                       Pr;
+
+                        int                       Ly;
+
+                        long                      St[3];
+
+                        long                      Il[3];
+
+                      };
+
+
+    /* Job of the batch demodulation (see f_apd_demodulation_batch) */
+
+    struct strAPD_Job {
+
+                        const double*             s;
+
+                        const struct strAPD_Par*  Par;
+
+                        const double*             Ub;
+
+                        const double*             t;
+
+                        double*                   out_m;
+
+                        double*                   out_e;
+
+                        const struct strAPD_Opt*  opt;
+
+                        long                      iter;
+
+                        int                       exitflag;
+
+                        int                       prec;
+
+                        long                      iter_sw;
+
+                      };
+
+
+    /* Statistics of the last demodulation (see f_apd_get_stats) */
+
+    #define APD_STATS_VALID 0     // validation of the parameters
+
+    #define APD_STATS_ALLOC 1     // memory allocation
+
+    #define APD_STATS_INTERP 2    // mapping onto the DFT grid (interpolation)
+
+    #define APD_STATS_DFT_INIT 3  // initialization of the DFT
+
+    #define APD_STATS_CHECK 4     // validation of the input data
+
+    #define APD_STATS_LOAD 5      // conversion, compression, and placement on grid
+
+    #define APD_STATS_ITER 6      // iterations of the AP algorithm
+
+    #define APD_STATS_DFT 7       // projections onto Mw (part of the iterations)
+
+    #define APD_STATS_DECOMP 8    // decompression of the output
+
+    #define APD_STATS_N 9         // number of phases
+
+
+    struct strAPD_Stats {
+
+                        double                    t[APD_STATS_N];
+
+                        double                    ts[APD_STATS_N];
+
+                        long                      n_dft;
+
+                        size_t                    bytes;
+
+                        long                      iter;
+
+                        double                    t_iter;
+
+                        double                    lambda;
+
+                      };
+
+
+    /* Stream of the streaming demodulation (opaque; see f_apd_stream_create) */
+
+    struct strAPD_Stream;
+
+
+    /* Pre-flight estimate of a demodulation (see f_apd_estimate) */
+
+    struct strAPD_Est {
+
+                        size_t                    bytes;
+
+                        size_t                    bytes_plan;
+
+                        size_t                    bytes_dft;
+
+                        size_t                    bytes_io;
+
+                        long                      Nx[3];
+
+                        long                      nx;
+
+                        int                       dft;
+
+                        long                      pfft;
+
+                        double                    flops;
+
+                        double                    t_iter;
+
+                        double                    t_max;
+
+                      };
                       
                       
                       
@@ -133,8 +334,13 @@
     extern "C" {
     #endif
 
-        int f_apd_demodulation (double*, struct strAPD_Par*, double*, double*, \
-                                double*, double*, long*);
+        int f_apd_demodulation (const double*, const struct strAPD_Par*, \
+                                const double*, const double*, double*, double*, \
+                                long*);
+
+        int f_apd_demodulation_typed (const void*, const int, \
+                                      const struct strAPD_Par*, const double*, \
+                                      const double*, double*, double*, long*);
 
         void f_apd_set_errexit (int);
 
@@ -142,6 +348,68 @@
 
         void f_apd_print_error (int);
 
+        int f_apd_set_dft_backend (int);
+
+        void f_apd_get_precision (int*, long*);
+
+        void f_apd_get_options (struct strAPD_Opt*);
+
+        void f_apd_get_stats (struct strAPD_Stats*);
+
+        int f_apd_write_trace (const char*);
+
+        int f_apd_plan_create (const struct strAPD_Par*, const double*, const int, \
+                               const struct strAPD_Opt*, struct strAPD_Plan**);
+
+        int f_apd_plan_execute (struct strAPD_Plan*, const double*, const double*, \
+                                double*, double*, long*);
+
+        int f_apd_plan_execute_typed (struct strAPD_Plan*, const void*, const int, \
+                                      const double*, double*, double*, long*);
+
+        int f_apd_plan_execute_warm (struct strAPD_Plan*, const double*, \
+                                     const double*, const double*, double*, \
+                                     double*, long*);
+
+        int f_apd_plan_create_multichannel (const struct strAPD_Par*, const double*, \
+                                            const int, const long, \
+                                            const struct strAPD_Opt*, \
+                                            struct strAPD_Plan**);
+
+        int f_apd_plan_workspace_size (const struct strAPD_Par*, const double*, \
+                                       const int, const long, \
+                                       const struct strAPD_Opt*, size_t*);
+
+        int f_apd_plan_create_ws (const struct strAPD_Par*, const double*, \
+                                  const int, const long, const struct strAPD_Opt*, \
+                                  void*, const size_t, struct strAPD_Plan**);
+
+        void f_apd_plan_destroy (struct strAPD_Plan*);
+
+        int f_apd_demodulation_batch (struct strAPD_Job*, const long, const int);
+
+        int f_apd_stream_create (const struct strAPD_Par*, const long, const long, \
+                                 const long, const int, const struct strAPD_Opt*, \
+                                 struct strAPD_Stream**);
+
+        int f_apd_stream_push (struct strAPD_Stream*, const double*, const long, \
+                               long*);
+
+        int f_apd_stream_pull (struct strAPD_Stream*, double*, const long, long*);
+
+        int f_apd_stream_flush (struct strAPD_Stream*);
+
+        void f_apd_stream_destroy (struct strAPD_Stream*);
+
+        int f_apd_demodulation_mmap (const char*, const char*, \
+                                     const struct strAPD_Par*, const long, \
+                                     const double, const long, \
+                                     const struct strAPD_Opt*, long*);
+
+        int f_apd_estimate (const struct strAPD_Par*, const int, const int, \
+                            const long, const struct strAPD_Opt*, \
+                            struct strAPD_Est*);
+
     #ifdef __cplusplus
     }
     #endif
@@ -194,7 +462,7 @@
 
     /* Macros of numeric codes of the error messages */
 
-    #define APD_ERR_N 24     // the largest error id in use
+    #define APD_ERR_N 40     // the largest error id in use
 
 
     #define APD_ERR_ID_NON 0
@@ -246,6 +514,172 @@
     #define APD_ERR_ID_T 23
 
     #define APD_ERR_ID_NUL 24
+
+    #define APD_ERR_ID_FT5 25
+
+    #define APD_ERR_ID_PL 26
+
+    #define APD_ERR_ID_CH 27
+
+    #define APD_ERR_ID_PR 28
+
+    #define APD_ERR_ID_M0 29
+
+    #define APD_ERR_ID_WS 30
+
+    #define APD_ERR_ID_ST 31
+
+    #define APD_ERR_ID_SF 32
+
+    #define APD_ERR_ID_MM 33
+
+    #define APD_ERR_ID_MMF 34
+
+    #define APD_ERR_ID_MMB 35
+
+    #define APD_ERR_ID_WSP 36
+
+    #define APD_ERR_ID_TR 37
+
+    #define APD_ERR_ID_LAY 38
+
+    #define APD_ERR_ID_IL 39
+
+    #define APD_ERR_ID_TYP 40
+
+
+
+
+    /* (9) DFT BACKENDS */
+
+    /* Macros of numeric codes of the DFT backends (see f_apd_set_dft_backend) */
+
+    #define APD_DFT_DEFAULT 0     // Intel MKL if available, built-in FFT otherwise
+
+    #define APD_DFT_MKL 1         // Intel MKL DFT
+
+    #define APD_DFT_BUILTIN 2     // built-in FFT of the AP Demodulation library
+
+
+
+
+    /* (10) PARTITION OF THE LOOPS OF THE AP ALGORITHMS */
+
+    /* Macros of the maximum number of blocks and of the minimum number of array
+     * elements per block (see f_apd_blocks) */
+
+    #define APD_OMP_NBLK 256
+
+    #define APD_OMP_BLK_MIN 32768
+
+
+
+
+    /* (11) PRECISION OF THE AP ALGORITHMS */
+
+    /* Macros of numeric codes of the precisions (field .Pr of strAPD_Opt, see
+     * f_apd_plan_create) and of the default precision of the plans */
+
+    #define APD_PREC_DOUBLE 0     // arrays of doubles
+
+    #define APD_PREC_SINGLE 1     // arrays of floats (sums in double precision)
+
+    #define APD_PREC_MIXED 2      // floats until the error stalls, doubles after
+
+    #ifndef APD_PRECISION
+
+        #define APD_PRECISION APD_PREC_DOUBLE
+
+    #endif
+
+
+    /* Macros of the phases of the AP algorithms in mixed precision (see f_apd_basic)
+     * and of the criteria of the switch from single to double precision (see
+     * f_apd_mix_stalled): the drop of the infeasibility error per iteration falls
+     * below its float resolution, APD_MIX_FLOOR*FLT_EPSILON times the square root
+     * of the error and of the grid size, in APD_MIX_NSTALL consecutive iterations,
+     * or only the last 1/APD_MIX_TAIL of the maximum number of iterations is left */
+
+    #define APD_MIX_NONE 0        // one precision in all iterations
+
+    #define APD_MIX_SINGLE 1      // single precision (stalled channels stopped)
+
+    #define APD_MIX_DOUBLE 2      // double precision (stalled channels resumed)
+
+    #define APD_MIX_FLOOR 2
+
+    #define APD_MIX_NSTALL 8
+
+    #define APD_MIX_TAIL 4
+
+
+
+
+    /* (12) INITIALIZATION OF THE AP ALGORITHMS */
+
+    /* Macros of the initial estimates of the modulator and of the auxiliary
+     * variables of the AP algorithms (see f_apd_basic and f_apd_plan_execute_warm) */
+
+    #define APD_INIT_COLD 0       // the absolute-value signal
+
+    #define APD_INIT_M0 1         // an initial modulator given by the user
+
+    #define APD_INIT_STATE 2      // the state of the last execution of a plan
+
+
+
+
+    /* (13) LAYOUT OF THE INPUT AND OUTPUT ARRAYS */
+
+    /* Macros of the layouts of uniformly sampled signals (field .Ly of strAPD_Opt,
+     * see f_apd_plan_create), of the size of the tiles of their transposition, and
+     * of the length of the runs of contiguous rows placed on the DFT grid at once
+     * (see f_apd_s_Ub_load) */
+
+    #define APD_LAYOUT_COL 0      // column-major, the first index fastest (MATLAB)
+
+    #define APD_LAYOUT_ROW 1      // row-major, the last index fastest (C, NumPy)
+
+    #define APD_LAYOUT_STRIDED 2  // dense layout given by strides
+
+    #define APD_LAYOUT_TILE 32
+
+    #define APD_LAYOUT_RUN 1024
+
+
+
+
+    /* (14) TYPES OF THE INPUT SIGNAL */
+
+    /* Macros of the element types of the input signal of the typed entry points
+     * (see f_apd_plan_execute_typed) */
+
+    #define APD_TYPE_F64 0        // double
+
+    #define APD_TYPE_F32 1        // float
+
+    #define APD_TYPE_I16 2        // 16-bit integer (e.g., PCM audio)
+
+    #define APD_TYPE_I32 3        // 32-bit integer
+
+
+
+
+    /* (15) CALIBRATION OF THE PRE-FLIGHT ESTIMATE */
+
+    /* Macros of the largest number of sample points of the signal timed by the
+     * calibration, of the minimum number of timed iterations, and of the minimum
+     * time of the timed iterations in seconds (see f_apd_estimate) */
+
+    #ifndef APD_EST_NCAL
+
+        #define APD_EST_NCAL 1048576
+
+    #endif
+
+    #define APD_EST_NREP 2
+
+    #define APD_EST_TMIN 0.02
                                   
                  
 #endif
@@ -29,13 +29,24 @@
 /* C O N T E N T S
  *
  * Three functions implementing different alternating projection algorithms of
- * amplitude demodulation:
+ * amplitude demodulation (of one signal or of several channels of the same shape,
+ * which share the projections onto Mw and are terminated independently) and the
+ * structure with the state of a channel:
  *
- * (1) f_apd_basic,
+ * (1) strAPD_Chan and f_apd_mix_stalled,
  *
- * (2) f_apd_accelerated,
+ * (2) f_apd_basic,
  *
- * (3) f_apd_projected.
+ * (3) f_apd_accelerated,
+ *
+ * (4) f_apd_projected,
+ *
+ * (5) f_apd_iteration_time - the time of one iteration of an algorithm on the
+ *     current host (the calibration of f_apd_estimate).
+ *
+ * The algorithms (2)-(5) are compiled a second time for arrays of floats (suffix _f,
+ * see f_apd_demodulation.c and f_apd_plan_create). The elementwise arithmetic and
+ * all sums are computed in double precision in both cases (see l_apd_kernels.c).
  */
 
 
@@ -44,21 +55,148 @@
 
 
 
-int f_apd_basic ( double* s, \
+#ifndef APD_SINGLE    // compiled only once (see f_apd_demodulation.c)
+
+
+
+/* (1) STATE OF A CHANNEL OF THE AP ALGORITHMS AND ITS SWITCH OF PRECISION */
+
+struct strAPD_Chan {
+
+                    double       E;            // infeasibility error
+
+                    double       Etol;         // error tolerance (normalized)
+
+                    double       max_s_abs;    // normalization factor
+
+                    double       nom;          // nominator of lambda (AP-A)
+
+                    double       lambda;       // last factor lambda (AP-A)
+
+                    long         iter_m;       // next modulator readout
+
+                    long         iter_e;       // next error readout
+
+                    int          done;         // premature termination (AP-A)
+
+                    int          mix;          // switch to double precision
+
+                    double       E_res;        // float resolution of E per sqrt(E)
+
+                    double       E_prev;       // E of the previous iteration
+
+                    long         n_stall;      // iterations with a drop below it
+
+                   };
+
+
+
+
+static int f_apd_mix_stalled (struct strAPD_Chan* st, const long iter, \
+
+                              const long Ni)
+{
+/* P U R P O S E
+ *
+ * Checks whether a channel iterated in single precision (the first phase of the
+ * mixed precision, see f_apd_plan_create) has to be switched to double
+ * precision, i.e., whether the drop of its infeasibility error E per iteration has
+ * fallen to the float resolution of E in APD_MIX_NSTALL consecutive iterations, or
+ * whether only the last Ni/APD_MIX_TAIL iterations (rounded up) are left, which are
+ * always computed in double precision. The float resolution of E is the change of E
+ * caused by rounding the modulator estimate (of at most unit magnitude) to floats,
+ * APD_MIX_FLOOR*FLT_EPSILON*sqrt(nx*E), so that the relative drop of E at which a
+ * channel is switched grows as E falls and reaches 1 when E drops to
+ * (APD_MIX_FLOOR*FLT_EPSILON)^2*nx.
+ */
+
+/* I N P U T   A R G U M E N T S
+ *
+ * [st] - state of the channel with the infeasibility error of the current
+ *        iteration and the error of the previous iteration.
+ *
+ * [iter] - number of the current iteration.
+ *
+ * [Ni] - maximum number of iterations.
+ */
+
+/* O U T P U T   A R G U M E N T S
+ *
+ * [st] - state of the channel with the updated error of the previous iteration and
+ *        count of the iterations with a drop below the float resolution.
+ */
+
+/* R E T U R N   V A L U E
+ *
+ * [stalled] - 1 if the channel has to be switched to double precision, 0 otherwise.
+ */
+
+/* N O N S T A N D A R D   F U N C T I O N S   U S E D
+ *
+ * None.
+ */
+
+    if (st->E_prev - st->E > st->E_res * sqrt(st->E))
+
+        st->n_stall = 0;
+
+    else
+
+        st->n_stall = st->n_stall + 1;
+
+    st->E_prev = st->E;
+
+
+    return (st->n_stall >= APD_MIX_NSTALL || \
+            iter >= Ni - (Ni + APD_MIX_TAIL - 1) / APD_MIX_TAIL);
+}
+
+
+
+#endif
+
+
+
+
+/* (2)-(4) AP ALGORITHMS */
+
 
-                  const struct strAPD_Par* Par, \
+
+int APD_RF(f_apd_basic) ( tAPD_Real* s, \
+
+                          const struct strAPD_Par* Par, \
                  
-                  const double* Ub, \
+                          const tAPD_Real* Ub, \
+
+                          const long* ix_map, \
+
+                          const long* St, \
 
-                  const long* ix_map, \
+                          const long il, \
+
+                          const long* iL, \
+
+                          const long* iR, \
                  
-                  DFTI_DESCRIPTOR_HANDLE* dft_handle, \
+                          struct strAPD_DFT* dft, \
+
+                          tAPD_Real* s_abs, \
                  
-                  double* m_out, \
+                          const long n_ch, \
+
+                          struct strAPD_Chan* ch, \
 
-                  double* e_out, \
+                          long* act, \
+
+                          const int mix, \
+
+                          const int init, \
+
+                          double* m_out, \
+
+                          double* e_out, \
                  
-                  long* iter)
+                          long* iter)
 {
 /* P U R P O S E
  *
@@ -68,8 +206,10 @@ int f_apd_basic ( double* s, \
 
 /* I N P U T   A R G U M E N T S
  *
- * [s] - input signal + 2 additional array elements along the last dimension. This
- *       input argument is modified in-place!
+ * [s] - input signal + 2 additional array elements along the last dimension (the
+ *       initial modulator or the modulator of the last execution for a warm start,
+ *       see init). For n_ch > 1, the channels of the signal are stored one after
+ *       another. This input argument is modified in-place!
  *
  * [Par] - pointer to the structure with demodulation parameters:
  *
@@ -111,24 +251,70 @@ int f_apd_basic ( double* s, \
  *               {Type: long}
  *
  * [Ub] - upper bound on the modulator. This array must have the same number of
- *        elements as the input signal (does not include the additional two elements
- *        in the last dimension of s).
+ *        elements and the same layout as s (the additional two elements in the last
+ *        dimension are not used) or must be set to NULL.
  *
  * [ix_map] - indexes of the moddulator elements to be saved for the output. This
- *            array is either NULL or consists of the same number of elements as the
+ *            array is either NULL (the signal is sampled uniformly and given in the
+ *            layout of St) or consists of the same number of elements as the
  *            original input signal (before any possible interpolation).
  *
- * [dft_handle] - address of the comitted descriptor handle of the Intel MKL DFT.
+ * [St] - strides of the output modulator in every dimension, in sample points (see
+ *        f_apd_layout_strides; St[0] is the stride of the sample points if ix_map
+ *        is not NULL).
+ *
+ * [il] - number of channels interleaved in the output modulator (1 - no
+ *        interleaving, see f_apd_plan_create).
+ *
+ * [iL] - indexes of the left cutoff frequencies.
+ *
+ * [iR] - indexes of the right cutoff frequencies.
+ *
+ * [dft] - initialized DFT of the projection onto Mw (see f_apd_dft_init).
+ *
+ * [s_abs] - work array with the same number of elements as s (the absolute
+ *           value of the input signal for a cold start and the input signal for a
+ *           warm start, see init).
+ *
+ * [n_ch] - number of channels of the signal.
+ *
+ * [ch] - work array with the states of n_ch channels (for a cold start, .max_s_abs
+ *        is the maximum of the absolute-value signal, see f_apd_s_Ub_load).
+ *
+ * [act] - work array with n_ch elements (indexes of the active channels).
+ *
+ * [mix] - phase of the mixed precision (see f_apd_plan_create): APD_MIX_NONE -
+ *         no switch of precision; APD_MIX_SINGLE - single-precision phase, in which
+ *         the iterations of a channel are also stopped when its infeasibility error
+ *         stalls (see f_apd_mix_stalled), marked by .mix of its state;
+ *         APD_MIX_DOUBLE - double-precision phase, in which the channels so
+ *         stopped are iterated further from their states, iteration numbers, and
+ *         arrays (s, s_abs, Ub, and the auxiliary arrays) without initialization.
+ *
+ * [init] - initial estimates of the modulator and of the auxiliary variables:
+ *          APD_INIT_COLD - the normalized absolute-value signal; APD_INIT_M0 - the
+ *          initial modulator given in s (in the units of the signal, placed on the
+ *          grid like the signal, which is given in s_abs), scaled by the maximum of
+ *          the absolute-value signal; APD_INIT_STATE - the modulator and the
+ *          auxiliary arrays of the last execution with the same arrays and ch
+ *          (warm start from the state, the signal is given in s_abs), rescaled by
+ *          the ratio of the last and the new maxima of the absolute-value signal.
+ *          The initial infeasibility error is the sum of squares of the initial
+ *          modulator in all cases.
  */
 
 /* O U T P U T   A R G U M E N T S
  *
- * [m_out] - array with modulator estimates (memory allocated  externally).
+ * [m_out] - array with modulator estimates (memory allocated  externally). For
+ *           n_ch > 1, the estimates of the channels are stored one after another,
+ *           Par->im[0]*Par->ns elements per channel (interleaved if il > 1).
  *
- * [e_out] - array with error estimates (memory allocated  externally).
+ * [e_out] - array with error estimates (memory allocated  externally). For
+ *           n_ch > 1, Par->ie[0] elements per channel.
  *
  * [iter] - the actual number of iterations used (this is the address of an
- *          externally defined scalar variable).
+ *          externally defined array with n_ch elements). If mix == APD_MIX_DOUBLE,
+ *          the numbers of iterations of the single-precision phase are input.
  */
 
 /* R E T U R N   V A L U E
@@ -136,13 +322,17 @@ int f_apd_basic ( double* s, \
  * [exitflag] - exit flag. Any positive value indicates an error (for numerical and
  *              textual definitions of the exit status, see l_ap_error_handling.c).
  * 
- *              Upon an error, all memory dynamically allocated in this function or
- *              functions called by this function is freed.
  */
     
 /* N O N S T A N D A R D   F U N C T I O N S   U S E D
  *
- * (1) f_apd_abs_scaled_max_abs, (2) f_apd_mkl_dft_PMw.
+ * (1) f_apd_abs_scaled_max_abs and f_apd_scaled, (2) f_apd_dft_PMw_mc,
+ *
+ * (3) f_apd_blocks, (4) f_apd_tree_sum,
+ *
+ * (5) f_apd_kernels (and the selected kernels),
+ *
+ * (6) f_apd_time, (7) f_apd_stats_phase, (8) f_apd_m_readout.
  */
  
     
@@ -150,6 +340,7 @@ int f_apd_basic ( double* s, \
 /************************** DEFINITIONS & INITIALIZATIONS **************************/
 /***********************************************************************************/
     
+    
     int exitflag = 0;
 
     f_apd_set_error (exitflag, __LINE__, APD_ERR_FILE);
@@ -158,32 +349,55 @@ int f_apd_basic ( double* s, \
     long i;
     
     long i_aux;
-    
-    long iter_m = 1;
-    
-    long iter_e = 1;
+
+    long j;
+
+    long k;
+
+    long n_act = 0;
     
     long nx = 1;
     
     long nx_2;
-    
-    long *iL = NULL;
-    
-    long *iR = NULL;
+
+    long i_b;
+
+    long n_blk;
+
+    long i_blk[APD_OMP_NBLK+1];
+
+    long n_i;
+
+    double part[APD_OMP_NBLK];
+
+    #ifdef _OPENMP
+
+        int n_omp;
+
+    #endif
+
+
+    tAPD_Real *s_k;
+
+    tAPD_Real *s_abs_k;
+
+    const tAPD_Real *Ub_k;
+
+    double *m_k;
+
+    double *e_k;
+
+    struct strAPD_Chan *st;
+
+    const struct APD_RF(strAPD_Kern) *kern;
     
     
     double E;
-    
-    double Etol;
 
-    double max_s_abs;
-    
-    double s_old;
-    
-    double aux;
-    
+    double t_dft;
+
+    double sc = 1;
     
-    double *s_abs = NULL;
     
     
 
@@ -197,94 +411,174 @@ int f_apd_basic ( double* s, \
     
     
 
-    /* Indexes of the left and right cutoff frequencies */
-    
-    iL = (long*) malloc((Par->D)*sizeof(long));
-    
-    if (iL==NULL)
-    {
-        f_apd_set_error(APD_ERR_ID_MEM,__LINE__,APD_ERR_FILE); goto failed;}
-    
-    
-    iR = (long*) malloc((Par->D)*sizeof(long));
-    
-    if (iR==NULL)
-    {
-        f_apd_set_error(APD_ERR_ID_MEM,__LINE__,APD_ERR_FILE); goto failed;}
-    
-    
-    for (i=0; i<(Par->D); i++)
-    {
-        iL[i] = 1 + (long) ceil(Par->Fc[i] / (Par->Fs[i] / Par->Nx[i]));
- 
-        iR[i] = Par->Nx[i] - iL[i];
-    }
-    
-    
-    
-    /* Normalized absolute-value version of the signal */
+    /* Partition of the loops into blocks (see f_apd_blocks) and the number of
+     * threads processing them */
+
+    n_blk = f_apd_blocks (Par->D, Par->Nx, nx_2, i_blk);
+
+    #ifdef _OPENMP
+
+        n_omp = (dft->n_thr > 0) ? dft->n_thr : omp_get_max_threads();
+
+    #endif
+
+
+
+    /* Elementwise kernels supported by the CPU (see l_apd_kernels.c) */
+
+    kern = APD_RF(f_apd_kernels) (APD_KERN_LEVEL);
     
-    s_abs = (double*) malloc(nx_2*sizeof(double));
     
-    if (s_abs==NULL)
+
+    /* Initialization of every channel */
+
+    for (k=0; k<n_ch; k++)
     {
-        f_apd_set_error(APD_ERR_ID_MEM,__LINE__,APD_ERR_FILE); goto failed;}
-    
+        s_k = s + k*nx_2;
+
+        s_abs_k = s_abs + k*nx_2;
+
+        m_k = m_out + k*((il > 1) ? 1 : (Par->im[0])*(Par->ns));
+
+        e_k = e_out + k*(Par->ie[0]);
+
+        st = ch + k;
+
+
+
+        /* Channels stopped in the single-precision phase of the mixed precision
+         * are resumed without initialization */
+
+        if (mix == APD_MIX_DOUBLE)
+        {
+            if (st->mix != 0 && st->E > st->Etol && Par->Ni > iter[k])
+
+                act[n_act++] = k;
+
+            st->mix = 0;
+
+            continue;
+        }
+
+
+        st->iter_m = 1;
+
+        st->iter_e = 1;
+
+        st->done = 0;
+
+        st->mix = 0;
+
+        st->E_prev = INFINITY;
+
+        st->n_stall = 0;
+
+
+
+        /* Normalized absolute-value version of the signal (the absolute-value
+         * signal and its maximum are computed when the signal is placed on the grid
+         * for a cold start, and the signal is given in s_abs for a warm start) and
+         * the scale of the initial estimates of a warm start */
     
-    max_s_abs = f_apd_abs_scaled_max_abs (s, nx_2, s_abs);
+        if (init == APD_INIT_COLD)
+
+            APD_RF(f_apd_scaled) (s_abs_k, nx_2, st->max_s_abs);
+
+        else
+        {
+            sc = (init == APD_INIT_STATE) ? st->max_s_abs : 1;
+
+            st->max_s_abs = APD_RF(f_apd_abs_scaled_max_abs) (s_abs_k, nx_2, \
+                                                              s_abs_k);
+
+            sc = sc / st->max_s_abs;
+        }
     
     
     
-    /* Initialization of the error tolerance variable */
+        /* Initialization of the error tolerance variable */
     
-    if (Par->Et > 0)
+        if (Par->Et > 0)
         
-        Etol = (Par->Et / max_s_abs) * (Par->Et / max_s_abs) * nx;
+            st->Etol = (Par->Et / st->max_s_abs) * (Par->Et / st->max_s_abs) * nx;
     
-    else
+        else
             
-        Etol = Par->Et;
+            st->Etol = Par->Et;
+
+
+
+        /* Float resolution of the infeasibility error (see f_apd_mix_stalled) */
+
+        st->E_res = APD_MIX_FLOOR * FLT_EPSILON * sqrt(nx);
     
     
 
-    /* Initialization of the modulator and infeasibility error variables */
+        /* Initialization of the modulator and infeasibility error variables */
 
-    E = 0;
-    
-    for (i=0; i<nx_2; i++)
-    {
-        /* Initial estimate of the modulator */
+        #ifdef _OPENMP
+
+            #pragma omp parallel for schedule(static) num_threads(n_omp) \
+                    if(n_blk > 1) private(i, E)
+
+        #endif
+
+        for (i_b=0; i_b<n_blk; i_b++)
+        {
+            E = 0;
+
+            for (i=i_blk[i_b]; i<i_blk[i_b+1]; i++)
+            {
+                /* Initial estimate of the modulator */
         
-        s[i] = s_abs[i];
+                s_k[i] = (init == APD_INIT_COLD) ? s_abs_k[i] : sc * s_k[i];
         
         
-        /* Infeasibility error of the initial estimate of the modulator */
+                /* Infeasibility error of the initial estimate of the modulator */
          
-        E = E + s_abs[i] * s_abs[i];
-    }
+                E = E + (double) s_k[i] * s_k[i];
+            }
+
+            part[i_b] = E;
+        }
+
+
+        E = f_apd_tree_sum (part, n_blk);
+
+        st->E = E;
     
     
     
-    /* Readout of the initial estimate of the modulator */
+        /* Readout of the initial estimate of the modulator */
 
-    if (Par->im[iter_m] == 0)
-    {
-        for (i=0; i<(Par->ns); i++)
-
-            m_out[i] = s_abs[ix_map[i]] * max_s_abs;
+        if (Par->im[st->iter_m] == 0)
+        {
+            APD_RF(f_apd_m_readout) (s_k, ix_map, Par, St, il, st->max_s_abs, \
+                                     dft->n_thr, m_k);
 
-        iter_m = iter_m + 1;
-    }
+            st->iter_m = st->iter_m + 1;
+        }
     
     
     
-    /* Readout of the infeasibility error */
+        /* Readout of the infeasibility error */
         
-    if (Par->ie[iter_e] == 0)
-    {
-        e_out[0] = sqrt(E / nx);
+        if (Par->ie[st->iter_e] == 0)
+        {
+            e_k[0] = sqrt(E / nx);
+
+            st->iter_e = st->iter_e + 1;
+        }
+
+
+
+        /* Channels to be iterated */
 
-        iter_e = iter_e + 1;
+        iter[k] = 0;
+
+        if (st->E > st->Etol && Par->Ni > iter[k])
+        
+            act[n_act++] = k;
     }
 
     
@@ -296,127 +590,184 @@ int f_apd_basic ( double* s, \
 
     /* Alternating projections */
     
-    *iter = 0;
-    
-    while (E > Etol && Par->Ni > *iter)
+    while (n_act > 0)
     {
-        *iter = *iter + 1;
+        for (j=0; j<n_act; j++)
+
+            iter[act[j]] = iter[act[j]] + 1;
         
         
         
         /* Projection onto the set Mw */
 
-        exitflag = f_apd_mkl_dft_PMw (s, Par->D, Par->Nx, iL, iR, dft_handle);
+        t_dft = f_apd_time();
+
+        exitflag = APD_RF(f_apd_dft_PMw_mc) (s, act, n_act, Par->D, Par->Nx, iL, iR, \
+                                             dft, NULL);
+
+        f_apd_stats_phase (APD_STATS_DFT, t_dft);
+
+        sgAPD_STATS.n_dft = sgAPD_STATS.n_dft + 2*n_act;
         
         if (exitflag != APD_ERR_ID_NON) goto finish;
         
         
+        
+        for (j=0; j<n_act; j++)
+        {
+            k = act[j];
+
+            s_k = s + k*nx_2;
+
+            s_abs_k = s_abs + k*nx_2;
+
+            Ub_k = (Ub != NULL) ? Ub + k*nx_2 : NULL;
+
+            m_k = m_out + k*((il > 1) ? 1 : (Par->im[0])*(Par->ns));
+
+            e_k = e_out + k*(Par->ie[0]);
+
+            st = ch + k;
+
+
                 
-        /* Projection onto the set Cd; error estimate */
+            /* Projection onto the set Cd; error estimate (see f_apd_cd_basic) */
+        
+            #ifdef _OPENMP
+
+                #pragma omp parallel for schedule(static) num_threads(n_omp) \
+                        if(n_blk > 1) private(i, n_i)
+
+            #endif
+
+            for (i_b=0; i_b<n_blk; i_b++)
+            {
+                i = i_blk[i_b];
+
+                n_i = i_blk[i_b+1] - i;
+
+                if (Ub_k == NULL)
+
+                    part[i_b] = kern->cd_b (s_k+i, s_abs_k+i, n_i);
+
+                else
+
+                    part[i_b] = kern->cd_b_ub (s_k+i, s_abs_k+i, Ub_k+i, n_i);
+            }
+
+
+            E = f_apd_tree_sum (part, n_blk);
+
+            st->E = E;
+
+
+
+            /* Switch to double precision (mixed precision) */
+
+            if (mix == APD_MIX_SINGLE && E > st->Etol)
+
+                st->mix = f_apd_mix_stalled (st, iter[k], Par->Ni);
+     
         
-        E = 0;
         
-        for (i=0; i<nx_2; i++)
-        {
-            /* Copy of the current version of the modulator */
-            
-            s_old = s[i];
-            
+            /* Output (modulator) */
+        
+            if ( st->iter_m <= Par->im[0] && (iter[k] == Par->im[st->iter_m] || \
+                    (E <= st->Etol && Par->im[0] == 1 && Par->im[1] == Par->Ni)) )
+            {
+                i_aux = (st->iter_m-1)*(Par->ns)*il;
             
+                APD_RF(f_apd_m_readout) (s_k, ix_map, Par, St, il, \
+                                         st->max_s_abs, dft->n_thr, m_k + i_aux);
             
-            /* Projection onto Cd */
+                st->iter_m = st->iter_m + 1;
+            }
+        
+        
+        
+            /* Output (infeasibility error) */
+        
+            if ( st->iter_e <= Par->ie[0] && (iter[k] == Par->ie[st->iter_e] || \
+                    (E <= st->Etol && Par->ie[0] == 1 && Par->ie[1] == Par->Ni)) )
+            {
+                e_k[st->iter_e-1] = st->max_s_abs * sqrt(E / nx);
             
-            if (s[i] < s_abs[i])
-                
-                s[i] = s_abs[i];
-            
-            else if (Ub != NULL && s[i] > Ub[i])
-                
-                s[i] = Ub[i];
-            
-            
-            
-            /* Infeasibility error */
-            
-            aux = (s[i]-s_old);
-
-            E = E + aux * aux;
-            
-        }
-     
-        
-        
-        /* Output (modulator) */
-        
-        if ( iter_m <= Par->im[0] && (*iter == Par->im[iter_m] || \
-                (E <= Etol && Par->im[0] == 1 && Par->im[1] == Par->Ni)) )
-        {
-            i_aux = (iter_m-1)*(Par->ns);
-            
-            for (i=0; i<(Par->ns); i++)
-                
-                m_out[i+i_aux] = s[ix_map[i]] * max_s_abs;
-            
-            iter_m = iter_m + 1;
+                st->iter_e = st->iter_e + 1;
+            }
         }
         
         
         
-        /* Output (infeasibility error) */
-        
-        if ( iter_e <= Par->ie[0] && (*iter == Par->ie[iter_e] || \
-                (E <= Etol && Par->ie[0] == 1 && Par->ie[1] == Par->Ni)) )
-        {
-            e_out[iter_e-1] = max_s_abs * sqrt(E / nx);
-            
-            iter_e = iter_e + 1;
-        }
-        
+        /* Channels to be iterated further */
+
+        for (i=0, j=0; j<n_act; j++)
+
+            if (ch[act[j]].mix == 0 && ch[act[j]].E > ch[act[j]].Etol && \
+                    Par->Ni > iter[act[j]])
+
+                act[i++] = act[j];
+
+        n_act = i;
     }
     
     
     
 /***********************************************************************************/
-/************************** OUTPUT & MEMORY DEALLOCATION ***************************/
+/************************************ OUTPUT ***************************************/
 /***********************************************************************************/
     
     
     finish:
         
-        free(iL);
+        return exitflag;
     
-        free(iR);
+}
 
-        free(s_abs);
-        
-        return exitflag;
 
-    failed:
 
-        f_apd_get_error (&exitflag, NULL, NULL, NULL);
 
-        goto finish;
-    
-}
 
+int APD_RF(f_apd_accelerated) ( tAPD_Real* s, \
 
+                                const struct strAPD_Par* Par, \
+                       
+                                const tAPD_Real* Ub, \
 
+                                const long* ix_map, \
 
-int f_apd_accelerated ( double* s, \
+                                const long* St, \
 
-                        const struct strAPD_Par* Par, \
-                       
-                        const double* Ub, \
+                                const long il, \
 
-                        const long* ix_map, \
+                                const long* iL, \
+
+                                const long* iR, \
                        
-                        DFTI_DESCRIPTOR_HANDLE* dft_handle, \
+                                struct strAPD_DFT* dft, \
+
+                                tAPD_Real* s_abs, \
+
+                                tAPD_Real* a, \
+
+                                tAPD_Real* b, \
+
+                                double* pw, \
                        
-                        double* m_out, \
+                                const long n_ch, \
+
+                                struct strAPD_Chan* ch, \
+
+                                long* act, \
+
+                                const int mix, \
+
+                                const int init, \
+
+                                double* m_out, \
 
-                        double* e_out, \
+                                double* e_out, \
                        
-                        long* iter)
+                                long* iter)
 {   
 /* P U R P O S E
  *
@@ -426,8 +777,9 @@ int f_apd_accelerated ( double* s, \
 
 /* I N P U T   A R G U M E N T S
  *
- * [s] - input signal + 2 additional array elements along the last dimension. This
- *       input argument is modified in-place!
+ * [s] - input signal + 2 additional array elements along the last dimension (see
+ *       f_apd_basic for a warm start). For n_ch > 1, the channels of the signal
+ *       are stored one after another. This input argument is modified in-place!
  *
  * [Par] - pointer to the structure with demodulation parameters:
  *
@@ -474,24 +826,50 @@ int f_apd_accelerated ( double* s, \
  *               {Type: long}
  *
  * [Ub] - upper bound on the modulator. This array must have the same number of
- *        elements as the input signal (does not include the additional two elements
- *        in the last dimension of s).
+ *        elements and the same layout as s (the additional two elements in the last
+ *        dimension are not used) or must be set to NULL.
  *
  * [ix_map] - indexes of the moddulator elements to be saved for the output. This
- *            array is either NULL or consists of the same number of elements as the
+ *            array is either NULL (the signal is sampled uniformly and given in the
+ *            layout of St) or consists of the same number of elements as the
  *            original input signal (before any possible interpolation).
  *
- * [dft_handle] - address of the comitted descriptor handle of the Intel MKL DFT.
+ * [St] - strides of the output modulator in every dimension, in sample points (see
+ *        f_apd_layout_strides; St[0] is the stride of the sample points if ix_map
+ *        is not NULL).
+ *
+ * [il] - number of channels interleaved in the output modulator (1 - no
+ *        interleaving, see f_apd_plan_create).
+ *
+ * [iL] - indexes of the left cutoff frequencies.
+ *
+ * [iR] - indexes of the right cutoff frequencies.
+ *
+ * [dft] - initialized DFT of the projection onto Mw (see f_apd_dft_init).
+ *
+ * [s_abs] - work array with the same number of elements as s (see f_apd_basic
+ *           for a warm start).
+ *
+ * [a], [b] - work arrays with the same number of elements as s. For a warm start
+ *            from an initial modulator, a = 0 and b is the scaled modulator.
+ *
+ * [pw] - work array with n_ch elements (the sums of squares of the channels of b,
+ *        i.e., the denominators of λ, calculated by the projection onto Mw).
+ *
+ * [n_ch], [ch], [act], [mix], [init] - see f_apd_basic.
  */
 
 /* O U T P U T   A R G U M E N T S
  *
- * [m_out] - array with modulator estimates (memory allocated  externally).
+ * [m_out] - array with modulator estimates (memory allocated  externally). For
+ *           n_ch > 1, the estimates of the channels are stored one after another,
+ *           Par->im[0]*Par->ns elements per channel (interleaved if il > 1).
  *
- * [e_out] - array with error estimates (memory allocated  externally).
+ * [e_out] - array with error estimates (memory allocated  externally). For
+ *           n_ch > 1, Par->ie[0] elements per channel.
  *
  * [iter] - the actual number of iterations used (this is the address of an
- *          externally defined scalar variable).
+ *          externally defined array with n_ch elements).
  */
 
 /* R E T U R N   V A L U E
@@ -499,13 +877,17 @@ int f_apd_accelerated ( double* s, \
  * [exitflag] - exit flag. Any positive value indicates an error (for numerical and
  *              textual definitions of the exit status, see l_ap_error_handling.c).
  * 
- *              Upon an error, all memory dynamically allocated in this function or
- *              functions called by this function is freed.
  */
     
 /* N O N S T A N D A R D   F U N C T I O N S   U S E D
  *
- * (1) f_apd_abs_scaled_max_abs, (2) f_apd_mkl_dft_PMw.
+ * (1) f_apd_abs_scaled_max_abs and f_apd_scaled, (2) f_apd_dft_PMw_mc,
+ *
+ * (3) f_apd_blocks, (4) f_apd_tree_sum,
+ *
+ * (5) f_apd_kernels (and the selected kernels),
+ *
+ * (6) f_apd_time, (7) f_apd_stats_phase, (8) f_apd_m_readout.
  */
     
     
@@ -522,25 +904,58 @@ int f_apd_accelerated ( double* s, \
     long i;
     
     long i_aux;
-    
-    long iter_m = 1;
-    
-    long iter_e = 1;
+
+    long j;
+
+    long k;
+
+    long n_act = 0;
     
     long nx = 1;
     
     long nx_2;
-    
-    long *iL = NULL;
-    
-    long *iR = NULL;
+
+    long i_b;
+
+    long n_blk;
+
+    long i_blk[APD_OMP_NBLK+1];
+
+    long n_i;
+
+    double part[APD_OMP_NBLK];
+
+    #ifdef _OPENMP
+
+        int n_omp;
+
+    #endif
+
+
+    tAPD_Real *s_k;
+
+    tAPD_Real *s_abs_k;
+
+    const tAPD_Real *Ub_k;
+
+    double *m_k;
+
+    double *e_k;
+
+    struct strAPD_Chan *st;
+
+    const struct APD_RF(strAPD_Kern) *kern;
     
     
     double E;
-    
-    double Etol;
 
-    double max_s_abs;
+    double t_dft;
+
+    double sc = 1;
+
+    tAPD_Real *a_k;
+
+    tAPD_Real *b_k;
     
     double lambda;
     
@@ -549,12 +964,6 @@ int f_apd_accelerated ( double* s, \
     double denom;
     
     
-    double *a = NULL;
-    
-    double *b = NULL;
-    
-    double *s_abs = NULL;
-    
     
     
     /* Number of sample points of the provided signal */
@@ -566,113 +975,204 @@ int f_apd_accelerated ( double* s, \
     nx_2 = (nx / Par->Nx[Par->D-1]) * (Par->Nx[Par->D-1]+2-(Par->Nx[Par->D-1]%2));
     
     
-    
-    /* Indexes of the left and right cutoff frequencies */
-    
-    iL = (long*) malloc((Par->D)*sizeof(long));
-    
-    if (iL==NULL)
-    {
-        f_apd_set_error(APD_ERR_ID_MEM,__LINE__,APD_ERR_FILE); goto failed;}
-    
-    
-    iR = (long*) malloc((Par->D)*sizeof(long));
-    
-    if (iR==NULL)
-    {
-        f_apd_set_error(APD_ERR_ID_MEM,__LINE__,APD_ERR_FILE); goto failed;}
+
+    /* Partition of the loops into blocks (see f_apd_blocks) and the number of
+     * threads processing them */
+
+    n_blk = f_apd_blocks (Par->D, Par->Nx, nx_2, i_blk);
+
+    #ifdef _OPENMP
+
+        n_omp = (dft->n_thr > 0) ? dft->n_thr : omp_get_max_threads();
+
+    #endif
+
+
+
+    /* Elementwise kernels supported by the CPU (see l_apd_kernels.c) */
+
+    kern = APD_RF(f_apd_kernels) (APD_KERN_LEVEL);
     
     
-    for (i=0; i<(Par->D); i++)
+
+    /* Initialization of every channel */
+
+    for (k=0; k<n_ch; k++)
     {
-        iL[i] = 1 + (long) ceil(Par->Fc[i] / (Par->Fs[i] / Par->Nx[i]));
-        
-        iR[i] = Par->Nx[i] - iL[i];
-    }
-    
-    
-    
-    /* Normalized absolute-value version of the signal */
+        s_k = s + k*nx_2;
+
+        s_abs_k = s_abs + k*nx_2;
+
+        a_k = a + k*nx_2;
+
+        b_k = b + k*nx_2;
+
+        m_k = m_out + k*((il > 1) ? 1 : (Par->im[0])*(Par->ns));
+
+        e_k = e_out + k*(Par->ie[0]);
+
+        st = ch + k;
+
+
+
+        /* Channels stopped in the single-precision phase of the mixed precision
+         * are resumed without initialization */
+
+        if (mix == APD_MIX_DOUBLE)
+        {
+            if (st->mix != 0 && st->E > st->Etol && Par->Ni > iter[k])
+
+                act[n_act++] = k;
+
+            st->mix = 0;
+
+            continue;
+        }
+
+
+        st->iter_m = 1;
+
+        st->iter_e = 1;
+
+        st->done = 0;
+
+        st->lambda = 0;
+
+        st->mix = 0;
+
+        st->E_prev = INFINITY;
+
+        st->n_stall = 0;
     
-    s_abs = (double*) malloc(nx_2*sizeof(double));
     
-    if (s_abs==NULL)
-    {
-        f_apd_set_error(APD_ERR_ID_MEM,__LINE__,APD_ERR_FILE); goto failed;}
     
+        /* Normalized absolute-value version of the signal (the absolute-value
+         * signal and its maximum are computed when the signal is placed on the grid
+         * for a cold start, and the signal is given in s_abs for a warm start) and
+         * the scale of the initial estimates of a warm start */
     
-    max_s_abs = f_apd_abs_scaled_max_abs (s, nx_2, s_abs);
+        if (init == APD_INIT_COLD)
+
+            APD_RF(f_apd_scaled) (s_abs_k, nx_2, st->max_s_abs);
+
+        else
+        {
+            sc = (init == APD_INIT_STATE) ? st->max_s_abs : 1;
+
+            st->max_s_abs = APD_RF(f_apd_abs_scaled_max_abs) (s_abs_k, nx_2, \
+                                                              s_abs_k);
+
+            sc = sc / st->max_s_abs;
+        }
     
     
     
-    /* Initialization of the error tolerance variable */
+        /* Initialization of the error tolerance variable */
     
-    if (Par->Et > 0)
+        if (Par->Et > 0)
         
-        Etol = (Par->Et / max_s_abs) * (Par->Et / max_s_abs) * nx;
+            st->Etol = (Par->Et / st->max_s_abs) * (Par->Et / st->max_s_abs) * nx;
     
-    else
+        else
             
-        Etol = Par->Et;
-    
-    
+            st->Etol = Par->Et;
+
+
+
+        /* Float resolution of the infeasibility error (see f_apd_mix_stalled) */
+
+        st->E_res = APD_MIX_FLOOR * FLT_EPSILON * sqrt(nx);
     
-    /* Initialization of the modulator-related and infeasibility error variables */
     
-    a = (double*) calloc(nx_2,sizeof(double));
     
-    if (a == NULL)
-    {
-        f_apd_set_error(APD_ERR_ID_MEM,__LINE__,APD_ERR_FILE); goto failed;}
+        /* Initialization of the modulator-related and infeasibility error
+         * variables */
     
+        #ifdef _OPENMP
+
+            #pragma omp parallel for schedule(static) num_threads(n_omp) \
+                    if(n_blk > 1) private(i, E)
+
+        #endif
+
+        for (i_b=0; i_b<n_blk; i_b++)
+        {
+            E = 0;
+
+            for (i=i_blk[i_b]; i<i_blk[i_b+1]; i++)
+            {
+                /* Initial estimates of the variables a and b (and of the modulator
+                 * for a warm start from the state) and the infeasibility error of
+                 * the initial estimate of the modulator */
+
+                if (init == APD_INIT_STATE)
+                {
+                    a_k[i] = sc * a_k[i];
+
+                    b_k[i] = sc * b_k[i];
+
+                    s_k[i] = sc * s_k[i];
+
+                    E = E + (double) s_k[i] * s_k[i];
+                }
+
+                else
+                {
+                    a_k[i] = 0;
+
+                    b_k[i] = (init == APD_INIT_COLD) ? s_abs_k[i] : sc * s_k[i];
+
+                    E = E + (double) b_k[i] * b_k[i];
+                }
+            }
+
+            part[i_b] = E;
+        }
+
+
+        E = f_apd_tree_sum (part, n_blk);
+
+
+
+        /* Nominator of lambda (equal to E, since b is the initial estimate of the
+         * modulator, except for a warm start from the state, whose b is rescaled) */
+
+        st->nom = (init == APD_INIT_STATE) ? sc * sc * st->nom : E;
+
+        st->E = E;
     
-    b = (double*) malloc(nx_2*sizeof(double));
     
-    if (b == NULL)
-    {
-        f_apd_set_error(APD_ERR_ID_MEM,__LINE__,APD_ERR_FILE); goto failed;}
     
+        /* Readout of the initial estimate of the modulator */
+
+        if (Par->im[st->iter_m] == 0)
+        {
+            APD_RF(f_apd_m_readout) ((init == APD_INIT_STATE) ? s_k : b_k, ix_map, \
+                                     Par, St, il, st->max_s_abs, dft->n_thr, m_k);
+
+            st->iter_m = st->iter_m + 1;
+        }
     
-    nom = 0;
     
-    E = 0;
     
-    for (i=0; i<nx_2; i++)
-    {
-        /* Initial estimates of the variable b and the nominator of lambda */
-        
-        b[i] = s_abs[i];
-        
-        nom = nom + b[i] * b[i];
-        
+        /* Readout of the infeasibility error */
         
-        /* Infeasibility error of the initial estimate of the modulator */
-         
-        E = E + s_abs[i] * s_abs[i];
-    }
-    
-    
-    
-    /* Readout of the initial estimate of the modulator */
+        if (Par->ie[st->iter_e] == 0)
+        {
+            e_k[0] = sqrt(E / nx);
 
-    if (Par->im[iter_m] == 0)
-    {
-        for (i=0; i<(Par->ns); i++)
+            st->iter_e = st->iter_e + 1;
+        }
 
-            m_out[i] = s_abs[ix_map[i]] * max_s_abs;
 
-        iter_m = iter_m + 1;
-    }
-    
-    
-    
-    /* Readout of the infeasibility error */
-        
-    if (Par->ie[iter_e] == 0)
-    {
-        e_out[0] = sqrt(E / nx);
 
-        iter_e = iter_e + 1;
+        /* Channels to be iterated */
+
+        iter[k] = 0;
+
+        if (st->E > st->Etol && Par->Ni > iter[k])
+        
+            act[n_act++] = k;
     }
     
     
@@ -684,162 +1184,231 @@ int f_apd_accelerated ( double* s, \
     
     /* Alternating projections */
     
-    *iter = 0;
-    
-    while (E > Etol && Par->Ni > *iter)
+    while (n_act > 0)
     {
-        *iter = *iter + 1;
+        for (j=0; j<n_act; j++)
+
+            iter[act[j]] = iter[act[j]] + 1;
         
         
         
         /* Projection onto the set Mw */
         
-        exitflag = f_apd_mkl_dft_PMw (b, Par->D, Par->Nx, iL, iR, dft_handle);
+        t_dft = f_apd_time();
+
+        exitflag = APD_RF(f_apd_dft_PMw_mc) (b, act, n_act, Par->D, Par->Nx, iL, iR, \
+                                             dft, pw);
+
+        f_apd_stats_phase (APD_STATS_DFT, t_dft);
+
+        sgAPD_STATS.n_dft = sgAPD_STATS.n_dft + 2*n_act;
         
         if (exitflag != APD_ERR_ID_NON) goto finish;
         
         
         
-        /* Factor lambda */
+        for (j=0; j<n_act; j++)
+        {
+            k = act[j];
+
+            s_k = s + k*nx_2;
+
+            s_abs_k = s_abs + k*nx_2;
+
+            Ub_k = (Ub != NULL) ? Ub + k*nx_2 : NULL;
+
+            a_k = a + k*nx_2;
+
+            b_k = b + k*nx_2;
+
+            m_k = m_out + k*((il > 1) ? 1 : (Par->im[0])*(Par->ns));
+
+            e_k = e_out + k*(Par->ie[0]);
+
+            st = ch + k;
         
-        denom = 0;
         
-        for (i=0; i<nx_2; i++)
-            
-            denom = denom + b[i] * b[i];
         
+            /* Factor lambda (the sum of squares of b is calculated from its
+             * Fourier coefficients by the projection onto Mw, see
+             * f_apd_dft_power). The first step of a warm start from an initial
+             * modulator is not extrapolated: b is then the modulator itself rather
+             * than the residual of the last projection, so that lambda = nom/denom
+             * would overshoot by the part of the initial modulator outside Mw */
         
-        if (denom != 0)
-            
-            lambda = nom / denom;
+            denom = pw[k];
         
-        else
-            
-            lambda = 1;
         
-        if (lambda < 1 && Par->Br != 0)
+            if (init == APD_INIT_M0 && iter[k] == 1)
+
+                lambda = 1;
+
+            else if (denom != 0)
             
-            break;
+                lambda = st->nom / denom;
         
+            else
+            
+                lambda = 1;
+
+            st->lambda = lambda;
         
+            if (lambda < 1 && Par->Br != 0)
+            {
+                st->done = 1;
+
+                continue;
+            }
         
-        /* Projection onto the set Cd; a, b, nom, and error estimates */
         
-        nom = 0;
         
-        E = 0;
+            /* Projection onto the set Cd; a, b, nom, and error estimates (see
+             * f_apd_cd_accelerated) */
         
-        for (i=0; i<nx_2; i++)
-        {            
-            /* a */
-            
-            a[i] = a[i] + lambda * b[i];
-            
-            
-            
-            /* Projection onto Cd */
-            
-            s[i] = a[i];
-            
-            if (s[i] < s_abs[i])
-                
-                s[i] = s_abs[i];
-            
-            else if (Ub != NULL && s[i] > Ub[i])
-                
-                s[i] = Ub[i];
-            
-            
-            
-            /* Nominator of the factor lambda for the next iteration */
-            
-            b[i] = s[i] - a[i];
-            
-            nom = nom + b[i] * b[i];
-            
-            
-            
-            /* Infeasibility error */
+            #ifdef _OPENMP
+
+                #pragma omp parallel for schedule(static) num_threads(n_omp) \
+                        if(n_blk > 1) private(i, n_i)
+
+            #endif
+
+            for (i_b=0; i_b<n_blk; i_b++)
+            {
+                i = i_blk[i_b];
+
+                n_i = i_blk[i_b+1] - i;
+
+                if (Ub_k == NULL)
+
+                    part[i_b] = kern->cd_a (s_k+i, s_abs_k+i, a_k+i, b_k+i, \
+                                            lambda, n_i);
+
+                else
+
+                    part[i_b] = kern->cd_a_ub (s_k+i, s_abs_k+i, Ub_k+i, a_k+i, \
+                                               b_k+i, lambda, n_i);
+            }
+
+
+            nom = f_apd_tree_sum (part, n_blk);
+
+
+
+            /* Infeasibility error */
+
+            st->nom = nom;
             
+            st->E = nom;
+
             E = nom;
-        }
+
+
+
+            /* Switch to double precision (mixed precision) */
+
+            if (mix == APD_MIX_SINGLE && E > st->Etol)
+
+                st->mix = f_apd_mix_stalled (st, iter[k], Par->Ni);
         
         
         
-        /* Output (modulator) */
+            /* Output (modulator) */
         
-        if ( iter_m <= Par->im[0] && (*iter == Par->im[iter_m] || \
-                (E <= Etol && Par->im[0] == 1 && Par->im[1] == Par->Ni)) )
-        {
-            i_aux = (iter_m-1)*(Par->ns);
+            if ( st->iter_m <= Par->im[0] && (iter[k] == Par->im[st->iter_m] || \
+                    (E <= st->Etol && Par->im[0] == 1 && Par->im[1] == Par->Ni)) )
+            {
+                i_aux = (st->iter_m-1)*(Par->ns)*il;
             
-            for (i=0; i<(Par->ns); i++)
-                
-                m_out[i+i_aux] = s[ix_map[i]] * max_s_abs;
+                APD_RF(f_apd_m_readout) (s_k, ix_map, Par, St, il, \
+                                         st->max_s_abs, dft->n_thr, m_k + i_aux);
             
-            iter_m = iter_m + 1;
-        }
+                st->iter_m = st->iter_m + 1;
+            }
         
         
         
-        /* Output (infeasibility error) */
+            /* Output (infeasibility error) */
         
-        if ( iter_e <= Par->ie[0] && (*iter == Par->ie[iter_e] || \
-                (E <= Etol && Par->ie[0] == 1 && Par->ie[1] == Par->Ni)) )
-        {
-            e_out[iter_e-1] = max_s_abs * sqrt(E / nx);
+            if ( st->iter_e <= Par->ie[0] && (iter[k] == Par->ie[st->iter_e] || \
+                    (E <= st->Etol && Par->ie[0] == 1 && Par->ie[1] == Par->Ni)) )
+            {
+                e_k[st->iter_e-1] = st->max_s_abs * sqrt(E / nx);
             
-            iter_e = iter_e + 1;
+                st->iter_e = st->iter_e + 1;
+            }
         }
+        
+        
+        
+        /* Channels to be iterated further (a channel is stopped prematurely when
+         * lambda drops below 1 and Par->Br != 0) */
+
+        for (i=0, j=0; j<n_act; j++)
+
+            if (ch[act[j]].done == 0 && ch[act[j]].mix == 0 && \
+                    ch[act[j]].E > ch[act[j]].Etol && Par->Ni > iter[act[j]])
+
+                act[i++] = act[j];
+
+        n_act = i;
     }
     
     
     
 /***********************************************************************************/
-/************************** OUTPUT & MEMORY DEALLOCATION ***************************/
+/************************************ OUTPUT ***************************************/
 /***********************************************************************************/
     
     
     finish:
         
-        free(iL);
+        return exitflag;
     
-        free(iR);
+}
 
-        free(s_abs);
-        
-        free(a);
-    
-        free(b);
-        
-        return exitflag;
 
-    failed:
 
-        f_apd_get_error (&exitflag, NULL, NULL, NULL);
 
-        goto finish;
-    
-}
 
+int APD_RF(f_apd_projected) ( tAPD_Real* s, \
+
+                              const struct strAPD_Par* Par, \
+                     
+                              const tAPD_Real* Ub, \
 
+                              const long* ix_map, \
 
+                              const long* St, \
 
-int f_apd_projected ( double* s, \
+                              const long il, \
 
-                      const struct strAPD_Par* Par, \
-                     
-                      const double* Ub, \
+                              const long* iL, \
 
-                      const long* ix_map, \
+                              const long* iR, \
                      
-                      DFTI_DESCRIPTOR_HANDLE* dft_handle, \
+                              struct strAPD_DFT* dft, \
+
+                              tAPD_Real* s_abs, \
+
+                              tAPD_Real* a, \
+
+                              tAPD_Real* c, \
                      
-                      double* m_out, \
+                              const long n_ch, \
+
+                              struct strAPD_Chan* ch, \
+
+                              long* act, \
 
-                      double* e_out, \
+                              const int mix, \
+
+                              const int init, \
+
+                              double* m_out, \
+
+                              double* e_out, \
                      
-                      long* iter )
+                              long* iter )
 {   
 /* P U R P O S E
  *
@@ -849,8 +1418,9 @@ int f_apd_projected ( double* s, \
 
 /* I N P U T   A R G U M E N T S
  *
- * [s] - input signal + 2 additional array elements along the last dimension. This
- *       input argument is modified in-place!
+ * [s] - input signal + 2 additional array elements along the last dimension (see
+ *       f_apd_basic for a warm start). For n_ch > 1, the channels of the signal
+ *       are stored one after another. This input argument is modified in-place!
  *
  * [Par] - pointer to the structure with demodulation parameters:
  *
@@ -893,14 +1463,36 @@ int f_apd_projected ( double* s, \
  *               {Type: long}
  *
  * [Ub] - upper bound on the modulator. This array must have the same number of
- *        elements as the input signal (does not include the additional two elements
- *        in the last dimension of s).
+ *        elements and the same layout as s (the additional two elements in the last
+ *        dimension are not used) or must be set to NULL.
  *
  * [ix_map] - indexes of the moddulator elements to be saved for the output. This
- *            array is either NULL or consists of the same number of elements as the
+ *            array is either NULL (the signal is sampled uniformly and given in the
+ *            layout of St) or consists of the same number of elements as the
  *            original input signal (before any possible interpolation).
  *
- * [dft_handle] - address of the comitted descriptor handle of the Intel MKL DFT.
+ * [St] - strides of the output modulator in every dimension, in sample points (see
+ *        f_apd_layout_strides; St[0] is the stride of the sample points if ix_map
+ *        is not NULL).
+ *
+ * [il] - number of channels interleaved in the output modulator (1 - no
+ *        interleaving, see f_apd_plan_create).
+ *
+ * [iL] - indexes of the left cutoff frequencies.
+ *
+ * [iR] - indexes of the right cutoff frequencies.
+ *
+ * [dft] - initialized DFT of the projection onto Mw (see f_apd_dft_init).
+ *
+ * [s_abs] - work array with the same number of elements as s (see f_apd_basic
+ *           for a warm start).
+ *
+ * [a], [c] - work arrays with the same number of elements as s. For a warm start
+ *            from an initial modulator, a is the scaled modulator and c = 0, so
+ *            that the initial modulator replaces the zero signal as the point
+ *            projected onto the intersection of Mw and Cd.
+ *
+ * [n_ch], [ch], [act], [mix], [init] - see f_apd_basic.
  */
 
 /* O U T P U T   A R G U M E N T S
@@ -913,12 +1505,15 @@ int f_apd_projected ( double* s, \
  *              functions called by this function is freed. The corresponding error
  *              message is sent to sderr.
  *
- * [m_out] - array with modulator estimates (memory allocated  externally).
+ * [m_out] - array with modulator estimates (memory allocated  externally). For
+ *           n_ch > 1, the estimates of the channels are stored one after another,
+ *           Par->im[0]*Par->ns elements per channel (interleaved if il > 1).
  *
- * [e_out] - array with error estimates (memory allocated  externally).
+ * [e_out] - array with error estimates (memory allocated  externally). For
+ *           n_ch > 1, Par->ie[0] elements per channel.
  *
  * [iter] - the actual number of iterations used (this is the address of an
- *          externally defined scalar variable).
+ *          externally defined array with n_ch elements).
  */
 
 /* R E T U R N   V A L U E
@@ -926,13 +1521,17 @@ int f_apd_projected ( double* s, \
  * [exitflag] - exit flag. Any positive value indicates an error (for numerical and
  *              textual definitions of the exit status, see l_ap_error_handling.c).
  * 
- *              Upon an error, all memory dynamically allocated in this function or
- *              functions called by this function is freed.
  */
     
 /* N O N S T A N D A R D   F U N C T I O N S   U S E D
  *
- * (1) f_apd_abs_scaled_max_abs, (2) f_apd_mkl_dft_PMw.
+ * (1) f_apd_abs_scaled_max_abs and f_apd_scaled, (2) f_apd_dft_PMw_mc,
+ *
+ * (3) f_apd_blocks, (4) f_apd_tree_sum,
+ *
+ * (5) f_apd_kernels (and the selected kernels),
+ *
+ * (6) f_apd_time, (7) f_apd_stats_phase, (8) f_apd_m_readout.
  */
     
     
@@ -949,36 +1548,59 @@ int f_apd_projected ( double* s, \
     long i;
     
     long i_aux;
-    
-    long iter_m = 1;
-    
-    long iter_e = 1;
+
+    long j;
+
+    long k;
+
+    long n_act = 0;
     
     long nx = 1;
     
     long nx_2;
-    
-    long *iL = NULL;
-    
-    long *iR = NULL;
+
+    long i_b;
+
+    long n_blk;
+
+    long i_blk[APD_OMP_NBLK+1];
+
+    long n_i;
+
+    double part[APD_OMP_NBLK];
+
+    #ifdef _OPENMP
+
+        int n_omp;
+
+    #endif
+
+
+    tAPD_Real *s_k;
+
+    tAPD_Real *s_abs_k;
+
+    const tAPD_Real *Ub_k;
+
+    double *m_k;
+
+    double *e_k;
+
+    struct strAPD_Chan *st;
+
+    const struct APD_RF(strAPD_Kern) *kern;
     
     
     double E;
-    
-    double Etol;
 
-    double max_s_abs;
-    
-    double aux;
-    
-    double aux2;
-    
-    
-    double *s_abs = NULL;
-    
-    double *a = NULL;
+    double t_dft;
+
+    double sc = 1;
+
+    tAPD_Real *a_k;
+
+    tAPD_Real *c_k;
     
-    double *c = NULL;
     
     
     
@@ -991,113 +1613,196 @@ int f_apd_projected ( double* s, \
     nx_2 = (nx / Par->Nx[Par->D-1]) * (Par->Nx[Par->D-1]+2-(Par->Nx[Par->D-1]%2));
     
     
-    
-    /* Indexes of the left and right cutoff frequencies */
-    
-    iL = (long*) malloc((Par->D)*sizeof(long));
-    
-    if (iL==NULL)
-    {
-        f_apd_set_error(APD_ERR_ID_MEM,__LINE__,APD_ERR_FILE); goto failed;}
-    
-    
-    iR = (long*) malloc((Par->D)*sizeof(long));
-    
-    if (iR==NULL)
-    {
-        f_apd_set_error(APD_ERR_ID_MEM,__LINE__,APD_ERR_FILE); goto failed;}
+
+    /* Partition of the loops into blocks (see f_apd_blocks) and the number of
+     * threads processing them */
+
+    n_blk = f_apd_blocks (Par->D, Par->Nx, nx_2, i_blk);
+
+    #ifdef _OPENMP
+
+        n_omp = (dft->n_thr > 0) ? dft->n_thr : omp_get_max_threads();
+
+    #endif
+
+
+
+    /* Elementwise kernels supported by the CPU (see l_apd_kernels.c) */
+
+    kern = APD_RF(f_apd_kernels) (APD_KERN_LEVEL);
     
     
-    for (i=0; i<(Par->D); i++)
+
+    /* Initialization of every channel */
+
+    for (k=0; k<n_ch; k++)
     {
-        iL[i] = 1 + (long) ceil(Par->Fc[i] / (Par->Fs[i] / Par->Nx[i]));
-        
-        iR[i] = Par->Nx[i] - iL[i];
-    }
+        s_k = s + k*nx_2;
 
+        s_abs_k = s_abs + k*nx_2;
+
+        a_k = a + k*nx_2;
+
+        c_k = c + k*nx_2;
+
+        m_k = m_out + k*((il > 1) ? 1 : (Par->im[0])*(Par->ns));
+
+        e_k = e_out + k*(Par->ie[0]);
+
+        st = ch + k;
+
+
+
+        /* Channels stopped in the single-precision phase of the mixed precision
+         * are resumed without initialization */
+
+        if (mix == APD_MIX_DOUBLE)
+        {
+            if (st->mix != 0 && st->E > st->Etol && Par->Ni > iter[k])
+
+                act[n_act++] = k;
+
+            st->mix = 0;
+
+            continue;
+        }
+
+
+        st->iter_m = 1;
+
+        st->iter_e = 1;
+
+        st->done = 0;
+
+        st->mix = 0;
+
+        st->E_prev = INFINITY;
+
+        st->n_stall = 0;
     
     
-    /* Normalized absolute-value version of the signal */
-    
-    s_abs = (double*) malloc(nx_2*sizeof(double));
-    
-    if (s_abs==NULL)
-    {
-        f_apd_set_error(APD_ERR_ID_MEM,__LINE__,APD_ERR_FILE); goto failed;}
     
+        /* Normalized absolute-value version of the signal (the absolute-value
+         * signal and its maximum are computed when the signal is placed on the grid
+         * for a cold start, and the signal is given in s_abs for a warm start) and
+         * the scale of the initial estimates of a warm start */
     
-    max_s_abs = f_apd_abs_scaled_max_abs (s, nx_2, s_abs);
+        if (init == APD_INIT_COLD)
+
+            APD_RF(f_apd_scaled) (s_abs_k, nx_2, st->max_s_abs);
+
+        else
+        {
+            sc = (init == APD_INIT_STATE) ? st->max_s_abs : 1;
+
+            st->max_s_abs = APD_RF(f_apd_abs_scaled_max_abs) (s_abs_k, nx_2, \
+                                                              s_abs_k);
+
+            sc = sc / st->max_s_abs;
+        }
 
     
     
-    /* Initialization of the error tolerance variable */
+        /* Initialization of the error tolerance variable */
     
-    if (Par->Et > 0)
+        if (Par->Et > 0)
         
-        Etol = (Par->Et / max_s_abs) * (Par->Et / max_s_abs) * nx * 2;
+            st->Etol = (Par->Et / st->max_s_abs) * (Par->Et / st->max_s_abs) * nx * 2;
     
-    else
+        else
             
-        Etol = Par->Et;
+            st->Etol = Par->Et;
 
-    
 
-    /* Initialization of the infeasibility error and modulator-related variables */
-    
-    a = (double*) malloc(nx_2*sizeof(double));
-    
-    if (a == NULL)
-    {
-        f_apd_set_error(APD_ERR_ID_MEM,__LINE__,APD_ERR_FILE); goto failed;}
 
-    
-    c = (double*) malloc(nx_2*sizeof(double));
-    
-    if (c == NULL)
-    {
-        f_apd_set_error(APD_ERR_ID_MEM,__LINE__,APD_ERR_FILE); goto failed;}
+        /* Float resolution of the infeasibility error (see f_apd_mix_stalled) */
+
+        st->E_res = APD_MIX_FLOOR * FLT_EPSILON * sqrt(nx * 2);
 
     
-    E = 0;
+
+        /* Initialization of the infeasibility error and modulator-related
+         * variables */
     
-    for (i=0; i<nx_2; i++)
-    {
-        /* Initial estimate of the modulator and variables a and c */
-        
-        s[i] = s_abs[i];
-        
-        a[i] = s[i];
+        #ifdef _OPENMP
+
+            #pragma omp parallel for schedule(static) num_threads(n_omp) \
+                    if(n_blk > 1) private(i, E)
+
+        #endif
+
+        for (i_b=0; i_b<n_blk; i_b++)
+        {
+            E = 0;
+
+            for (i=i_blk[i_b]; i<i_blk[i_b+1]; i++)
+            {
+                /* Initial estimate of the modulator and variables a and c */
         
-        c[i] = s[i];
+                if (init == APD_INIT_STATE)
+                {
+                    s_k[i] = sc * s_k[i];
+
+                    a_k[i] = sc * a_k[i];
+
+                    c_k[i] = sc * c_k[i];
+                }
+
+                else
+                {
+                    s_k[i] = (init == APD_INIT_COLD) ? s_abs_k[i] : sc * s_k[i];
+
+                    a_k[i] = s_k[i];
+
+                    c_k[i] = (init == APD_INIT_COLD) ? s_k[i] : 0;
+                }
         
         
-        /* Infeasibility error of the initial estimate of the modulator */
+                /* Infeasibility error of the initial estimate of the modulator */
          
-        E = E + s_abs[i] * s_abs[i];
-    }
+                E = E + (double) s_k[i] * s_k[i];
+            }
 
-    
+            part[i_b] = E;
+        }
 
-    /* Readout of the initial estimate of the modulator */
 
-    if (Par->im[iter_m] == 0)
-    {
-        for (i=0; i<(Par->ns); i++)
+        E = f_apd_tree_sum (part, n_blk);
 
-            m_out[i] = s_abs[ix_map[i]] * max_s_abs;
+        st->E = E;
 
-        iter_m = iter_m + 1;
-    }
+    
+
+        /* Readout of the initial estimate of the modulator */
+
+        if (Par->im[st->iter_m] == 0)
+        {
+            APD_RF(f_apd_m_readout) (s_k, ix_map, Par, St, il, st->max_s_abs, \
+                                     dft->n_thr, m_k);
+
+            st->iter_m = st->iter_m + 1;
+        }
     
     
     
-    /* Readout of the infeasibility error */
+        /* Readout of the infeasibility error */
         
-    if (Par->ie[iter_e] == 0)
-    {
-        e_out[0] = sqrt(E / nx);
+        if (Par->ie[st->iter_e] == 0)
+        {
+            e_k[0] = sqrt(E / nx);
+
+            st->iter_e = st->iter_e + 1;
+        }
+
+
+
+        /* Channels to be iterated */
 
-        iter_e = iter_e + 1;
+        iter[k] = 0;
+
+        if (st->E > st->Etol && Par->Ni > iter[k])
+        
+            act[n_act++] = k;
     }
     
     
@@ -1108,109 +1813,388 @@ int f_apd_projected ( double* s, \
 
     
     /* Alternating projections */
-
-    *iter = 0;
     
-    while (E > Etol && Par->Ni > *iter)
+    while (n_act > 0)
     {
-        *iter = *iter + 1;
+        for (j=0; j<n_act; j++)
+
+            iter[act[j]] = iter[act[j]] + 1;
         
         
         /* Projection onto the set Mw */
         
-        exitflag = f_apd_mkl_dft_PMw (a, Par->D, Par->Nx, iL, iR, dft_handle);
+        t_dft = f_apd_time();
+
+        exitflag = APD_RF(f_apd_dft_PMw_mc) (a, act, n_act, Par->D, Par->Nx, iL, iR, \
+                                             dft, NULL);
+
+        f_apd_stats_phase (APD_STATS_DFT, t_dft);
+
+        sgAPD_STATS.n_dft = sgAPD_STATS.n_dft + 2*n_act;
         
         if (exitflag != APD_ERR_ID_NON) goto finish;
         
         
         
-        /* Projection onto the set Cd; error estimate */
+        for (j=0; j<n_act; j++)
+        {
+            k = act[j];
+
+            s_k = s + k*nx_2;
+
+            s_abs_k = s_abs + k*nx_2;
+
+            Ub_k = (Ub != NULL) ? Ub + k*nx_2 : NULL;
+
+            a_k = a + k*nx_2;
+
+            c_k = c + k*nx_2;
+
+            m_k = m_out + k*((il > 1) ? 1 : (Par->im[0])*(Par->ns));
+
+            e_k = e_out + k*(Par->ie[0]);
+
+            st = ch + k;
         
-        E = 0;
         
-        for (i=0; i<nx_2; i++)
-        {
-            /* Projection onto Cd*/
-            
-            aux = s[i] - a[i];
-            
-            s[i] = (a[i] - c[i]);
-            
-            if (s[i] < s_abs[i])
-                
-                s[i] = s_abs[i];
-            
-            else if (Ub != NULL && s[i] > Ub[i])
-                
-                s[i] = Ub[i];
-            
-            
-            
-            /* c and a */
-            
-            aux2 = s[i] - a[i];
-            
-            c[i] = c[i] + aux2;
-            
-            a[i] = s[i];
-            
-            
-            
-            /* Infeasibility error */
-            
-            E = E + aux * aux + aux2 * aux2;
-                
-        }
+        
+            /* Projection onto the set Cd; a, c, and error estimates (see
+             * f_apd_cd_projected) */
+        
+            #ifdef _OPENMP
+
+                #pragma omp parallel for schedule(static) num_threads(n_omp) \
+                        if(n_blk > 1) private(i, n_i)
+
+            #endif
+
+            for (i_b=0; i_b<n_blk; i_b++)
+            {
+                i = i_blk[i_b];
+
+                n_i = i_blk[i_b+1] - i;
+
+                if (Ub_k == NULL)
+
+                    part[i_b] = kern->cd_p (s_k+i, s_abs_k+i, a_k+i, c_k+i, n_i);
+
+                else
+
+                    part[i_b] = kern->cd_p_ub (s_k+i, s_abs_k+i, Ub_k+i, a_k+i, \
+                                               c_k+i, n_i);
+            }
+
+
+            E = f_apd_tree_sum (part, n_blk);
+
+            st->E = E;
+
+
+
+            /* Switch to double precision (mixed precision) */
+
+            if (mix == APD_MIX_SINGLE && E > st->Etol)
+
+                st->mix = f_apd_mix_stalled (st, iter[k], Par->Ni);
         
         
         
-        /* Output (modulator) */
+            /* Output (modulator) */
         
-        if ( iter_m <= Par->im[0] && (*iter == Par->im[iter_m] || \
-                (E <= Etol && Par->im[0] == 1 && Par->im[1] == Par->Ni)) )
-        {
-            i_aux = (iter_m-1)*(Par->ns);
+            if ( st->iter_m <= Par->im[0] && (iter[k] == Par->im[st->iter_m] || \
+                    (E <= st->Etol && Par->im[0] == 1 && Par->im[1] == Par->Ni)) )
+            {
+                i_aux = (st->iter_m-1)*(Par->ns)*il;
    
-            for (i=0; i<(Par->ns); i++)
-                
-                m_out[i+i_aux] = s[ix_map[i]] * max_s_abs;
+                APD_RF(f_apd_m_readout) (s_k, ix_map, Par, St, il, \
+                                         st->max_s_abs, dft->n_thr, m_k + i_aux);
     
-            iter_m = iter_m + 1;
-        }
+                st->iter_m = st->iter_m + 1;
+            }
         
         
         
-        /* Output (infeasibility error) */
+            /* Output (infeasibility error) */
         
-        if ( iter_e <= Par->ie[0] && (*iter == Par->ie[iter_e] || \
-                (E <= Etol && Par->ie[0] == 1 && Par->ie[1] == Par->Ni)) )
-        {
-            e_out[iter_e-1] = max_s_abs * sqrt(E / (2*nx));
+            if ( st->iter_e <= Par->ie[0] && (iter[k] == Par->ie[st->iter_e] || \
+                    (E <= st->Etol && Par->ie[0] == 1 && Par->ie[1] == Par->Ni)) )
+            {
+                e_k[st->iter_e-1] = st->max_s_abs * sqrt(E / (2*nx));
             
-            iter_e = iter_e + 1;
+                st->iter_e = st->iter_e + 1;
+            }
         }
         
+        
+        
+        /* Channels to be iterated further */
+
+        for (i=0, j=0; j<n_act; j++)
+
+            if (ch[act[j]].mix == 0 && ch[act[j]].E > ch[act[j]].Etol && \
+                    Par->Ni > iter[act[j]])
+
+                act[i++] = act[j];
+
+        n_act = i;
     }
     
     
     
 /***********************************************************************************/
-/************************** OUTPUT & MEMORY DEALLOCATION ***************************/
+/************************************ OUTPUT ***************************************/
 /***********************************************************************************/
     
     
     finish:
         
-        free(iL);
-    
-        free(iR);
+        return exitflag;
+   
+}
+
+
+
+
+
+
+/* (5) CALIBRATION OF THE TIME PER ITERATION */
+
+int APD_RF(f_apd_iteration_time) ( const int D, \
+
+                                   const long* N, \
+
+                                   const long* iL, \
+
+                                   const long* iR, \
+
+                                   const char Al, \
+
+                                   const int Ub_flag, \
+
+                                   struct strAPD_DFT* dft, \
+
+                                   double* t_dft, \
+
+                                   double* t_cd )
+{
+/* P U R P O S E
+ *
+ * Measures the time of one iteration of an AP algorithm on the current host, split
+ * into the projection onto Mw and the projection onto Cd (the elementwise kernel),
+ * for a synthetic signal of one channel (see f_apd_estimate). The iterations are
+ * computed as in f_apd_basic, f_apd_accelerated, and f_apd_projected, with the same
+ * DFT, kernels, and threads. The first iteration is not timed. Then, at least
+ * APD_EST_NREP iterations are timed, and more until APD_EST_TMIN seconds elapse.
+ */
+
+/* I N P U T   A R G U M E N T S
+ *
+ * [D], [N], [iL], [iR] - number of dimensions, numbers of elements, and indexes of
+ *                        the cutoff frequencies of the signal (see f_apd_dft_PMw).
+ *
+ * [Al] - AP algorithm: 'B', 'A', or 'P'.
+ *
+ * [Ub_flag] - if nonzero, the kernels with an upper bound are timed.
+ *
+ * [dft] - structure of the DFT initialized by f_apd_dft_init (and f_apd_dft_prune).
+ */
+
+/* O U T P U T   A R G U M E N T S
+ *
+ * [t_dft], [t_cd] - average time (in seconds) of the projections onto Mw and onto
+ *                   Cd per iteration (these are addresses of externally defined
+ *                   scalar variables).
+ */
+
+/* R E T U R N   V A L U E
+ *
+ * [exitflag] - exit flag. Any positive value indicates an error (for numerical and
+ *              textual definitions of the exit status, see l_ap_error_handling.c).
+ *
+ *              Upon an error, all memory dynamically allocated in this function is
+ *              freed.
+ */
+
+/* N O N S T A N D A R D   F U N C T I O N S   U S E D
+ *
+ * (1) f_apd_blocks, (2) f_apd_kernels (and the selected kernels),
+ *
+ * (3) f_apd_time, (4) f_apd_dft_PMw_mc, (5) f_apd_tree_sum.
+ */
+
+
+    int exitflag = 0;
+
+    f_apd_set_error (exitflag, __LINE__, APD_ERR_FILE);
+
+
+    long i;
+
+    long rep;
+
+    long nx = 1;
+
+    long nx_2;
+
+    long i_b;
+
+    long n_blk;
+
+    long i_blk[APD_OMP_NBLK+1];
+
+    long n_i;
+
+    double part[APD_OMP_NBLK];
+
+    #ifdef _OPENMP
+
+        int n_omp;
+
+    #endif
+
+
+    const long act = 0;
+
+    double pw;
+
+    double E = 0;
+
+    double t0;
+
+    double t1;
+
+    tAPD_Real *s = NULL;
+
+    tAPD_Real *s_abs, *Ub, *a, *b;
+
+    const struct APD_RF(strAPD_Kern) *kern;
+
+
+    *t_dft = 0;
+
+    *t_cd = 0;
+
+    for (i=0; i<D; i++)
+
+        nx = nx * N[i];
+
+    nx_2 = (nx / N[D-1]) * (N[D-1]+2-(N[D-1]%2));
+
+    n_blk = f_apd_blocks (D, N, nx_2, i_blk);
+
+    #ifdef _OPENMP
+
+        n_omp = (dft->n_thr > 0) ? dft->n_thr : omp_get_max_threads();
+
+    #endif
+
+    kern = APD_RF(f_apd_kernels) (APD_KERN_LEVEL);
+
+
+
+    /* Work arrays of one channel (s, s_abs, Ub, and the auxiliary arrays of AP-A
+     * and AP-P) with a synthetic normalized absolute-value signal */
+
+    s = (tAPD_Real*) malloc(5*nx_2*sizeof(tAPD_Real));
+
+    if (s==NULL)
+    {
+        f_apd_set_error(APD_ERR_ID_MEM,__LINE__,APD_ERR_FILE); goto failed;}
+
+    s_abs = s + nx_2;
+
+    Ub = s + 2*nx_2;
+
+    a = s + 3*nx_2;
+
+    b = s + 4*nx_2;
+
+    for (i=0; i<nx_2; i++)
+    {
+        s_abs[i] = (tAPD_Real) fabs(cos(0.1 * (double) i));
+
+        s[i] = s_abs[i];
+
+        Ub[i] = 2;
+
+        a[i] = 0;
+
+        b[i] = s_abs[i];
+    }
+
+
+
+    /* Iterations */
+
+    for (rep=0; rep<=APD_EST_NREP || (*t_dft + *t_cd) < APD_EST_TMIN; rep++)
+    {
+        t0 = f_apd_time();
+
+        exitflag = APD_RF(f_apd_dft_PMw_mc) ((Al == 'B') ? s : b, &act, 1, D, N, \
+                                             iL, iR, dft, (Al == 'A') ? &pw : NULL);
+
+        if (exitflag != APD_ERR_ID_NON) goto finish;
+
+        t1 = f_apd_time();
+
+
+        #ifdef _OPENMP
+
+            #pragma omp parallel for schedule(static) num_threads(n_omp) \
+                    if(n_blk > 1) private(i, n_i)
+
+        #endif
+
+        for (i_b=0; i_b<n_blk; i_b++)
+        {
+            i = i_blk[i_b];
+
+            n_i = i_blk[i_b+1] - i;
+
+            if (Al == 'B')
+
+                part[i_b] = (Ub_flag) ? \
+                        kern->cd_b_ub (s+i, s_abs+i, Ub+i, n_i) : \
+                        kern->cd_b (s+i, s_abs+i, n_i);
+
+            else if (Al == 'A')
+
+                part[i_b] = (Ub_flag) ? \
+                        kern->cd_a_ub (s+i, s_abs+i, Ub+i, a+i, b+i, 1.0, n_i) : \
+                        kern->cd_a (s+i, s_abs+i, a+i, b+i, 1.0, n_i);
+
+            else
+
+                part[i_b] = (Ub_flag) ? \
+                        kern->cd_p_ub (s+i, s_abs+i, Ub+i, a+i, b+i, n_i) : \
+                        kern->cd_p (s+i, s_abs+i, a+i, b+i, n_i);
+        }
+
+        E = f_apd_tree_sum (part, n_blk);
+
+
+        if (rep > 0)
+        {
+            *t_dft = *t_dft + (t1 - t0);
+
+            *t_cd = *t_cd + (f_apd_time() - t1);
+        }
+    }
+
+    *t_dft = *t_dft / (rep-1);
+
+    *t_cd = *t_cd / (rep-1);
+
+    (void) E;
+
+
+
+    /* Output & Memory deallocation */
+
+    finish:
+
+        free(s);
 
-        free(s_abs);
-        
-        free(a);
-    
-        free(c);
-        
         return exitflag;
 
     failed:
@@ -1218,6 +2202,5 @@ int f_apd_projected ( double* s, \
         f_apd_get_error (&exitflag, NULL, NULL, NULL);
 
         goto finish;
-   
-}
 
+}
@@ -28,21 +28,37 @@
 
 /* C O N T E N T S
  *
- * Seven auxiliary functions for amplitude demodulation via alternating projections:
+ * Auxiliary functions for amplitude demodulation via alternating projections:
  *
  * (1) f_apd_minmax,
  *
- * (2) f_apd_abs_scaled_max_abs,
+ * (2) f_apd_scaled and f_apd_abs_scaled_max_abs,
  *
  * (3) f_apd_compression,
  *
- * (4) f_apd_interpolation,
+ * (4) f_apd_ix_r2 and f_apd_interpolation,
  *
- * (5) f_apd_s_Ub_init,
+ * (5) f_apd_ix_remap, f_apd_layout_tiles, f_apd_s_get, f_apd_s_at,
+ *     f_apd_s_Ub_load, f_apd_m_readout, f_apd_promote, and f_apd_demote,
  *
- * (6) f_apd_mkl_dft_init,
+ * (6) f_apd_dft_mask, f_apd_dft_power, and f_apd_dft_pad,
  *
- * (7) f_apd_mkl_dft_PMw.
+ * (7) f_apd_mkl_dft_init and f_apd_mkl_dft_PMw (omitted if APD_NO_MKL is defined),
+ *
+ * (8) sgAPD_DFT_BACKEND, strAPD_DFT, f_apd_set_dft_backend, f_apd_get_options,
+ *     f_apd_options, f_apd_layout_strides, f_apd_dft_free, f_apd_dft_init,
+ *     f_apd_dft_prune, f_apd_dft_PMw, and f_apd_dft_PMw_mc - the DFT backend layer,
+ *     which dispatches the projection onto Mw of one or several channels to the
+ *     Intel MKL DFT, the built-in FFT, or the pruned FFT (see l_apd_fft.c),
+ *
+ * (9) f_apd_blocks and f_apd_tree_sum - the partition of the loops of the AP
+ *     algorithms into blocks (processed in parallel if the library is compiled
+ *     with OpenMP) and the deterministic summation of their partial sums.
+ *
+ * The functions on the arrays of the AP algorithms (f_apd_scaled,
+ * f_apd_abs_scaled_max_abs, f_apd_s_Ub_load, f_apd_m_readout, the functions of
+ * (6), f_apd_mkl_dft_PMw, f_apd_dft_PMw, and f_apd_dft_PMw_mc) are compiled a
+ * second time for arrays of floats (suffix _f, see f_apd_demodulation.c).
  */
 
 
@@ -51,6 +67,10 @@
 
 
 
+#ifndef APD_SINGLE    // the double-precision parts are compiled only once
+
+
+
 void f_apd_minmax ( const double* in, \
 
                     const long N, \
@@ -116,11 +136,60 @@ void f_apd_minmax ( const double* in, \
 
 
 
-double f_apd_abs_scaled_max_abs ( const double* in, \
+#endif
+
+
+
+
+void APD_RF(f_apd_scaled) ( tAPD_Real* s, \
+
+                           const long N, \
+
+                           const double maxval )
+{
+/* P U R P O S E
+ *
+ * Normalizes the absolute-value signal by its maximum in-place (the second pass
+ * of f_apd_abs_scaled_max_abs, used alone when the absolute-value signal and its
+ * maximum are computed by f_apd_s_Ub_load).
+ */
+
+/* I N P U T   A R G U M E N T S
+ *
+ * [s] - absolute-value signal.
+ *
+ * [N] - number of elements in the array of the signal.
+ *
+ * [maxval] - maximum of the absolute-value signal.
+ */
+
+/* O U T P U T   A R G U M E N T S
+ *
+ * [s] - normalized absolute-value signal.
+ */
+
+/* R E T U R N   V A L U E
+ *
+ * None.
+ */
+    
+    
+    long i;
+
+
+    for (i=0; i<N; i++)
+        
+        s[i] = s[i] / maxval;
+}
+
+
+
+
+double APD_RF(f_apd_abs_scaled_max_abs) ( const tAPD_Real* in, \
 
-                                  const long N, \
+                                          const long N, \
 
-                                  double* out)
+                                          tAPD_Real* out)
 {
 /* P U R P O S E
  *
@@ -168,9 +237,7 @@ double f_apd_abs_scaled_max_abs ( const double* in, \
     
     /* Scaled signal */
     
-    for (i=0; i<N; i++)
-        
-        out[i] = out[i] / maxval;
+    APD_RF(f_apd_scaled) (out, N, maxval);
     
     
     
@@ -181,10 +248,16 @@ double f_apd_abs_scaled_max_abs ( const double* in, \
 
 
 
+#ifndef APD_SINGLE
+
+
+
 void f_apd_compression ( double* s, \
 
                          const long N, \
 
+                         const long st, \
+
                          const double p )
 {
 /* P U R P O S E
@@ -198,6 +271,9 @@ void f_apd_compression ( double* s, \
  *
  * [N] - number of elements in the array of the input signal.
  *
+ * [st] - stride of the elements (1 for a contiguous array, see .Il of the options
+ *        of f_apd_plan_create).
+ *
  * [p] - compression parameter.
  */
 
@@ -220,7 +296,7 @@ void f_apd_compression ( double* s, \
     
     /* Calculation */
     
-    for (i=0; i<N; i++)
+    for (i=0; i<N*st; i=i+st)
         
         s[i] = ((s[i]>0)-(s[i]<0)) * pow(fabs(s[i]),p);
     
@@ -229,29 +305,75 @@ void f_apd_compression ( double* s, \
 
 
 
-int f_apd_interpolation ( const double* s, \
+static inline double f_apd_ix_r2 ( const double* t, \
+
+                                   const long ns, \
+
+                                   const int D, \
+
+                                   const long* cumnr, \
+
+                                   const double* tmin, \
+
+                                   const double* dt, \
+
+                                   const long i1, \
+
+                                   long* ix )
+{
+/* Closest grid point (linear index, the first index running fastest) of the sample
+ * point i1 and the squared distance between them (see f_apd_interpolation) */
+
+    long i2, i3, ix_d;
+
+    double r2 = 0;
+
+
+    *ix = 0;
+
+    for (i2=0; i2<D; i2++)
+    {
+        i3 = i1 + i2*ns;
+
+        ix_d = lround((t[i3]-tmin[i2]) / dt[i2]);
+
+        r2 = r2 + (t[i3]-tmin[i2]-ix_d*dt[i2]) * (t[i3]-tmin[i2]-ix_d*dt[i2]);
+
+        *ix = *ix + ((i2 == 0) ? ix_d : ix_d * cumnr[i2-1]);
+    }
+
+    return r2;
+}
+
 
-                          const struct strAPD_Par* Par, \
 
-                          const double* Ub, \
+
+int f_apd_interpolation ( const struct strAPD_Par* Par, \
                          
                           const double* t, \
-                         
-                          double* s_out, \
-                         
-                          double* Ub_out, \
+
+                          long* own, \
         
-                          long* ix_out )
+                          long* ix_out, \
+
+                          long* iw_out, \
+
+                          long* nw_out )
 {
 /* P U R P O S E
  *
- * Interpolates the input signal on a refined uniform grid following Eq. 23 in
- * M. Gabrielaitis IEEE Trans. Signal Process., vol. 69, pp. 4039-4054, 2021.
+ * Prepares the interpolation of the input signal on a refined uniform grid
+ * following Eq. 23 in M. Gabrielaitis IEEE Trans. Signal Process., vol. 69,
+ * pp. 4039-4054, 2021. Only the sampling coordinates are needed; the signal values
+ * are placed on the grid by f_apd_s_Ub_load. Every used grid point takes the value
+ * of its closest sample point, which is found by a table of grid point owners in
+ * O(ns + nr) operations. The table is the only work array of the grid size and is
+ * provided by the caller (the work arrays of the demodulation plan, which are not
+ * used yet, see f_apd_plan_init); the distances of the sample points are computed
+ * again where two of them claim the same grid point instead of being stored.
  */
 
 /* I N P U T   A R G U M E N T S
- *
- * [s] - input signal.
  *
  * [Par] - pointer to the structure with interpolation parameters:
  *
@@ -262,25 +384,27 @@ int f_apd_interpolation ( const double* s, \
  *         .Nr - number of sample points on the refined uniform grid. This is an
  *               array of D elements. {Type: long}
  *
- * [Ub] - array with the upper bound values on the modulator. This is an array of the
- *        same size as the input signal s or Ub == NULL. In the latter case, no upper
- *        bound is assumed.
- *
  * [t] - sampling coordinates of the input signal. This is a 2D array with the number
  *       of columns equal to the dimension of the input signal (Par.D) and the number
  *       of rows equal to the total number of signal sample points, Par.Ns[0].
+ *
+ * [own] - work array with Par.Nr[0] x ... x Par.Nr[Par.D-1] elements (memory
+ *         allocated externally). Its content is overwritten.
  */
 
 /* O U T P U T   A R G U M E N T S
  *
- * [s_out] - interpolated signal (memory allocated externally). The number of
- *           dimensions of this array is given by Par.D.
+ * [ix_out] - linear indexes of the grid points (Par.D-dimensional array with the
+ *            first index running fastest) corresponding to every sample point of the
+ *            input signal (memory allocated externally).
  *
- * [Ub_out] - interpolated upper bounds on the modulator (memory allocated
- *            externally). The dimensions of this array are the same as of s_out.
+ * [iw_out] - indexes of the sample points whose values are assigned to the grid
+ *            points, i.e., the closest sample point of every used grid point
+ *            (memory allocated externally for Par.ns elements). The indexes are
+ *            ordered by the grid points.
  *
- * [ix_out] - linear indexes of the elements of s_out corresponding to every element
- *            of s (memory allocated externally).
+ * [nw_out] - number of the elements of iw_out (this is the address of an
+ *            externally defined scalar variable).
  */
 
 /* R E T U R N   V A L U E
@@ -294,7 +418,7 @@ int f_apd_interpolation ( const double* s, \
 
 /* N O N S T A N D A R D   F U N C T I O N S   U S E D
  *
- * (1) f_apd_print_error, (2) f_apd_minmax.
+ * (1) f_apd_print_error, (2) f_apd_minmax, (3) f_apd_ix_r2.
  */
     
     
@@ -305,9 +429,7 @@ int f_apd_interpolation ( const double* s, \
     f_apd_set_error (exitflag, __LINE__, APD_ERR_FILE);
     
     
-    int log_aux;
-    
-    long i1, i2, i3;
+    long i1;
     
     long nr = 1;
     
@@ -315,7 +437,7 @@ int f_apd_interpolation ( const double* s, \
     
     long ix;
     
-    long *ix_aux = NULL;
+    long ix_o;
     
     
     double *tmin = NULL;
@@ -324,10 +446,6 @@ int f_apd_interpolation ( const double* s, \
     
     double *dt = NULL;
     
-    double r2;
-    
-    double *r2_all = NULL;
-    
  
     
     
@@ -340,13 +458,6 @@ int f_apd_interpolation ( const double* s, \
         f_apd_set_error(APD_ERR_ID_MEM,__LINE__,APD_ERR_FILE); goto failed;}
     
     
-    ix_aux = (long*) malloc((Par->D)*sizeof(long));
-        
-    if (ix_aux==NULL)
-    {
-        f_apd_set_error(APD_ERR_ID_MEM,__LINE__,APD_ERR_FILE); goto failed;}
-    
-    
     tmin = (double*) malloc((Par->D)*sizeof(double));
     
     if (tmin==NULL)
@@ -386,26 +497,11 @@ int f_apd_interpolation ( const double* s, \
     
     
     
-    /* Memory allocation for r2_all arrays */
-    
-    r2_all = (double*) malloc((Par->ns)*sizeof(double));
-        
-    if (r2_all==NULL)
-    {
-        f_apd_set_error(APD_ERR_ID_MEM,__LINE__,APD_ERR_FILE); goto failed;}
-    
-    
-    
-    /* Preparation of the signal and upper bound output arrays */
-    
-        for (i1=0; i1<nr; i1++)
-        {
-            s_out[i1] = 0;
-    
-            if (Ub != NULL)
-            
-                Ub_out[i1] = INFINITY;
-        }
+    /* Sample point assigned to every grid point (-1 if none) */
+
+    for (i1=0; i1<nr; i1++)
+
+        own[i1] = -1;
     
     
     
@@ -420,76 +516,52 @@ int f_apd_interpolation ( const double* s, \
 
 
 
-    /* Interpolation */
+    /* Interpolation: the closest point on the new grid of every sample point
+     * (independent of the other sample points) */
     
+    #ifdef _OPENMP
+
+        #pragma omp parallel for schedule(static) if(Par->ns > APD_OMP_BLK_MIN)
+
+    #endif
+
+    for (i1=0; i1<(Par->ns); i1++)
+
+        f_apd_ix_r2 (t, Par->ns, Par->D, cumnr, tmin, dt, i1, ix_out + i1);
+
+
+
+    /* Every used grid point is assigned to its closest sample point (the earliest
+     * one if several sample points are equally close). The owner table replaces the
+     * search among the previous sample points, so that the assignment takes O(ns)
+     * operations. The distances are compared only for the grid points claimed by
+     * several sample points. */
+
     for (i1=0; i1<(Par->ns); i1++)
     {
-        /* The closest point on the new grid and the corresponding distance */
-        
-        r2 = 0;
-        
-        for (i2=0; i2<(Par->D); i2++)
-        {
-            i3 = i1 + i2*(Par->ns);
+        ix = ix_out[i1];
 
-            ix_aux[i2] = lround((t[i3]-tmin[i2]) / dt[i2]);
-            
-            r2 = r2 + (t[i3]-tmin[i2]-ix_aux[i2]*dt[i2]) * \
-                      (t[i3]-tmin[i2]-ix_aux[i2]*dt[i2]);
-        }
-        
-        ix = ix_aux[0];
- 
-        for (i2=1; i2<(Par->D); i2++)
+        if (own[ix] < 0 || f_apd_ix_r2 (t, Par->ns, Par->D, cumnr, tmin, dt, i1, \
+                &ix_o) < f_apd_ix_r2 (t, Par->ns, Par->D, cumnr, tmin, dt, \
+                own[ix], &ix_o))
 
-            ix = ix + ix_aux[i2] * cumnr[i2-1];
+            own[ix] = i1;
+    }
 
-        
-        /* Checking whether the closest point on the new grid has already been used*/
-        
-        log_aux = 0;
-        
-        for (i2=0; i2<i1; i2++)
-        {
-            if(ix_out[i2] == ix)
-            {
-                log_aux = 1;
-                
-                break;
-            }
-        }
-        
-        
-        if (log_aux == 0 || r2 < r2_all[i2])
+
+
+    /* Sample points assigned to the grid */
+
+    *nw_out = 0;
+
+    for (i1=0; i1<nr; i1++)
+
+        if (own[i1] >= 0)
         {
-            s_out[ix] = s[i1];
-       
-            if (Ub != NULL)
-                
-                Ub_out[ix] = Ub[i1];
-            
-            ix_out[i1] = ix;
-            
-            r2_all[i1] = r2;
-        }
-        
-        if (log_aux == 1 && r2 < r2_all[i2])
-        
-            ix_out[i2] = -ix_out[i2];
-        
-        else if (log_aux == 1)
-            
-            ix_out[i1] = -ix_out[i1];
-          
-    }
-    
+            iw_out[*nw_out] = own[i1];
 
-    
-    /* Absolute value of ix_out */
-    
-    for (i1=0; i1<(Par->ns); i1++)
-        
-        ix_out[i1] = labs(ix_out[i1]);
+            *nw_out = *nw_out + 1;
+        }
     
     
     
@@ -498,8 +570,6 @@ int f_apd_interpolation ( const double* s, \
     finish:
     
         free(cumnr);
-    
-        free(ix_aux);
 
         free(tmin);
 
@@ -507,8 +577,6 @@ int f_apd_interpolation ( const double* s, \
 
         free(dt);
 
-        free(r2_all);
-
         return exitflag;
 
     failed:
@@ -522,763 +590,2934 @@ int f_apd_interpolation ( const double* s, \
 
 
 
-int f_apd_s_Ub_init ( const double* s, \
-
-                      const double* Ub, \
-                     
-                      long* ix, \
-                     
-                      const int D, \
+void f_apd_ix_remap ( const int D, \
 
                       const long* N, \
                      
                       const long ns, \
                      
-                      double* out_s, \
-                     
-                      double* out_Ub )
+                      long* ix )
 {
 /* P U R P O S E
  *
- * Remaps elements of the signal, modulator upper bound, and interpolation index
- * arrays to comply with the Intel's MKL DFT indexing convention. */
+ * Remaps the interpolation index array to comply with the DFT indexing convention
+ * (row-major order with +2 elements in the last dimension). */
 
 /* I N P U T   A R G U M E N T S
- *
- * [s] - input signal.
- *
- * [Ub] - upper bound on the modulator. This array must have the same number of
- *        elements as the input signal.
- *
- * [ix] - array with the mapping between the indexes of the original and (possibly)
- *        interpolated signal arrays. This array contains ns number of elements.
  *
  * [D] - number of dimensions of the signal array.
  *
  * [N] - numbers of elements of the signal array in every dimension.
  *
  * [ns] - number of elements in the array ix.
+ *
+ * [ix] - array with the mapping between the indexes of the original and (possibly)
+ *        interpolated signal arrays (the first index of the latter running fastest).
  */
 
 /* O U T P U T   A R G U M E N T S
- *
- * [out_s] - output signal with rearranged placement and +2 elements in the last
- *           dimension to meet the MKL DFT requirements (memory allocated
- *           externally).
- *
- * [out_Ub] - output upper bound on the modulator with rearranged placement and +2
- *            elements in the last dimension to meet the MKL DFT requirements (memory
- *            allocated externally).
  *
  * [ix] - array with the mapping between the indexes of the original and (possibly)
- *        interpolated signal arrays compliant with the Intel's MKL DFT indexing
- *        convention (memory allocated externally).
+ *        interpolated signal arrays compliant with the DFT indexing convention
+ *        (memory allocated externally).
  */
 
 /* R E T U R N   V A L U E
  *
- * [exitflag] - exit flag. Any positive value indicates an error (for numerical and
- *              textual definitions of the exit status, see l_ap_error_handling.c).
- * 
- *              Upon an error, all memory dynamically allocated in this function is
- *              freed.
+ * None.
  */
     
 /* N O N S T A N D A R D   F U N C T I O N S   U S E D
  *
- * (1) f_apd_print_error.
+ * None.
  */
     
     
     /* Definitions and initializations */
     
-    int exitflag = 0;
+    long i;
 
-    f_apd_set_error (exitflag, __LINE__, APD_ERR_FILE);
-    
-    
     long i0, i1, i2;
-    
-    long n = 1, n_2;
-    
-    long i_lin0, i_lin;
-    
-    long strd0[3], strd[3];
-    
-    long *ilin0_to_ilin = NULL;
-    
-    
-    
-    /* Number of elements in the s and Ub arrays */
-    
-    for (i0=0; i0<D; i0++)
-        
-        n = n * N[i0];
-        
-    n_2 = (n / N[D-1]) * (N[D-1]+2-(N[D-1]%2));
+
+    const long L = (N[D-1]/2+1)*2;
     
     
     
-    /* Initialization of some of the arrays */
+    /* Remapping of the ix array */
     
-    for (i0=0; i0<n_2; i0++)
-    {
-        out_s[i0] = 0;
-
-        if (Ub != NULL)
+    if (D == 2)
 
-            out_Ub[i0] = INFINITY;
-    }
-    
-    
-    if (D > 1)
-    {
-        ilin0_to_ilin = (long*) malloc(n*sizeof(long));
-        
-        if (ilin0_to_ilin==NULL)
+        for (i=0; i<ns; i++)
         {
-            f_apd_set_error(APD_ERR_ID_MEM,__LINE__,APD_ERR_FILE); goto failed;}
-    }
-    
-    
-    
-    /* Remapping of the s and Ub arrays */
-    
-    if (D == 1)
-    {
-        memcpy(out_s, s, N[0]*sizeof(double));
+            i0 = ix[i] % N[0];
+
+            i1 = ix[i] / N[0];
+
+            ix[i] = i0*L + i1;
+        }
 
-        if (Ub != NULL)
-               
-            memcpy(out_Ub, Ub, N[0]*sizeof(double));
-    }
-    
-    else if (D == 2)
-    {
-        strd0[0] = 1;
-        
-        strd0[1] = N[0];
-        
-        
-        strd[0] = (N[1]/2+1)*2;
-        
-        strd[1] = 1;
-        
-    
-        for (i0=0; i0<N[0]; i0++)
-            
-            for (i1=0; i1<N[1]; i1++)
-            {
-                i_lin0 = i0*strd0[0] + i1*strd0[1];
-                
-                i_lin = i0*strd[0] + i1*strd[1];
-                
-                
-                ilin0_to_ilin[i_lin0] = i_lin;
-                
-                out_s[i_lin] = s[i_lin0];
-                
-                if (Ub != NULL)
-                    
-                    out_Ub[i_lin] = Ub[i_lin0];
-            }
-    }
-    
     else if (D == 3)
-    {
-        strd0[0] = 1;
-        
-        strd0[1] = N[0];
-        
-        strd0[2] = N[0]*N[1];
-        
-        
-        strd[0] = N[1]*(N[2]/2+1)*2;
-        
-        strd[1] = (N[2]/2+1)*2;
-        
-        strd[2] = 1;
-        
-    
-        for (i0=0; i0<N[0]; i0++)
-            
-            for (i1=0; i1<N[1]; i1++)
-            
-                for (i2=0; i2<N[2]; i2++)
-                {
-                    i_lin0 = i0*strd0[0] + i1*strd0[1] + i2*strd0[2];
 
-                    i_lin = i0*strd[0] + i1*strd[1] + i2*strd[2];
+        for (i=0; i<ns; i++)
+        {
+            i0 = ix[i] % N[0];
 
-                    
-                    ilin0_to_ilin[i_lin0] = i_lin;
-                    
-                    out_s[i_lin] = s[i_lin0];
+            i1 = (ix[i] / N[0]) % N[1];
 
-                    if (Ub != NULL)
-                        
-                        out_Ub[i_lin] = Ub[i_lin0];
-                }
-        
-    }
-    
-    
-    
-    /* Remapping of the ix array */
-    
-    if (D > 1)
-    
-        for (i0=0; i0<ns; i0++)
-
-            ix[i0] = ilin0_to_ilin[ix[i0]];
-    
-    
-    
-    /* Output & Memory deallocation */
-    
-    finish:
-    
-        free(ilin0_to_ilin);
+            i2 = ix[i] / (N[0]*N[1]);
 
-        return exitflag;
+            ix[i] = (i0*N[1] + i1)*L + i2;
+        }
+}
 
-    failed:
 
-        f_apd_get_error (&exitflag, NULL, NULL, NULL);
 
-        goto finish;
-    
-}
 
+void f_apd_layout_tiles ( const int D, \
 
+                          const long* N, \
 
+                          const long* St, \
 
-int f_apd_mkl_dft_init ( const int D, \
+                          long* n, \
 
-                         const long* N, \
+                          long* st, \
 
-                         DFTI_DESCRIPTOR_HANDLE* dft_handle )
+                          long* sg )
 {
 /* P U R P O S E
  *
- * Initializes Intel's Mkl DFT routine for AP algorithms. */
+ * Describes the transposition between a uniformly sampled signal in the layout given
+ * by the strides St (see f_apd_layout_strides) and the DFT grid (row-major order
+ * with +2 elements in the last dimension) by three loops: an outer loop (index 0), a
+ * loop over the rows of the grid along the dimension with the smaller stride of the
+ * signal (index 1), and a loop along the last dimension (index 2). The loops 1 and 2
+ * are tiled by f_apd_s_Ub_load and f_apd_m_readout, so that the signal and the grid
+ * are both accessed in runs of contiguous elements. */
 
 /* I N P U T   A R G U M E N T S
  *
- * [D] - number of DFT dimensions.
+ * [D] - number of dimensions of the signal array.
  *
- * [N] - numbers of elements of the DFT array in every dimension.
+ * [N] - numbers of elements of the signal array in every dimension.
  *
- * [dft_handle] - address of an empty variable for the comitted descriptor handle.
+ * [St] - strides of the signal array in every dimension.
  */
 
 /* O U T P U T   A R G U M E N T S
  *
- * [dft_handle] - pointer to the initialized and comitted descriptor handle.
+ * [n] - numbers of iterations of the three loops (memory allocated externally).
+ *
+ * [st] - strides of the signal array in the three loops (memory allocated
+ *        externally).
+ *
+ * [sg] - strides of the DFT grid in the three loops (memory allocated
+ *        externally).
  */
 
 /* R E T U R N   V A L U E
  *
- * [exitflag] - exit flag. Any positive value indicates an error (for numerical and
- *              textual definitions of the exit status, see l_ap_error_handling.c).
- * 
- *              Upon an error, all memory dynamically allocated in this function or
- *              functions called by this function is freed.
+ * None.
  */
-
+    
 /* N O N S T A N D A R D   F U N C T I O N S   U S E D
  *
- * (1) DftiCreateDescriptor, (2) DftiSetValue, (3) DftiCommitDescriptor.
+ * None.
  */
     
     
-    /* Definitions and initializations */
-    
-    int exitflag = 0;
+    const long L = (N[D-1]/2+1)*2;
 
-    f_apd_set_error (exitflag, __LINE__, APD_ERR_FILE);
-    
-    
-    int i;
-    
-    long n = 1;
-    
-    MKL_LONG status;
-    
-    MKL_LONG *N_ = NULL;
-    
-    MKL_LONG *rs = NULL;
+    const int c = (D == 3 && St[1] < St[0]) ? 1 : 0;
 
-    MKL_LONG *cs = NULL;
-    
-    
-    
-    /* DFT descriptor */
-    
-    if (D == 1)
+
+    n[0] = 1; st[0] = 0; sg[0] = 0;
+
+    n[1] = 1; st[1] = 0; sg[1] = 0;
+
+    n[2] = N[D-1]; st[2] = St[D-1]; sg[2] = 1;
+
+    if (D == 2)
     {
-        status = DftiCreateDescriptor ( dft_handle, DFTI_DOUBLE, DFTI_REAL, \
-                (MKL_LONG) D, (MKL_LONG) N[0]);
-        
-        if (status != DFTI_NO_ERROR)
-        {
-            f_apd_set_error(APD_ERR_ID_FT1, __LINE__,APD_ERR_FILE); goto failed;}
-        
-        n = N[0];
+        n[1] = N[0]; st[1] = St[0]; sg[1] = L;
     }
-    else
+
+    else if (D == 3)
     {
-        N_ = (MKL_LONG*) malloc(D*sizeof(MKL_LONG));
-        
-        if (N_==NULL)
-        {
-            f_apd_set_error(APD_ERR_ID_MEM,__LINE__,APD_ERR_FILE); goto failed;}
-        
-        
-        for (i=0; i < D; i++)
-        {
-            N_[i] = (MKL_LONG) N[i];
-            
-            n = n * N[i];
-        }
-        
-        
-        status = DftiCreateDescriptor ( dft_handle, DFTI_DOUBLE, DFTI_REAL, \
-                (MKL_LONG) D, N_);
-        
-        if (status != DFTI_NO_ERROR)
-        {
-            f_apd_set_error(APD_ERR_ID_FT1,__LINE__,APD_ERR_FILE); goto failed;}
+        n[0] = N[1-c]; st[0] = St[1-c]; sg[0] = (c == 0) ? L : N[1]*L;
+
+        n[1] = N[c]; st[1] = St[c]; sg[1] = (c == 0) ? N[1]*L : L;
     }
+}
 
 
 
-    /* DFT strides in real and conjugate domains */
 
-    rs = (MKL_LONG*) malloc((D+1)*sizeof(MKL_LONG));
+static inline double f_apd_s_get ( const void* s, \
 
-    if (rs==NULL)
+                                   const int type, \
+
+                                   const long i )
+{
+/* Element i of the signal s of the given type (see f_apd_plan_execute_typed) */
+
+    switch (type)
     {
-        f_apd_set_error(APD_ERR_ID_MEM,__LINE__,APD_ERR_FILE); goto failed;}
+        case APD_TYPE_F32: return ((const float*) s)[i];
 
+        case APD_TYPE_I16: return ((const int16_t*) s)[i];
 
-    cs = (MKL_LONG*) malloc((D+1)*sizeof(MKL_LONG));
+        case APD_TYPE_I32: return ((const int32_t*) s)[i];
 
-    if (cs==NULL)
-    {
-        f_apd_set_error(APD_ERR_ID_MEM,__LINE__,APD_ERR_FILE); goto failed;}
+        default: return ((const double*) s)[i];
+    }
+}
 
 
-    cs[D] = 1;
 
-    rs[D] = 1;
 
-    cs[D-1] = (N[D-1]/2+1);
+static inline const void* f_apd_s_at ( const void* s, \
 
-    rs[D-1] = cs[D-1]*2;
+                                       const int type, \
 
-    for (i=D-2; i>0; i--)
+                                       const long i )
+{
+/* Address of the element i of the signal s of the given type */
+
+    const size_t sz = (type == APD_TYPE_F32) ? sizeof(float) : \
+                      (type == APD_TYPE_I16) ? sizeof(int16_t) : \
+                      (type == APD_TYPE_I32) ? sizeof(int32_t) : sizeof(double);
+
+    return (s != NULL) ? (const char*) s + i*sz : NULL;
+}
+
+
+
+
+#endif
+
+
+
+
+static inline void APD_RF(f_apd_s_Ub_put) ( const void* s, \
+
+                                           const int type, \
+
+                                           const double* Ub, \
+
+                                           const long i, \
+
+                                           const long i_u, \
+
+                                           const long i_g, \
+
+                                           const double p, \
+
+                                           tAPD_Real* out_s, \
+
+                                           tAPD_Real* out_Ub, \
+
+                                           int* bad )
+{
+/* Places the (compressed) element i of the signal and the element i_u of the upper
+ * bound (if not NULL) at the element i_g of the DFT grid and marks an invalid
+ * element of the upper bound in bad (bit 2, see f_apd_s_Ub_load) */
+
+    double v = f_apd_s_get (s, type, i);
+
+    double u;
+
+
+    if (Ub != NULL)
     {
-        cs[i] = cs[i+1] * N[i];
+        u = Ub[i_u];
 
-        rs[i] = rs[i+1] * N[i];
+        *bad |= (!isfinite(u) || u < fabs(v)) << 1;
+
+        if (p != 1)
+
+            u = ((u>0)-(u<0)) * pow(fabs(u),p);
+
+        out_Ub[i_g] = u;
     }
 
-    cs[0] = 0;
+    if (p != 1)
 
-    rs[0] = 0;
+        v = ((v>0)-(v<0)) * pow(fabs(v),p);
 
+    out_s[i_g] = v;
+}
 
-    
-    /* Setting strides of the DFT descriptor for the forward transform */
 
-    status = DftiSetValue(*dft_handle, DFTI_INPUT_STRIDES, rs);
 
-    if (status != DFTI_NO_ERROR)
-    {
-        f_apd_set_error(APD_ERR_ID_FT2,__LINE__,APD_ERR_FILE); goto failed;}
 
+static inline void APD_RF(f_apd_s_run) ( const void* s, \
 
-    status = DftiSetValue(*dft_handle, DFTI_OUTPUT_STRIDES, cs);
+                                         const int type, \
 
-    if (status != DFTI_NO_ERROR)
-    {
-        f_apd_set_error(APD_ERR_ID_FT2,__LINE__,APD_ERR_FILE); goto failed;}
+                                         const long i, \
 
-    
-    
-    /* Setting the calculations to be done in-place */
-    
-    status = DftiSetValue (*dft_handle, DFTI_PLACEMENT, DFTI_INPLACE);
-    
-    if (status != DFTI_NO_ERROR)
-    {
-        f_apd_set_error(APD_ERR_ID_FT2,__LINE__,APD_ERR_FILE); goto failed;}
+                                         const long st, \
 
-    
-    
-    /* Setting the data storage scheme in the Fourier domain */
-    
-    status = DftiSetValue (*dft_handle, DFTI_CONJUGATE_EVEN_STORAGE, \
-            DFTI_COMPLEX_COMPLEX);
-    
-    if (status != DFTI_NO_ERROR)
-    {
-        f_apd_set_error(APD_ERR_ID_FT2,__LINE__,APD_ERR_FILE); goto failed;}
-    
-    
-    status = DftiSetValue (*dft_handle, DFTI_PACKED_FORMAT, DFTI_CCE_FORMAT);
-    
-    if (status != DFTI_NO_ERROR)
-    {
-        f_apd_set_error(APD_ERR_ID_FT2,__LINE__,APD_ERR_FILE); goto failed;}
+                                         const long n, \
 
-    
-    
-    /* Setting the backward transform as the inverse transform */
-    
-    status = DftiSetValue (*dft_handle, DFTI_BACKWARD_SCALE, 1.0/((double)n));
-    
-    if (status != DFTI_NO_ERROR)
-    {
-        f_apd_set_error(APD_ERR_ID_FT2,__LINE__,APD_ERR_FILE); goto failed;}
+                                         tAPD_Real* out, \
 
-    
-    
-    /* Setting all computations to use one CPU thread */
-    
-    /*status = DftiSetValue (*dft_handle, DFTI_THREAD_LIMIT, 1);
-    
-    if (status != DFTI_NO_ERROR)
-    {
-        f_apd_set_error(APD_ERR_ID_FT2,__LINE__,APD_ERR_FILE); goto failed;}*/
+                                         const long st_g )
+{
+/* Places n elements of the signal s of the given type, st apart from the element
+ * i on, at the elements of the DFT grid st_g apart from out on (the signal
+ * without compression and upper bound, see f_apd_s_Ub_load). The type is
+ * dispatched once per run, so that the copies of contiguous runs are vectorized */
 
-    
-    
-    /* Commiting the DFT descriptor */
+    long j;
 
-    status = DftiCommitDescriptor (*dft_handle);
 
-    if (status != DFTI_NO_ERROR)
+    #define APD_S_RUN(T) \
+        if (st == 1 && st_g == 1) \
+            for (j=0; j<n; j++) \
+                out[j] = ((const T*) s)[i+j]; \
+        else \
+            for (j=0; j<n; j++) \
+                out[j*st_g] = ((const T*) s)[i+j*st];
+
+    switch (type)
     {
-        f_apd_set_error(APD_ERR_ID_FT3,__LINE__,APD_ERR_FILE); goto failed;}
+        case APD_TYPE_F32: APD_S_RUN(float) break;
 
-    
-    
-    /* Output & Memory deallocation */
-    
-    finish:
-    
-        free(N_);
+        case APD_TYPE_I16: APD_S_RUN(int16_t) break;
 
-        free(rs);
+        case APD_TYPE_I32: APD_S_RUN(int32_t) break;
 
-        free(cs);
-        
-        return exitflag;
-                
-    failed:
-        
-        DftiFreeDescriptor(dft_handle);
-        
-        *dft_handle = 0;
-        
-        f_apd_get_error (&exitflag, NULL, NULL, NULL);
+        default: APD_S_RUN(double) break;
+    }
 
-        goto finish;
-        
+    #undef APD_S_RUN
 }
 
 
 
 
-int f_apd_mkl_dft_PMw ( double* s, \
-                     
-                        const int D, \
-                     
-                        const long* N, \
-                     
-                        const long* iL, \
+static inline double APD_RF(f_apd_s_abs_run) ( const tAPD_Real* s, \
 
-                        const long* iR, \
-                     
-                        DFTI_DESCRIPTOR_HANDLE* dft_handle )
+                                               const long n, \
+
+                                               tAPD_Real* out_abs, \
+
+                                               double mx, \
+
+                                               int* bad )
 {
-/* P U R P O S E
- *
- * Implements the projection onto the set Mw by using the Intel's Mkl DFT routine. */
+/* Absolute values of n contiguous elements of the DFT grid (written to out_abs if
+ * not NULL), their maximum merged with mx (returned), and non-finite elements
+ * marked in bad (bit 1, see f_apd_s_Ub_load). The maximum is taken over four
+ * independent partial maxima */
 
-/* I N P U T   A R G U M E N T S
- *
- * [s] - input signal + 2 additional array elements along the last dimension.
- *
- * [D] - number of dimensions of the signal array.
- *
- * [N] - numbers of elements of the signal array in every dimension. The additional
- *        two elements in the last dimension of s are not counted here.
- *
- * [iL] - indexes of the left cutoff frequencies.
- *
- * [iR] - indexes of the right cutoff frequencies.
- *
- * [dft_handle] - address of an empty variable for the comitted descriptor handle.
- */
+    long j, q;
 
-/* O U T P U T   A R G U M E N T S
- *
- * [s] - projected input signal (memory allocated externally).
- */
+    double a, m[4] = {mx, 0, 0, 0};
 
-/* R E T U R N   V A L U E
- *
- * [exitflag] - exit flag. Any positive value indicates an error (for numerical and
- *              textual definitions of the exit status, see l_ap_error_handling.c).
- * 
- *              Upon an error, all memory dynamically allocated in this function or
- *              functions called by this function is freed.
- */
+    long n_bad = 0;
 
-/* N O N S T A N D A R D   F U N C T I O N S   U S E D
- *
- * (1) f_apd_print_error, (2) DftiSetValue, (3) DftiCommitDescriptor,
- * 
- * (4) DftiComputeForward, (5) DftiComputeBackward.
- */
-    
-    
-    /* Definitions and initializations */
-    
-    int exitflag = 0;
 
-    f_apd_set_error (exitflag, __LINE__, APD_ERR_FILE);
-    
-    
-    long i1, i2, i3;
-    
-    MKL_LONG status;
-    
-    MKL_LONG *rs = NULL;
-    
-    MKL_LONG *cs = NULL;
-    
+    if (out_abs != NULL)
+
+        for (j=0; j<n; j++)
+
+            out_abs[j] = fabs(s[j]);
+
+    for (j=0; j+3<n; j=j+4)
+
+        for (q=0; q<4; q++)
+        {
+            a = fabs(s[j+q]);
+
+            m[q] = (a > m[q]) ? a : m[q];
+
+            n_bad = n_bad + !(a <= DBL_MAX);
+        }
+
+    for (; j<n; j++)
+    {
+        a = fabs(s[j]);
+
+        m[0] = (a > m[0]) ? a : m[0];
+
+        n_bad = n_bad + !(a <= DBL_MAX);
+    }
+
+    *bad |= (n_bad > 0);
+
+    m[0] = (m[1] > m[0]) ? m[1] : m[0];
+
+    m[2] = (m[3] > m[2]) ? m[3] : m[2];
+
+    return (m[2] > m[0]) ? m[2] : m[0];
+}
+
+
+
+
+static inline double APD_RF(f_apd_s_run_abs) ( const void* s, \
+
+                                               const int type, \
+
+                                               const long i, \
+
+                                               const long st, \
+
+                                               const long n, \
+
+                                               tAPD_Real* out, \
+
+                                               tAPD_Real* out_abs, \
+
+                                               double mx, \
+
+                                               int* bad )
+{
+/* Places n elements of the signal s of the given type, st apart from the element
+ * i on, at contiguous elements of the DFT grid from out on, together with their
+ * absolute values, maximum, and non-finite elements (see f_apd_s_run and
+ * f_apd_s_abs_run) in one sweep, in which every element is converted only once */
+
+    long j, q;
+
+    tAPD_Real v;
+
+    double a, m[4] = {mx, 0, 0, 0};
+
+    long n_bad = 0;
+
+
+    #define APD_S_RUN_ABS(T) \
+        for (j=0; j+3<n; j=j+4) \
+            for (q=0; q<4; q++) \
+            { \
+                v = (tAPD_Real) ((const T*) s)[i+(j+q)*st]; \
+                a = fabs(v); \
+                out[j+q] = v; \
+                if (out_abs != NULL) \
+                    out_abs[j+q] = (tAPD_Real) a; \
+                m[q] = (a > m[q]) ? a : m[q]; \
+                n_bad = n_bad + !(a <= DBL_MAX); \
+            } \
+        for (; j<n; j++) \
+        { \
+            v = (tAPD_Real) ((const T*) s)[i+j*st]; \
+            a = fabs(v); \
+            out[j] = v; \
+            if (out_abs != NULL) \
+                out_abs[j] = (tAPD_Real) a; \
+            m[0] = (a > m[0]) ? a : m[0]; \
+            n_bad = n_bad + !(a <= DBL_MAX); \
+        }
+
+    switch (type)
+    {
+        case APD_TYPE_F32: APD_S_RUN_ABS(float) break;
+
+        case APD_TYPE_I16: APD_S_RUN_ABS(int16_t) break;
+
+        case APD_TYPE_I32: APD_S_RUN_ABS(int32_t) break;
+
+        default: APD_S_RUN_ABS(double) break;
+    }
+
+    #undef APD_S_RUN_ABS
+
+
+    *bad |= (n_bad > 0);
+
+    m[0] = (m[1] > m[0]) ? m[1] : m[0];
+
+    m[2] = (m[3] > m[2]) ? m[3] : m[2];
+
+    return (m[2] > m[0]) ? m[2] : m[0];
+}
+
+
+
+
+int APD_RF(f_apd_s_Ub_load) ( const void* s, \
+
+                              const int type, \
+
+                              const double* Ub, \
+
+                              const long* ix, \
+
+                              const long* iw, \
+
+                              const long nw, \
+
+                              const int D, \
+
+                              const long* N, \
+
+                              const long* St, \
+
+                              const long il_s, \
+
+                              const long il_u, \
+
+                              const double p, \
+
+                              const int n_thr, \
+
+                              tAPD_Real* out_s, \
+
+                              tAPD_Real* out_Ub, \
+
+                              tAPD_Real* out_abs, \
+
+                              double* out_max )
+{
+/* P U R P O S E
+ *
+ * Places the (compressed) elements of the signal and modulator upper bound arrays
+ * on the uniform grid of the DFT (see f_apd_interpolation and f_apd_ix_remap).
+ * Conversion of the signal type, validation, compression, interpolation,
+ * remapping, and the absolute value of the signal on the grid with its maximum
+ * (the input of the normalization of the AP algorithms, see f_apd_basic) are done
+ * in one pass. A uniformly sampled signal is placed without the index array: its
+ * rows are copied if the layout of the signal is row-major (converted together
+ * with their absolute values and maximum in one sweep if there is no compression
+ * and no upper bound), and transposed in tiles of APD_LAYOUT_TILE x
+ * APD_LAYOUT_TILE elements otherwise (see f_apd_layout_tiles). */
+
+/* I N P U T   A R G U M E N T S
+ *
+ * [s] - input signal.
+ *
+ * [type] - type of the elements of s (APD_TYPE_F64, APD_TYPE_F32, APD_TYPE_I16,
+ *          or APD_TYPE_I32, see f_apd_plan_execute_typed).
+ *
+ * [Ub] - upper bound on the modulator. This array must have the same number of
+ *        elements as the input signal or must be NULL.
+ *
+ * [ix] - array with the mapping between the indexes of the original and (possibly)
+ *        interpolated signal arrays compliant with the DFT indexing convention, or
+ *        NULL if the signal is sampled uniformly (the mapping is given by St).
+ *
+ * [iw] - indexes of the sample points assigned to the grid (see
+ *        f_apd_interpolation) or NULL if the signal is sampled uniformly. In the
+ *        latter case, all nw sample points are used.
+ *
+ * [nw] - number of elements of iw (number of sample points if iw == NULL).
+ *
+ * [D] - number of dimensions of the signal array.
+ *
+ * [N] - numbers of elements of the signal array in every dimension.
+ *
+ * [St] - strides of the signal array in every dimension in sample points (see
+ *        f_apd_layout_strides). If ix != NULL, St[0] is the stride of the sample
+ *        points.
+ *
+ * [il_s], [il_u] - numbers of interleaved channels of s and Ub, by which the
+ *                  strides are multiplied in the respective array (see
+ *                  f_apd_plan_create; 1 - no interleaving).
+ *
+ * [p] - compression exponent (p=1 - no compression).
+ *
+ * [n_thr] - maximum number of OpenMP threads (the default if n_thr < 1).
+ */
+
+/* O U T P U T   A R G U M E N T S
+ *
+ * [out_s] - output signal with rearranged placement and +2 elements in the last
+ *           dimension to meet the DFT requirements (memory allocated externally).
+ *
+ * [out_Ub] - output upper bound on the modulator with rearranged placement and +2
+ *            elements in the last dimension to meet the DFT requirements (memory
+ *            allocated externally).
+ *
+ * [out_abs] - absolute value of out_s (memory allocated externally) or NULL. If
+ *             out_abs is out_s, the absolute value replaces the signal in place.
+ *
+ * [out_max] - maximum of the absolute value of out_s (this is the address of an
+ *             externally defined scalar variable) or NULL.
+ */
+
+/* R E T U R N   V A L U E
+ *
+ * [err] - APD_ERR_ID_S if the signal has a non-finite element, APD_ERR_ID_UB if
+ *         the upper bound has a non-finite element or an element smaller than the
+ *         absolute value of the signal (see f_apd_s_Ub_validation), and
+ *         APD_ERR_ID_NON otherwise. The error is not set by this function.
+ */
+
+/* N O N S T A N D A R D   F U N C T I O N S   U S E D
+ *
+ * (1) f_apd_layout_tiles, (2) f_apd_s_Ub_put, f_apd_s_run, f_apd_s_abs_run, and
+ *     f_apd_s_run_abs, (3) f_apd_s_get.
+ */
+
+
+    /* Definitions and initializations */
+
+    long i, k;
+
+    long n = 1, n_2;
+
+    const long L = (N[D-1]/2+1)*2;
+
+    long b, o, c, c0, c1, j, j0, j1, t_j, n_b;
+
+    long ts[3], tst[3], tsg[3];
+
+    double mx = 0, mx_b;
+
+    int bad = 0, bad_b;
+
+    #ifdef _OPENMP
+
+        const int n_omp = (n_thr > 0) ? n_thr : omp_get_max_threads();
+
+    #else
+
+        (void) n_thr;
+
+    #endif
+
+
+    for (i=0; i<D; i++)
+
+        n = n * N[i];
+
+    n_2 = (n / N[D-1]) * L;
+
+
+
+    /* Uniformly sampled signal: the tiles (o, c, j) of the three loops of
+     * f_apd_layout_tiles (j innermost and the rows of a tile copied in runs of
+     * APD_LAYOUT_RUN elements if the last dimension of the signal is contiguous, c
+     * innermost otherwise), followed by the +2 elements of the rows. The absolute
+     * values of a tile are computed from the grid while the tile is in the cache,
+     * and the maxima and the invalid elements of the tiles are merged at the end of
+     * every tile */
+
+    if (ix == NULL)
+    {
+        f_apd_layout_tiles (D, N, St, ts, tst, tsg);
+
+        t_j = (tst[2] == 1) ? APD_LAYOUT_RUN : APD_LAYOUT_TILE;
+
+        n_b = (ts[1] + APD_LAYOUT_TILE - 1) / APD_LAYOUT_TILE;
+
+
+        #ifdef _OPENMP
+
+            #pragma omp parallel for schedule(static) num_threads(n_omp) \
+                    if(n > APD_OMP_BLK_MIN) \
+                    private(o, c, c0, c1, j, j0, j1, mx_b, bad_b)
+
+        #endif
+
+        for (b=0; b<ts[0]*n_b; b++)
+        {
+            o = b / n_b;
+
+            c0 = (b % n_b) * APD_LAYOUT_TILE;
+
+            c1 = (c0 + APD_LAYOUT_TILE < ts[1]) ? c0 + APD_LAYOUT_TILE : ts[1];
+
+            mx_b = 0;
+
+            bad_b = 0;
+
+            for (j0=0; j0<ts[2]; j0=j0+t_j)
+            {
+                j1 = (j0 + t_j < ts[2]) ? j0 + t_j : ts[2];
+
+                if (p == 1 && Ub == NULL && tst[2] == 1)
+                {
+                    for (c=c0; c<c1; c++)
+
+                        mx_b = APD_RF(f_apd_s_run_abs) (s, type, (o*tst[0] + \
+                                c*tst[1] + j0)*il_s, il_s, j1 - j0, out_s + \
+                                o*tsg[0] + c*tsg[1] + j0, (out_abs != NULL) ? \
+                                out_abs + o*tsg[0] + c*tsg[1] + j0 : NULL, mx_b, \
+                                &bad_b);
+
+                    continue;
+                }
+
+                else if (p == 1 && Ub == NULL)
+
+                    for (j=j0; j<j1; j++)
+
+                        APD_RF(f_apd_s_run) (s, type, (o*tst[0] + c0*tst[1] + \
+                                j*tst[2])*il_s, tst[1]*il_s, c1 - c0, out_s + \
+                                o*tsg[0] + c0*tsg[1] + j, tsg[1]);
+
+                else if (tst[2] == 1)
+
+                    for (c=c0; c<c1; c++)
+
+                        for (j=j0; j<j1; j++)
+
+                            APD_RF(f_apd_s_Ub_put) (s, type, Ub, \
+                                    (o*tst[0] + c*tst[1] + j)*il_s, \
+                                    (o*tst[0] + c*tst[1] + j)*il_u, \
+                                    o*tsg[0] + c*tsg[1] + j, p, out_s, out_Ub, \
+                                    &bad_b);
+
+                else
+
+                    for (j=j0; j<j1; j++)
+
+                        for (c=c0; c<c1; c++)
+
+                            APD_RF(f_apd_s_Ub_put) (s, type, Ub, \
+                                    (o*tst[0] + c*tst[1] + j*tst[2])*il_s, \
+                                    (o*tst[0] + c*tst[1] + j*tst[2])*il_u, \
+                                    o*tsg[0] + c*tsg[1] + j, p, out_s, out_Ub, \
+                                    &bad_b);
+
+                for (c=c0; c<c1; c++)
+
+                    mx_b = APD_RF(f_apd_s_abs_run) (out_s + o*tsg[0] + \
+                            c*tsg[1] + j0, j1 - j0, (out_abs != NULL) ? \
+                            out_abs + o*tsg[0] + c*tsg[1] + j0 : NULL, mx_b, \
+                            &bad_b);
+            }
+
+            #ifdef _OPENMP
+
+                #pragma omp critical (apd_s_Ub_load)
+
+            #endif
+            {
+                if (mx_b > mx)
+
+                    mx = mx_b;
+
+                bad = bad | bad_b;
+            }
+        }
+
+
+        for (i=0; i<n_2; i+=L)
+
+            for (k=i+N[D-1]; k<i+L; k++)
+            {
+                out_s[k] = 0;
+
+                if (Ub != NULL)
+
+                    out_Ub[k] = INFINITY;
+
+                if (out_abs != NULL)
+
+                    out_abs[k] = 0;
+            }
+
+        goto finish;
+    }
+
+
+
+    /* Elements not assigned to any sample point: the whole grid of an interpolated
+     * signal or the +2 elements in the last dimension otherwise */
+
+    if (iw != NULL)
+
+        for (i=0; i<n_2; i++)
+        {
+            out_s[i] = 0;
+            
+            if (Ub != NULL)
+                
+                out_Ub[i] = INFINITY;
+        }
+
+    else
+
+        for (i=0; i<n_2; i+=L)
+
+            for (k=i+N[D-1]; k<i+L; k++)
+            {
+                out_s[k] = 0;
+                
+                if (Ub != NULL)
+                    
+                    out_Ub[k] = INFINITY;
+            }
+    
+    
+    
+    /* Placement of the sample points (St[0]*il_s apart in s and St[0]*il_u apart in
+     * Ub), followed by the absolute values of the whole grid */
+    
+    for (k=0; k<nw; k++)
+    {
+        i = (iw != NULL) ? iw[k] : k;
+
+        APD_RF(f_apd_s_Ub_put) (s, type, Ub, i*St[0]*il_s, i*St[0]*il_u, ix[i], \
+                                p, out_s, out_Ub, &bad);
+    }
+
+    mx = APD_RF(f_apd_s_abs_run) (out_s, n_2, out_abs, mx, &bad);
+
+
+
+    /* Output (an invalid signal precedes an invalid upper bound, as in
+     * f_apd_s_Ub_validation) */
+
+    finish:
+
+        if (out_max != NULL)
+
+            *out_max = mx;
+
+        return (bad & 1) ? APD_ERR_ID_S : (bad & 2) ? APD_ERR_ID_UB : APD_ERR_ID_NON;
+}
+
+
+
+
+void APD_RF(f_apd_m_readout) ( const tAPD_Real* s, \
+
+                                const long* ix, \
+
+                                const struct strAPD_Par* Par, \
+
+                                const long* St, \
+
+                                const long il, \
+
+                                const double c, \
+
+                                const int n_thr, \
+
+                                double* m )
+{
+/* P U R P O S E
+ *
+ * Reads the modulator estimate out of the DFT grid (the inverse of the placement by
+ * f_apd_s_Ub_load): gathers the sample points of a nonuniformly sampled signal
+ * through the index array, or transposes a uniformly sampled signal into its layout
+ * in tiles (see f_apd_layout_tiles). */
+
+/* I N P U T   A R G U M E N T S
+ *
+ * [s] - modulator estimate on the DFT grid.
+ *
+ * [ix] - index array (see f_apd_s_Ub_load) or NULL if the signal is sampled
+ *        uniformly.
+ *
+ * [Par] - parameters of the plan (.D, .Nx, and .ns are used).
+ *
+ * [St] - strides of m in every dimension, in sample points (see
+ *        f_apd_layout_strides; St[0] is the stride of the sample points if
+ *        ix != NULL). They are multiplied by il.
+ *
+ * [il] - number of channels interleaved in m (1 - no interleaving).
+ *
+ * [c] - scaling factor of the modulator.
+ *
+ * [n_thr] - maximum number of OpenMP threads (the default if n_thr < 1).
+ */
+
+/* O U T P U T   A R G U M E N T S
+ *
+ * [m] - modulator estimate in the layout of the input signal (memory allocated
+ *       externally).
+ */
+
+/* R E T U R N   V A L U E
+ *
+ * None.
+ */
+    
+/* N O N S T A N D A R D   F U N C T I O N S   U S E D
+ *
+ * (1) f_apd_layout_tiles.
+ */
+    
+    
+    long i, b, o, c0, c1, k, j, j0, j1, t_j, n_b;
+
+    long ts[3], tst[3], tsg[3];
+
+    long st[3];
+
+    #ifdef _OPENMP
+
+        const int n_omp = (n_thr > 0) ? n_thr : omp_get_max_threads();
+
+    #else
+
+        (void) n_thr;
+
+    #endif
+
+
+    for (i=0; i<3; i++)
+
+        st[i] = St[i] * il;
+
+
+
+    /* Nonuniformly sampled signal */
+
+    if (ix != NULL)
+    {
+        #ifdef _OPENMP
+
+            #pragma omp parallel for schedule(static) num_threads(n_omp) \
+                    if(Par->ns > APD_OMP_BLK_MIN)
+
+        #endif
+
+        for (i=0; i<(Par->ns); i++)
+
+            m[i*st[0]] = s[ix[i]] * c;
+
+        return;
+    }
+
+
+
+    /* Uniformly sampled signal (see f_apd_s_Ub_load) */
+
+    f_apd_layout_tiles (Par->D, Par->Nx, st, ts, tst, tsg);
+
+    t_j = (tst[2] == 1) ? ts[2] : APD_LAYOUT_TILE;
+
+    n_b = (ts[1] + APD_LAYOUT_TILE - 1) / APD_LAYOUT_TILE;
+
+
+    #ifdef _OPENMP
+
+        #pragma omp parallel for schedule(static) num_threads(n_omp) \
+                if(Par->ns > APD_OMP_BLK_MIN) private(o, c0, c1, k, j, j0, j1)
+
+    #endif
+
+    for (b=0; b<ts[0]*n_b; b++)
+    {
+        o = b / n_b;
+
+        c0 = (b % n_b) * APD_LAYOUT_TILE;
+
+        c1 = (c0 + APD_LAYOUT_TILE < ts[1]) ? c0 + APD_LAYOUT_TILE : ts[1];
+
+        for (j0=0; j0<ts[2]; j0=j0+t_j)
+        {
+            j1 = (j0 + t_j < ts[2]) ? j0 + t_j : ts[2];
+
+            if (tst[2] == 1)
+
+                for (k=c0; k<c1; k++)
+
+                    for (j=j0; j<j1; j++)
+
+                        m[o*tst[0] + k*tst[1] + j] = \
+                            s[o*tsg[0] + k*tsg[1] + j] * c;
+
+            else
+
+                for (j=j0; j<j1; j++)
+
+                    for (k=c0; k<c1; k++)
+
+                        m[o*tst[0] + k*tst[1] + j*tst[2]] = \
+                            s[o*tsg[0] + k*tsg[1] + j] * c;
+        }
+    }
+}
+
+
+
+
+#ifndef APD_SINGLE
+
+
+
+void f_apd_promote ( void* x, \
+
+                     const long n )
+{
+/* P U R P O S E
+ *
+ * Converts an array of floats into an array of doubles in place (the switch of the
+ * mixed precision, see f_apd_plan_create). The elements are converted in blocks
+ * from the end of the array, so that no float is overwritten before it is read. The
+ * array is accessed by memcpy only, since its effective type changes. */
+
+/* I N P U T   A R G U M E N T S
+ *
+ * [x] - array of n floats at the beginning of a memory block of (at least) n
+ *       doubles.
+ *
+ * [n] - number of elements.
+ */
+
+/* O U T P U T   A R G U M E N T S
+ *
+ * [x] - array of n doubles.
+ */
+
+/* R E T U R N   V A L U E
+ *
+ * None.
+ */
+    
+/* N O N S T A N D A R D   F U N C T I O N S   U S E D
+ *
+ * None.
+ */
+    
+    
+    /* Definitions and initializations */
+    
+    long i, k;
+
+    long n_b;
+
+    float xf[512];
+
+    double xd[512];
+
+    char *b = (char*) x;
+    
+    
+    
+    /* Blocks [i, i+n_b) are converted from the end of the array. The doubles of a
+     * block occupy the floats [2i, 2i+2n_b), which have all been read before,
+     * since the block is read completely before it is written */
+
+    for (i=n; i>0; )
+    {
+        n_b = (i > 512) ? 512 : i;
+
+        i = i - n_b;
+
+        memcpy(xf, b + i*sizeof(float), n_b*sizeof(float));
+
+        for (k=0; k<n_b; k++)
+
+            xd[k] = xf[k];
+
+        memcpy(b + i*sizeof(double), xd, n_b*sizeof(double));
+    }
+}
+
+
+
+
+void f_apd_demote ( void* x, \
+
+                    const long n )
+{
+/* P U R P O S E
+ *
+ * Converts an array of doubles into an array of floats in place (the warm start of
+ * a mixed-precision plan whose arrays have been promoted, see f_apd_promote). The
+ * elements are converted in blocks from the beginning of the array, so that no
+ * double is overwritten before it is read. The array is accessed by memcpy only,
+ * since its effective type changes. */
+
+/* I N P U T   A R G U M E N T S
+ *
+ * [x] - array of n doubles.
+ *
+ * [n] - number of elements.
+ */
+
+/* O U T P U T   A R G U M E N T S
+ *
+ * [x] - array of n floats at the beginning of the memory block of x.
+ */
+
+/* R E T U R N   V A L U E
+ *
+ * None.
+ */
+    
+/* N O N S T A N D A R D   F U N C T I O N S   U S E D
+ *
+ * None.
+ */
+    
+    
+    /* Definitions and initializations */
+    
+    long i, k;
+
+    long n_b;
+
+    float xf[512];
+
+    double xd[512];
+
+    char *b = (char*) x;
+    
+    
+    
+    /* Blocks [i, i+n_b) are converted from the beginning of the array. The floats
+     * of a block occupy the doubles [i/2, (i+n_b)/2), which have all been read
+     * before, since the block is read completely before it is written */
+
+    for (i=0; i<n; i=i+n_b)
+    {
+        n_b = (n-i > 512) ? 512 : n-i;
+
+        memcpy(xd, b + i*sizeof(double), n_b*sizeof(double));
+
+        for (k=0; k<n_b; k++)
+
+            xf[k] = (float) xd[k];
+
+        memcpy(b + i*sizeof(float), xf, n_b*sizeof(float));
+    }
+}
+
+
+
+#endif
+
+
+
+
+int APD_RF(f_apd_dft_mask) ( tAPD_Real* s, \
+                     
+                             const int D, \
+                     
+                             const long* N, \
+                     
+                             const long* iL, \
+
+                             const long* iR )
+{
+/* P U R P O S E
+ *
+ * Sets to zero all Fourier coefficients of s outside the passband of the modulator.
+ * The layout of s is the conjugate-even (CCE) format shared by all DFT backends. */
+
+/* I N P U T   A R G U M E N T S
+ *
+ * [s] - forward DFT of the signal in the CCE format.
+ *
+ * [D] - number of dimensions of the signal array.
+ *
+ * [N] - numbers of elements of the signal array in every dimension. The additional
+ *        two elements in the last dimension of s are not counted here.
+ *
+ * [iL] - indexes of the left cutoff frequencies.
+ *
+ * [iR] - indexes of the right cutoff frequencies.
+ */
+
+/* O U T P U T   A R G U M E N T S
+ *
+ * [s] - masked DFT of the signal (memory allocated externally).
+ */
+
+/* R E T U R N   V A L U E
+ *
+ * [exitflag] - exit flag. Any positive value indicates an error (for numerical and
+ *              textual definitions of the exit status, see l_ap_error_handling.c).
+ */
+
+/* N O N S T A N D A R D   F U N C T I O N S   U S E D
+ *
+ * None.
+ */
+    
+    
+    /* Definitions and initializations */
+    
+    int exitflag = 0;
+
+    f_apd_set_error (exitflag, __LINE__, APD_ERR_FILE);
+    
+    
+    long i1, i2;
+
+    long n_r;
+
+    long n_t;
+
+    long rs[3];
+    
+    
+    
+    /* Projection onto Mw in the Fourier domain. The zeroed coefficients are set
+     * in memory order by contiguous runs: the tail of every row above the cutoff of
+     * the last dimension, and whole rows (D = 2) or rows and planes (D = 3) in the
+     * stopbands of the other dimensions, which are adjacent in memory and are
+     * merged into one run each */
+
+    n_r = N[D-1]+2-(N[D-1]%2);
+
+    n_t = (2*iL[D-1] < n_r) ? n_r - 2*iL[D-1] : 0;
+    
+    
+    if (D == 1)
+    {
+        if (n_t > 0)
+
+            memset(s + 2*iL[0], 0, n_t*sizeof(tAPD_Real));
+    }
+    
+    else if (D == 2)
+    {
+        for (i1 = 0; i1 < N[0]; i1++)
+        {
+            if (i1 >= iL[0] && i1 <= iR[0])
+            {
+                memset(s + n_r*i1, 0, (iR[0]-i1+1)*n_r*sizeof(tAPD_Real));
+
+                i1 = iR[0];
+            }
+
+            else if (n_t > 0)
+
+                memset(s + n_r*i1 + 2*iL[1], 0, n_t*sizeof(tAPD_Real));
+        }
+    }
+        
+    else if (D == 3)
+    {
+        rs[2] = n_r;
+
+        rs[1] = n_r * N[1];
+
+        for (i1 = 0; i1 < N[0]; i1++)
+        {
+            if (i1 >= iL[0] && i1 <= iR[0])
+            {
+                memset(s + rs[1]*i1, 0, (iR[0]-i1+1)*rs[1]*sizeof(tAPD_Real));
+
+                i1 = iR[0];
+
+                continue;
+            }
+
+            for (i2 = 0; i2 < N[1]; i2++)
+            {
+                if (i2 >= iL[1] && i2 <= iR[1])
+                {
+                    memset(s + rs[1]*i1 + rs[2]*i2, 0, \
+                           (iR[1]-i2+1)*rs[2]*sizeof(tAPD_Real));
+
+                    i2 = iR[1];
+                }
+
+                else if (n_t > 0)
+
+                    memset(s + rs[1]*i1 + rs[2]*i2 + 2*iL[2], 0, \
+                           n_t*sizeof(tAPD_Real));
+            }
+        }
+    }
+        
+    else
+    {
+        f_apd_set_error(APD_ERR_ID_D,__LINE__,APD_ERR_FILE); goto failed;
+    }
+        
+    
+    
+    /* Output */
+    
+    finish:
+        
+        return exitflag;
+
+    failed:
+        
+        f_apd_get_error (&exitflag, NULL, NULL, NULL);
+
+        goto finish;
+ 
+}
+
+
+
+
+double APD_RF(f_apd_dft_power) ( const tAPD_Real* s, \
+                     
+                                 const int D, \
+                     
+                                 const long* N, \
+                     
+                                 const long* iL, \
+
+                                 const long* iR )
+{
+/* P U R P O S E
+ *
+ * Calculates the sum of squares of the signal whose DFT, masked by f_apd_dft_mask,
+ * is s. By Parseval's theorem, the sum equals (1/n) * sum |X|^2 over all Fourier
+ * coefficients X, of which only those in the passband are nonzero. In the CCE
+ * format, every stored coefficient of the last dimension except the first one
+ * (and the last one if N[D-1] is even) also stands for its complex conjugate,
+ * which is counted by the weight 2. The sum thus reads only the passband of s and
+ * replaces a pass over the whole signal array after the backward DFT. */
+
+/* I N P U T   A R G U M E N T S
+ *
+ * [s] - masked DFT of the signal in the CCE format (see f_apd_dft_mask).
+ *
+ * [D] - number of dimensions of the signal array.
+ *
+ * [N] - numbers of elements of the signal array in every dimension. The additional
+ *        two elements in the last dimension of s are not counted here.
+ *
+ * [iL] - indexes of the left cutoff frequencies.
+ *
+ * [iR] - indexes of the right cutoff frequencies.
+ */
+
+/* R E T U R N   V A L U E
+ *
+ * [sum] - sum of squares of the elements of the signal (inverse DFT of s).
+ */
+
+/* N O N S T A N D A R D   F U N C T I O N S   U S E D
+ *
+ * None.
+ */
+    
+    
+    /* Definitions and initializations */
+    
+    long i1, i2, k;
+
+    long n1, n2, n_k, o;
+
+    double n = 1;
+
+    double w;
+
+    double sum = 0;
+
+
+    for (i1=0; i1<D; i1++)
+
+        n = n * N[i1];
+
+
+    n1 = (D > 1) ? N[0] : 1;
+
+    n2 = (D > 2) ? N[1] : 1;
+
+    n_k = (iL[D-1] < N[D-1]/2+1) ? iL[D-1] : N[D-1]/2+1;
+    
+    
+    
+    /* Fourier coefficients in the passband (rows of the last dimension whose
+     * indexes lie outside [iL, iR] in the other dimensions) */
+
+    for (i1=0; i1<n1; i1++)
+    {
+        if (D > 1 && i1 >= iL[0] && i1 <= iR[0])
+
+            continue;
+
+        for (i2=0; i2<n2; i2++)
+        {
+            if (D > 2 && i2 >= iL[1] && i2 <= iR[1])
+
+                continue;
+
+            o = (i1*n2 + i2) * (N[D-1]/2+1) * 2;
+
+            for (k=0; k<n_k; k++)
+            {
+                w = (k == 0 || 2*k == N[D-1]) ? 1 : 2;
+
+                sum = sum + w * ((double) s[o+2*k] * s[o+2*k] + \
+                                 (double) s[o+2*k+1] * s[o+2*k+1]);
+            }
+        }
+    }
+        
+    
+    
+    /* Output */
+    
+    return sum / n;
+}
+
+
+
+
+void APD_RF(f_apd_dft_pad) ( tAPD_Real* s, \
+                     
+                             const int D, \
+                     
+                             const long* N, \
+                     
+                             const long* iL )
+{
+/* P U R P O S E
+ *
+ * Sets to zero the additional array elements of the last dimension of the signal
+ * after the backward DFT, if the passband includes the last Fourier coefficient of
+ * the last dimension. Otherwise, f_apd_dft_mask has set these elements to zero
+ * already. The elements are not part of the signal, but they enter the sums of the
+ * AP algorithms, which have to be consistent with f_apd_dft_power. */
+
+/* I N P U T   A R G U M E N T S
+ *
+ * [s] - signal + 2 additional array elements along the last dimension.
+ *
+ * [D] - number of dimensions of the signal array.
+ *
+ * [N] - numbers of elements of the signal array in every dimension. The additional
+ *        two elements in the last dimension of s are not counted here.
+ *
+ * [iL] - indexes of the left cutoff frequencies.
+ */
+
+/* O U T P U T   A R G U M E N T S
+ *
+ * [s] - signal with the additional elements set to zero.
+ */
+
+/* N O N S T A N D A R D   F U N C T I O N S   U S E D
+ *
+ * None.
+ */
+    
+    
+    long i1, i2;
+
+    long n_row = 1;
+
+    long rl = (N[D-1]/2+1)*2;
+
+
+    if (2*iL[D-1] <= N[D-1])
+
+        return;
+
+
+    for (i1=0; i1<D-1; i1++)
+
+        n_row = n_row * N[i1];
+
+    for (i1=0; i1<n_row; i1++)
+
+        for (i2=N[D-1]; i2<rl; i2++)
+
+            s[i1*rl+i2] = 0;
+}
+
+
+
+
+#ifndef APD_NO_MKL
+
+#ifndef APD_SINGLE
+
+int f_apd_mkl_dft_init ( const int D, \
+
+                         const long* N, \
+
+                         const int n_thr, \
+
+                         const long n_tr, \
+
+                         const int prec, \
+
+                         DFTI_DESCRIPTOR_HANDLE* dft_handle )
+{
+/* P U R P O S E
+ *
+ * Initializes Intel's Mkl DFT routine for AP algorithms. Two descriptors are
+ * created and committed: one for the forward transform (real input strides,
+ * conjugate-even output strides) and one for the backward transform (the strides
+ * swapped). Both remain valid for the whole AP iteration, so that the projection
+ * onto Mw does not need to modify or recommit any descriptor. If n_tr > 1, each
+ * descriptor computes n_tr transforms of arrays stored one after another (the
+ * channels of a multichannel signal) in one call. */
+
+/* I N P U T   A R G U M E N T S
+ *
+ * [D] - number of DFT dimensions.
+ *
+ * [N] - numbers of elements of the DFT array in every dimension.
+ *
+ * [n_thr] - maximum number of CPU threads used by each DFT computation. If
+ *           n_thr < 1, the number of threads is chosen by Intel MKL.
+ *
+ * [n_tr] - number of transforms computed in one call. The distance between the
+ *          arrays of consecutive transforms is the number of elements of the
+ *          padded array, 2*(N[0]*...*N[D-2])*(N[D-1]/2+1).
+ *
+ * [prec] - precision of the arrays: APD_PREC_DOUBLE (DFTI_DOUBLE) or
+ *          APD_PREC_SINGLE (DFTI_SINGLE).
+ *
+ * [dft_handle] - address of an array of two empty variables for the comitted
+ *                descriptor handles.
+ */
+
+/* O U T P U T   A R G U M E N T S
+ *
+ * [dft_handle] - array with the initialized and comitted descriptor handles of the
+ *                forward (dft_handle[0]) and backward (dft_handle[1]) transforms.
+ */
+
+/* R E T U R N   V A L U E
+ *
+ * [exitflag] - exit flag. Any positive value indicates an error (for numerical and
+ *              textual definitions of the exit status, see l_ap_error_handling.c).
+ * 
+ *              Upon an error, all memory dynamically allocated in this function or
+ *              functions called by this function is freed.
+ */
+
+/* N O N S T A N D A R D   F U N C T I O N S   U S E D
+ *
+ * (1) DftiCreateDescriptor, (2) DftiSetValue, (3) DftiCommitDescriptor.
+ */
+    
+    
+    /* Definitions and initializations */
+    
+    int exitflag = 0;
+
+    f_apd_set_error (exitflag, __LINE__, APD_ERR_FILE);
+    
+    
+    int i;
+    
+    int i_dir;
+    
+    long n = 1;
+    
+    MKL_LONG status;
+
+    MKL_LONG dist;
+    
+    MKL_LONG *N_ = NULL;
+    
+    MKL_LONG *rs = NULL;
+
+    MKL_LONG *cs = NULL;
+    
+    
+    dft_handle[0] = 0;
+    
+    dft_handle[1] = 0;
+    
+    
+    
+    /* Dimensions of the DFT */
+    
+    N_ = (MKL_LONG*) malloc(D*sizeof(MKL_LONG));
+        
+    if (N_==NULL)
+    {
+        f_apd_set_error(APD_ERR_ID_MEM,__LINE__,APD_ERR_FILE); goto failed;}
+        
+        
+    for (i=0; i < D; i++)
+    {
+        N_[i] = (MKL_LONG) N[i];
+            
+        n = n * N[i];
+    }
+
+    dist = (MKL_LONG) ((n / N[D-1]) * (N[D-1]/2+1));
+
+
+
+    /* DFT strides in real and conjugate domains */
+
+    rs = (MKL_LONG*) malloc((D+1)*sizeof(MKL_LONG));
+
+    if (rs==NULL)
+    {
+        f_apd_set_error(APD_ERR_ID_MEM,__LINE__,APD_ERR_FILE); goto failed;}
+
+
+    cs = (MKL_LONG*) malloc((D+1)*sizeof(MKL_LONG));
+
+    if (cs==NULL)
+    {
+        f_apd_set_error(APD_ERR_ID_MEM,__LINE__,APD_ERR_FILE); goto failed;}
+
+
+    cs[D] = 1;
+
+    rs[D] = 1;
+
+    cs[D-1] = (N[D-1]/2+1);
+
+    rs[D-1] = cs[D-1]*2;
+
+    for (i=D-2; i>0; i--)
+    {
+        cs[i] = cs[i+1] * N[i];
+
+        rs[i] = rs[i+1] * N[i];
+    }
+
+    cs[0] = 0;
+
+    rs[0] = 0;
+    
+    
+    
+    /* Forward (i_dir=0) and backward (i_dir=1) DFT descriptors */
+    
+    for (i_dir=0; i_dir<2; i_dir++)
+    {
+        if (D == 1)
+        
+            status = DftiCreateDescriptor ( dft_handle+i_dir, \
+                    (prec == APD_PREC_SINGLE) ? DFTI_SINGLE : DFTI_DOUBLE, \
+                    DFTI_REAL, (MKL_LONG) D, N_[0]);
+            
+        else
+            
+            status = DftiCreateDescriptor ( dft_handle+i_dir, \
+                    (prec == APD_PREC_SINGLE) ? DFTI_SINGLE : DFTI_DOUBLE, \
+                    DFTI_REAL, (MKL_LONG) D, N_);
+        
+        if (status != DFTI_NO_ERROR)
+        {
+            f_apd_set_error(APD_ERR_ID_FT1,__LINE__,APD_ERR_FILE); goto failed;}
+        
+        
+        
+        /* Strides of the descriptor. The input of the forward transform and the
+         * output of the backward transform are real, the other two conjugate. */
+        
+        status = DftiSetValue(dft_handle[i_dir], DFTI_INPUT_STRIDES, \
+                (i_dir == 0) ? rs : cs);
+
+        if (status != DFTI_NO_ERROR)
+        {
+            f_apd_set_error(APD_ERR_ID_FT2,__LINE__,APD_ERR_FILE); goto failed;}
+
+
+        status = DftiSetValue(dft_handle[i_dir], DFTI_OUTPUT_STRIDES, \
+                (i_dir == 0) ? cs : rs);
+
+        if (status != DFTI_NO_ERROR)
+        {
+            f_apd_set_error(APD_ERR_ID_FT2,__LINE__,APD_ERR_FILE); goto failed;}
+
+        
+        
+        /* Setting the calculations to be done in-place */
+        
+        status = DftiSetValue (dft_handle[i_dir], DFTI_PLACEMENT, DFTI_INPLACE);
+        
+        if (status != DFTI_NO_ERROR)
+        {
+            f_apd_set_error(APD_ERR_ID_FT2,__LINE__,APD_ERR_FILE); goto failed;}
+
+        
+        
+        /* Setting the data storage scheme in the Fourier domain */
+        
+        status = DftiSetValue (dft_handle[i_dir], DFTI_CONJUGATE_EVEN_STORAGE, \
+                DFTI_COMPLEX_COMPLEX);
+        
+        if (status != DFTI_NO_ERROR)
+        {
+            f_apd_set_error(APD_ERR_ID_FT2,__LINE__,APD_ERR_FILE); goto failed;}
+        
+        
+        status = DftiSetValue (dft_handle[i_dir], DFTI_PACKED_FORMAT, \
+                DFTI_CCE_FORMAT);
+        
+        if (status != DFTI_NO_ERROR)
+        {
+            f_apd_set_error(APD_ERR_ID_FT2,__LINE__,APD_ERR_FILE); goto failed;}
+
+        
+        
+        /* Setting the backward transform as the inverse transform */
+        
+        status = DftiSetValue (dft_handle[i_dir], DFTI_BACKWARD_SCALE, \
+                1.0/((double)n));
+        
+        if (status != DFTI_NO_ERROR)
+        {
+            f_apd_set_error(APD_ERR_ID_FT2,__LINE__,APD_ERR_FILE); goto failed;}
+
+        
+        
+        /* Number of transforms and the distance between their arrays in the real
+         * (2*dist elements) and conjugate (dist elements) domains */
+
+        if (n_tr > 1)
+        {
+            status = DftiSetValue (dft_handle[i_dir], DFTI_NUMBER_OF_TRANSFORMS, \
+                    (MKL_LONG) n_tr);
+
+            if (status != DFTI_NO_ERROR)
+            {
+                f_apd_set_error(APD_ERR_ID_FT2,__LINE__,APD_ERR_FILE); goto failed;}
+
+
+            status = DftiSetValue (dft_handle[i_dir], DFTI_INPUT_DISTANCE, \
+                    (i_dir == 0) ? 2*dist : dist);
+
+            if (status != DFTI_NO_ERROR)
+            {
+                f_apd_set_error(APD_ERR_ID_FT2,__LINE__,APD_ERR_FILE); goto failed;}
+
+
+            status = DftiSetValue (dft_handle[i_dir], DFTI_OUTPUT_DISTANCE, \
+                    (i_dir == 0) ? dist : 2*dist);
+
+            if (status != DFTI_NO_ERROR)
+            {
+                f_apd_set_error(APD_ERR_ID_FT2,__LINE__,APD_ERR_FILE); goto failed;}
+        }
+        
+        
+        
+        /* Limiting the number of CPU threads of the computations (e.g., to one
+         * thread when many DFTs run concurrently in a batch demodulation) */
+        
+        if (n_thr > 0)
+        {
+            status = DftiSetValue (dft_handle[i_dir], DFTI_THREAD_LIMIT, \
+                    (MKL_LONG) n_thr);
+        
+            if (status != DFTI_NO_ERROR)
+            {
+                f_apd_set_error(APD_ERR_ID_FT2,__LINE__,APD_ERR_FILE); goto failed;}
+        }
+
+        
+        
+        /* Commiting the DFT descriptor */
+
+        status = DftiCommitDescriptor (dft_handle[i_dir]);
+
+        if (status != DFTI_NO_ERROR)
+        {
+            f_apd_set_error(APD_ERR_ID_FT3,__LINE__,APD_ERR_FILE); goto failed;}
+    }
+
+    
+    
+    /* Output & Memory deallocation */
+    
+    finish:
+    
+        free(N_);
+
+        free(rs);
+
+        free(cs);
+        
+        return exitflag;
+                
+    failed:
+        
+        DftiFreeDescriptor(dft_handle);
+        
+        DftiFreeDescriptor(dft_handle+1);
+        
+        dft_handle[0] = 0;
+        
+        dft_handle[1] = 0;
+        
+        f_apd_get_error (&exitflag, NULL, NULL, NULL);
+
+        goto finish;
+        
+}
+
+
+
+
+#endif
+
+
+
+
+int APD_RF(f_apd_mkl_dft_PMw) ( tAPD_Real* s, \
+                     
+                                const int D, \
+                     
+                                const long* N, \
+                     
+                                const long* iL, \
+
+                                const long* iR, \
+                     
+                                DFTI_DESCRIPTOR_HANDLE* dft_handle, \
+
+                                double* pw )
+{
+/* P U R P O S E
+ *
+ * Implements the projection onto the set Mw by using the Intel's Mkl DFT routine. */
+
+/* I N P U T   A R G U M E N T S
+ *
+ * [s] - input signal + 2 additional array elements along the last dimension.
+ *
+ * [D] - number of dimensions of the signal array.
+ *
+ * [N] - numbers of elements of the signal array in every dimension. The additional
+ *        two elements in the last dimension of s are not counted here.
+ *
+ * [iL] - indexes of the left cutoff frequencies.
+ *
+ * [iR] - indexes of the right cutoff frequencies.
+ *
+ * [dft_handle] - array with the comitted descriptor handles of the forward and
+ *                backward transforms (see f_apd_mkl_dft_init).
+ *
+ * [pw] - address of a variable for the sum of squares of the projected signal, or
+ *        NULL if the sum is not needed.
+ */
+
+/* O U T P U T   A R G U M E N T S
+ *
+ * [s] - projected input signal (memory allocated externally).
+ *
+ * [pw] - sum of squares of the projected signal (if pw is not NULL), calculated in
+ *        the Fourier domain (see f_apd_dft_power).
+ */
+
+/* R E T U R N   V A L U E
+ *
+ * [exitflag] - exit flag. Any positive value indicates an error (for numerical and
+ *              textual definitions of the exit status, see l_ap_error_handling.c).
+ */
+
+/* N O N S T A N D A R D   F U N C T I O N S   U S E D
+ *
+ * (1) f_apd_print_error, (2) DftiComputeForward, (3) f_apd_dft_mask,
+ *
+ * (4) f_apd_dft_power, (5) DftiComputeBackward, (6) f_apd_dft_pad.
+ */
+    
+    
+    /* Definitions and initializations */
+    
+    int exitflag = 0;
+
+    f_apd_set_error (exitflag, __LINE__, APD_ERR_FILE);
+    
+    
+    MKL_LONG status;
+    
+    
+    
+    /* Forward FFT */
+        
+    status = DftiComputeForward (dft_handle[0], s);
+        
+    if (status != DFTI_NO_ERROR)
+    {
+        f_apd_set_error(APD_ERR_ID_FT4,__LINE__,APD_ERR_FILE); goto failed;}
+    
+    
+    
+    /* Projection onto Mw in the Fourier domain */
+    
+    exitflag = APD_RF(f_apd_dft_mask) (s, D, N, iL, iR);
+    
+    if (exitflag != APD_ERR_ID_NON) goto finish;
+
+    if (pw != NULL)
+
+        *pw = APD_RF(f_apd_dft_power) (s, D, N, iL, iR);
+        
+    
+    
+    /* Backward FFT */
+        
+    status = DftiComputeBackward (dft_handle[1], s);
+        
+    if (status != DFTI_NO_ERROR)
+    {
+        f_apd_set_error(APD_ERR_ID_FT4,__LINE__,APD_ERR_FILE); goto failed;}
+
+    APD_RF(f_apd_dft_pad) (s, D, N, iL);
+    
+    
+    
+    /* Output */
+    
+    finish:
+        
+        return exitflag;
+
+    failed:
+        
+        f_apd_get_error (&exitflag, NULL, NULL, NULL);
+
+        goto finish;
+ 
+}
+
+#endif
+
+
+
+
+#ifndef APD_SINGLE
+
+
+
+/* DFT backend used by f_apd_dft_init (see f_apd_set_dft_backend) */
+
+static int sgAPD_DFT_BACKEND = APD_DFT_DEFAULT;
+
+
+
+/* Precision of the last iterations and the number of iterations in single
+ * precision of the last demodulation in the calling thread (one per thread, see
+ * f_apd_get_precision) */
+
+static APD_TLS int sgAPD_PREC_LAST = APD_PREC_DOUBLE;
+
+static APD_TLS long sgAPD_PREC_ITER_SW = 0;
+
+
+
+
+/* DFT of the AP algorithms: the descriptors (handles) of the Intel MKL DFT or the
+ * plan of the built-in FFT, depending on the backend in use. For multichannel
+ * signals, n_tr channels are stored one after another at the distance dist, and
+ * the Intel MKL descriptors mkl[2] and mkl[3] transform all of them in one call.
+ * If f_apd_dft_prune selects the pruned FFT of l_apd_fft.c (1D signals with narrow
+ * passbands), pfft is used instead of both backends, which are freed. The Intel
+ * MKL descriptors are created for the precision prec of the arrays; the built-in
+ * and pruned FFTs compute in double precision for both precisions */
+
+struct strAPD_DFT {
+
+                    int          bk;
+
+                    #ifndef APD_NO_MKL
+
+                        DFTI_DESCRIPTOR_HANDLE mkl[4];
+
+                    #endif
+
+                    struct strAPD_RFFT* rfft;
+
+                    struct strAPD_PFFT* pfft;
+
+                    long         n_tr;
+
+                    long         dist;
+
+                    int          prec;
+
+                    int          n_thr;        // thread limit (also of the loops
+                                               // of the AP algorithms)
+
+                    double       scale;
+
+                  };
+
+
+
+
+int f_apd_set_dft_backend (int backend)
+{
+/* P U R P O S E
+ *
+ * Selects the DFT backend of all subsequent calls to the AP Demodulation library.
+ * The selection is shared by all threads of the program and, therefore, should be
+ * made before concurrent demodulations are started.
+ */
+
+/* I N P U T   A R G U M E N T S
+ *
+ * [backend] - DFT backend. Possible options are: APD_DFT_DEFAULT - Intel MKL DFT
+ *             if the library is compiled with Intel MKL, the built-in FFT
+ *             otherwise; APD_DFT_MKL - Intel MKL DFT; APD_DFT_BUILTIN - built-in
+ *             mixed-radix FFT (see l_apd_fft.c).
+ */
+
+/* O U T P U T   A R G U M E N T S
+ *
+ * None.
+ */
+
+/* R E T U R N   V A L U E
+ *
+ * [exitflag] - exit flag. Any positive value indicates an error (for numerical and
+ *              textual definitions of the exit status, see l_ap_error_handling.c).
+ *              Upon an error, the backend in use is not changed.
+ */
+
+/* N O N S T A N D A R D   F U N C T I O N S   U S E D
+ *
+ * None.
+ */
     
     
-    /* Calculation */
+    int exitflag = 0;
+
+    f_apd_set_error (exitflag, __LINE__, APD_ERR_FILE);
+
+
+    #ifdef APD_NO_MKL
+
+        if (backend == APD_DFT_MKL)
+        {
+            f_apd_set_error(APD_ERR_ID_FT5,__LINE__,APD_ERR_FILE); goto failed;}
+
+    #endif
+
+    if (backend != APD_DFT_DEFAULT && backend != APD_DFT_MKL && \
+            backend != APD_DFT_BUILTIN)
+    {
+        f_apd_set_error(APD_ERR_ID_FT5,__LINE__,APD_ERR_FILE); goto failed;}
+
+
+    sgAPD_DFT_BACKEND = backend;
+
+
+
+    /* Output */
     
-    if (D == 1)
+    finish:
+        
+        return exitflag;
+
+    failed:
+        
+        f_apd_get_error (&exitflag, NULL, NULL, NULL);
+
+        goto finish;
+}
+
+
+
+
+void f_apd_get_precision ( int* prec, \
+
+                           long* iter_sw )
+{
+/* P U R P O S E
+ *
+ * Outputs the precision of the last iterations and the number of iterations
+ * computed in single precision (the switchover point of the mixed precision, see
+ * f_apd_plan_create) of the last demodulation in the calling thread. For a
+ * multichannel plan, the precision is APD_PREC_DOUBLE if any channel was switched
+ * to double precision, and the number of iterations in single precision is the
+ * smallest one among the channels.
+ */
+
+/* I N P U T   A R G U M E N T S
+ *
+ * None.
+ */
+
+/* O U T P U T   A R G U M E N T S
+ *
+ * [prec] - precision of the last iterations, APD_PREC_DOUBLE or APD_PREC_SINGLE
+ *          (this is the address of an externally defined scalar variable). If
+ *          prec == NULL, no value is assigned.
+ *
+ * [iter_sw] - number of iterations computed in single precision, i.e., 0 in
+ *             double precision and all iterations in single precision or in mixed
+ *             precision without a switch (this is the address of an externally
+ *             defined scalar variable). If iter_sw == NULL, no value is assigned.
+ */
+
+/* R E T U R N   V A L U E
+ *
+ * None.
+ */
+
+/* N O N S T A N D A R D   F U N C T I O N S   U S E D
+ *
+ * None.
+ */
+
+    if (prec != NULL)
+
+        *prec = sgAPD_PREC_LAST;
+
+    if (iter_sw != NULL)
+
+        *iter_sw = sgAPD_PREC_ITER_SW;
+}
+
+
+
+
+void f_apd_get_options (struct strAPD_Opt* opt)
+{
+/* P U R P O S E
+ *
+ * Outputs the default options of the plans (the precision APD_PRECISION, see
+ * h_apd.h, the column-major layout, and no interleaved channels), which can be
+ * modified and given to f_apd_plan_create, to the jobs of
+ * f_apd_demodulation_batch, or to the streaming and out-of-core demodulations.
+ */
+
+/* I N P U T   A R G U M E N T S
+ *
+ * None.
+ */
+
+/* O U T P U T   A R G U M E N T S
+ *
+ * [opt] - default options (see f_apd_plan_create; memory allocated externally).
+ */
+
+/* R E T U R N   V A L U E
+ *
+ * None.
+ */
+
+/* N O N S T A N D A R D   F U N C T I O N S   U S E D
+ *
+ * None.
+ */
+
+    int i;
+
+
+    memset(opt, 0, sizeof(struct strAPD_Opt));
+
+    opt->Pr = APD_PRECISION;
+
+    opt->Ly = APD_LAYOUT_COL;
+
+    for (i=0; i<3; i++)
+    {
+        opt->St[i] = 1;
+
+        opt->Il[i] = 1;
+    }
+}
+
+
+
+
+int f_apd_options ( const struct strAPD_Opt* opt, \
+
+                    struct strAPD_Opt* out )
+{
+/* P U R P O S E
+ *
+ * Resolves the options of a demodulation plan: copies the options given to the plan
+ * or, if they are not given, the defaults (see f_apd_get_options), and validates
+ * them (the strides of a strided layout are checked against the signal by
+ * f_apd_layout_strides). */
+
+/* I N P U T   A R G U M E N T S
+ *
+ * [opt] - options of the plan (see f_apd_plan_create) or NULL.
+ */
+
+/* O U T P U T   A R G U M E N T S
+ *
+ * [out] - resolved options (memory allocated externally).
+ */
+
+/* R E T U R N   V A L U E
+ *
+ * [exitflag] - exit flag. Any positive value indicates an error (for numerical and
+ *              textual definitions of the exit status, see l_ap_error_handling.c).
+ */
+
+/* N O N S T A N D A R D   F U N C T I O N S   U S E D
+ *
+ * (1) f_apd_get_options.
+ */
+    
+    
+    int exitflag = 0;
+
+    f_apd_set_error (exitflag, __LINE__, APD_ERR_FILE);
+
+
+    if (opt != NULL)
+
+        *out = *opt;
+
+    else
+
+        f_apd_get_options (out);
+
+    if (out->Pr != APD_PREC_DOUBLE && out->Pr != APD_PREC_SINGLE && \
+            out->Pr != APD_PREC_MIXED)
+    {
+        f_apd_set_error(APD_ERR_ID_PR,__LINE__,APD_ERR_FILE); goto failed;}
+
+    if (out->Ly != APD_LAYOUT_COL && out->Ly != APD_LAYOUT_ROW && \
+            out->Ly != APD_LAYOUT_STRIDED)
+    {
+        f_apd_set_error(APD_ERR_ID_LAY,__LINE__,APD_ERR_FILE); goto failed;}
+
+    if (out->Il[0] < 1 || out->Il[1] < 1 || out->Il[2] < 1)
+    {
+        f_apd_set_error(APD_ERR_ID_IL,__LINE__,APD_ERR_FILE); goto failed;}
+
+
+
+    /* Output */
+    
+    finish:
+        
+        return exitflag;
+
+    failed:
+        
+        f_apd_get_error (&exitflag, NULL, NULL, NULL);
+
+        goto finish;
+}
+
+
+
+
+int f_apd_layout_strides ( const struct strAPD_Par* Par, \
+
+                           const double* t, \
+
+                           const struct strAPD_Opt* opt, \
+
+                           long* St )
+{
+/* P U R P O S E
+ *
+ * Computes the strides of the arrays of a signal in the layout of the options of a
+ * plan and checks whether they describe a dense layout. The strides count the
+ * sample points of one channel (the numbers of interleaved channels of the arrays
+ * are applied by f_apd_s_Ub_load and f_apd_m_readout). */
+
+/* I N P U T   A R G U M E N T S
+ *
+ * [Par] - demodulation parameters (see f_apd_demodulation).
+ *
+ * [t] - sampling coordinates (see f_apd_demodulation) or NULL. The sample points
+ *       of a nonuniformly sampled signal are adjacent (all strides are set to 1).
+ *
+ * [opt] - resolved options of the plan (.Ly and .St are used, see f_apd_options).
+ */
+
+/* O U T P U T   A R G U M E N T S
+ *
+ * [St] - strides of the arrays in every dimension (memory allocated externally,
+ *        three elements).
+ */
+
+/* R E T U R N   V A L U E
+ *
+ * [dense] - 1 if the layout is dense (i.e., valid), 0 otherwise.
+ */
+
+/* N O N S T A N D A R D   F U N C T I O N S   U S E D
+ *
+ * None.
+ */
+    
+    
+    int i, j;
+
+    long n_d;
+
+
+    St[0] = 1; St[1] = 1; St[2] = 1;
+
+    if (t != NULL || Par->D == 1)
+
+        return 1;
+
+
+    for (i=0; i<(Par->D); i++)
+
+        if (opt->Ly == APD_LAYOUT_STRIDED)
+
+            St[i] = opt->St[i];
+
+        else if (opt->Ly == APD_LAYOUT_ROW)
+
+            St[Par->D-1-i] = (i == 0) ? 1 : St[Par->D-i] * Par->Ns[Par->D-i];
+
+        else
+
+            St[i] = (i == 0) ? 1 : St[i-1] * Par->Ns[i-1];
+
+
+    /* Dense layout: the stride of every dimension is the product of the numbers of
+     * sample points of the dimensions with smaller strides (equal strides are
+     * ordered by the dimensions) */
+
+    for (i=0; i<(Par->D); i++)
     {
-       /* Forward FFT */
-        
-        status = DftiComputeForward (*dft_handle, s);
-        
-        if (status != DFTI_NO_ERROR)
-        {
-            f_apd_set_error(APD_ERR_ID_FT4,__LINE__,APD_ERR_FILE); goto failed;}
-        
-        
-        
-        /* Projection onto Mw in the Fourier domain */
-        
-        for (i1 = 2*iL[0]; i1 < N[0]+2; i1++)
-            
-            s[i1] = 0;
-        
-        
-        
-        /* Backward FFT */
-        
-        status = DftiComputeBackward (*dft_handle, s);
-        
-        if (status != DFTI_NO_ERROR)
-        {
-            f_apd_set_error(APD_ERR_ID_FT4,__LINE__,APD_ERR_FILE); goto failed;}
+        n_d = 1;
+
+        for (j=0; j<(Par->D); j++)
+
+            if (St[j] < St[i] || (St[j] == St[i] && j < i))
+
+                n_d = n_d * Par->Ns[j];
+
+        if (St[i] != n_d)
+
+            return 0;
     }
+
+
+    return 1;
+}
+
+
+
+
+void f_apd_dft_free (struct strAPD_DFT* dft)
+{
+/* P U R P O S E
+ *
+ * Frees the descriptors or plans held by dft (initialized by f_apd_dft_init). The
+ * structure itself is not freed.
+ */
+
+    #ifndef APD_NO_MKL
+
+        DftiFreeDescriptor (dft->mkl);
+
+        DftiFreeDescriptor (dft->mkl+1);
+
+        DftiFreeDescriptor (dft->mkl+2);
+
+        DftiFreeDescriptor (dft->mkl+3);
+
+        dft->mkl[0] = 0;
+
+        dft->mkl[1] = 0;
+
+        dft->mkl[2] = 0;
+
+        dft->mkl[3] = 0;
+
+    #endif
+
+    f_apd_rfft_free (dft->rfft);
+
+    f_apd_pfft_free (dft->pfft);
+
+    dft->rfft = NULL;
+
+    dft->pfft = NULL;
+}
+
+
+
+
+int f_apd_dft_init ( const int D, \
+
+                     const long* N, \
+
+                     const int n_thr, \
+
+                     const long n_tr, \
+
+                     const int prec, \
+
+                     struct strAPD_DFT* dft )
+{
+/* P U R P O S E
+ *
+ * Initializes the DFT of the AP algorithms with the backend selected by
+ * f_apd_set_dft_backend. */
+
+/* I N P U T   A R G U M E N T S
+ *
+ * [D] - number of DFT dimensions.
+ *
+ * [N] - numbers of elements of the DFT array in every dimension.
+ *
+ * [n_thr] - maximum number of CPU threads used by each DFT computation (Intel MKL
+ *           only; the built-in FFT always uses one thread) and by the OpenMP-
+ *           parallel loops of the AP algorithms. If n_thr < 1, the number of
+ *           threads is chosen by Intel MKL and OpenMP, respectively.
+ *
+ * [n_tr] - number of channels of the signal (see f_apd_dft_PMw_mc).
+ *
+ * [prec] - precision of the arrays of the signal: APD_PREC_DOUBLE (f_apd_dft_PMw)
+ *          or APD_PREC_SINGLE (f_apd_dft_PMw_f).
+ *
+ * [dft] - address of the (uninitialized) structure of the DFT.
+ */
+
+/* O U T P U T   A R G U M E N T S
+ *
+ * [dft] - initialized structure of the DFT. It must be released by f_apd_dft_free,
+ *         also upon an error.
+ */
+
+/* R E T U R N   V A L U E
+ *
+ * [exitflag] - exit flag. Any positive value indicates an error (for numerical and
+ *              textual definitions of the exit status, see l_ap_error_handling.c).
+ */
+
+/* N O N S T A N D A R D   F U N C T I O N S   U S E D
+ *
+ * (1) f_apd_mkl_dft_init, (2) f_apd_rfft_init.
+ */
     
-    else
-    {
-        /* Calculation of strides in real and conjugate domains */
-        
-        rs = (MKL_LONG*) malloc((D+1)*sizeof(MKL_LONG));
     
-        if (rs==NULL)
+    int exitflag = 0;
+
+    f_apd_set_error (exitflag, __LINE__, APD_ERR_FILE);
+
+
+    int i;
+
+    double n = 1;
+
+
+    for (i=0; i<D; i++)
+
+        n = n * N[i];
+
+    dft->scale = 1.0/n;
+
+    dft->rfft = NULL;
+
+    dft->pfft = NULL;
+
+    dft->n_tr = n_tr;
+
+    dft->prec = prec;
+
+    dft->n_thr = n_thr;
+
+    dft->dist = (long) (n / N[D-1]) * 2 * (N[D-1]/2+1);
+
+    dft->bk = sgAPD_DFT_BACKEND;
+
+
+    #ifdef APD_NO_MKL
+
+        dft->bk = APD_DFT_BUILTIN;
+
+    #else
+
+        dft->mkl[0] = 0;
+
+        dft->mkl[1] = 0;
+
+        dft->mkl[2] = 0;
+
+        dft->mkl[3] = 0;
+
+        if (dft->bk == APD_DFT_DEFAULT)
+
+            dft->bk = APD_DFT_MKL;
+
+        if (dft->bk == APD_DFT_MKL)
         {
-            f_apd_set_error(APD_ERR_ID_MEM,__LINE__,APD_ERR_FILE); goto failed;}
+            exitflag = f_apd_mkl_dft_init (D, N, n_thr, 1, prec, dft->mkl);
+
+            if (exitflag == APD_ERR_ID_NON && n_tr > 1)
+
+                exitflag = f_apd_mkl_dft_init (D, N, n_thr, n_tr, prec, \
+                                               dft->mkl+2);
+
+            return exitflag;
+        }
+
+    #endif
+
+
+    return f_apd_rfft_init (D, N, prec, &(dft->rfft));
+}
+
+
+
+
+int f_apd_dft_prune ( struct strAPD_DFT* dft, \
+
+                      const int D, \
+
+                      const long* N, \
+
+                      const long* iL )
+{
+/* P U R P O S E
+ *
+ * Selects the pruned FFT of l_apd_fft.c for the projection onto Mw of a 1D signal
+ * if it is estimated to be faster than the DFT backend of dft (see
+ * f_apd_pfft_select). The pruned FFT computes only the Fourier coefficients in the
+ * passband, whose number, iL[0], is often much smaller than N[0]. For very narrow
+ * passbands, it reduces to direct sums over the signal. The full DFT of the
+ * backend is then freed. For D > 1, dft is not modified. */
+
+/* I N P U T   A R G U M E N T S
+ *
+ * [dft] - structure of the DFT initialized by f_apd_dft_init.
+ *
+ * [D] - number of dimensions of the signal array.
+ *
+ * [N] - numbers of elements of the signal array in every dimension.
+ *
+ * [iL] - indexes of the left cutoff frequencies.
+ */
+
+/* O U T P U T   A R G U M E N T S
+ *
+ * [dft] - structure of the DFT, possibly with the plan of the pruned FFT.
+ */
+
+/* R E T U R N   V A L U E
+ *
+ * [exitflag] - exit flag. Any positive value indicates an error (for numerical and
+ *              textual definitions of the exit status, see l_ap_error_handling.c).
+ */
+
+/* N O N S T A N D A R D   F U N C T I O N S   U S E D
+ *
+ * (1) f_apd_pfft_select, (2) f_apd_pfft_init, (3) f_apd_dft_free.
+ */
+
+
+    int exitflag;
+
+    long p;
+
+    struct strAPD_PFFT *pfft = NULL;
+
+
+    if (D != 1 || dft->pfft != NULL)
+
+        return APD_ERR_ID_NON;
+
+
+    p = f_apd_pfft_select (N[0], iL[0], dft->bk == APD_DFT_MKL);
+
+    if (p == 0)
+
+        return APD_ERR_ID_NON;
+
+
+    exitflag = f_apd_pfft_init (N[0], p, iL[0], &pfft);
+
+    if (exitflag != APD_ERR_ID_NON)
+
+        return exitflag;
+
+
+    /* The full DFT is not used by the projection any more (the plan of the built-in
+     * FFT holds scratch arrays and twiddles of the size of the signal) */
+
+    f_apd_dft_free (dft);
+
+    dft->pfft = pfft;
+
+    return APD_ERR_ID_NON;
+}
+
+
+
+
+#endif
+
+
+
+
+int APD_RF(f_apd_dft_PMw) ( tAPD_Real* s, \
+                     
+                            const int D, \
+                     
+                            const long* N, \
+                     
+                            const long* iL, \
+
+                            const long* iR, \
+                     
+                            struct strAPD_DFT* dft, \
+
+                            double* pw )
+{
+/* P U R P O S E
+ *
+ * Implements the projection onto the set Mw by using the DFT backend of dft. */
+
+/* I N P U T   A R G U M E N T S
+ *
+ * [s] - input signal + 2 additional array elements along the last dimension.
+ *
+ * [D] - number of dimensions of the signal array.
+ *
+ * [N] - numbers of elements of the signal array in every dimension. The additional
+ *        two elements in the last dimension of s are not counted here.
+ *
+ * [iL] - indexes of the left cutoff frequencies.
+ *
+ * [iR] - indexes of the right cutoff frequencies.
+ *
+ * [dft] - structure of the DFT initialized by f_apd_dft_init.
+ *
+ * [pw] - address of a variable for the sum of squares of the projected signal, or
+ *        NULL if the sum is not needed.
+ */
+
+/* O U T P U T   A R G U M E N T S
+ *
+ * [s] - projected input signal (memory allocated externally).
+ *
+ * [pw] - sum of squares of the projected signal (if pw is not NULL), calculated in
+ *        the Fourier domain (see f_apd_dft_power).
+ */
+
+/* R E T U R N   V A L U E
+ *
+ * [exitflag] - exit flag. Any positive value indicates an error (for numerical and
+ *              textual definitions of the exit status, see l_ap_error_handling.c).
+ */
+
+/* N O N S T A N D A R D   F U N C T I O N S   U S E D
+ *
+ * (1) f_apd_pfft_forward, (2) f_apd_dft_power, (3) f_apd_pfft_backward,
+ *
+ * (4) f_apd_mkl_dft_PMw, (5) f_apd_rfft_forward, (6) f_apd_dft_mask,
+ *
+ * (7) f_apd_rfft_backward, (8) f_apd_dft_pad.
+ */
     
-        
-        cs = (MKL_LONG*) malloc((D+1)*sizeof(MKL_LONG));
     
-        if (cs==NULL)
-        {
-            f_apd_set_error(APD_ERR_ID_MEM,__LINE__,APD_ERR_FILE); goto failed;}
-        
+    int exitflag = 0;
+
+    long i;
+
+
+    if (dft->pfft != NULL)
+    {
+        APD_RF(f_apd_pfft_forward) (dft->pfft, s);
+
+        if (pw != NULL)
+
+            *pw = f_apd_dft_power (dft->pfft->X, D, N, iL, iR);
+
+        APD_RF(f_apd_pfft_backward) (dft->pfft, s, dft->scale);
+
+        for (i=N[0]; i<N[0]+2-(N[0]%2); i++)
+
+            s[i] = 0;
+
+        return exitflag;
+    }
+
+
+    #ifndef APD_NO_MKL
+
+        if (dft->bk == APD_DFT_MKL)
+
+            return APD_RF(f_apd_mkl_dft_PMw) (s, D, N, iL, iR, dft->mkl, pw);
+
+    #endif
+
+
+    APD_RF(f_apd_rfft_forward) (dft->rfft, s);
+
+    exitflag = APD_RF(f_apd_dft_mask) (s, D, N, iL, iR);
+
+    if (exitflag != APD_ERR_ID_NON)
+
+        return exitflag;
+
+    if (pw != NULL)
+
+        *pw = APD_RF(f_apd_dft_power) (s, D, N, iL, iR);
+
+    APD_RF(f_apd_rfft_backward) (dft->rfft, s, dft->scale);
+
+    APD_RF(f_apd_dft_pad) (s, D, N, iL);
+
+    return exitflag;
+}
+
+
+
+
+int APD_RF(f_apd_dft_PMw_mc) ( tAPD_Real* s, \
+
+                               const long* act, \
+
+                               const long n_act, \
+                     
+                               const int D, \
+                     
+                               const long* N, \
+                     
+                               const long* iL, \
+
+                               const long* iR, \
+                     
+                               struct strAPD_DFT* dft, \
+
+                               double* pw )
+{
+/* P U R P O S E
+ *
+ * Implements the projection onto the set Mw of the active channels of a
+ * multichannel signal. If more than half of the channels are active and the Intel
+ * MKL DFT is in use, all channels are transformed by one batched DFT (the inactive
+ * channels are projected too, which does not affect their outputs). Otherwise, the
+ * active channels are projected one after another. */
+
+/* I N P U T   A R G U M E N T S
+ *
+ * [s] - channels of the input signal (each with 2 additional array elements along
+ *       the last dimension) stored one after another at the distance dft->dist.
+ *
+ * [act] - indexes of the active channels.
+ *
+ * [n_act] - number of the active channels.
+ *
+ * [D], [N], [iL], [iR] - see f_apd_dft_PMw.
+ *
+ * [dft] - structure of the DFT initialized by f_apd_dft_init.
+ *
+ * [pw] - array for the sums of squares of the projected channels (element k for
+ *        channel k), or NULL if the sums are not needed.
+ */
+
+/* O U T P U T   A R G U M E N T S
+ *
+ * [s] - projected channels of the input signal (memory allocated externally).
+ *
+ * [pw] - sums of squares of the projected active channels (if pw is not NULL),
+ *        calculated in the Fourier domain (see f_apd_dft_power).
+ */
+
+/* R E T U R N   V A L U E
+ *
+ * [exitflag] - exit flag. Any positive value indicates an error (for numerical and
+ *              textual definitions of the exit status, see l_ap_error_handling.c).
+ */
+
+/* N O N S T A N D A R D   F U N C T I O N S   U S E D
+ *
+ * (1) DftiComputeForward, (2) f_apd_dft_mask, (3) f_apd_dft_power,
+ *
+ * (4) DftiComputeBackward, (5) f_apd_dft_pad, (6) f_apd_dft_PMw.
+ */
+    
     
-        cs[D] = 1;
+    int exitflag = 0;
+
+    long i;
 
-        rs[D] = 1;
 
-        cs[D-1] = (N[D-1]/2+1);
+    #ifndef APD_NO_MKL
 
-        rs[D-1] = cs[D-1]*2;
+        MKL_LONG status;
 
-        for (i1=D-2; i1>0; i1--)
+        if (dft->bk == APD_DFT_MKL && dft->pfft == NULL && dft->n_tr > 1 && \
+                2*n_act > dft->n_tr)
         {
-            cs[i1] = cs[i1+1] * N[i1];
+            status = DftiComputeForward (dft->mkl[2], s);
 
-            rs[i1] = rs[i1+1] * N[i1];
-        }
-        
-        cs[0] = 0;
-        
-        rs[0] = 0;
-        
-        
+            if (status != DFTI_NO_ERROR)
+            {
+                f_apd_set_error(APD_ERR_ID_FT4,__LINE__,APD_ERR_FILE); goto failed;}
 
-        /* Update of strides of the FFT descriptor for the forward transform */
-        
-        status = DftiSetValue(*dft_handle, DFTI_INPUT_STRIDES, rs);
-        
-        if (status != DFTI_NO_ERROR)
-        {
-            f_apd_set_error(APD_ERR_ID_FT2,__LINE__,APD_ERR_FILE); goto failed;}
-        
-        
-        status = DftiSetValue(*dft_handle, DFTI_OUTPUT_STRIDES, cs);
-        
-        if (status != DFTI_NO_ERROR)
-        {
-            f_apd_set_error(APD_ERR_ID_FT2,__LINE__,APD_ERR_FILE); goto failed;}
-        
-        
 
-        /* Commiting the descriptor */
-    
-        status = DftiCommitDescriptor (*dft_handle);
+            for (i=0; i<(dft->n_tr) && exitflag == APD_ERR_ID_NON; i++)
 
-        if (status != DFTI_NO_ERROR)
-        {
-            f_apd_set_error(APD_ERR_ID_FT3,__LINE__,APD_ERR_FILE); goto failed;}
+                exitflag = APD_RF(f_apd_dft_mask) (s + i*(dft->dist), D, N, \
+                                                   iL, iR);
 
-        
-        
-        /* Forward FFT */
-        
-        status = DftiComputeForward (*dft_handle, s);
-        
-        if (status != DFTI_NO_ERROR)
-        {
-            f_apd_set_error(APD_ERR_ID_FT4,__LINE__,APD_ERR_FILE); goto failed;}
+            if (exitflag != APD_ERR_ID_NON)
 
-        
-        
-        /* Projection onto Mw in the Fourier domain */
-        
-        if (D == 2)
-        {
-            for (i2 = 2*iL[1]; i2 < N[1]+2-(N[0]%2); i2++)
-                
-                for (i1 = 0; i1 < N[0]; i1++)
-                    
-                    s[rs[1]*i1+rs[2]*i2] = 0;
-            
-            for (i2 = 0; i2 < 2*iL[1]; i2++)
-                
-                for (i1 = iL[0]; i1 <= iR[0]; i1++)
-                    
-                    s[rs[1]*i1+rs[2]*i2] = 0;
-        }
-        
-        else if (D == 3)
-        {
-            for (i3 = 2*iL[2]; i3 < N[2]+2-(N[0]%2); i3++)
-                
-                for (i2 = 0; i2 < N[1]; i2++)
-                
-                    for (i1 = 0; i1 < N[0]; i1++)
+                return exitflag;
 
-                        s[rs[1]*i1+rs[2]*i2+rs[3]*i3] = 0;
-            
-            for (i3 = 0; i3 < 2*iL[2]; i3++)
-                
-                for (i2 = iL[1]; i2 <= iR[1]; i2++)
-                
-                    for (i1 = 0; i1 < N[0]; i1++)
+            for (i=0; i<n_act && pw != NULL; i++)
 
-                        s[rs[1]*i1+rs[2]*i2+rs[3]*i3] = 0;
-            
-            for (i3 = 0; i3 < 2*iL[2]; i3++)
-                
-                for (i1 = iL[0]; i1 <= iR[0]; i1++)
-                {
-                    for (i2 = 0; i2 < iL[1]; i2++)
+                pw[act[i]] = APD_RF(f_apd_dft_power) (s + act[i]*(dft->dist), \
+                                                      D, N, iL, iR);
 
-                        s[rs[1]*i1+rs[2]*i2+rs[3]*i3] = 0;
-                    
-                    for (i2 = iR[1]+1; i2 < N[1]; i2++)
 
-                        s[rs[1]*i1+rs[2]*i2+rs[3]*i3] = 0;
-                }
-        }
-            
-        else
-        {
-            f_apd_set_error(APD_ERR_ID_D,__LINE__,APD_ERR_FILE); goto failed;
+            status = DftiComputeBackward (dft->mkl[3], s);
+
+            if (status != DFTI_NO_ERROR)
+            {
+                f_apd_set_error(APD_ERR_ID_FT4,__LINE__,APD_ERR_FILE); goto failed;}
+
+            for (i=0; i<(dft->n_tr); i++)
+
+                APD_RF(f_apd_dft_pad) (s + i*(dft->dist), D, N, iL);
+
+            return exitflag;
         }
 
-        
-        
-        /* Update of strides of the FFT descriptor for the backward transform */
-        
-        status = DftiSetValue(*dft_handle, DFTI_INPUT_STRIDES, cs);
-        
-        if (status != DFTI_NO_ERROR)
-        {
-            f_apd_set_error(APD_ERR_ID_FT2,__LINE__,APD_ERR_FILE); goto failed;}
-        
-        
-        status = DftiSetValue(*dft_handle, DFTI_OUTPUT_STRIDES, rs);
-        
-        if (status != DFTI_NO_ERROR)
-        {
-            f_apd_set_error(APD_ERR_ID_FT2,__LINE__,APD_ERR_FILE); goto failed;}
-        
-        
-        
-        /* Commiting the descriptor */
-    
-        status = DftiCommitDescriptor (*dft_handle);
+    #endif
 
-        if (status != DFTI_NO_ERROR)
-        {
-            f_apd_set_error(APD_ERR_ID_FT3,__LINE__,APD_ERR_FILE); goto failed;}
-        
-        
-        
-        /* Backward FFT */
-        
-        status = DftiComputeBackward (*dft_handle, s);
+
+    for (i=0; i<n_act && exitflag == APD_ERR_ID_NON; i++)
+
+        exitflag = APD_RF(f_apd_dft_PMw) (s + act[i]*(dft->dist), D, N, iL, iR, \
+                                          dft, (pw != NULL) ? pw + act[i] : NULL);
+
+    return exitflag;
+
+    #ifndef APD_NO_MKL
+
+        failed:
         
-        if (status != DFTI_NO_ERROR)
-        {
-            f_apd_set_error(APD_ERR_ID_FT4,__LINE__,APD_ERR_FILE); goto failed;}
+            f_apd_get_error (&exitflag, NULL, NULL, NULL);
+
+            return exitflag;
+
+    #endif
+}
+
+
+
+
+
+#ifndef APD_SINGLE
+
+
+
+/* (9) PARTITION OF THE LOOPS OF THE AP ALGORITHMS */
+
+
+
+long f_apd_blocks ( const int D, \
+
+                    const long* N, \
+
+                    const long nx_2, \
+
+                    long* i_blk )
+{
+/* P U R P O S E
+ *
+ * Splits the (padded) signal array of the AP algorithms into blocks, which are
+ * processed in parallel (if the library is compiled with OpenMP) and whose partial
+ * sums are combined by f_apd_tree_sum. The blocks depend only on the shape of the
+ * signal, so that the results do not depend on the number of threads. For D > 1,
+ * the blocks consist of whole rows of the padded last dimension; for D = 1, their
+ * boundaries are multiples of 8 elements (64 bytes). Arrays with fewer than
+ * 2*APD_OMP_BLK_MIN elements form one block, so that their sums are calculated
+ * in the original order.
+ */
+
+/* I N P U T   A R G U M E N T S
+ *
+ * [D] - number of signal dimensions.
+ *
+ * [N] - numbers of elements of the signal in every dimension.
+ *
+ * [nx_2] - number of elements of the padded signal array.
+ */
+
+/* O U T P U T   A R G U M E N T S
+ *
+ * [i_blk] - boundaries of the blocks: block b consists of the elements
+ *           i_blk[b], ..., i_blk[b+1]-1 (memory allocated externally for
+ *           APD_OMP_NBLK+1 elements).
+ */
+
+/* R E T U R N   V A L U E
+ *
+ * [n_blk] - number of blocks (1 ≤ n_blk ≤ APD_OMP_NBLK).
+ */
+
+
+    /* Definitions and initializations */
+
+    long b;
+
+    long unit = 8;
+
+    long n_unit;
+
+    long n_blk = nx_2 / APD_OMP_BLK_MIN;
+
+
+
+    /* Block unit and the number of blocks */
+
+    if (D > 1)
+
+        unit = N[D-1] + 2 - (N[D-1] % 2);
+
+    n_unit = (nx_2 + unit - 1) / unit;
+
+    if (n_blk > APD_OMP_NBLK)
+
+        n_blk = APD_OMP_NBLK;
+
+    if (n_blk > n_unit)
+
+        n_blk = n_unit;
+
+    if (n_blk < 1)
+
+        n_blk = 1;
+
+
+
+    /* Block boundaries */
+
+    for (b=0; b<=n_blk; b++)
+    {
+        i_blk[b] = ((b * n_unit) / n_blk) * unit;
+
+        if (i_blk[b] > nx_2)
+
+            i_blk[b] = nx_2;
     }
-    
-    
-    
-    /* Output & Memory deallocation */
-    
-    finish:
-        
-        free(rs);
-    
-        free(cs);
-        
-        return exitflag;
 
-    failed:
-        
-        f_apd_get_error (&exitflag, NULL, NULL, NULL);
 
-        goto finish;
- 
+    return n_blk;
+}
+
+
+
+
+double f_apd_tree_sum ( double* part, \
+
+                        const long n )
+{
+/* P U R P O S E
+ *
+ * Sums partial sums in a fixed pairwise (tree) order, which does not depend on
+ * the number of threads that calculated them.
+ */
+
+/* I N P U T   A R G U M E N T S
+ *
+ * [part] - partial sums. This input argument is modified in-place!
+ *
+ * [n] - number of partial sums (positive).
+ */
+
+/* R E T U R N   V A L U E
+ *
+ * [sum] - sum of the partial sums.
+ */
+
+
+    long b;
+
+    long w;
+
+
+    for (w=1; w<n; w=2*w)
+
+        for (b=0; b+w<n; b=b+2*w)
+
+            part[b] = part[b] + part[b+w];
+
+
+    return part[0];
 }
 
+#endif
@@ -0,0 +1,538 @@
+
+/*                       C O P Y R I G H T   N O T I C E
+ *
+ * Copyright ©2021. Institute of Science and Technology Austria (IST Austria).
+ * All Rights Reserved. The underlying technology is protected by PCT Patent
+ * Application No. PCT/EP2021/054650.
+ *
+ * This file is part of the AP Demodulation library, which is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation in version 2.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY, without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE. See the GNU General Public License v2 for more details. You
+ * should have received a copy of the GNU General Public License v2 along with this
+ * program. If not, see https://www.gnu.org/licenses/.
+ *
+ * Contact the Technology Transfer Office, IST Austria, Am Campus 1,
+ * A-3400 Klosterneuburg, Austria, +43-(0)2243 9000, twist@ist.ac.at, for commercial
+ * licensing opportunities.
+ *
+ * See https://github.com/mgabriel-lt/ap-demodulation for the latest version of the
+ * code and user-friendly explanations on the working principle, domains of
+ * application, and advice on the usage of different AP Demodulation algorithms in
+ * practice.
+ */
+
+
+/* C O N T E N T S
+ *
+ * The batch demodulation, which demodulates many independent signals concurrently
+ * on a pool of POSIX threads. Every worker thread keeps a small cache of
+ * demodulation plans (work arrays and DFTs limited to one CPU thread), which is
+ * reused by consecutive jobs with the same parameters. Jobs are distributed among
+ * the workers in contiguous ranges; a worker that runs out of jobs steals half of
+ * the remaining range of another worker:
+ *
+ * (1) APD_BATCH_NPLAN and strAPD_Worker,
+ *
+ * (2) f_apd_batch_next,
+ *
+ * (3) f_apd_batch_worker,
+ *
+ * (4) f_apd_demodulation_batch.
+ *
+ * If the macro APD_NO_PTHREADS is defined, all jobs are run in the calling thread.
+ */
+
+
+
+#include "h_apd.h"
+
+
+
+/* (1) WORKER OF THE BATCH DEMODULATION */
+
+/* Number of demodulation plans cached by each worker */
+
+#define APD_BATCH_NPLAN 8
+
+
+/* Worker thread: its range of jobs [lo, hi), protected by the lock, and its cache
+ * of plans (the most recently used first) */
+
+struct strAPD_Worker {
+
+                    #ifndef APD_NO_PTHREADS
+
+                        pthread_mutex_t lock;
+
+                        pthread_t    thread;
+
+                    #endif
+
+                    long         lo;
+
+                    long         hi;
+
+                    int          id;
+
+                    int          n_wrk;
+
+                    struct strAPD_Worker* wrk;
+
+                    struct strAPD_Job* jobs;
+
+                    struct strAPD_Plan* plan[APD_BATCH_NPLAN];
+
+                   };
+
+
+
+
+/* (2)-(4) FUNCTIONS OF THE BATCH DEMODULATION */
+
+long f_apd_batch_next (struct strAPD_Worker* W)
+{
+/* P U R P O S E
+ *
+ * Takes the next job from the range of the worker. If the range is empty, steals
+ * the upper half of the remaining range of another worker.
+ */
+
+/* I N P U T   A R G U M E N T S
+ *
+ * [W] - worker.
+ */
+
+/* O U T P U T   A R G U M E N T S
+ *
+ * [W] - worker with the updated range of jobs.
+ */
+
+/* R E T U R N   V A L U E
+ *
+ * [i_job] - index of the job, or -1 if no jobs are left.
+ */
+
+/* N O N S T A N D A R D   F U N C T I O N S   U S E D
+ *
+ * None.
+ */
+
+    long i_job = -1;
+
+    long lo;
+
+    long hi;
+
+    int i;
+
+    struct strAPD_Worker *V;
+
+
+
+    /* Own range */
+
+    #ifndef APD_NO_PTHREADS
+
+        pthread_mutex_lock (&(W->lock));
+
+    #endif
+
+    if (W->lo < W->hi)
+
+        i_job = (W->lo)++;
+
+    #ifndef APD_NO_PTHREADS
+
+        pthread_mutex_unlock (&(W->lock));
+
+    #endif
+
+    if (i_job >= 0)
+
+        return i_job;
+
+
+
+    /* Stealing from the other workers (the owner takes jobs from the lower end of
+     * its range, the thief from the upper end) */
+
+    for (i=1; i<(W->n_wrk); i++)
+    {
+        V = W->wrk + (W->id + i) % (W->n_wrk);
+
+        lo = hi = 0;
+
+        #ifndef APD_NO_PTHREADS
+
+            pthread_mutex_lock (&(V->lock));
+
+        #endif
+
+        if (V->lo < V->hi)
+        {
+            hi = V->hi;
+
+            lo = hi - (V->hi - V->lo + 1)/2;
+
+            V->hi = lo;
+        }
+
+        #ifndef APD_NO_PTHREADS
+
+            pthread_mutex_unlock (&(V->lock));
+
+        #endif
+
+        if (lo < hi)
+        {
+            #ifndef APD_NO_PTHREADS
+
+                pthread_mutex_lock (&(W->lock));
+
+            #endif
+
+            W->lo = lo + 1;
+
+            W->hi = hi;
+
+            #ifndef APD_NO_PTHREADS
+
+                pthread_mutex_unlock (&(W->lock));
+
+            #endif
+
+            return lo;
+        }
+    }
+
+    return -1;
+}
+
+
+
+
+void* f_apd_batch_worker (void* arg)
+{
+/* P U R P O S E
+ *
+ * Runs the jobs of the worker (and the jobs stolen from the other workers) until
+ * no jobs are left.
+ */
+
+/* I N P U T   A R G U M E N T S
+ *
+ * [arg] - worker (struct strAPD_Worker*).
+ */
+
+/* O U T P U T   A R G U M E N T S
+ *
+ * [arg] - worker with the updated cache of plans. The exit flags, iteration
+ *         numbers, precisions, and outputs are written to the jobs.
+ */
+
+/* R E T U R N   V A L U E
+ *
+ * NULL.
+ */
+
+/* N O N S T A N D A R D   F U N C T I O N S   U S E D
+ *
+ * (1) f_apd_batch_next, (2) f_apd_plan_match, (3) f_apd_plan_init,
+ *
+ * (4) f_apd_plan_execute, (5) f_apd_plan_destroy, (6) f_apd_get_precision,
+ *
+ * (7) f_apd_options.
+ */
+
+    struct strAPD_Worker *W = (struct strAPD_Worker*) arg;
+
+    struct strAPD_Job *J;
+
+    struct strAPD_Plan *plan;
+
+    struct strAPD_Opt O;
+
+    long i_job;
+
+    int i;
+
+    int Ub_flag;
+
+
+
+    while ((i_job = f_apd_batch_next (W)) >= 0)
+    {
+        J = W->jobs + i_job;
+
+        J->iter = 0;
+
+        J->iter_sw = 0;
+
+        Ub_flag = (J->Ub != NULL);
+
+        J->exitflag = f_apd_options (J->opt, &O);
+
+        if (J->exitflag != APD_ERR_ID_NON)
+
+            continue;
+
+
+
+        /* Plan from the cache (moved to its front) or a new plan replacing the
+         * least recently used one */
+
+        for (i=0; i<APD_BATCH_NPLAN; i++)
+
+            if (W->plan[i] != NULL && f_apd_plan_match (W->plan[i], J->Par, J->t, \
+                    Ub_flag, &O))
+
+                break;
+
+        if (i == APD_BATCH_NPLAN)
+        {
+            i = APD_BATCH_NPLAN - 1;
+
+            f_apd_plan_destroy (W->plan[i]);
+
+            W->plan[i] = NULL;
+
+            J->exitflag = f_apd_plan_init (J->Par, J->t, Ub_flag, 1, 1, &O, \
+                                          NULL, 0, W->plan+i);
+
+            if (J->exitflag != APD_ERR_ID_NON)
+
+                continue;
+        }
+
+        plan = W->plan[i];
+
+        for (; i>0; i--)
+
+            W->plan[i] = W->plan[i-1];
+
+        W->plan[0] = plan;
+
+
+
+        /* Demodulation */
+
+        J->exitflag = f_apd_plan_execute (plan, J->s, J->Ub, J->out_m, J->out_e, \
+                &(J->iter));
+
+        f_apd_get_precision (&(J->prec), &(J->iter_sw));
+    }
+
+    return NULL;
+}
+
+
+
+
+int f_apd_demodulation_batch ( struct strAPD_Job* jobs, \
+
+                               const long n_jobs, \
+
+                               const int n_threads )
+{
+/* P U R P O S E
+ *
+ * Demodulates many independent signals (jobs) concurrently on a pool of threads.
+ * Every job is demodulated as by f_apd_demodulation, but the DFTs of each job are
+ * computed by one CPU thread and the work arrays and DFTs are reused by the
+ * consecutive jobs of a thread that have the same parameters (the same values of
+ * the fields of Par, the same address t, and a compatible Ub).
+ */
+
+/* I N P U T   A R G U M E N T S
+ *
+ * [jobs] - array of the jobs. The fields .s, .Par, .Ub, .t, .out_m, and .out_e
+ *          of every job have the meaning of the arguments of f_apd_demodulation
+ *          with the same names. The field .opt holds the options of the job (see
+ *          f_apd_plan_create) or NULL for the defaults (see f_apd_get_options).
+ *          Different jobs may share Par, t, and opt, but their output arrays
+ *          must not overlap.
+ *
+ * [n_jobs] - number of jobs.
+ *
+ * [n_threads] - number of threads (including the calling thread). If
+ *               n_threads < 1, the number of online processors is used.
+ */
+
+/* O U T P U T   A R G U M E N T S
+ *
+ * [jobs] - jobs with the outputs (.out_m and .out_e), the numbers of AP iterations
+ *          (.iter), the precisions of the last iterations and the numbers of
+ *          iterations in single precision (.prec and .iter_sw, see
+ *          f_apd_get_precision), and the exit flags (.exitflag) of their
+ *          demodulations. An error of one job does not affect the other jobs.
+ */
+
+/* R E T U R N   V A L U E
+ *
+ * [exitflag] - exit flag of the batch itself (not of its jobs). Any positive value
+ *              indicates an error (for numerical and textual definitions of the
+ *              exit status, see l_ap_error_handling.c).
+ * 
+ *              Upon an error, all memory dynamically allocated in this function or
+ *              functions called by this function is freed.
+ */
+
+/* N O N S T A N D A R D   F U N C T I O N S   U S E D
+ *
+ * (1) f_apd_batch_worker, (2) f_apd_plan_destroy.
+ */
+    
+    
+    /* Definitions and initializations */
+    
+    int exitflag = 0;
+
+    f_apd_set_error (exitflag, __LINE__, APD_ERR_FILE);
+
+
+    int i;
+
+    int j;
+
+    int n_wrk = n_threads;
+
+    #ifndef APD_NO_PTHREADS
+
+        int n_run = 1;
+
+    #endif
+
+    struct strAPD_Worker *W = NULL;
+
+
+    if (n_jobs <= 0)
+
+        return exitflag;
+
+
+
+    /* Number of workers */
+
+    #ifdef APD_NO_PTHREADS
+
+        n_wrk = 1;
+
+    #else
+
+        #ifdef _SC_NPROCESSORS_ONLN
+
+            if (n_wrk < 1)
+
+                n_wrk = (int) sysconf(_SC_NPROCESSORS_ONLN);
+
+        #endif
+
+    #endif
+
+    if (n_wrk < 1)
+
+        n_wrk = 1;
+
+    if (n_wrk > n_jobs)
+
+        n_wrk = (int) n_jobs;
+
+
+
+    /* Workers with equal contiguous ranges of jobs */
+
+    W = (struct strAPD_Worker*) calloc(n_wrk, sizeof(struct strAPD_Worker));
+
+    if (W==NULL)
+    {
+        f_apd_set_error(APD_ERR_ID_MEM,__LINE__,APD_ERR_FILE); goto failed;}
+
+
+    for (i=0; i<n_wrk; i++)
+    {
+        W[i].lo = (n_jobs * i) / n_wrk;
+
+        W[i].hi = (n_jobs * (i+1)) / n_wrk;
+
+        W[i].id = i;
+
+        W[i].n_wrk = n_wrk;
+
+        W[i].wrk = W;
+
+        W[i].jobs = jobs;
+
+        #ifndef APD_NO_PTHREADS
+
+            pthread_mutex_init (&(W[i].lock), NULL);
+
+        #endif
+    }
+
+
+
+    /* Demodulation. Worker 0 is the calling thread. If a thread cannot be started,
+     * its jobs are stolen by the running workers. */
+
+    #ifndef APD_NO_PTHREADS
+
+        for (i=1; i<n_wrk; i++)
+        {
+            if (pthread_create (&(W[i].thread), NULL, f_apd_batch_worker, W+i) != 0)
+
+                break;
+
+            n_run++;
+        }
+
+    #endif
+
+    f_apd_batch_worker (W);
+
+    #ifndef APD_NO_PTHREADS
+
+        for (i=1; i<n_run; i++)
+
+            pthread_join (W[i].thread, NULL);
+
+    #endif
+
+    f_apd_set_error (exitflag, __LINE__, APD_ERR_FILE);
+
+
+
+    /* Output & Memory deallocation */
+
+    finish:
+
+        if (W != NULL)
+        {
+            for (i=0; i<n_wrk; i++)
+            {
+                for (j=0; j<APD_BATCH_NPLAN; j++)
+
+                    f_apd_plan_destroy (W[i].plan[j]);
+
+                #ifndef APD_NO_PTHREADS
+
+                    pthread_mutex_destroy (&(W[i].lock));
+
+                #endif
+            }
+        }
+
+        free(W);
+
+        return exitflag;
+
+    failed:
+
+        f_apd_get_error (&exitflag, NULL, NULL, NULL);
+
+        goto finish;
+
+}
@@ -28,16 +28,16 @@
 
 /* C O N T E N T S
  *
- * Static global variables and functions for error handling and error message
- * formating and printing + a function for checking the validity of input parameters
- * for f_apd_demodulation:
+ * Static global (and thread-local) variables and functions for error handling and
+ * error message formating and printing + a function for checking the validity of
+ * input parameters for f_apd_demodulation:
  *
- * (1) sgAPD_ERR_ID, sgAPD_ERR_EXIT, sgAPD_ERR_LINE, sgAPD_ERR_FILE, and
+ * (1) APD_TLS, sgAPD_ERR_ID, sgAPD_ERR_EXIT, sgAPD_ERR_LINE, sgAPD_ERR_FILE, and
  *     sgAPD_ERR_MSG.
  * 
  * (2) f_apd_set_errexit, f_apd_set_error, f_apd_get_error, and f_apd_print_error.
  * 
- * (3) f_apd_input_validation.
+ * (3) f_apd_s_Ub_validation, f_apd_m0_validation, and f_apd_input_validation.
  */
 
 
@@ -48,24 +48,46 @@
 
 /* (1) STATIC GLOBAL VARIABLES FOR ERROR HANDLING */
 
-/* Variable with the numeric id of the error status */
+/* Storage class of the error state. Every thread has its own copy of the error
+ * state, so that demodulations running concurrently in different threads of one
+ * process do not overwrite each other's error ids, lines, and filenames */
 
-static int sgAPD_ERR_ID = 0;
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
 
+    #define APD_TLS _Thread_local
 
-/* Variable that indicates the behavior of the program upon error */
+#elif defined(_MSC_VER)
+
+    #define APD_TLS __declspec(thread)
+
+#else
+
+    #define APD_TLS __thread
+
+#endif
+
+
+/* Variable with the numeric id of the error status (one per thread) */
+
+static APD_TLS int sgAPD_ERR_ID = 0;
+
+
+/* Variable that indicates the behavior of the program upon error (shared by all
+ * threads; it is only read by the library and written by f_apd_set_errexit) */
 
 static int sgAPD_ERR_EXIT = 1;
 
 
-/* Variable that holds the line no. of the file where the error occurs */
+/* Variable that holds the line no. of the file where the error occurs (one per
+ * thread) */
 
-static long sgAPD_ERR_LINE = 0;
+static APD_TLS long sgAPD_ERR_LINE = 0;
 
 
-/* Variable that holds the name of the code file where the error occurs */
+/* Variable that holds the name of the code file where the error occurs (one per
+ * thread) */
 
-static char sgAPD_ERR_FILE[200] = "";
+static APD_TLS char sgAPD_ERR_FILE[200] = "";
 
 
 /* Variable that holds error messages (see h_apd.h for definitions of the
@@ -143,10 +165,67 @@ const char *sgAPD_ERR_MSG[] = {
     "argument t, must consist of real numbers!",                           //
                                                                            //
     /* For C++ version */
-    "The second input argument has to be a NULL pointer!"                  //[24]
+    "The second input argument has to be a NULL pointer!",                 //[24]
+                                                                           //
+    /* DFT backends */
+    "The requested DFT backend is not available in this build!",           //[25]
+                                                                           //
+    /* Demodulation plans */
+    "The upper bound on the modulator, Ub, can be used only with a plan "  //[26]
+    "created with the nonzero argument Ub_flag (see f_apd_plan_create)!",  //
+                                                                           //
+    "The number of channels of a multichannel plan, n_ch, must be "        //[27]
+    "positive!",                                                           //
+                                                                           //
+    "The precision must be APD_PREC_DOUBLE, APD_PREC_SINGLE, or "          //[28]
+    "APD_PREC_MIXED (see f_apd_plan_create)!",                             //
+                                                                           //
+    /* Warm start */
+    "The initial modulator, m0, must consist of finite nonnegative "       //[29]
+    "numbers!",                                                            //
+                                                                           //
+    "The plan holds no state of a previous demodulation to start from "    //[30]
+    "(m0 = NULL, see f_apd_plan_execute_warm)!",                           //
+                                                                           //
+    /* Streaming demodulation */
+    "A stream requires Par.D = 1, hop > 0, xfade >= 0, and edges "         //[31]
+    "(Par.Ns[0]-hop-xfade)/2 of at least Par.Fs[0]/(Pi*Par.Fc[0]) "        //
+    "samples (see f_apd_stream_create)!",                                  //
+                                                                           //
+    "The output of the stream must be pulled before the stream is "        //[32]
+    "flushed (see f_apd_stream_flush)!",                                   //
+                                                                           //
+    /* Out-of-core demodulation */
+    "Out-of-core demodulation requires Par.D = 1, n_ch > 0, 0 < acc < 1, " //[33]
+    "and mem > 0 (see f_apd_demodulation_mmap)!",                          //
+                                                                           //
+    "The signal or modulator file cannot be opened, sized, or mapped "     //[34]
+    "into memory (see f_apd_demodulation_mmap)!",                          //
+                                                                           //
+    "The memory budget, mem, is too small for the segments required by "   //[35]
+    "the accuracy target, acc (see f_apd_demodulation_mmap)!",             //
+                                                                           //
+    /* Workspace of the plans */
+    "The workspace must be aligned to 64 bytes and at least as large as "  //[36]
+    "computed by f_apd_plan_workspace_size (see f_apd_plan_create_ws)!",   //
+                                                                           //
+    /* Statistics */
+    "The trace file cannot be written (see f_apd_write_trace)!",           //[37]
+                                                                           //
+    /* Layout */
+    "The layout must be APD_LAYOUT_COL, APD_LAYOUT_ROW, or APD_LAYOUT_"    //[38]
+    "STRIDED with positive strides of a dense layout of the signal (see "  //
+    "f_apd_plan_create)!",                                                 //
+    "The numbers of interleaved channels must be positive and not "        //[39]
+    "smaller than the number of channels of a plan (see "                  //
+    "f_apd_plan_create)!",                                                 //
+                                                                           //
+    /* Typed input */
+    "The type of the input signal must be APD_TYPE_F64, APD_TYPE_F32, "    //[40]
+    "APD_TYPE_I16, or APD_TYPE_I32 (see f_apd_plan_execute_typed)!",       //
                                                                            //
     /* Invalid error id */
-    "Invalid error id provided to f_apd_print_error!"                       //[25]
+    "Invalid error id provided to f_apd_print_error!"                       //[41]
     };
 
 
@@ -158,15 +237,19 @@ void f_apd_set_errexit (int err_exit)
 {
 /* P U R P O S E
  *
- * Stores the indicator of the behavior of f_apd_demodulation upon an error.
+ * Stores the indicator of the behavior of f_apd_demodulation upon an error. The
+ * indicator is shared by all threads of the program and, therefore, should be set
+ * before concurrent demodulations are started.
  */
 
 /* I N P U T   A R G U M E N T S
  *
  * [err_exit] - indicator of the behavior of f_apd_demodulation upon an error.
- *              0 sets f_apd_demodulation to return control to the calling function.
- *              Any nonzero value sets f_apd_demodulation to print the error message
- *              to stderr and exit the whole program.
+ *              0 sets f_apd_demodulation to return control to the calling function
+ *              silently. Any nonzero value sets f_apd_demodulation to print the
+ *              error message to stderr before returning control to the calling
+ *              function. In both cases, the error id is returned as the exit flag;
+ *              the library never terminates the calling program.
  */
 
 /* O U T P U T   A R G U M E N T S
@@ -198,7 +281,8 @@ void f_apd_set_error ( const int err_id, \
 {
 /* P U R P O S E
  *
- * Stores the line number and the filename associated to the error.
+ * Stores the error id, the line number, and the filename associated to the error in
+ * the error state of the calling thread.
  */
 
 /* I N P U T   A R G U M E N T S
@@ -234,11 +318,8 @@ void f_apd_set_error ( const int err_id, \
 
 
     if (sgAPD_ERR_EXIT != 0 && err_id != APD_ERR_ID_NON)
-    {
+    
         f_apd_print_error (err_id);
-
-        exit(err_id);
-    }
 }
 
 
@@ -254,8 +335,8 @@ void f_apd_get_error ( int* err_id, \
 {
 /* P U R P O S E
  *
- * Outputs the line number, the filename, and the error message associated with the
- * provided error id.
+ * Outputs the id, the line number, the filename, and the message of the last error
+ * state set in the calling thread.
  */
 
 /* I N P U T   A R G U M E N T S
@@ -365,7 +446,176 @@ void f_apd_print_error (int err_id)
 
 
 
-/* (3) FUNCTION FOR INPUT VALIDATION */
+/* (3) FUNCTIONS FOR INPUT VALIDATION */
+
+int f_apd_s_Ub_validation ( const double* s, \
+
+                            const double* Ub, \
+
+                            const long ns, \
+
+                            const long st, \
+
+                            const long st_u )
+{
+/* SHORT DESCRIPTION
+ *
+ * Checks the validity of the signal and upper bound arrays for f_apd_demodulation
+ * and f_apd_plan_execute.
+ */
+
+/* INPUT ARGUMENTS
+ *
+ * [s] - input signal.
+ *
+ * [Ub] - upper bound on the modulator. This array must have the same number of
+ *        elements as the input signal or must be set to NULL (if no upper bound on
+ *        the modulator is assumed).
+ *
+ * [ns] - number of sample points of the input signal.
+ *
+ * [st], [st_u] - strides of the sample points in s and Ub, respectively (see
+ *                 f_apd_plan_create).
+ */
+
+/* O U T P U T   A R G U M E N T S
+ *
+ * None.
+ */
+
+/* R E T U R N   V A L U E
+ *
+ * [exitflag] - exit flag. Any positive value indicates an error (for numerical and
+ *              textual definitions of the exit status, see l_ap_error_handling.c).
+ */
+
+/* N O N S T A N D A R D   F U N C T I O N S   U S E D
+ *
+ * None.
+ */
+    
+    
+    
+    /* Definition and initialization of the local variables */
+
+    int exitflag = 0;
+
+    long i;
+    
+    
+    
+    for (i=0; i < ns*st; i=i+st)
+    {
+        if ( !isfinite(s[i]) )
+        {
+            f_apd_set_error(APD_ERR_ID_S,__LINE__,APD_ERR_FILE); goto failed;}
+    }
+    
+    
+    
+    if (Ub != NULL)
+    {
+        for (i=0; i < ns; i++)
+        {
+            if ( !isfinite(Ub[i*st_u]) || Ub[i*st_u] < fabs(s[i*st]))
+            {
+                f_apd_set_error(APD_ERR_ID_UB,__LINE__,APD_ERR_FILE); goto failed;}
+        }
+    }
+    
+    
+    
+    /* Output */
+
+    finish:
+    
+        return exitflag;
+
+    failed:
+
+        f_apd_get_error (&exitflag, NULL, NULL, NULL);
+
+        goto finish;
+    
+}
+
+
+
+
+int f_apd_m0_validation ( const double* m0, \
+
+                          const long ns, \
+
+                          const long st )
+{
+/* SHORT DESCRIPTION
+ *
+ * Checks the validity of the initial modulator for f_apd_plan_execute_warm.
+ */
+
+/* INPUT ARGUMENTS
+ *
+ * [m0] - initial modulator (or NULL, which is valid).
+ *
+ * [ns] - number of sample points of the input signal.
+ *
+ * [st] - stride of the sample points in m0 (see f_apd_plan_create).
+ */
+
+/* O U T P U T   A R G U M E N T S
+ *
+ * None.
+ */
+
+/* R E T U R N   V A L U E
+ *
+ * [exitflag] - exit flag. Any positive value indicates an error (for numerical and
+ *              textual definitions of the exit status, see l_ap_error_handling.c).
+ */
+
+/* N O N S T A N D A R D   F U N C T I O N S   U S E D
+ *
+ * None.
+ */
+    
+    
+    
+    /* Definition and initialization of the local variables */
+
+    int exitflag = 0;
+
+    long i;
+    
+    
+    
+    if (m0 != NULL)
+    {
+        for (i=0; i < ns*st; i=i+st)
+        {
+            if ( !isfinite(m0[i]) || m0[i] < 0)
+            {
+                f_apd_set_error(APD_ERR_ID_M0,__LINE__,APD_ERR_FILE); goto failed;}
+        }
+    }
+    
+    
+    
+    /* Output */
+
+    finish:
+    
+        return exitflag;
+
+    failed:
+
+        f_apd_get_error (&exitflag, NULL, NULL, NULL);
+
+        goto finish;
+    
+}
+
+
+
 
 int f_apd_input_validation ( const double* s, \
 
@@ -382,7 +632,8 @@ int f_apd_input_validation ( const double* s, \
     
 /* INPUT ARGUMENTS
  *
- * [s] - input signal.
+ * [s] - input signal. If s == NULL, only the parameters and the sampling
+ *       coordinates are checked (see f_apd_plan_create).
  *
  * [Par] - pointer to the structure with demodulation parameters:
  *
@@ -584,27 +835,11 @@ int f_apd_input_validation ( const double* s, \
     
     
     
-    if (exitflag == 0)
-    {
-        for (i=0; i < Ns; i++)
-        {
-            if ( !isfinite(s[i]) )
-            {
-                f_apd_set_error(APD_ERR_ID_S,__LINE__,APD_ERR_FILE); goto failed;}
-        }
-    }
-    
-    
-    
-    if (exitflag == 0 && Ub != NULL)
+    if (exitflag == 0 && s != NULL)
     {
+        exitflag = f_apd_s_Ub_validation (s, Ub, Ns, 1, 1);
         
-        for (i=0; i < Ns; i++)
-        {
-            if ( !isfinite(Ub[i]) || Ub[i] < fabs(s[i]))
-            {
-                f_apd_set_error(APD_ERR_ID_UB,__LINE__,APD_ERR_FILE); goto failed;}
-        }
+        if (exitflag != APD_ERR_ID_NON) goto finish;
     }
     
     
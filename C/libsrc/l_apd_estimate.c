@@ -0,0 +1,684 @@
+/*                       C O P Y R I G H T   N O T I C E
+ *
+ * Copyright ©2021. Institute of Science and Technology Austria (IST Austria).
+ * All Rights Reserved. The underlying technology is protected by PCT Patent
+ * Application No. PCT/EP2021/054650.
+ *
+ * This file is part of the AP Demodulation library, which is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation in version 2.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY, without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE. See the GNU General Public License v2 for more details. You
+ * should have received a copy of the GNU General Public License v2 along with this
+ * program. If not, see https://www.gnu.org/licenses/.
+ *
+ * Contact the Technology Transfer Office, IST Austria, Am Campus 1,
+ * A-3400 Klosterneuburg, Austria, +43-(0)2243 9000, twist@ist.ac.at, for commercial
+ * licensing opportunities.
+ *
+ * See https://github.com/mgabriel-lt/ap-demodulation for the latest version of the
+ * code and user-friendly explanations on the working principle, domains of
+ * application, and advice on the usage of different AP Demodulation algorithms in
+ * practice.
+ */
+
+
+/* C O N T E N T S
+ *
+ * The pre-flight estimate of a demodulation, which predicts its memory, DFT,
+ * floating-point operations, and time before any memory of the signal size is
+ * allocated, e.g., to size the memory budgets and thread counts of batch jobs. The
+ * memory is computed from the layout of the memory block of the plan and the sizes
+ * of the plans of the built-in FFTs. The time is extrapolated from a calibration of
+ * the DFT and the elementwise kernels on the current host:
+ *
+ * (1) APD_EST_TW and sgAPD_EST_CAL,
+ *
+ * (2) f_apd_est_cfft_flops, f_apd_est_dft_flops, and f_apd_est_smooth,
+ *
+ * (3) f_apd_est_calibrate,
+ *
+ * (4) f_apd_estimate.
+ */
+
+
+
+#include "h_apd.h"
+
+
+
+/* (1) COST MODEL AND CALIBRATION */
+
+/* Floating-point operations of one term of the twiddle sums of the pruned FFT (one
+ * Fourier coefficient and one pair of subsequences, see f_apd_pfft_forward) */
+
+#define APD_EST_TW 18.0
+
+
+/* Last calibration in the calling thread (one per thread; D = 0 if none), which is
+ * reused by estimates with the same calibration signal, DFT, and threads */
+
+struct strAPD_EstCal {
+
+                    int          D;
+
+                    long         N[3];
+
+                    long         iL[3];
+
+                    char         Al;
+
+                    int          Ub_flag;
+
+                    int          prec;
+
+                    int          bk;
+
+                    int          n_thr;
+
+                    double       t_dft;
+
+                    double       t_cd;
+
+                   };
+
+static APD_TLS struct strAPD_EstCal sgAPD_EST_CAL = {0, {0}, {0}, 0, 0, 0, 0, 0, \
+                                                     0, 0};
+
+
+
+
+/* (2)-(4) FUNCTIONS OF THE PRE-FLIGHT ESTIMATE */
+
+static double f_apd_est_cfft_flops (const long n)
+{
+/* Floating-point operations of the complex FFT of length n: 5*n*log2(n) for the
+ * mixed-radix FFT, two power-of-two FFTs and the products with the chirp for
+ * Bluestein's algorithm (see f_apd_cfft_init) */
+
+    int nf;
+
+    int fac[APD_FFT_MAXF];
+
+    long mb = 1;
+
+
+    if (n < 2)
+
+        return 0;
+
+    if (f_apd_cfft_factor (n, fac, &nf) == 1)
+
+        return 5.0 * n * log2((double) n);
+
+    while (mb < 2*n-1)
+
+        mb = 2 * mb;
+
+    return 10.0 * mb * log2((double) mb) + 6.0 * mb + 12.0 * n;
+}
+
+
+
+
+double f_apd_est_dft_flops ( const int D, \
+
+                             const long* N, \
+
+                             const long* iL, \
+
+                             const long p )
+{
+/* P U R P O S E
+ *
+ * Estimates the number of floating-point operations of one projection onto Mw of
+ * one channel (the forward and backward real DFTs and the scaling of the result).
+ */
+
+/* I N P U T   A R G U M E N T S
+ *
+ * [D], [N], [iL] - number of dimensions, numbers of elements, and indexes of the
+ *                  left cutoff frequencies of the signal.
+ *
+ * [p] - length of the short DFTs of the pruned FFT (see f_apd_pfft_select), or 0
+ *       if the full DFT is computed.
+ */
+
+/* R E T U R N   V A L U E
+ *
+ * [flops] - number of floating-point operations.
+ */
+
+/* N O N S T A N D A R D   F U N C T I O N S   U S E D
+ *
+ * (1) f_apd_est_cfft_flops.
+ */
+
+    int i;
+
+    double nx = 1;
+
+    double nx_2;
+
+    double f;
+
+
+    for (i=0; i<D; i++)
+
+        nx = nx * N[i];
+
+    nx_2 = (nx / N[D-1]) * (N[D-1]+2-(N[D-1]%2));
+
+
+    /* Pruned FFT: short DFTs of the pairs of subsequences and the twiddle sums of
+     * the retained coefficients */
+
+    if (p > 0)
+
+        return 2 * (nx / (2.0*p) * f_apd_est_cfft_flops(p) + \
+                    APD_EST_TW * iL[0] * nx / p) + nx_2;
+
+
+    /* Full real FFT: FFTs of the rows (packed into half length with the split of
+     * the result for even N[D-1]) and complex FFTs along the other dimensions */
+
+    if (N[D-1] % 2 == 0)
+
+        f = nx / N[D-1] * (f_apd_est_cfft_flops(N[D-1]/2) + 5.0 * N[D-1]);
+
+    else
+
+        f = nx / N[D-1] * f_apd_est_cfft_flops(N[D-1]);
+
+    for (i=0; i<D-1; i++)
+
+        f = f + nx_2 / 2 / N[i] * f_apd_est_cfft_flops(N[i]);
+
+    return 2 * f + nx_2;
+}
+
+
+
+
+static long f_apd_est_smooth (const long n)
+{
+/* Largest number not larger than n (and not smaller than 2) without prime factors
+ * larger than 5 */
+
+    long m, r;
+
+
+    for (m=n; m>2; m--)
+    {
+        r = m;
+
+        while (r % 2 == 0) r = r / 2;
+
+        while (r % 3 == 0) r = r / 3;
+
+        while (r % 5 == 0) r = r / 5;
+
+        if (r == 1)
+
+            return m;
+    }
+
+    return 2;
+}
+
+
+
+
+int f_apd_est_calibrate ( const struct strAPD_Plan* P, \
+
+                          const int bk, \
+
+                          const long p, \
+
+                          double* t_dft, \
+
+                          double* t_cd )
+{
+/* P U R P O S E
+ *
+ * Extrapolates the time per iteration of the projections onto Mw and onto Cd of
+ * one channel of a plan from the times measured on the current host for a signal
+ * of at most APD_EST_NCAL sample points (see f_apd_iteration_time). The grid of
+ * the plan is scaled down to this size in every dimension and rounded down to
+ * lengths without prime factors larger than 5, with the same sampling and cutoff
+ * frequencies, i.e., the same relative passband. The time of the projection onto Mw
+ * is scaled by its floating-point operations (see f_apd_est_dft_flops), so that
+ * lengths with large prime factors (Bluestein's algorithm) are covered by the cost
+ * model only, and the time of the projection onto Cd by the number of elements.
+ * Mixed-precision plans are timed in double precision.
+ */
+
+/* I N P U T   A R G U M E N T S
+ *
+ * [P] - plan structure set by f_apd_plan_dims.
+ *
+ * [bk] - DFT backend in use (APD_DFT_MKL or APD_DFT_BUILTIN).
+ *
+ * [p] - length of the short DFTs of the pruned FFT of the plan, or 0 (see
+ *       f_apd_est_dft_flops).
+ */
+
+/* O U T P U T   A R G U M E N T S
+ *
+ * [t_dft], [t_cd] - estimated time (in seconds) of the projections onto Mw and
+ *                   onto Cd per iteration and channel (these are addresses of
+ *                   externally defined scalar variables).
+ */
+
+/* R E T U R N   V A L U E
+ *
+ * [exitflag] - exit flag. Any positive value indicates an error (for numerical and
+ *              textual definitions of the exit status, see l_ap_error_handling.c).
+ *
+ *              Upon an error, all memory dynamically allocated in this function or
+ *              functions called by this function is freed.
+ */
+
+/* N O N S T A N D A R D   F U N C T I O N S   U S E D
+ *
+ * (1) f_apd_est_smooth, (2) f_apd_dft_init, (3) f_apd_dft_prune,
+ *
+ * (4) f_apd_iteration_time, (5) f_apd_dft_free, (6) f_apd_pfft_select,
+ *
+ * (7) f_apd_est_dft_flops.
+ */
+
+
+    int exitflag = 0;
+
+    int i;
+
+    const int D = P->Par.D;
+
+    const int prec = (P->prec == APD_PREC_SINGLE) ? APD_PREC_SINGLE : APD_PREC_DOUBLE;
+
+    int n_thr = 1;
+
+    long N[3] = {1, 1, 1};
+
+    long iL[3] = {0, 0, 0};
+
+    long iR[3] = {0, 0, 0};
+
+    long nx = 1;
+
+    long p_c;
+
+    double f = 1;
+
+    struct strAPD_DFT dft;
+
+    struct strAPD_EstCal *C = &sgAPD_EST_CAL;
+
+
+    #ifdef _OPENMP
+
+        n_thr = omp_get_max_threads();
+
+    #endif
+
+
+
+    /* Calibration grid and its cutoff indexes */
+
+    if (P->nx > APD_EST_NCAL)
+
+        f = pow((double) APD_EST_NCAL / P->nx, 1.0 / D);
+
+    for (i=0; i<D; i++)
+    {
+        N[i] = f_apd_est_smooth ((f < 1) ? (long) (f * P->Nx[i]) : P->Nx[i]);
+
+        iL[i] = 1 + (long) ceil(P->Par.Fc[i] / (P->Par.Fs[i] / N[i]));
+
+        iR[i] = N[i] - iL[i];
+
+        nx = nx * N[i];
+    }
+
+
+
+    /* Times of the calibration signal (measured unless the last calibration in
+     * this thread had the same signal, DFT, and threads) */
+
+    if ( C->D != D || C->N[0] != N[0] || C->N[1] != N[1] || C->N[2] != N[2] || \
+         C->iL[0] != iL[0] || C->iL[1] != iL[1] || C->iL[2] != iL[2] || \
+         C->Al != P->Par.Al || C->Ub_flag != P->Ub_flag || C->prec != prec || \
+         C->bk != bk || C->n_thr != n_thr )
+    {
+        C->D = 0;
+
+        exitflag = f_apd_dft_init (D, N, 0, 1, prec, &dft);
+
+        if (exitflag == APD_ERR_ID_NON)
+
+            exitflag = f_apd_dft_prune (&dft, D, N, iL);
+
+        if (exitflag == APD_ERR_ID_NON && prec == APD_PREC_SINGLE)
+
+            exitflag = f_apd_iteration_time_f (D, N, iL, iR, P->Par.Al, \
+                                               P->Ub_flag, &dft, &(C->t_dft), \
+                                               &(C->t_cd));
+
+        else if (exitflag == APD_ERR_ID_NON)
+
+            exitflag = f_apd_iteration_time (D, N, iL, iR, P->Par.Al, \
+                                             P->Ub_flag, &dft, &(C->t_dft), \
+                                             &(C->t_cd));
+
+        f_apd_dft_free (&dft);
+
+        if (exitflag != APD_ERR_ID_NON)
+
+            return exitflag;
+
+        C->D = D;
+
+        for (i=0; i<3; i++)
+        {
+            C->N[i] = N[i];
+
+            C->iL[i] = iL[i];
+        }
+
+        C->Al = P->Par.Al;
+
+        C->Ub_flag = P->Ub_flag;
+
+        C->prec = prec;
+
+        C->bk = bk;
+
+        C->n_thr = n_thr;
+    }
+
+
+
+    /* Extrapolation to the grid of the plan (with the DFT selected for it, see
+     * f_apd_dft_prune) */
+
+    p_c = (D == 1) ? f_apd_pfft_select (N[0], iL[0], bk == APD_DFT_MKL) : 0;
+
+    *t_dft = C->t_dft * f_apd_est_dft_flops (D, P->Nx, P->iL, p) / \
+             f_apd_est_dft_flops (D, N, iL, p_c);
+
+    *t_cd = C->t_cd * (double) P->nx_2 / \
+            ((nx / N[D-1]) * (N[D-1]+2-(N[D-1]%2)));
+
+    return exitflag;
+}
+
+
+
+
+int f_apd_estimate ( const struct strAPD_Par* Par, \
+
+                     const int Ub_flag, \
+
+                     const int t_flag, \
+
+                     const long n_ch, \
+
+                     const struct strAPD_Opt* opt, \
+
+                     struct strAPD_Est* est )
+{
+/* P U R P O S E
+ *
+ * Estimates the resources of a demodulation by f_apd_demodulation (n_ch = 1) or by
+ * a plan created with the same arguments (see f_apd_plan_create_multichannel)
+ * before it is started: the peak memory allocated by the library, the DFT grid,
+ * the floating-point operations and the time per iteration, and the largest time
+ * of the iterations. The memory is exact for the built-in FFT; it does not include
+ * the internal memory of the Intel MKL DFT. The time is extrapolated from a short
+ * calibration on the current host (see f_apd_est_calibrate), which takes up to a
+ * few iterations of a signal with APD_EST_NCAL sample points and is reused by the
+ * next estimates in the same thread with the same calibration signal. The
+ * precision is that of the options, and the DFT backend and number of OpenMP
+ * threads are those in effect at this call.
+ */
+
+/* I N P U T   A R G U M E N T S
+ *
+ * [Par] - pointer to the structure with demodulation parameters (see
+ *         f_apd_demodulation).
+ *
+ * [Ub_flag] - if nonzero, the demodulation uses an upper bound on the modulator.
+ *
+ * [t_flag] - if nonzero, the signal is sampled nonuniformly (Par.Ns[0] sample
+ *            points interpolated to the grid Par.Nr). The sampling coordinates
+ *            themselves are not needed.
+ *
+ * [n_ch] - number of channels (positive, 1 for a single-channel plan).
+ *
+ * [opt] - options of the plan (see f_apd_plan_create) or NULL for the defaults.
+ */
+
+/* O U T P U T   A R G U M E N T S
+ *
+ * [est] - pointer to the structure of the estimate (memory allocated externally):
+ *
+ *         .bytes - peak memory allocated by the library (in bytes) in the setup
+ *                  and execution of the plan, i.e., the memory block of the plan
+ *                  and, at the setup of a pruned FFT, both DFTs.
+ *
+ *         .bytes_plan - memory block of the plan (see f_apd_plan_workspace_size;
+ *                       with the margin for its alignment).
+ *
+ *         .bytes_dft - memory of the DFT after the setup (0 for the Intel MKL DFT).
+ *
+ *         .bytes_io - memory of the input and output arrays of the caller (s, Ub,
+ *                     t, out_m, out_e, and iter, with s as doubles).
+ *
+ *         .Nx, .nx - numbers of elements of the DFT grid in every dimension and in
+ *                    total.
+ *
+ *         .dft - DFT backend: APD_DFT_MKL or APD_DFT_BUILTIN.
+ *
+ *         .pfft - number of Fourier coefficients computed by the pruned FFT, or 0
+ *                 if the full DFT is computed (see f_apd_pfft_select).
+ *
+ *         .flops - floating-point operations per iteration of all channels.
+ *
+ *         .t_iter - estimated time per iteration of all channels in seconds.
+ *
+ *         .t_max - estimated time of Par.Ni iterations in seconds, i.e., an upper
+ *                  bound on the time of the iterations.
+ */
+
+/* R E T U R N   V A L U E
+ *
+ * [exitflag] - exit flag. Any positive value indicates an error (for numerical and
+ *              textual definitions of the exit status, see l_ap_error_handling.c).
+ */
+
+/* N O N S T A N D A R D   F U N C T I O N S   U S E D
+ *
+ * (1) f_apd_input_validation, (2) f_apd_plan_dims, (3) f_apd_plan_layout,
+ *
+ * (4) f_apd_rfft_bytes, (5) f_apd_pfft_select, (6) f_apd_pfft_bytes,
+ *
+ * (7) f_apd_est_dft_flops, (8) f_apd_est_calibrate, (9) f_apd_options.
+ */
+
+
+    /* Definitions and initializations */
+
+    int exitflag = 0;
+
+    f_apd_set_error (exitflag, __LINE__, APD_ERR_FILE);
+
+
+    int i;
+
+    int bk;
+
+    long p;
+
+    size_t b_dft;
+
+    size_t b_tmp = 0;
+
+    double t_dft;
+
+    double t_cd;
+
+    double c_cd;
+
+    const double t0 = 0;
+
+    struct strAPD_Par V;
+
+    struct strAPD_Plan Q;
+
+    struct strAPD_Opt O;
+
+
+    memset(est, 0, sizeof(struct strAPD_Est));
+
+    if (n_ch < 1)
+    {
+        f_apd_set_error(APD_ERR_ID_CH,__LINE__,APD_ERR_FILE); goto failed;}
+
+
+
+    /* Validation of the parameters (the grid of a nonuniformly sampled signal,
+     * Par.Nr, is validated as the grid of a uniformly sampled one) */
+
+    V = *Par;
+
+    if (t_flag && Par->D >= 1 && Par->D <= 3)
+
+        for (i=0; i<(Par->D); i++)
+
+            V.Ns[i] = Par->Nr[i];
+
+    exitflag = f_apd_input_validation (NULL, &V, NULL, NULL);
+
+    if (exitflag == APD_ERR_ID_NS && t_flag)
+    {
+        f_apd_set_error(APD_ERR_ID_NR,__LINE__,APD_ERR_FILE); goto failed;}
+
+    if (exitflag != APD_ERR_ID_NON) goto finish;
+
+    if (t_flag && Par->Ns[0] <= 1)
+    {
+        f_apd_set_error(APD_ERR_ID_NS,__LINE__,APD_ERR_FILE); goto failed;}
+
+    exitflag = f_apd_options (opt, &O);
+
+    if (exitflag != APD_ERR_ID_NON) goto finish;
+
+
+
+    /* Dimensions of the plan (only the presence of the sampling coordinates is
+     * used) and the memory block */
+
+    f_apd_plan_dims (Par, (t_flag) ? &t0 : NULL, Ub_flag, n_ch, &O, &Q);
+
+    est->bytes_plan = f_apd_plan_layout (&Q, Par->im[0]+1, Par->ie[0]+1, NULL, \
+                                         NULL) + APD_WS_ALIGN;
+
+    for (i=0; i<3; i++)
+
+        est->Nx[i] = (i < Par->D) ? Q.Nx[i] : 1;
+
+    est->nx = Q.nx;
+
+    if (t_flag)
+
+        b_tmp = (Par->D)*(sizeof(long) + 3*sizeof(double));  // f_apd_interpolation
+
+
+
+    /* DFT (see f_apd_dft_init and f_apd_dft_prune): the full DFT and, if selected,
+     * the pruned FFT, which are both allocated before the full DFT is freed. In
+     * mixed precision, the built-in and pruned FFTs are shared by both phases */
+
+    bk = sgAPD_DFT_BACKEND;
+
+    #ifdef APD_NO_MKL
+
+        bk = APD_DFT_BUILTIN;
+
+    #else
+
+        if (bk == APD_DFT_DEFAULT)
+
+            bk = APD_DFT_MKL;
+
+    #endif
+
+    est->dft = bk;
+
+    b_dft = (bk == APD_DFT_BUILTIN) ? f_apd_rfft_bytes (Par->D, Q.Nx, \
+            (Q.prec == APD_PREC_DOUBLE) ? APD_PREC_DOUBLE : APD_PREC_SINGLE) : 0;
+
+    p = (Par->D == 1) ? f_apd_pfft_select (Q.Nx[0], Q.iL[0], bk == APD_DFT_MKL) : 0;
+
+    est->bytes_dft = b_dft;
+
+    if (p > 0)
+    {
+        est->pfft = Q.iL[0];
+
+        est->bytes_dft = f_apd_pfft_bytes (Q.Nx[0], p, Q.iL[0]);
+
+        b_dft = b_dft + est->bytes_dft;
+    }
+
+    est->bytes = est->bytes_plan + ((b_dft > b_tmp) ? b_dft : b_tmp);
+
+
+
+    /* Input and output arrays of the caller */
+
+    est->bytes_io = n_ch * ((1 + (Ub_flag != 0) + Par->im[0]) * (Q.Par.ns) + \
+                            Par->ie[0]) * sizeof(double) + n_ch * sizeof(long);
+
+    if (t_flag)
+
+        est->bytes_io = est->bytes_io + (Q.Par.ns)*(Par->D)*sizeof(double);
+
+
+
+    /* Floating-point operations (the projection onto Mw and the kernel of the
+     * projection onto Cd, see l_apd_kernels.c) and time per iteration */
+
+    c_cd = (Par->Al == 'B') ? 4 : ((Par->Al == 'A') ? 6 : 9);
+
+    c_cd = c_cd + (Ub_flag != 0);
+
+    est->flops = n_ch * (f_apd_est_dft_flops (Par->D, Q.Nx, Q.iL, p) + \
+                         c_cd * Q.nx_2);
+
+    exitflag = f_apd_est_calibrate (&Q, bk, p, &t_dft, &t_cd);
+
+    if (exitflag != APD_ERR_ID_NON) goto finish;
+
+    est->t_iter = n_ch * (t_dft + t_cd);
+
+    est->t_max = (Par->Ni) * (est->t_iter);
+
+
+
+    /* Output */
+
+    finish:
+
+        return exitflag;
+
+    failed:
+
+        f_apd_get_error (&exitflag, NULL, NULL, NULL);
+
+        goto finish;
+
+}
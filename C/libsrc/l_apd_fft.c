@@ -0,0 +1,2318 @@
+
+/*                       C O P Y R I G H T   N O T I C E
+ *
+ * Copyright ©2021. Institute of Science and Technology Austria (IST Austria).
+ * All Rights Reserved. The underlying technology is protected by PCT Patent
+ * Application No. PCT/EP2021/054650.
+ *
+ * This file is part of the AP Demodulation library, which is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation in version 2.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY, without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE. See the GNU General Public License v2 for more details. You
+ * should have received a copy of the GNU General Public License v2 along with this
+ * program. If not, see https://www.gnu.org/licenses/.
+ *
+ * Contact the Technology Transfer Office, IST Austria, Am Campus 1,
+ * A-3400 Klosterneuburg, Austria, +43-(0)2243 9000, twist@ist.ac.at, for commercial
+ * licensing opportunities.
+ *
+ * See https://github.com/mgabriel-lt/ap-demodulation for the latest version of the
+ * code and user-friendly explanations on the working principle, domains of
+ * application, and advice on the usage of different AP Demodulation algorithms in
+ * practice.
+ */
+
+
+/* C O N T E N T S
+ *
+ * A self-contained (built-in) implementation of the discrete Fourier transform used
+ * by the AP Demodulation library when Intel's MKL is not available or not chosen:
+ *
+ * (1) Complex arithmetic helpers (SSE2-vectorized if available).
+ *
+ * (2) f_apd_cfft_pass2, f_apd_cfft_pass3, f_apd_cfft_pass4, f_apd_cfft_pass5, and
+ *     f_apd_cfft_passg - butterflies of the mixed-radix Stockham complex FFT.
+ *
+ * (3) f_apd_cfft_free, f_apd_cfft_exec, f_apd_cfft_init, and f_apd_cfft_bytes -
+ *     complex FFT of an arbitrary length (radix 2/3/4/5, generic small primes, and
+ *     Bluestein's algorithm for lengths with large prime factors).
+ *
+ * (4) f_apd_rfft_init, f_apd_rfft_forward, f_apd_rfft_backward, f_apd_rfft_free,
+ *     and f_apd_rfft_bytes - in-place multidimensional real FFT using the same
+ *     conjugate-even (CCE) data layout as the Intel MKL DFT in AP Demodulation.
+ *
+ * (5) f_apd_pfft_select, f_apd_pfft_init, f_apd_pfft_forward, f_apd_pfft_backward,
+ *     f_apd_pfft_free, and f_apd_pfft_bytes - pruned real FFT of a 1D signal,
+ *     which computes only the lowest Fourier coefficients (the passband of the
+ *     modulator) and transforms them back.
+ *
+ * The memory of the plans is given by the _bytes functions without creating them
+ * (see f_apd_estimate).
+ *
+ * The transforms of the arrays (f_apd_rfft_forward, f_apd_rfft_backward,
+ * f_apd_pfft_forward, and f_apd_pfft_backward) are compiled a second time for arrays
+ * of floats (suffix _f, see f_apd_demodulation.c). The floats are converted to
+ * double precision row by row or line by line in the scratch buffers, so that the
+ * plans and the arithmetic are shared by both precisions.
+ */
+
+
+
+#include "h_apd.h"
+
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+
+    #include <emmintrin.h>
+
+    #define APD_FFT_SSE2
+
+#endif
+
+
+#define APD_FFT_MAXF 64       // maximum number of factors of the FFT length
+
+#define APD_FFT_MAXP 31       // largest prime handled by a direct butterfly
+
+#define APD_FFT_NB 16         // number of lines transformed at once (D > 1)
+
+#define APD_PFFT_TW 4.0       // cost of a twiddle sum of the pruned FFT relative to
+                              // a butterfly (see f_apd_pfft_select)
+
+#define APD_PFFT_MKL 2.0      // assumed speedup of the Intel MKL DFT over the
+                              // built-in FFT (see f_apd_pfft_select)
+
+#define APD_PFFT_GAIN 0.7     // maximum estimated cost of the pruned FFT relative
+                              // to the full FFT (see f_apd_pfft_select)
+
+
+
+
+#ifndef APD_SINGLE    // the double-precision parts are compiled only once
+
+
+
+/* (1) COMPLEX ARITHMETIC HELPERS */
+
+/* A complex number (re, im) is stored in two consecutive doubles. With SSE2, it is
+ * kept in one 128-bit register, so that every butterfly operation is vectorized.
+ * f_apd_c_tw loads a twiddle of the forward transform, conjugated for sg = -1 (the
+ * backward transform), which is exact. */
+
+#ifdef APD_FFT_SSE2
+
+    typedef __m128d tAPD_Cpx;
+
+    static inline tAPD_Cpx f_apd_c_ld (const double* p)
+        { return _mm_loadu_pd(p); }
+
+    static inline void f_apd_c_st (double* p, const tAPD_Cpx a)
+        { _mm_storeu_pd(p, a); }
+
+    static inline tAPD_Cpx f_apd_c_set (const double re, const double im)
+        { return _mm_set_pd(im, re); }
+
+    static inline tAPD_Cpx f_apd_c_add (const tAPD_Cpx a, const tAPD_Cpx b)
+        { return _mm_add_pd(a, b); }
+
+    static inline tAPD_Cpx f_apd_c_sub (const tAPD_Cpx a, const tAPD_Cpx b)
+        { return _mm_sub_pd(a, b); }
+
+    static inline tAPD_Cpx f_apd_c_scl (const tAPD_Cpx a, const double c)
+        { return _mm_mul_pd(a, _mm_set1_pd(c)); }
+
+    static inline tAPD_Cpx f_apd_c_mul (const tAPD_Cpx a, const tAPD_Cpx w)
+    {
+        /* (ar*wr - ai*wi, ai*wr + ar*wi) */
+
+        tAPD_Cpx t = _mm_mul_pd(_mm_shuffle_pd(a, a, 1), _mm_unpackhi_pd(w, w));
+
+        t = _mm_xor_pd(t, _mm_set_pd(0.0, -0.0));
+
+        return _mm_add_pd(_mm_mul_pd(a, _mm_unpacklo_pd(w, w)), t);
+    }
+
+    static inline tAPD_Cpx f_apd_c_mnj (const tAPD_Cpx a, const double sg)
+    {
+        /* Multiplication by -i*sg: (sg*ai, -sg*ar) */
+
+        return _mm_mul_pd(_mm_shuffle_pd(a, a, 1), _mm_set_pd(-sg, sg));
+    }
+
+    static inline tAPD_Cpx f_apd_c_cnj (const tAPD_Cpx a)
+        { return _mm_xor_pd(a, _mm_set_pd(-0.0, 0.0)); }
+
+    static inline tAPD_Cpx f_apd_c_tw (const double* p, const double sg)
+        { return _mm_mul_pd(_mm_loadu_pd(p), _mm_set_pd(sg, 1.0)); }
+
+    static inline double f_apd_c_re (const tAPD_Cpx a)
+        { return _mm_cvtsd_f64(a); }
+
+    static inline double f_apd_c_im (const tAPD_Cpx a)
+        { return _mm_cvtsd_f64(_mm_unpackhi_pd(a, a)); }
+
+#else
+
+    typedef struct { double re; double im; } tAPD_Cpx;
+
+    static inline tAPD_Cpx f_apd_c_ld (const double* p)
+        { tAPD_Cpx a; a.re = p[0]; a.im = p[1]; return a; }
+
+    static inline void f_apd_c_st (double* p, const tAPD_Cpx a)
+        { p[0] = a.re; p[1] = a.im; }
+
+    static inline tAPD_Cpx f_apd_c_set (const double re, const double im)
+        { tAPD_Cpx a; a.re = re; a.im = im; return a; }
+
+    static inline tAPD_Cpx f_apd_c_add (const tAPD_Cpx a, const tAPD_Cpx b)
+        { return f_apd_c_set(a.re + b.re, a.im + b.im); }
+
+    static inline tAPD_Cpx f_apd_c_sub (const tAPD_Cpx a, const tAPD_Cpx b)
+        { return f_apd_c_set(a.re - b.re, a.im - b.im); }
+
+    static inline tAPD_Cpx f_apd_c_scl (const tAPD_Cpx a, const double c)
+        { return f_apd_c_set(a.re * c, a.im * c); }
+
+    static inline tAPD_Cpx f_apd_c_mul (const tAPD_Cpx a, const tAPD_Cpx w)
+        { return f_apd_c_set(a.re*w.re - a.im*w.im, a.im*w.re + a.re*w.im); }
+
+    static inline tAPD_Cpx f_apd_c_mnj (const tAPD_Cpx a, const double sg)
+        { return f_apd_c_set(sg * a.im, -sg * a.re); }
+
+    static inline tAPD_Cpx f_apd_c_cnj (const tAPD_Cpx a)
+        { return f_apd_c_set(a.re, -a.im); }
+
+    static inline tAPD_Cpx f_apd_c_tw (const double* p, const double sg)
+        { return f_apd_c_set(p[0], sg * p[1]); }
+
+    static inline double f_apd_c_re (const tAPD_Cpx a)
+        { return a.re; }
+
+    static inline double f_apd_c_im (const tAPD_Cpx a)
+        { return a.im; }
+
+#endif
+
+
+
+
+/* (2) BUTTERFLIES OF THE STOCKHAM AUTOSORT FFT */
+
+/* Every pass of radix p takes the input x holding s interleaved sequences of length
+ * p*m and writes to y:
+ *
+ *   y[q + s*(p*j + t)] = w^(j*t) * sum_r x[q + s*(j + r*m)] * exp(-sg*2*pi*i*r*t/p),
+ *
+ * where j = 0..m-1, q = 0..s-1, t = 0..p-1, and w = exp(-sg*2*pi*i/(p*m)). The
+ * twiddles w^(j*t), t = 1..p-1, of the forward transform are precomputed in tw (p-1
+ * complex numbers per j) and conjugated while they are loaded for the backward
+ * transform. sg = 1 for the forward and sg = -1 for the backward transform. All
+ * indexes count complex numbers. The innermost loop runs over the contiguous
+ * index q. */
+
+void f_apd_cfft_pass2 ( const long m, const long s, const double* x, double* y, \
+                        const double* tw, const double sg )
+{
+    long j, q;
+
+    tAPD_Cpx a0, a1, w1;
+
+
+    for (j=0; j<m; j++)
+    {
+        w1 = f_apd_c_tw(tw + 2*j, sg);
+
+        for (q=0; q<s; q++)
+        {
+            a0 = f_apd_c_ld(x + 2*(q + s*j));
+
+            a1 = f_apd_c_ld(x + 2*(q + s*(j+m)));
+
+            f_apd_c_st(y + 2*(q + s*(2*j)), f_apd_c_add(a0, a1));
+
+            f_apd_c_st(y + 2*(q + s*(2*j+1)), f_apd_c_mul(f_apd_c_sub(a0, a1), w1));
+        }
+    }
+}
+
+
+
+
+void f_apd_cfft_pass3 ( const long m, const long s, const double* x, double* y, \
+                        const double* tw, const double sg )
+{
+    const double c3 = 0.86602540378443864676;   // sqrt(3)/2
+
+    long j, q;
+
+    tAPD_Cpx a0, a1, a2, t1, t2, t3, w1, w2;
+
+
+    for (j=0; j<m; j++)
+    {
+        w1 = f_apd_c_tw(tw + 4*j, sg);
+
+        w2 = f_apd_c_tw(tw + 4*j + 2, sg);
+
+        for (q=0; q<s; q++)
+        {
+            a0 = f_apd_c_ld(x + 2*(q + s*j));
+
+            a1 = f_apd_c_ld(x + 2*(q + s*(j+m)));
+
+            a2 = f_apd_c_ld(x + 2*(q + s*(j+2*m)));
+
+
+            t1 = f_apd_c_add(a1, a2);
+
+            t2 = f_apd_c_sub(a0, f_apd_c_scl(t1, 0.5));
+
+            t3 = f_apd_c_scl(f_apd_c_mnj(f_apd_c_sub(a1, a2), sg), c3);
+
+
+            f_apd_c_st(y + 2*(q + s*(3*j)), f_apd_c_add(a0, t1));
+
+            f_apd_c_st(y + 2*(q + s*(3*j+1)), f_apd_c_mul(f_apd_c_add(t2, t3), w1));
+
+            f_apd_c_st(y + 2*(q + s*(3*j+2)), f_apd_c_mul(f_apd_c_sub(t2, t3), w2));
+        }
+    }
+}
+
+
+
+
+void f_apd_cfft_pass4 ( const long m, const long s, const double* x, double* y, \
+                        const double* tw, const double sg )
+{
+    long j, q;
+
+    tAPD_Cpx a0, a1, a2, a3, t0, t1, t2, t3, w1, w2, w3;
+
+
+    for (j=0; j<m; j++)
+    {
+        w1 = f_apd_c_tw(tw + 6*j, sg);
+
+        w2 = f_apd_c_tw(tw + 6*j + 2, sg);
+
+        w3 = f_apd_c_tw(tw + 6*j + 4, sg);
+
+        for (q=0; q<s; q++)
+        {
+            a0 = f_apd_c_ld(x + 2*(q + s*j));
+
+            a1 = f_apd_c_ld(x + 2*(q + s*(j+m)));
+
+            a2 = f_apd_c_ld(x + 2*(q + s*(j+2*m)));
+
+            a3 = f_apd_c_ld(x + 2*(q + s*(j+3*m)));
+
+
+            t0 = f_apd_c_add(a0, a2);
+
+            t1 = f_apd_c_sub(a0, a2);
+
+            t2 = f_apd_c_add(a1, a3);
+
+            t3 = f_apd_c_mnj(f_apd_c_sub(a1, a3), sg);
+
+
+            f_apd_c_st(y + 2*(q + s*(4*j)), f_apd_c_add(t0, t2));
+
+            f_apd_c_st(y + 2*(q + s*(4*j+1)), f_apd_c_mul(f_apd_c_add(t1, t3), w1));
+
+            f_apd_c_st(y + 2*(q + s*(4*j+2)), f_apd_c_mul(f_apd_c_sub(t0, t2), w2));
+
+            f_apd_c_st(y + 2*(q + s*(4*j+3)), f_apd_c_mul(f_apd_c_sub(t1, t3), w3));
+        }
+    }
+}
+
+
+
+
+void f_apd_cfft_pass5 ( const long m, const long s, const double* x, double* y, \
+                        const double* tw, const double sg )
+{
+    const double c1 = 0.30901699437494742410;   // cos(2*pi/5)
+
+    const double c2 = -0.80901699437494742410;  // cos(4*pi/5)
+
+    const double s1 = 0.95105651629515357212;   // sin(2*pi/5)
+
+    const double s2 = 0.58778525229247312917;   // sin(4*pi/5)
+
+    long j, q;
+
+    tAPD_Cpx a0, a1, a2, a3, a4, t1, t2, t3, t4, r1, r2, i1, i2, w1, w2, w3, w4;
+
+
+    for (j=0; j<m; j++)
+    {
+        w1 = f_apd_c_tw(tw + 8*j, sg);
+
+        w2 = f_apd_c_tw(tw + 8*j + 2, sg);
+
+        w3 = f_apd_c_tw(tw + 8*j + 4, sg);
+
+        w4 = f_apd_c_tw(tw + 8*j + 6, sg);
+
+        for (q=0; q<s; q++)
+        {
+            a0 = f_apd_c_ld(x + 2*(q + s*j));
+
+            a1 = f_apd_c_ld(x + 2*(q + s*(j+m)));
+
+            a2 = f_apd_c_ld(x + 2*(q + s*(j+2*m)));
+
+            a3 = f_apd_c_ld(x + 2*(q + s*(j+3*m)));
+
+            a4 = f_apd_c_ld(x + 2*(q + s*(j+4*m)));
+
+
+            t1 = f_apd_c_add(a1, a4);
+
+            t2 = f_apd_c_add(a2, a3);
+
+            t3 = f_apd_c_sub(a1, a4);
+
+            t4 = f_apd_c_sub(a2, a3);
+
+
+            r1 = f_apd_c_add(a0, f_apd_c_add(f_apd_c_scl(t1, c1), f_apd_c_scl(t2, c2)));
+
+            r2 = f_apd_c_add(a0, f_apd_c_add(f_apd_c_scl(t1, c2), f_apd_c_scl(t2, c1)));
+
+            i1 = f_apd_c_mnj(f_apd_c_add(f_apd_c_scl(t3, s1), f_apd_c_scl(t4, s2)), sg);
+
+            i2 = f_apd_c_mnj(f_apd_c_sub(f_apd_c_scl(t3, s2), f_apd_c_scl(t4, s1)), sg);
+
+
+            f_apd_c_st(y + 2*(q + s*(5*j)), f_apd_c_add(a0, f_apd_c_add(t1, t2)));
+
+            f_apd_c_st(y + 2*(q + s*(5*j+1)), f_apd_c_mul(f_apd_c_add(r1, i1), w1));
+
+            f_apd_c_st(y + 2*(q + s*(5*j+2)), f_apd_c_mul(f_apd_c_add(r2, i2), w2));
+
+            f_apd_c_st(y + 2*(q + s*(5*j+3)), f_apd_c_mul(f_apd_c_sub(r2, i2), w3));
+
+            f_apd_c_st(y + 2*(q + s*(5*j+4)), f_apd_c_mul(f_apd_c_sub(r1, i1), w4));
+        }
+    }
+}
+
+
+
+
+void f_apd_cfft_passg ( const long m, const long s, const double* x, double* y, \
+                        const double* tw, const double sg, const int p, \
+                        const double* wp )
+{
+    /* Direct butterfly of an odd prime radix p <= APD_FFT_MAXP; wp holds the p roots
+     * of unity exp(-sg*2*pi*i*k/p), k = 0..p-1. */
+
+    long j, q;
+
+    int r, t;
+
+    tAPD_Cpx a[APD_FFT_MAXP], acc;
+
+
+    for (j=0; j<m; j++)
+
+        for (q=0; q<s; q++)
+        {
+            for (r=0; r<p; r++)
+
+                a[r] = f_apd_c_ld(x + 2*(q + s*(j+r*m)));
+
+
+            acc = a[0];
+
+            for (r=1; r<p; r++)
+
+                acc = f_apd_c_add(acc, a[r]);
+
+            f_apd_c_st(y + 2*(q + s*(p*j)), acc);
+
+
+            for (t=1; t<p; t++)
+            {
+                acc = a[0];
+
+                for (r=1; r<p; r++)
+
+                    acc = f_apd_c_add(acc, f_apd_c_mul(a[r], \
+                            f_apd_c_ld(wp + 2*((r*t) % p))));
+
+                f_apd_c_st(y + 2*(q + s*(p*j+t)), \
+                        f_apd_c_mul(acc, \
+                                    f_apd_c_tw(tw + 2*((p-1)*j + t-1), sg)));
+            }
+        }
+}
+
+
+
+
+/* (3) COMPLEX FFT */
+
+/* Plan of the complex FFT of length n */
+
+struct strAPD_CFFT {
+
+                    long         n;
+
+                    int          nf;
+
+                    int          fac[APD_FFT_MAXF];
+
+                    long         off[APD_FFT_MAXF];
+
+                    double*      tw;           // twiddles of the forward
+                                               // transform (see f_apd_c_tw)
+
+                    double*      wp[2];
+
+                    long         bl_m;
+
+                    double*      bl_c;
+
+                    double*      bl_h;
+
+                    double*      bl_a;
+
+                    double*      bl_work;
+
+                    struct strAPD_CFFT* bl_sub;
+
+                   };
+
+
+
+
+void f_apd_cfft_free (struct strAPD_CFFT* P)
+{
+/* P U R P O S E
+ *
+ * Frees the complex FFT plan created by f_apd_cfft_init.
+ */
+
+    if (P == NULL)
+
+        return;
+
+    free(P->tw);
+
+    free(P->wp[0]);
+
+    free(P->wp[1]);
+
+    free(P->bl_c);
+
+    free(P->bl_h);
+
+    free(P->bl_a);
+
+    free(P->bl_work);
+
+    f_apd_cfft_free(P->bl_sub);
+
+    free(P);
+}
+
+
+
+
+static inline long f_apd_cfft_factor (const long n, int* fac, int* nf)
+{
+/* Factors of the length n (radices 4, 2, and odd primes not larger than
+ * APD_FFT_MAXP, at most APD_FFT_MAXF of them) and the remaining cofactor (1 if n is
+ * factorized completely, otherwise Bluestein's algorithm is used) */
+
+    int p;
+
+    long r = n;
+
+
+    *nf = 0;
+
+    while (r % 4 == 0 && *nf < APD_FFT_MAXF)
+    {
+        fac[(*nf)++] = 4; r = r / 4;}
+
+    while (r % 2 == 0 && *nf < APD_FFT_MAXF)
+    {
+        fac[(*nf)++] = 2; r = r / 2;}
+
+    for (p=3; p<=APD_FFT_MAXP && r > 1; p+=2)
+
+        while (r % p == 0 && *nf < APD_FFT_MAXF)
+        {
+            fac[(*nf)++] = p; r = r / p;}
+
+    return r;
+}
+
+
+
+
+void f_apd_cfft_exec ( struct strAPD_CFFT* P, \
+
+                       double* x, \
+
+                       const long nb, \
+
+                       const int sign, \
+
+                       double* work )
+{
+/* P U R P O S E
+ *
+ * Computes nb unnormalized complex FFTs of length P->n in-place.
+ */
+
+/* I N P U T   A R G U M E N T S
+ *
+ * [P] - plan created by f_apd_cfft_init.
+ *
+ * [x] - nb interleaved complex sequences: element k of sequence b is stored in
+ *       x[2*(k*nb+b)] (real part) and x[2*(k*nb+b)+1] (imaginary part).
+ *
+ * [nb] - number of sequences.
+ *
+ * [sign] - 1 for the forward transform (exp(-2*pi*i*k*j/n)), -1 for the backward
+ *          transform (exp(+2*pi*i*k*j/n)).
+ *
+ * [work] - scratch array with at least 2*n*nb elements.
+ */
+
+/* O U T P U T   A R G U M E N T S
+ *
+ * [x] - transformed sequences.
+ */
+
+/* R E T U R N   V A L U E
+ *
+ * None.
+ */
+
+    int i, p;
+
+    const int dir = (sign > 0) ? 0 : 1;
+
+    const double sg = (sign > 0) ? 1.0 : -1.0;
+
+    long b, k, m, s, ns;
+
+    double *in = x;
+
+    double *out = work;
+
+    double *aux;
+
+    tAPD_Cpx c;
+
+
+
+    /* Bluestein's algorithm (one sequence at a time) */
+
+    if (P->bl_m > 0)
+    {
+        for (b=0; b<nb; b++)
+        {
+            for (k=0; k<P->n; k++)
+            {
+                c = f_apd_c_ld(x + 2*(k*nb+b));
+
+                if (dir == 1)
+
+                    c = f_apd_c_cnj(c);
+
+                f_apd_c_st(P->bl_a + 2*k, f_apd_c_mul(c, f_apd_c_ld(P->bl_c + 2*k)));
+            }
+
+            for (k=2*P->n; k<2*P->bl_m; k++)
+
+                P->bl_a[k] = 0;
+
+
+            f_apd_cfft_exec(P->bl_sub, P->bl_a, 1, 1, P->bl_work);
+
+            for (k=0; k<P->bl_m; k++)
+
+                f_apd_c_st(P->bl_a + 2*k, f_apd_c_mul(f_apd_c_ld(P->bl_a + 2*k), \
+                        f_apd_c_ld(P->bl_h + 2*k)));
+
+            f_apd_cfft_exec(P->bl_sub, P->bl_a, 1, -1, P->bl_work);
+
+
+            for (k=0; k<P->n; k++)
+            {
+                c = f_apd_c_mul(f_apd_c_ld(P->bl_a + 2*k), f_apd_c_ld(P->bl_c + 2*k));
+
+                if (dir == 1)
+
+                    c = f_apd_c_cnj(c);
+
+                f_apd_c_st(x + 2*(k*nb+b), c);
+            }
+        }
+
+        return;
+    }
+
+
+
+    /* Mixed-radix Stockham passes */
+
+    ns = P->n;
+
+    s = nb;
+
+    for (i=0; i<P->nf; i++)
+    {
+        p = P->fac[i];
+
+        m = ns / p;
+
+        if (p == 4)
+
+            f_apd_cfft_pass4(m, s, in, out, P->tw + 2*P->off[i], sg);
+
+        else if (p == 2)
+
+            f_apd_cfft_pass2(m, s, in, out, P->tw + 2*P->off[i], sg);
+
+        else if (p == 3)
+
+            f_apd_cfft_pass3(m, s, in, out, P->tw + 2*P->off[i], sg);
+
+        else if (p == 5)
+
+            f_apd_cfft_pass5(m, s, in, out, P->tw + 2*P->off[i], sg);
+
+        else
+
+            f_apd_cfft_passg(m, s, in, out, P->tw + 2*P->off[i], sg, p, \
+                    P->wp[dir] + 2*i*(APD_FFT_MAXP+1));
+
+        aux = in;
+
+        in = out;
+
+        out = aux;
+
+        ns = m;
+
+        s = s * p;
+    }
+
+    if (in != x)
+
+        memcpy(x, in, 2*P->n*nb*sizeof(double));
+}
+
+
+
+
+int f_apd_cfft_init ( const long n, \
+
+                      struct strAPD_CFFT** P_out )
+{
+/* P U R P O S E
+ *
+ * Creates the plan of the complex FFT of length n. The length is factorized into
+ * radices 4, 2, 3, 5 and odd primes not larger than APD_FFT_MAXP. If a larger prime
+ * factor is present, the transform is computed by Bluestein's algorithm via a
+ * power-of-two FFT.
+ */
+
+/* I N P U T   A R G U M E N T S
+ *
+ * [n] - length of the transform.
+ */
+
+/* O U T P U T   A R G U M E N T S
+ *
+ * [P_out] - pointer to the created plan (NULL upon an error).
+ */
+
+/* R E T U R N   V A L U E
+ *
+ * [exitflag] - exit flag. Any positive value indicates an error (for numerical and
+ *              textual definitions of the exit status, see l_ap_error_handling.c).
+ * 
+ *              Upon an error, all memory dynamically allocated in this function is
+ *              freed.
+ */
+
+/* N O N S T A N D A R D   F U N C T I O N S   U S E D
+ *
+ * (1) f_apd_cfft_exec, (2) f_apd_cfft_free.
+ */
+
+
+    /* Definitions and initializations */
+
+    int exitflag = 0;
+
+    f_apd_set_error (exitflag, __LINE__, APD_ERR_FILE);
+
+
+    int i, p, dir;
+
+    long j, t, k, r, m, ns, ntw;
+
+    long k2;
+
+    double ang;
+
+    struct strAPD_CFFT *P = NULL;
+
+
+    *P_out = NULL;
+
+    P = (struct strAPD_CFFT*) calloc(1, sizeof(struct strAPD_CFFT));
+
+    if (P==NULL)
+    {
+        f_apd_set_error(APD_ERR_ID_MEM,__LINE__,APD_ERR_FILE); goto failed;}
+
+    P->n = n;
+
+
+
+    /* Factorization of the transform length */
+
+    r = f_apd_cfft_factor (n, P->fac, &(P->nf));
+
+
+
+    /* Bluestein's algorithm for lengths with large prime factors */
+
+    if (r > 1)
+    {
+        P->nf = 0;
+
+        P->bl_m = 1;
+
+        while (P->bl_m < 2*n-1)
+
+            P->bl_m = 2 * P->bl_m;
+
+
+        exitflag = f_apd_cfft_init(P->bl_m, &(P->bl_sub));
+
+        if (exitflag != APD_ERR_ID_NON) goto finish;
+
+
+        P->bl_c = (double*) malloc(2*n*sizeof(double));
+
+        P->bl_h = (double*) calloc(2*P->bl_m, sizeof(double));
+
+        P->bl_a = (double*) malloc(2*P->bl_m*sizeof(double));
+
+        P->bl_work = (double*) malloc(2*P->bl_m*sizeof(double));
+
+        if (P->bl_c==NULL || P->bl_h==NULL || P->bl_a==NULL || P->bl_work==NULL)
+        {
+            f_apd_set_error(APD_ERR_ID_MEM,__LINE__,APD_ERR_FILE); goto failed;}
+
+
+        /* Chirp exp(-i*pi*k^2/n); k^2 is reduced modulo 2n to keep accuracy */
+
+        k2 = 0;
+
+        for (k=0; k<n; k++)
+        {
+            ang = M_PI * (double) k2 / (double) n;
+
+            P->bl_c[2*k] = cos(ang);
+
+            P->bl_c[2*k+1] = -sin(ang);
+
+            k2 = (k2 + 2*k + 1) % (2*n);
+        }
+
+
+        /* FFT of the convolution filter (conjugate chirp), scaled by 1/bl_m */
+
+        for (k=0; k<n; k++)
+        {
+            P->bl_h[2*k] = P->bl_c[2*k] / P->bl_m;
+
+            P->bl_h[2*k+1] = -P->bl_c[2*k+1] / P->bl_m;
+
+            if (k > 0)
+            {
+                P->bl_h[2*(P->bl_m-k)] = P->bl_h[2*k];
+
+                P->bl_h[2*(P->bl_m-k)+1] = P->bl_h[2*k+1];
+            }
+        }
+
+        f_apd_cfft_exec(P->bl_sub, P->bl_h, 1, 1, P->bl_work);
+
+        goto finish;
+    }
+
+
+
+    /* Twiddles of every pass of the forward transform (conjugated for the backward
+     * transform, see f_apd_c_tw) and the roots of unity of the generic-radix
+     * butterflies for the forward (dir=0) and backward (dir=1) transforms */
+
+    ntw = 0;
+
+    ns = n;
+
+    for (i=0; i<P->nf; i++)
+    {
+        P->off[i] = ntw;
+
+        ntw = ntw + (ns / P->fac[i]) * (P->fac[i] - 1);
+
+        ns = ns / P->fac[i];
+    }
+
+    P->tw = (double*) malloc(2*(ntw+1)*sizeof(double));
+
+    if (P->tw==NULL)
+    {
+        f_apd_set_error(APD_ERR_ID_MEM,__LINE__,APD_ERR_FILE); goto failed;}
+
+    for (dir=0; dir<2; dir++)
+    {
+        P->wp[dir] = (double*) malloc(2*(APD_FFT_MAXP+1)*APD_FFT_MAXF*sizeof(double));
+
+        if (P->wp[dir]==NULL)
+        {
+            f_apd_set_error(APD_ERR_ID_MEM,__LINE__,APD_ERR_FILE); goto failed;}
+    }
+
+
+    ns = n;
+
+    for (i=0; i<P->nf; i++)
+    {
+        p = P->fac[i];
+
+        m = ns / p;
+
+        for (j=0; j<m; j++)
+
+            for (t=1; t<p; t++)
+            {
+                ang = 2 * M_PI * (double) ((j*t) % ns) / (double) ns;
+
+                P->tw[2*(P->off[i] + (p-1)*j + t-1)] = cos(ang);
+
+                P->tw[2*(P->off[i] + (p-1)*j + t-1)+1] = -sin(ang);
+            }
+
+
+        /* Roots of unity of the generic-radix butterflies */
+
+        if (p > 5)
+
+            for (t=0; t<p; t++)
+            {
+                ang = 2 * M_PI * (double) t / (double) p;
+
+                P->wp[0][2*(i*(APD_FFT_MAXP+1) + t)] = cos(ang);
+
+                P->wp[0][2*(i*(APD_FFT_MAXP+1) + t)+1] = -sin(ang);
+
+                P->wp[1][2*(i*(APD_FFT_MAXP+1) + t)] = cos(ang);
+
+                P->wp[1][2*(i*(APD_FFT_MAXP+1) + t)+1] = sin(ang);
+            }
+
+        ns = m;
+    }
+
+
+
+    /* Output & Memory deallocation */
+
+    finish:
+
+        if (exitflag == APD_ERR_ID_NON)
+
+            *P_out = P;
+
+        else
+
+            f_apd_cfft_free(P);
+
+        return exitflag;
+
+    failed:
+
+        f_apd_get_error (&exitflag, NULL, NULL, NULL);
+
+        goto finish;
+
+}
+
+
+
+
+size_t f_apd_cfft_bytes (const long n)
+{
+/* P U R P O S E
+ *
+ * Computes the memory allocated by f_apd_cfft_init for the plan of the complex FFT
+ * of length n (without creating the plan).
+ */
+
+/* I N P U T   A R G U M E N T S
+ *
+ * [n] - length of the transform.
+ */
+
+/* R E T U R N   V A L U E
+ *
+ * [bytes] - memory of the plan (in bytes).
+ */
+
+/* N O N S T A N D A R D   F U N C T I O N S   U S E D
+ *
+ * (1) f_apd_cfft_factor.
+ */
+
+    int i, nf;
+
+    int fac[APD_FFT_MAXF];
+
+    long ns, ntw, bl_m;
+
+    size_t bytes = sizeof(struct strAPD_CFFT);
+
+
+    if (f_apd_cfft_factor (n, fac, &nf) > 1)
+    {
+        bl_m = 1;
+
+        while (bl_m < 2*n-1)
+
+            bl_m = 2 * bl_m;
+
+        return bytes + f_apd_cfft_bytes(bl_m) + (2*n + 6*bl_m)*sizeof(double);
+    }
+
+
+    ntw = 0;
+
+    ns = n;
+
+    for (i=0; i<nf; i++)
+    {
+        ntw = ntw + (ns / fac[i]) * (fac[i] - 1);
+
+        ns = ns / fac[i];
+    }
+
+    return bytes + (2*(ntw+1) + 4*(APD_FFT_MAXP+1)*APD_FFT_MAXF)*sizeof(double);
+}
+
+
+
+
+/* (4) MULTIDIMENSIONAL REAL FFT */
+
+/* Plan of the in-place real FFT of a D-dimensional array. The array is stored in the
+ * row-major order with the last dimension padded to 2*(N[D-1]/2+1) elements. After
+ * the forward transform, it holds N[D-1]/2+1 complex numbers along the last
+ * dimension (the CCE format of the Intel MKL DFT). */
+
+struct strAPD_RFFT {
+
+                    int          D;
+
+                    long         N[3];
+
+                    long         rs[4];
+
+                    long         nh;
+
+                    long         nb;
+
+                    struct strAPD_CFFT* cf[3];
+
+                    double*      tw_r;
+
+                    double*      buf;
+
+                    double*      work;
+
+                    double*      row;
+
+                   };
+
+
+
+
+void f_apd_rfft_free (struct strAPD_RFFT* R)
+{
+/* P U R P O S E
+ *
+ * Frees the real FFT plan created by f_apd_rfft_init.
+ */
+
+    int i;
+
+    if (R == NULL)
+
+        return;
+
+    for (i=0; i<3; i++)
+
+        f_apd_cfft_free(R->cf[i]);
+
+    free(R->tw_r);
+
+    free(R->buf);
+
+    free(R->work);
+
+    free(R->row);
+
+    free(R);
+}
+
+
+
+
+int f_apd_rfft_init ( const int D, \
+
+                      const long* N, \
+
+                      const int prec, \
+
+                      struct strAPD_RFFT** R_out )
+{
+/* P U R P O S E
+ *
+ * Creates the plan of the in-place multidimensional real FFT.
+ */
+
+/* I N P U T   A R G U M E N T S
+ *
+ * [D] - number of dimensions (1, 2, or 3).
+ *
+ * [N] - numbers of elements of the real array in every dimension.
+ *
+ * [prec] - precision of the transformed arrays: APD_PREC_DOUBLE or APD_PREC_SINGLE
+ *          (the rows of floats are transformed in a buffer of doubles, see
+ *          f_apd_rfft_rows).
+ */
+
+/* O U T P U T   A R G U M E N T S
+ *
+ * [R_out] - pointer to the created plan (NULL upon an error).
+ */
+
+/* R E T U R N   V A L U E
+ *
+ * [exitflag] - exit flag. Any positive value indicates an error (for numerical and
+ *              textual definitions of the exit status, see l_ap_error_handling.c).
+ * 
+ *              Upon an error, all memory dynamically allocated in this function or
+ *              functions called by this function is freed.
+ */
+
+/* N O N S T A N D A R D   F U N C T I O N S   U S E D
+ *
+ * (1) f_apd_cfft_init, (2) f_apd_rfft_free.
+ */
+
+
+    /* Definitions and initializations */
+
+    int exitflag = 0;
+
+    f_apd_set_error (exitflag, __LINE__, APD_ERR_FILE);
+
+
+    int i;
+
+    long k, n_max, n_buf, n_lines;
+
+    double ang;
+
+    struct strAPD_RFFT *R = NULL;
+
+
+    *R_out = NULL;
+
+    R = (struct strAPD_RFFT*) calloc(1, sizeof(struct strAPD_RFFT));
+
+    if (R==NULL)
+    {
+        f_apd_set_error(APD_ERR_ID_MEM,__LINE__,APD_ERR_FILE); goto failed;}
+
+
+    R->D = D;
+
+    for (i=0; i<D; i++)
+
+        R->N[i] = N[i];
+
+
+
+    /* Strides in the real domain */
+
+    R->rs[D] = 1;
+
+    R->rs[D-1] = (N[D-1]/2+1)*2;
+
+    for (i=D-2; i>0; i--)
+
+        R->rs[i] = R->rs[i+1] * N[i];
+
+    if (D > 1)
+
+        R->rs[0] = 0;    // for D = 1, rs[0] is the length of the padded row
+
+
+
+    /* Complex FFT along the last dimension: half length for even N[D-1] (two real
+     * numbers packed into one complex), full length for odd N[D-1]. The split and
+     * merge steps use the twiddles of k = 0..N[D-1]/4 */
+
+    if (N[D-1] % 2 == 0)
+    {
+        R->nh = N[D-1] / 2;
+
+        R->tw_r = (double*) malloc(2*(R->nh/2+1)*sizeof(double));
+
+        if (R->tw_r==NULL)
+        {
+            f_apd_set_error(APD_ERR_ID_MEM,__LINE__,APD_ERR_FILE); goto failed;}
+
+        for (k=0; k<=R->nh/2; k++)
+        {
+            ang = 2 * M_PI * (double) k / (double) N[D-1];
+
+            R->tw_r[2*k] = cos(ang);
+
+            R->tw_r[2*k+1] = -sin(ang);
+        }
+    }
+
+    else
+
+        R->nh = N[D-1];
+
+
+    exitflag = f_apd_cfft_init(R->nh, R->cf + (D-1));
+
+    if (exitflag != APD_ERR_ID_NON) goto finish;
+
+
+
+    /* Complex FFTs along the other dimensions */
+
+    n_max = R->nh;
+
+    n_lines = N[D-1]/2+1;
+
+    for (i=0; i<D-1; i++)
+    {
+        exitflag = f_apd_cfft_init(N[i], R->cf + i);
+
+        if (exitflag != APD_ERR_ID_NON) goto finish;
+
+        if (N[i] > n_max)
+
+            n_max = N[i];
+    }
+
+    R->nb = (D > 1) ? ((n_lines < APD_FFT_NB) ? n_lines : APD_FFT_NB) : 1;
+
+
+
+    /* Scratch arrays as long as the lines transformed at once: buf for the lines of
+     * the other dimensions and the rows of odd length (not used by the packed
+     * transform of the rows of a 1D signal of even length), work for the passes of
+     * the complex FFTs, and row for the rows of floats */
+
+    n_buf = (D > 1 || N[D-1] % 2 != 0) ? 2*n_max*R->nb : 2;
+
+    R->buf = (double*) malloc(n_buf*sizeof(double));
+
+    R->work = (double*) malloc(2*n_max*R->nb*sizeof(double));
+
+    R->row = (double*) malloc(((prec == APD_PREC_SINGLE) ? R->rs[D-1] : 2) * \
+                              sizeof(double));
+
+    if (R->buf==NULL || R->work==NULL || R->row==NULL)
+    {
+        f_apd_set_error(APD_ERR_ID_MEM,__LINE__,APD_ERR_FILE); goto failed;}
+
+
+
+    /* Output & Memory deallocation */
+
+    finish:
+
+        if (exitflag == APD_ERR_ID_NON)
+
+            *R_out = R;
+
+        else
+
+            f_apd_rfft_free(R);
+
+        return exitflag;
+
+    failed:
+
+        f_apd_get_error (&exitflag, NULL, NULL, NULL);
+
+        goto finish;
+
+}
+
+
+
+
+size_t f_apd_rfft_bytes ( const int D, \
+
+                          const long* N, \
+
+                          const int prec )
+{
+/* P U R P O S E
+ *
+ * Computes the memory allocated by f_apd_rfft_init for the plan of the real FFT
+ * (without creating the plan).
+ */
+
+/* I N P U T   A R G U M E N T S
+ *
+ * [D], [N], [prec] - see f_apd_rfft_init.
+ */
+
+/* R E T U R N   V A L U E
+ *
+ * [bytes] - memory of the plan (in bytes).
+ */
+
+/* N O N S T A N D A R D   F U N C T I O N S   U S E D
+ *
+ * (1) f_apd_cfft_bytes.
+ */
+
+    int i;
+
+    long nh, nb, n_max, n_lines, n_buf;
+
+    size_t bytes = sizeof(struct strAPD_RFFT);
+
+
+    nh = (N[D-1] % 2 == 0) ? N[D-1] / 2 : N[D-1];
+
+    if (N[D-1] % 2 == 0)
+
+        bytes = bytes + 2*(nh/2+1)*sizeof(double);
+
+    bytes = bytes + f_apd_cfft_bytes(nh);
+
+
+    n_max = nh;
+
+    n_lines = N[D-1]/2+1;
+
+    for (i=0; i<D-1; i++)
+    {
+        bytes = bytes + f_apd_cfft_bytes(N[i]);
+
+        if (N[i] > n_max)
+
+            n_max = N[i];
+    }
+
+    nb = (D > 1) ? ((n_lines < APD_FFT_NB) ? n_lines : APD_FFT_NB) : 1;
+
+
+    /* Scratch arrays buf, work, and row (see f_apd_rfft_init) */
+
+    n_buf = (D > 1 || N[D-1] % 2 != 0) ? 2*n_max*nb : 2;
+
+    bytes = bytes + (n_buf + 2*n_max*nb)*sizeof(double);
+
+    bytes = bytes + ((prec == APD_PREC_SINGLE) ? 2*n_lines : 2)*sizeof(double);
+
+    return bytes;
+}
+
+
+
+
+void f_apd_rfft_row ( struct strAPD_RFFT* R, \
+
+                      double* r, \
+
+                      const int sign, \
+
+                      const double scale )
+{
+/* P U R P O S E
+ *
+ * Real-to-complex (sign=1) or complex-to-real (sign=-1, result multiplied by scale)
+ * transform of one row r along the last dimension.
+ */
+
+    const int D = R->D;
+
+    const long N = R->N[D-1];
+
+    const long nh = R->nh;
+
+    long k;
+
+    tAPD_Cpx zk, zc, e, o, w;
+
+
+    if (N % 2 == 0 && sign > 0)
+    {
+        /* Packed complex FFT of length N/2 followed by the split step */
+
+        f_apd_cfft_exec(R->cf[D-1], r, 1, 1, R->work);
+
+        zk = f_apd_c_ld(r);
+
+        r[2*nh] = f_apd_c_re(zk) - f_apd_c_im(zk);
+
+        r[2*nh+1] = 0;
+
+        r[0] = f_apd_c_re(zk) + f_apd_c_im(zk);
+
+        r[1] = 0;
+
+        for (k=1; 2*k<=nh; k++)
+        {
+            zk = f_apd_c_ld(r + 2*k);
+
+            zc = f_apd_c_cnj(f_apd_c_ld(r + 2*(nh-k)));
+
+            e = f_apd_c_scl(f_apd_c_add(zk, zc), 0.5);
+
+            o = f_apd_c_scl(f_apd_c_mnj(f_apd_c_sub(zk, zc), 1.0), 0.5);
+
+            w = f_apd_c_mul(o, f_apd_c_ld(R->tw_r + 2*k));
+
+            f_apd_c_st(r + 2*(nh-k), f_apd_c_cnj(f_apd_c_sub(e, w)));
+
+            f_apd_c_st(r + 2*k, f_apd_c_add(e, w));
+        }
+    }
+
+    else if (N % 2 == 0)
+    {
+        /* Merge step followed by the packed complex FFT of length N/2 */
+
+        e = f_apd_c_set(r[0] + r[2*nh], r[0] - r[2*nh]);
+
+        f_apd_c_st(r, f_apd_c_scl(e, scale));
+
+        for (k=1; 2*k<=nh; k++)
+        {
+            zk = f_apd_c_ld(r + 2*k);
+
+            zc = f_apd_c_cnj(f_apd_c_ld(r + 2*(nh-k)));
+
+            e = f_apd_c_add(zk, zc);
+
+            o = f_apd_c_mul(f_apd_c_sub(zk, zc), \
+                    f_apd_c_cnj(f_apd_c_ld(R->tw_r + 2*k)));
+
+            w = f_apd_c_mnj(o, -1.0);
+
+            f_apd_c_st(r + 2*(nh-k), f_apd_c_scl(f_apd_c_cnj(f_apd_c_sub(e, w)), \
+                    scale));
+
+            f_apd_c_st(r + 2*k, f_apd_c_scl(f_apd_c_add(e, w), scale));
+        }
+
+        f_apd_cfft_exec(R->cf[D-1], r, 1, -1, R->work);
+    }
+
+    else if (sign > 0)
+    {
+        /* Odd length: full complex FFT of the real sequence */
+
+        for (k=0; k<N; k++)
+        {
+            R->buf[2*k] = r[k];
+
+            R->buf[2*k+1] = 0;
+        }
+
+        f_apd_cfft_exec(R->cf[D-1], R->buf, 1, 1, R->work);
+
+        memcpy(r, R->buf, (N+1)*sizeof(double));
+    }
+
+    else
+    {
+        /* Odd length: Hermitian extension followed by the full complex FFT */
+
+        R->buf[0] = r[0];
+
+        R->buf[1] = 0;
+
+        for (k=1; k<=N/2; k++)
+        {
+            R->buf[2*k] = r[2*k];
+
+            R->buf[2*k+1] = r[2*k+1];
+
+            R->buf[2*(N-k)] = r[2*k];
+
+            R->buf[2*(N-k)+1] = -r[2*k+1];
+        }
+
+        f_apd_cfft_exec(R->cf[D-1], R->buf, 1, -1, R->work);
+
+        for (k=0; k<N; k++)
+
+            r[k] = scale * R->buf[2*k];
+    }
+}
+
+
+
+
+#endif
+
+
+
+
+/* Copies of n elements between an array of the precision tAPD_Real and a buffer of
+ * doubles (plain memcpy for double-precision arrays) */
+
+static inline void APD_RF(f_apd_fft_ld) (double* y, const tAPD_Real* x, const long n)
+{
+    #ifdef APD_SINGLE
+
+        long i;
+
+        for (i=0; i<n; i++)
+
+            y[i] = x[i];
+
+    #else
+
+        memcpy(y, x, n*sizeof(double));
+
+    #endif
+}
+
+
+static inline void APD_RF(f_apd_fft_st) (tAPD_Real* y, const double* x, const long n)
+{
+    #ifdef APD_SINGLE
+
+        long i;
+
+        for (i=0; i<n; i++)
+
+            y[i] = (float) x[i];
+
+    #else
+
+        memcpy(y, x, n*sizeof(double));
+
+    #endif
+}
+
+
+
+
+void APD_RF(f_apd_rfft_rows) ( struct strAPD_RFFT* R, \
+
+                               tAPD_Real* s, \
+
+                               const int sign, \
+
+                               const double scale )
+{
+/* P U R P O S E
+ *
+ * Real-to-complex (sign=1) or complex-to-real (sign=-1, result multiplied by scale)
+ * transforms of all rows of s along the last dimension. The rows of an array of
+ * floats are transformed in double precision in R->row.
+ */
+
+    const int D = R->D;
+
+    long i_row, n_rows, k;
+
+    tAPD_Real *r;
+
+
+    n_rows = 1;
+
+    for (k=0; k<D-1; k++)
+
+        n_rows = n_rows * R->N[k];
+
+
+    for (i_row=0; i_row<n_rows; i_row++)
+    {
+        r = s + i_row * R->rs[D-1];
+
+        #ifdef APD_SINGLE
+
+            APD_RF(f_apd_fft_ld) (R->row, r, (sign > 0) ? R->N[D-1] : R->rs[D-1]);
+
+            f_apd_rfft_row(R, R->row, sign, scale);
+
+            APD_RF(f_apd_fft_st) (r, R->row, (sign > 0) ? R->rs[D-1] : R->N[D-1]);
+
+        #else
+
+            f_apd_rfft_row(R, r, sign, scale);
+
+        #endif
+    }
+}
+
+
+
+
+void APD_RF(f_apd_rfft_lines) ( struct strAPD_RFFT* R, \
+
+                                tAPD_Real* s, \
+
+                                const int sign )
+{
+/* P U R P O S E
+ *
+ * Complex transforms of s (after the real-to-complex step) along all dimensions
+ * except the last one. Blocks of R->nb adjacent lines are gathered into a
+ * contiguous buffer and transformed together.
+ */
+
+    const int D = R->D;
+
+    const long h = R->N[D-1]/2+1;
+
+    int d;
+
+    long i_out, n_out, c0, nc, k, st, len;
+
+    tAPD_Real *base;
+
+
+    for (d=0; d<D-1; d++)
+    {
+        /* Lines along dimension d have the stride st (in complex numbers); st
+         * adjacent lines are contiguous in memory */
+
+        st = h;
+
+        for (k=d+1; k<D-1; k++)
+
+            st = st * R->N[k];
+
+        n_out = 1;
+
+        for (k=0; k<d; k++)
+
+            n_out = n_out * R->N[k];
+
+        len = R->N[d];
+
+
+        for (i_out=0; i_out<n_out; i_out++)
+        {
+            base = s + 2 * i_out * len * st;
+
+            for (c0=0; c0<st; c0+=R->nb)
+            {
+                nc = (st-c0 < R->nb) ? st-c0 : R->nb;
+
+                for (k=0; k<len; k++)
+
+                    APD_RF(f_apd_fft_ld) (R->buf + 2*k*nc, base + 2*(k*st+c0), 2*nc);
+
+                f_apd_cfft_exec(R->cf[d], R->buf, nc, sign, R->work);
+
+                for (k=0; k<len; k++)
+
+                    APD_RF(f_apd_fft_st) (base + 2*(k*st+c0), R->buf + 2*k*nc, 2*nc);
+            }
+        }
+    }
+}
+
+
+
+
+void APD_RF(f_apd_rfft_forward) ( struct strAPD_RFFT* R, \
+
+                                  tAPD_Real* s )
+{
+/* P U R P O S E
+ *
+ * Computes the forward real FFT of s in-place (unnormalized).
+ */
+
+    APD_RF(f_apd_rfft_rows) (R, s, 1, 1.0);
+
+    APD_RF(f_apd_rfft_lines) (R, s, 1);
+}
+
+
+
+
+void APD_RF(f_apd_rfft_backward) ( struct strAPD_RFFT* R, \
+
+                                   tAPD_Real* s, \
+
+                                   const double scale )
+{
+/* P U R P O S E
+ *
+ * Computes the backward real FFT of s in-place; the result is multiplied by scale
+ * (1/(N[0]*...*N[D-1]) gives the inverse transform).
+ */
+
+    APD_RF(f_apd_rfft_lines) (R, s, -1);
+
+    APD_RF(f_apd_rfft_rows) (R, s, -1, scale);
+}
+
+
+
+
+#ifndef APD_SINGLE
+
+
+
+/* (5) PRUNED REAL FFT OF A 1D SIGNAL */
+
+/* Plan of the pruned real FFT of a 1D signal x of length n = p*m, which computes
+ * only the Fourier coefficients X(l), l < k, and transforms them back. With the
+ * sample index t = j + m*q (j < m, q < p),
+ *
+ *     X(l) = sum_j W^(j*l) * Z_j(l mod p),     W = exp(-2*pi*i/n),
+ *
+ * where Z_j is the DFT of length p of the subsequence x(j + m*q). The m short DFTs
+ * take about n*log2(p) operations and the sums k*m = k*n/p operations, compared
+ * with n*log2(n) operations of the full FFT. The backward transform reverses these
+ * steps: the k coefficients (and their complex conjugates) are distributed to the
+ * m short spectra, which are inverted by DFTs of length p. Two real subsequences
+ * (j, j+1) are packed into one complex sequence, and nb such sequences are
+ * transformed together. For p = 1, both transforms are direct sums over all
+ * samples. The twiddle factors W^j are products of a coarse and a fine table. */
+
+struct strAPD_PFFT {
+
+                    long         n;
+
+                    long         p;
+
+                    long         m;
+
+                    long         k;
+
+                    long         nb;
+
+                    int          tb;           // bits of the fine twiddle table
+
+                    struct strAPD_CFFT* cf;    // DFT of length p (NULL for p = 1)
+
+                    double*      tw_f;         // W^j, j < 2^tb
+
+                    double*      tw_c;         // W^(j*2^tb), j ≤ n/2^tb
+
+                    double*      X;            // coefficients X(l), l < k (CCE)
+
+                    double*      buf;
+
+                    double*      work;
+
+                   };
+
+
+
+
+long f_apd_pfft_select ( const long n, \
+
+                         const long k, \
+
+                         const int mkl )
+{
+/* P U R P O S E
+ *
+ * Selects the length p of the short DFTs of the pruned FFT (see strAPD_PFFT) of a
+ * signal of length n with k retained Fourier coefficients. The estimated costs (in
+ * butterflies of one direction) of the full real FFT, nh*log2(nh) + n with the
+ * length nh (n/2 or n) of its complex FFT, and of the pruned FFT, n/2*log2(p) + n +
+ * APD_PFFT_TW*k*n/p, are compared for all divisors p of n with prime factors not
+ * larger than APD_FFT_MAXP (i.e., without Bluestein's algorithm). If nh has larger
+ * prime factors, the built-in FFT uses Bluestein's algorithm (three FFTs of a
+ * power-of-two length mb ≥ 2*nh-1, i.e., 3*mb*log2(mb) + n). If the full FFT is
+ * computed by Intel MKL, the cost of the smooth length is divided by
+ * APD_PFFT_MKL. The pruned FFT is selected only if its cost is at most
+ * APD_PFFT_GAIN times the cost of the full FFT: the model neglects the cache misses
+ * of long short DFTs, so that pruned FFTs estimated to be slightly cheaper are not
+ * faster in practice (see benchmark_pruned.c). */
+
+/* I N P U T   A R G U M E N T S
+ *
+ * [n] - length of the signal.
+ *
+ * [k] - number of retained Fourier coefficients (the indexes 0, ..., k-1).
+ *
+ * [mkl] - 1 if the full FFT is computed by Intel MKL, 0 otherwise.
+ */
+
+/* R E T U R N   V A L U E
+ *
+ * [p] - length of the short DFTs (p = 1 for direct sums), or 0 if the full FFT is
+ *       used.
+ */
+
+    long p, r, f;
+
+    long p_best = 0;
+
+    long nh = (n % 2 == 0) ? n/2 : n;
+
+    long mb = 1;
+
+    double c;
+
+    double c_best;
+
+
+    if (k < 1 || 2*k > n)
+
+        return 0;
+
+
+    /* Cost of the full FFT (scaled by APD_PFFT_GAIN, the bound of the cost of the
+     * pruned FFT) */
+
+    r = nh;
+
+    for (f=2; f<=APD_FFT_MAXP && r>1; f++)
+
+        while (r % f == 0)
+
+            r = r / f;
+
+    if (mkl)
+
+        c_best = (nh * log2((double) nh) + n) / APD_PFFT_MKL;
+
+    else if (r == 1)
+
+        c_best = nh * log2((double) nh) + n;
+
+    else
+    {
+        while (mb < 2*nh-1)
+
+            mb = 2 * mb;
+
+        c_best = 3.0 * mb * log2((double) mb) + n;
+    }
+
+    c_best = APD_PFFT_GAIN * c_best;
+
+
+
+    /* Cost of the pruned FFT */
+
+
+    /* The optimum is near p = 2*ln(2)*APD_PFFT_TW*k */
+
+    for (p=1; p<=n && p<=16*k+16; p++)
+    {
+        if (n % p != 0)
+
+            continue;
+
+        r = p;
+
+        for (f=2; f<=APD_FFT_MAXP && r>1; f++)
+
+            while (r % f == 0)
+
+                r = r / f;
+
+        if (r != 1)
+
+            continue;
+
+        c = 0.5 * n * log2((double) p) + n + APD_PFFT_TW * k * ((double) n / p);
+
+        if (c < c_best)
+        {
+            c_best = c;
+
+            p_best = p;
+        }
+    }
+
+    return p_best;
+}
+
+
+
+
+void f_apd_pfft_free (struct strAPD_PFFT* R)
+{
+/* P U R P O S E
+ *
+ * Frees the pruned FFT plan created by f_apd_pfft_init.
+ */
+
+    if (R == NULL)
+
+        return;
+
+    f_apd_cfft_free(R->cf);
+
+    free(R->tw_f);
+
+    free(R->tw_c);
+
+    free(R->X);
+
+    free(R->buf);
+
+    free(R->work);
+
+    free(R);
+}
+
+
+
+
+int f_apd_pfft_init ( const long n, \
+
+                      const long p, \
+
+                      const long k, \
+
+                      struct strAPD_PFFT** R_out )
+{
+/* P U R P O S E
+ *
+ * Creates the plan of the pruned real FFT of a 1D signal.
+ */
+
+/* I N P U T   A R G U M E N T S
+ *
+ * [n] - length of the signal.
+ *
+ * [p] - length of the short DFTs, a divisor of n (see f_apd_pfft_select).
+ *
+ * [k] - number of retained Fourier coefficients (2*k ≤ n).
+ */
+
+/* O U T P U T   A R G U M E N T S
+ *
+ * [R_out] - pointer to the created plan (NULL upon an error).
+ */
+
+/* R E T U R N   V A L U E
+ *
+ * [exitflag] - exit flag. Any positive value indicates an error (for numerical and
+ *              textual definitions of the exit status, see l_ap_error_handling.c).
+ * 
+ *              Upon an error, all memory dynamically allocated in this function or
+ *              functions called by this function is freed.
+ */
+
+/* N O N S T A N D A R D   F U N C T I O N S   U S E D
+ *
+ * (1) f_apd_cfft_init, (2) f_apd_pfft_free.
+ */
+
+
+    /* Definitions and initializations */
+
+    int exitflag = 0;
+
+    f_apd_set_error (exitflag, __LINE__, APD_ERR_FILE);
+
+
+    long j, n_f, n_c;
+
+    double ang;
+
+    struct strAPD_PFFT *R = NULL;
+
+
+    *R_out = NULL;
+
+    R = (struct strAPD_PFFT*) calloc(1, sizeof(struct strAPD_PFFT));
+
+    if (R==NULL)
+    {
+        f_apd_set_error(APD_ERR_ID_MEM,__LINE__,APD_ERR_FILE); goto failed;}
+
+
+    R->n = n;
+
+    R->p = p;
+
+    R->m = n / p;
+
+    R->k = k;
+
+    R->nb = (p <= 1024) ? APD_FFT_NB : 4;
+
+
+
+    /* Twiddle tables (W^j = tw_c[j >> tb] * tw_f[j & (2^tb-1)], 4^tb ≥ n) */
+
+    R->tb = 0;
+
+    while (((long) 1 << (2*R->tb)) < n)
+
+        R->tb = R->tb + 1;
+
+    n_f = (long) 1 << R->tb;
+
+    n_c = (n >> R->tb) + 1;
+
+    R->tw_f = (double*) malloc(2*n_f*sizeof(double));
+
+    R->tw_c = (double*) malloc(2*n_c*sizeof(double));
+
+    R->X = (double*) malloc(2*k*sizeof(double));
+
+    if (R->tw_f==NULL || R->tw_c==NULL || R->X==NULL)
+    {
+        f_apd_set_error(APD_ERR_ID_MEM,__LINE__,APD_ERR_FILE); goto failed;}
+
+    for (j=0; j<n_f; j++)
+    {
+        ang = 2 * M_PI * (double) j / (double) n;
+
+        R->tw_f[2*j] = cos(ang);
+
+        R->tw_f[2*j+1] = -sin(ang);
+    }
+
+    for (j=0; j<n_c; j++)
+    {
+        ang = 2 * M_PI * (double) (j*n_f) / (double) n;
+
+        R->tw_c[2*j] = cos(ang);
+
+        R->tw_c[2*j+1] = -sin(ang);
+    }
+
+
+
+    /* Short DFTs and scratch arrays */
+
+    if (p > 1)
+    {
+        exitflag = f_apd_cfft_init(p, &(R->cf));
+
+        if (exitflag != APD_ERR_ID_NON) goto finish;
+    }
+
+    R->buf = (double*) malloc(2*p*R->nb*sizeof(double));
+
+    R->work = (double*) malloc(2*p*R->nb*sizeof(double));
+
+    if (R->buf==NULL || R->work==NULL)
+    {
+        f_apd_set_error(APD_ERR_ID_MEM,__LINE__,APD_ERR_FILE); goto failed;}
+
+
+
+    /* Output & Memory deallocation */
+
+    finish:
+
+        if (exitflag == APD_ERR_ID_NON)
+
+            *R_out = R;
+
+        else
+
+            f_apd_pfft_free(R);
+
+        return exitflag;
+
+    failed:
+
+        f_apd_get_error (&exitflag, NULL, NULL, NULL);
+
+        goto finish;
+
+}
+
+
+
+
+size_t f_apd_pfft_bytes ( const long n, \
+
+                          const long p, \
+
+                          const long k )
+{
+/* P U R P O S E
+ *
+ * Computes the memory allocated by f_apd_pfft_init for the plan of the pruned FFT
+ * (without creating the plan).
+ */
+
+/* I N P U T   A R G U M E N T S
+ *
+ * [n], [p], [k] - see f_apd_pfft_init.
+ */
+
+/* R E T U R N   V A L U E
+ *
+ * [bytes] - memory of the plan (in bytes).
+ */
+
+/* N O N S T A N D A R D   F U N C T I O N S   U S E D
+ *
+ * (1) f_apd_cfft_bytes.
+ */
+
+    int tb = 0;
+
+    const long nb = (p <= 1024) ? APD_FFT_NB : 4;
+
+    size_t bytes = sizeof(struct strAPD_PFFT);
+
+
+    while (((long) 1 << (2*tb)) < n)
+
+        tb = tb + 1;
+
+    bytes = bytes + 2*(((long) 1 << tb) + (n >> tb) + 1 + k)*sizeof(double);
+
+    if (p > 1)
+
+        bytes = bytes + f_apd_cfft_bytes(p);
+
+    return bytes + 4*p*nb*sizeof(double);
+}
+
+
+
+
+static inline tAPD_Cpx f_apd_pfft_tw (const struct strAPD_PFFT* R, const long j)
+{
+/* Twiddle factor W^j, 0 ≤ j < n */
+
+    return f_apd_c_mul(f_apd_c_ld(R->tw_c + 2*(j >> R->tb)), \
+                       f_apd_c_ld(R->tw_f + 2*(j & (((long) 1 << R->tb) - 1))));
+}
+
+#endif
+
+
+
+
+void APD_RF(f_apd_pfft_forward) ( struct strAPD_PFFT* R, \
+
+                                  const tAPD_Real* s )
+{
+/* P U R P O S E
+ *
+ * Computes the Fourier coefficients X(l), l < R->k, of the real signal s (length
+ * R->n) and stores them in R->X in the CCE format (unnormalized).
+ */
+
+    const long n = R->n;
+
+    const long p = R->p;
+
+    const long m = R->m;
+
+    long j0, j, cnt, nc, b, q, qc, l, i_e, i_o;
+
+    tAPD_Cpx zq, zc, ze, zo, x;
+
+
+    for (l=0; l<2*(R->k); l++)
+
+        R->X[l] = 0;
+
+
+    for (j0=0; j0<m; j0+=2*(R->nb))
+    {
+        /* Subsequences j0, ..., j0+cnt-1 packed into nc complex sequences */
+
+        cnt = (m-j0 < 2*(R->nb)) ? m-j0 : 2*(R->nb);
+
+        nc = (cnt+1) / 2;
+
+        for (q=0; q<p; q++)
+        {
+            APD_RF(f_apd_fft_ld) (R->buf + 2*q*nc, s + j0 + m*q, cnt);
+
+            if (cnt % 2 == 1)
+
+                R->buf[2*q*nc+cnt] = 0;
+        }
+
+        if (p > 1)
+
+            f_apd_cfft_exec(R->cf, R->buf, nc, 1, R->work);
+
+
+        /* Sums over the subsequences (the DFTs Z_j and Z_j+1 are separated from
+         * their packed DFT) */
+
+        for (b=0; b<nc; b++)
+        {
+            j = j0 + 2*b;
+
+            i_e = 0;
+
+            i_o = 0;
+
+            for (l=0; l<(R->k); l++)
+            {
+                q = l % p;
+
+                qc = (q == 0) ? 0 : p-q;
+
+                zq = f_apd_c_ld(R->buf + 2*(q*nc+b));
+
+                zc = f_apd_c_cnj(f_apd_c_ld(R->buf + 2*(qc*nc+b)));
+
+                ze = f_apd_c_scl(f_apd_c_add(zq, zc), 0.5);
+
+                zo = f_apd_c_scl(f_apd_c_mnj(f_apd_c_sub(zq, zc), 1.0), 0.5);
+
+                x = f_apd_c_add(f_apd_c_mul(ze, f_apd_pfft_tw(R, i_e)), \
+                                f_apd_c_mul(zo, f_apd_pfft_tw(R, i_o)));
+
+                f_apd_c_st(R->X + 2*l, f_apd_c_add(f_apd_c_ld(R->X + 2*l), x));
+
+                i_e = i_e + j;
+
+                i_e = (i_e >= n) ? i_e-n : i_e;
+
+                i_o = i_o + j + 1;
+
+                i_o = (i_o >= n) ? i_o-n : i_o;
+            }
+        }
+    }
+}
+
+
+
+
+void APD_RF(f_apd_pfft_backward) ( struct strAPD_PFFT* R, \
+
+                                   tAPD_Real* s, \
+
+                                   const double scale )
+{
+/* P U R P O S E
+ *
+ * Computes the real signal s (length R->n) whose only nonzero Fourier coefficients
+ * are R->X(l), l < R->k, and their complex conjugates; the result is multiplied by
+ * scale (1/R->n gives the inverse transform). R->X is multiplied by scale, too.
+ */
+
+    const long n = R->n;
+
+    const long p = R->p;
+
+    const long m = R->m;
+
+    long j0, j, cnt, nc, b, q, qc, l, i_e, i_o;
+
+    tAPD_Cpx x, ve, vo, d;
+
+
+    for (l=0; l<2*(R->k); l++)
+
+        R->X[l] = scale * R->X[l];
+
+
+    for (j0=0; j0<m; j0+=2*(R->nb))
+    {
+        cnt = (m-j0 < 2*(R->nb)) ? m-j0 : 2*(R->nb);
+
+        nc = (cnt+1) / 2;
+
+        memset(R->buf, 0, 2*p*nc*sizeof(double));
+
+
+        /* Short spectra of the subsequences j and j+1 packed into one complex
+         * sequence (V_j + i*V_j+1) */
+
+        for (b=0; b<nc; b++)
+        {
+            j = j0 + 2*b;
+
+            i_e = 0;
+
+            i_o = 0;
+
+            for (l=0; l<(R->k); l++)
+            {
+                q = l % p;
+
+                qc = (q == 0) ? 0 : p-q;
+
+                x = f_apd_c_ld(R->X + 2*l);
+
+                ve = f_apd_c_mul(x, f_apd_c_cnj(f_apd_pfft_tw(R, i_e)));
+
+                vo = f_apd_c_mul(x, f_apd_c_cnj(f_apd_pfft_tw(R, i_o)));
+
+                d = f_apd_c_add(ve, f_apd_c_mnj(vo, -1.0));
+
+                f_apd_c_st(R->buf + 2*(q*nc+b), \
+                        f_apd_c_add(f_apd_c_ld(R->buf + 2*(q*nc+b)), d));
+
+                if (l > 0)
+                {
+                    d = f_apd_c_add(f_apd_c_cnj(ve), \
+                                    f_apd_c_mnj(f_apd_c_cnj(vo), -1.0));
+
+                    f_apd_c_st(R->buf + 2*(qc*nc+b), \
+                            f_apd_c_add(f_apd_c_ld(R->buf + 2*(qc*nc+b)), d));
+                }
+
+                i_e = i_e + j;
+
+                i_e = (i_e >= n) ? i_e-n : i_e;
+
+                i_o = i_o + j + 1;
+
+                i_o = (i_o >= n) ? i_o-n : i_o;
+            }
+        }
+
+
+        if (p > 1)
+
+            f_apd_cfft_exec(R->cf, R->buf, nc, -1, R->work);
+
+        for (q=0; q<p; q++)
+
+            APD_RF(f_apd_fft_st) (s + j0 + m*q, R->buf + 2*q*nc, cnt);
+    }
+}
@@ -0,0 +1,1631 @@
+
+/*                       C O P Y R I G H T   N O T I C E
+ *
+ * Copyright ©2021. Institute of Science and Technology Austria (IST Austria).
+ * All Rights Reserved. The underlying technology is protected by PCT Patent
+ * Application No. PCT/EP2021/054650.
+ *
+ * This file is part of the AP Demodulation library, which is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation in version 2.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY, without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE. See the GNU General Public License v2 for more details. You
+ * should have received a copy of the GNU General Public License v2 along with this
+ * program. If not, see https://www.gnu.org/licenses/.
+ *
+ * Contact the Technology Transfer Office, IST Austria, Am Campus 1,
+ * A-3400 Klosterneuburg, Austria, +43-(0)2243 9000, twist@ist.ac.at, for commercial
+ * licensing opportunities.
+ *
+ * See https://github.com/mgabriel-lt/ap-demodulation for the latest version of the
+ * code and user-friendly explanations on the working principle, domains of
+ * application, and advice on the usage of different AP Demodulation algorithms in
+ * practice.
+ */
+
+
+/* C O N T E N T S
+ *
+ * Elementwise kernels of the AP algorithms, i.e., the projections onto the set Cd
+ * with the updates of the auxiliary variables and the accumulation of the squared
+ * differences, in three versions selected at runtime: scalar (any platform), AVX2,
+ * and AVX-512 (x86 with GCC or Clang, unless the macro APD_NO_SIMD is defined).
+ *
+ * All versions give bitwise identical results. The projections are exact and
+ * follow the original loops (s < s_abs → s_abs; otherwise s > Ub → Ub), and every
+ * sum is accumulated in APD_KERN_W interleaved lanes (element i of the array in
+ * lane i % APD_KERN_W) that are combined in a fixed order (f_apd_lane_sum), both in
+ * the vectorized and in the scalar versions. Contraction of multiplications and
+ * additions to FMA instructions is disabled, as it would change the rounding.
+ *
+ * The file is included twice by f_apd_demodulation.c: for the arrays of doubles and
+ * (with the macro APD_SINGLE defined) for the arrays of floats, in which case the
+ * names of the structure and functions have the suffix _f (APD_RF). The
+ * single-precision kernels load and store floats, but do the arithmetic and the sums
+ * in double precision, with the values rounded to float where they are stored.
+ *
+ * (1) strAPD_Kern and f_apd_lane_sum,
+ *
+ * (2) f_apd_cd_basic, f_apd_cd_basic_ub, f_apd_cd_accelerated,
+ *     f_apd_cd_accelerated_ub, f_apd_cd_projected, f_apd_cd_projected_ub, and
+ *     f_apd_sum_sq - the scalar kernels,
+ *
+ * (3) the AVX2 versions of the kernels (suffix _avx2),
+ *
+ * (4) the AVX-512 versions of the kernels (suffix _avx512),
+ *
+ * (5) f_apd_kernels - the runtime (CPUID-based) selection of the kernels.
+ */
+
+
+
+#include "h_apd.h"
+
+
+#if !defined(APD_NO_SIMD) && (defined(__GNUC__) || defined(__clang__)) && \
+        (defined(__x86_64__) || defined(__i386__))
+
+    #include <immintrin.h>
+
+    #define APD_KERN_X86
+
+    #define APD_KERN_AVX2 __attribute__((target("avx2")))
+
+    #define APD_KERN_AVX512 __attribute__((target("avx512f")))
+
+#endif
+
+
+#define APD_KERN_W 8          // number of interleaved lanes of the sums
+
+
+#ifndef APD_KERN_LEVEL
+
+    #define APD_KERN_LEVEL 2  // highest instruction set used by the AP algorithms
+                              // (0 - scalar, 1 - AVX2, 2 - AVX-512)
+#endif
+
+
+#if defined(__clang__)
+
+    #pragma STDC FP_CONTRACT OFF
+
+#elif defined(__GNUC__)
+
+    #pragma GCC push_options
+
+    #pragma GCC optimize ("fp-contract=off")
+
+#endif
+
+
+
+
+/* (1) TABLE OF THE KERNELS AND THE SUM OF THE LANES */
+
+struct APD_RF(strAPD_Kern) {
+
+                    double (*cd_b) (tAPD_Real*, const tAPD_Real*, const long);
+
+                    double (*cd_b_ub) (tAPD_Real*, const tAPD_Real*, \
+                                       const tAPD_Real*, const long);
+
+                    double (*cd_a) (tAPD_Real*, const tAPD_Real*, tAPD_Real*, \
+                                    tAPD_Real*, const double, const long);
+
+                    double (*cd_a_ub) (tAPD_Real*, const tAPD_Real*, \
+                                       const tAPD_Real*, tAPD_Real*, tAPD_Real*, \
+                                       const double, const long);
+
+                    double (*cd_p) (tAPD_Real*, const tAPD_Real*, tAPD_Real*, \
+                                    tAPD_Real*, const long);
+
+                    double (*cd_p_ub) (tAPD_Real*, const tAPD_Real*, \
+                                       const tAPD_Real*, tAPD_Real*, tAPD_Real*, \
+                                       const long);
+
+                    double (*sum_sq) (const tAPD_Real*, const long);
+
+                    const char*  name;
+
+                   };
+
+
+
+
+#ifndef APD_SINGLE
+
+double f_apd_lane_sum (const double* l)
+{
+/* P U R P O S E
+ *
+ * Sums the APD_KERN_W = 8 lanes of a kernel in the fixed order, in which the
+ * vectorized kernels reduce their registers.
+ */
+
+    return ((l[0] + l[4]) + (l[2] + l[6])) + ((l[1] + l[5]) + (l[3] + l[7]));
+}
+
+#endif
+
+
+
+
+/* (2) SCALAR KERNELS */
+
+/* Input arguments of the kernels (of one block of one channel):
+ *
+ * [s] - current estimate of the modulator (AP-B) or the modulator (AP-A and AP-P).
+ *       It is modified in-place (set to the projection onto Cd).
+ *
+ * [s_abs] - normalized absolute-value signal.
+ *
+ * [Ub] - normalized upper bound on the modulator (_ub versions only).
+ *
+ * [a], [b], [c] - auxiliary variables of AP-A and AP-P. They are modified in-place.
+ *
+ * [lambda] - factor lambda of AP-A.
+ *
+ * [n] - number of elements.
+ *
+ * The return value is the sum of the squared differences used for the infeasibility
+ * error (AP-B and AP-P) or the nominator of lambda (AP-A). */
+
+
+
+double APD_RF(f_apd_cd_basic) ( tAPD_Real* s, \
+
+                                const tAPD_Real* s_abs, \
+
+                                const long n )
+{
+/* P U R P O S E
+ *
+ * Projection onto the set Cd of AP-Basic and the sum of (s_new - s_old)^2.
+ */
+
+    long i;
+
+    double l[APD_KERN_W] = {0};
+
+    double v;
+
+    double d;
+
+
+    for (i=0; i<n; i++)
+    {
+        v = (s[i] < s_abs[i]) ? s_abs[i] : s[i];
+
+        d = v - s[i];
+
+        s[i] = v;
+
+        l[i % APD_KERN_W] = l[i % APD_KERN_W] + d * d;
+    }
+
+    return f_apd_lane_sum (l);
+}
+
+
+
+
+double APD_RF(f_apd_cd_basic_ub) ( tAPD_Real* s, \
+
+                                   const tAPD_Real* s_abs, \
+
+                                   const tAPD_Real* Ub, \
+
+                                   const long n )
+{
+/* P U R P O S E
+ *
+ * Projection onto the set Cd (with an upper bound) of AP-Basic and the sum of
+ * (s_new - s_old)^2.
+ */
+
+    long i;
+
+    double l[APD_KERN_W] = {0};
+
+    double v;
+
+    double d;
+
+
+    for (i=0; i<n; i++)
+    {
+        v = (s[i] < s_abs[i]) ? s_abs[i] : ((s[i] > Ub[i]) ? Ub[i] : s[i]);
+
+        d = v - s[i];
+
+        s[i] = v;
+
+        l[i % APD_KERN_W] = l[i % APD_KERN_W] + d * d;
+    }
+
+    return f_apd_lane_sum (l);
+}
+
+
+
+
+double APD_RF(f_apd_cd_accelerated) ( tAPD_Real* s, \
+
+                                      const tAPD_Real* s_abs, \
+
+                                      tAPD_Real* a, \
+
+                                      tAPD_Real* b, \
+
+                                      const double lambda, \
+
+                                      const long n )
+{
+/* P U R P O S E
+ *
+ * Update a = a + lambda * b, projection of a onto the set Cd, update b = s - a,
+ * and the sum of b^2 (AP-Accelerated).
+ */
+
+    long i;
+
+    double l[APD_KERN_W] = {0};
+
+    double v;
+
+
+    for (i=0; i<n; i++)
+    {
+        a[i] = a[i] + lambda * b[i];
+
+        v = (a[i] < s_abs[i]) ? s_abs[i] : a[i];
+
+        s[i] = v;
+
+        b[i] = v - a[i];
+
+        l[i % APD_KERN_W] = l[i % APD_KERN_W] + (double) b[i] * b[i];
+    }
+
+    return f_apd_lane_sum (l);
+}
+
+
+
+
+double APD_RF(f_apd_cd_accelerated_ub) ( tAPD_Real* s, \
+
+                                         const tAPD_Real* s_abs, \
+
+                                         const tAPD_Real* Ub, \
+
+                                         tAPD_Real* a, \
+
+                                         tAPD_Real* b, \
+
+                                         const double lambda, \
+
+                                         const long n )
+{
+/* P U R P O S E
+ *
+ * Same as f_apd_cd_accelerated with an upper bound in the projection onto Cd.
+ */
+
+    long i;
+
+    double l[APD_KERN_W] = {0};
+
+    double v;
+
+
+    for (i=0; i<n; i++)
+    {
+        a[i] = a[i] + lambda * b[i];
+
+        v = (a[i] < s_abs[i]) ? s_abs[i] : ((a[i] > Ub[i]) ? Ub[i] : a[i]);
+
+        s[i] = v;
+
+        b[i] = v - a[i];
+
+        l[i % APD_KERN_W] = l[i % APD_KERN_W] + (double) b[i] * b[i];
+    }
+
+    return f_apd_lane_sum (l);
+}
+
+
+
+
+double APD_RF(f_apd_cd_projected) ( tAPD_Real* s, \
+
+                                    const tAPD_Real* s_abs, \
+
+                                    tAPD_Real* a, \
+
+                                    tAPD_Real* c, \
+
+                                    const long n )
+{
+/* P U R P O S E
+ *
+ * Projection of a - c onto the set Cd, updates of c and a, and the sum of
+ * (s - a)^2 + (s_new - a)^2 (AP-Projected).
+ */
+
+    long i;
+
+    double l[APD_KERN_W] = {0};
+
+    double v;
+
+    double d;
+
+    double d2;
+
+
+    for (i=0; i<n; i++)
+    {
+        d = (double) s[i] - a[i];
+
+        v = (double) a[i] - c[i];
+
+        v = (v < s_abs[i]) ? s_abs[i] : v;
+
+        d2 = v - a[i];
+
+        c[i] = c[i] + d2;
+
+        a[i] = v;
+
+        s[i] = v;
+
+        l[i % APD_KERN_W] = l[i % APD_KERN_W] + d * d + d2 * d2;
+    }
+
+    return f_apd_lane_sum (l);
+}
+
+
+
+
+double APD_RF(f_apd_cd_projected_ub) ( tAPD_Real* s, \
+
+                                       const tAPD_Real* s_abs, \
+
+                                       const tAPD_Real* Ub, \
+
+                                       tAPD_Real* a, \
+
+                                       tAPD_Real* c, \
+
+                                       const long n )
+{
+/* P U R P O S E
+ *
+ * Same as f_apd_cd_projected with an upper bound in the projection onto Cd.
+ */
+
+    long i;
+
+    double l[APD_KERN_W] = {0};
+
+    double v;
+
+    double d;
+
+    double d2;
+
+
+    for (i=0; i<n; i++)
+    {
+        d = (double) s[i] - a[i];
+
+        v = (double) a[i] - c[i];
+
+        v = (v < s_abs[i]) ? s_abs[i] : ((v > Ub[i]) ? Ub[i] : v);
+
+        d2 = v - a[i];
+
+        c[i] = c[i] + d2;
+
+        a[i] = v;
+
+        s[i] = v;
+
+        l[i % APD_KERN_W] = l[i % APD_KERN_W] + d * d + d2 * d2;
+    }
+
+    return f_apd_lane_sum (l);
+}
+
+
+
+
+double APD_RF(f_apd_sum_sq) ( const tAPD_Real* x, \
+
+                              const long n )
+{
+/* P U R P O S E
+ *
+ * Sum of x^2.
+ */
+
+    long i;
+
+    double l[APD_KERN_W] = {0};
+
+
+    for (i=0; i<n; i++)
+
+        l[i % APD_KERN_W] = l[i % APD_KERN_W] + (double) x[i] * x[i];
+
+    return f_apd_lane_sum (l);
+}
+
+
+
+
+#ifdef APD_KERN_X86
+
+
+
+    /* (3) AVX2 KERNELS */
+
+    /* The lanes 0-3 and 4-7 are held in two registers of 4 doubles. The elements
+     * after the last multiple of APD_KERN_W are processed as in the scalar kernels.
+     * The projections onto Cd are max(s_abs, x) and, with an upper bound,
+     * (x < s_abs) ? s_abs : min(Ub, x), which select the same operands as the
+     * comparisons of the scalar kernels (including signed zeros and NaNs). The
+     * arguments are the same as of the scalar kernels. Single-precision arrays are
+     * converted to double precision when loaded (f_apd_ld_avx2_f) and rounded when
+     * stored (f_apd_st_avx2_f); a value that the scalar kernels read back from an
+     * array after storing it is rounded in the register, too (f_apd_rnd_avx2_f). */
+
+    #ifdef APD_SINGLE
+
+        APD_KERN_AVX2 static inline __m256d f_apd_ld_avx2_f (const float* p)
+            { return _mm256_cvtps_pd(_mm_loadu_ps(p)); }
+
+        APD_KERN_AVX2 static inline void f_apd_st_avx2_f (float* p, const __m256d x)
+            { _mm_storeu_ps(p, _mm256_cvtpd_ps(x)); }
+
+        APD_KERN_AVX2 static inline __m256d f_apd_rnd_avx2_f (const __m256d x)
+            { return _mm256_cvtps_pd(_mm256_cvtpd_ps(x)); }
+
+    #else
+
+        APD_KERN_AVX2 static inline __m256d f_apd_ld_avx2 (const double* p)
+            { return _mm256_loadu_pd(p); }
+
+        APD_KERN_AVX2 static inline void f_apd_st_avx2 (double* p, const __m256d x)
+            { _mm256_storeu_pd(p, x); }
+
+        APD_KERN_AVX2 static inline __m256d f_apd_rnd_avx2 (const __m256d x)
+            { return x; }
+
+    #endif
+
+    APD_KERN_AVX2 static inline
+    __m256d APD_RF(f_apd_pcd_avx2) (const __m256d x, const tAPD_Real* s_abs)
+        { return _mm256_max_pd(APD_RF(f_apd_ld_avx2) (s_abs), x); }
+
+    APD_KERN_AVX2 static inline
+    __m256d APD_RF(f_apd_pcd_ub_avx2) (const __m256d x, \
+                                       const tAPD_Real* s_abs, \
+                                       const tAPD_Real* Ub)
+    {
+        __m256d sa = APD_RF(f_apd_ld_avx2) (s_abs);
+
+        return _mm256_blendv_pd(_mm256_min_pd(APD_RF(f_apd_ld_avx2) (Ub), x), sa, \
+                                _mm256_cmp_pd(x, sa, _CMP_LT_OQ));
+    }
+
+
+
+
+    APD_KERN_AVX2
+    double APD_RF(f_apd_cd_basic_avx2) ( tAPD_Real* s, \
+
+                                         const tAPD_Real* s_abs, \
+
+                                         const long n )
+    {
+        long i;
+
+        long j;
+
+        double l[APD_KERN_W];
+
+        double v;
+
+        double d;
+
+        __m256d acc[2] = {_mm256_setzero_pd(), _mm256_setzero_pd()};
+
+        __m256d x;
+
+        __m256d y;
+
+
+        for (i=0; i+APD_KERN_W<=n; i=i+APD_KERN_W)
+        {
+            for (j=0; j<APD_KERN_W; j=j+4)
+            {
+                x = APD_RF(f_apd_ld_avx2) (s+i+j);
+
+                y = APD_RF(f_apd_pcd_avx2) (x, s_abs+i+j);
+
+                APD_RF(f_apd_st_avx2) (s+i+j, y);
+
+                x = _mm256_sub_pd(y, x);
+
+                acc[j/4] = _mm256_add_pd(acc[j/4], _mm256_mul_pd(x, x));
+            }
+        }
+
+        _mm256_storeu_pd(l, acc[0]);
+
+        _mm256_storeu_pd(l+4, acc[1]);
+
+
+        for (; i<n; i++)
+        {
+            v = (s[i] < s_abs[i]) ? s_abs[i] : s[i];
+
+            d = v - s[i];
+
+            s[i] = v;
+
+            l[i % APD_KERN_W] = l[i % APD_KERN_W] + d * d;
+        }
+
+        return f_apd_lane_sum (l);
+    }
+
+
+
+
+    APD_KERN_AVX2
+    double APD_RF(f_apd_cd_basic_ub_avx2) ( tAPD_Real* s, \
+
+                                            const tAPD_Real* s_abs, \
+
+                                            const tAPD_Real* Ub, \
+
+                                            const long n )
+    {
+        long i;
+
+        long j;
+
+        double l[APD_KERN_W];
+
+        double v;
+
+        double d;
+
+        __m256d acc[2] = {_mm256_setzero_pd(), _mm256_setzero_pd()};
+
+        __m256d x;
+
+        __m256d y;
+
+
+        for (i=0; i+APD_KERN_W<=n; i=i+APD_KERN_W)
+        {
+            for (j=0; j<APD_KERN_W; j=j+4)
+            {
+                x = APD_RF(f_apd_ld_avx2) (s+i+j);
+
+                y = APD_RF(f_apd_pcd_ub_avx2) (x, s_abs+i+j, Ub+i+j);
+
+                APD_RF(f_apd_st_avx2) (s+i+j, y);
+
+                x = _mm256_sub_pd(y, x);
+
+                acc[j/4] = _mm256_add_pd(acc[j/4], _mm256_mul_pd(x, x));
+            }
+        }
+
+        _mm256_storeu_pd(l, acc[0]);
+
+        _mm256_storeu_pd(l+4, acc[1]);
+
+
+        for (; i<n; i++)
+        {
+            v = (s[i] < s_abs[i]) ? s_abs[i] : ((s[i] > Ub[i]) ? Ub[i] : s[i]);
+
+            d = v - s[i];
+
+            s[i] = v;
+
+            l[i % APD_KERN_W] = l[i % APD_KERN_W] + d * d;
+        }
+
+        return f_apd_lane_sum (l);
+    }
+
+
+
+
+    APD_KERN_AVX2
+    double APD_RF(f_apd_cd_accelerated_avx2) ( tAPD_Real* s, \
+
+                                               const tAPD_Real* s_abs, \
+
+                                               tAPD_Real* a, \
+
+                                               tAPD_Real* b, \
+
+                                               const double lambda, \
+
+                                               const long n )
+    {
+        long i;
+
+        long j;
+
+        double l[APD_KERN_W];
+
+        double v;
+
+        __m256d acc[2] = {_mm256_setzero_pd(), _mm256_setzero_pd()};
+
+        __m256d x;
+
+        __m256d y;
+
+        __m256d lam = _mm256_set1_pd(lambda);
+
+
+        for (i=0; i+APD_KERN_W<=n; i=i+APD_KERN_W)
+        {
+            for (j=0; j<APD_KERN_W; j=j+4)
+            {
+                x = _mm256_add_pd(APD_RF(f_apd_ld_avx2) (a+i+j), \
+                                  _mm256_mul_pd(lam, APD_RF(f_apd_ld_avx2) (b+i+j)));
+
+                x = APD_RF(f_apd_rnd_avx2) (x);
+
+                APD_RF(f_apd_st_avx2) (a+i+j, x);
+
+                y = APD_RF(f_apd_pcd_avx2) (x, s_abs+i+j);
+
+                APD_RF(f_apd_st_avx2) (s+i+j, y);
+
+                x = _mm256_sub_pd(y, x);
+
+                x = APD_RF(f_apd_rnd_avx2) (x);
+
+                APD_RF(f_apd_st_avx2) (b+i+j, x);
+
+                acc[j/4] = _mm256_add_pd(acc[j/4], _mm256_mul_pd(x, x));
+            }
+        }
+
+        _mm256_storeu_pd(l, acc[0]);
+
+        _mm256_storeu_pd(l+4, acc[1]);
+
+
+        for (; i<n; i++)
+        {
+            a[i] = a[i] + lambda * b[i];
+
+            v = (a[i] < s_abs[i]) ? s_abs[i] : a[i];
+
+            s[i] = v;
+
+            b[i] = v - a[i];
+
+            l[i % APD_KERN_W] = l[i % APD_KERN_W] + (double) b[i] * b[i];
+        }
+
+        return f_apd_lane_sum (l);
+    }
+
+
+
+
+    APD_KERN_AVX2
+    double APD_RF(f_apd_cd_accelerated_ub_avx2) ( tAPD_Real* s, \
+
+                                                  const tAPD_Real* s_abs, \
+
+                                                  const tAPD_Real* Ub, \
+
+                                                  tAPD_Real* a, \
+
+                                                  tAPD_Real* b, \
+
+                                                  const double lambda, \
+
+                                                  const long n )
+    {
+        long i;
+
+        long j;
+
+        double l[APD_KERN_W];
+
+        double v;
+
+        __m256d acc[2] = {_mm256_setzero_pd(), _mm256_setzero_pd()};
+
+        __m256d x;
+
+        __m256d y;
+
+        __m256d lam = _mm256_set1_pd(lambda);
+
+
+        for (i=0; i+APD_KERN_W<=n; i=i+APD_KERN_W)
+        {
+            for (j=0; j<APD_KERN_W; j=j+4)
+            {
+                x = _mm256_add_pd(APD_RF(f_apd_ld_avx2) (a+i+j), \
+                                  _mm256_mul_pd(lam, APD_RF(f_apd_ld_avx2) (b+i+j)));
+
+                x = APD_RF(f_apd_rnd_avx2) (x);
+
+                APD_RF(f_apd_st_avx2) (a+i+j, x);
+
+                y = APD_RF(f_apd_pcd_ub_avx2) (x, s_abs+i+j, Ub+i+j);
+
+                APD_RF(f_apd_st_avx2) (s+i+j, y);
+
+                x = _mm256_sub_pd(y, x);
+
+                x = APD_RF(f_apd_rnd_avx2) (x);
+
+                APD_RF(f_apd_st_avx2) (b+i+j, x);
+
+                acc[j/4] = _mm256_add_pd(acc[j/4], _mm256_mul_pd(x, x));
+            }
+        }
+
+        _mm256_storeu_pd(l, acc[0]);
+
+        _mm256_storeu_pd(l+4, acc[1]);
+
+
+        for (; i<n; i++)
+        {
+            a[i] = a[i] + lambda * b[i];
+
+            v = (a[i] < s_abs[i]) ? s_abs[i] : ((a[i] > Ub[i]) ? Ub[i] : a[i]);
+
+            s[i] = v;
+
+            b[i] = v - a[i];
+
+            l[i % APD_KERN_W] = l[i % APD_KERN_W] + (double) b[i] * b[i];
+        }
+
+        return f_apd_lane_sum (l);
+    }
+
+
+
+
+    APD_KERN_AVX2
+    double APD_RF(f_apd_cd_projected_avx2) ( tAPD_Real* s, \
+
+                                             const tAPD_Real* s_abs, \
+
+                                             tAPD_Real* a, \
+
+                                             tAPD_Real* c, \
+
+                                             const long n )
+    {
+        long i;
+
+        long j;
+
+        double l[APD_KERN_W];
+
+        double v;
+
+        double d;
+
+        double d2;
+
+        __m256d acc[2] = {_mm256_setzero_pd(), _mm256_setzero_pd()};
+
+        __m256d x;
+
+        __m256d y;
+
+        __m256d z;
+
+        __m256d w;
+
+
+        for (i=0; i+APD_KERN_W<=n; i=i+APD_KERN_W)
+        {
+            for (j=0; j<APD_KERN_W; j=j+4)
+            {
+                x = APD_RF(f_apd_ld_avx2) (a+i+j);
+
+                z = _mm256_sub_pd(APD_RF(f_apd_ld_avx2) (s+i+j), x);
+
+                w = APD_RF(f_apd_ld_avx2) (c+i+j);
+
+                y = APD_RF(f_apd_pcd_avx2) (_mm256_sub_pd(x, w), s_abs+i+j);
+
+                x = _mm256_sub_pd(y, x);
+
+                APD_RF(f_apd_st_avx2) (c+i+j, _mm256_add_pd(w, x));
+
+                APD_RF(f_apd_st_avx2) (a+i+j, y);
+
+                APD_RF(f_apd_st_avx2) (s+i+j, y);
+
+                acc[j/4] = _mm256_add_pd(acc[j/4], _mm256_mul_pd(z, z));
+
+                acc[j/4] = _mm256_add_pd(acc[j/4], _mm256_mul_pd(x, x));
+            }
+        }
+
+        _mm256_storeu_pd(l, acc[0]);
+
+        _mm256_storeu_pd(l+4, acc[1]);
+
+
+        for (; i<n; i++)
+        {
+            d = (double) s[i] - a[i];
+
+            v = (double) a[i] - c[i];
+
+            v = (v < s_abs[i]) ? s_abs[i] : v;
+
+            d2 = v - a[i];
+
+            c[i] = c[i] + d2;
+
+            a[i] = v;
+
+            s[i] = v;
+
+            l[i % APD_KERN_W] = l[i % APD_KERN_W] + d * d + d2 * d2;
+        }
+
+        return f_apd_lane_sum (l);
+    }
+
+
+
+
+    APD_KERN_AVX2
+    double APD_RF(f_apd_cd_projected_ub_avx2) ( tAPD_Real* s, \
+
+                                                const tAPD_Real* s_abs, \
+
+                                                const tAPD_Real* Ub, \
+
+                                                tAPD_Real* a, \
+
+                                                tAPD_Real* c, \
+
+                                                const long n )
+    {
+        long i;
+
+        long j;
+
+        double l[APD_KERN_W];
+
+        double v;
+
+        double d;
+
+        double d2;
+
+        __m256d acc[2] = {_mm256_setzero_pd(), _mm256_setzero_pd()};
+
+        __m256d x;
+
+        __m256d y;
+
+        __m256d z;
+
+        __m256d w;
+
+
+        for (i=0; i+APD_KERN_W<=n; i=i+APD_KERN_W)
+        {
+            for (j=0; j<APD_KERN_W; j=j+4)
+            {
+                x = APD_RF(f_apd_ld_avx2) (a+i+j);
+
+                z = _mm256_sub_pd(APD_RF(f_apd_ld_avx2) (s+i+j), x);
+
+                w = APD_RF(f_apd_ld_avx2) (c+i+j);
+
+                y = APD_RF(f_apd_pcd_ub_avx2) (_mm256_sub_pd(x, w), s_abs+i+j, \
+                                               Ub+i+j);
+
+                x = _mm256_sub_pd(y, x);
+
+                APD_RF(f_apd_st_avx2) (c+i+j, _mm256_add_pd(w, x));
+
+                APD_RF(f_apd_st_avx2) (a+i+j, y);
+
+                APD_RF(f_apd_st_avx2) (s+i+j, y);
+
+                acc[j/4] = _mm256_add_pd(acc[j/4], _mm256_mul_pd(z, z));
+
+                acc[j/4] = _mm256_add_pd(acc[j/4], _mm256_mul_pd(x, x));
+            }
+        }
+
+        _mm256_storeu_pd(l, acc[0]);
+
+        _mm256_storeu_pd(l+4, acc[1]);
+
+
+        for (; i<n; i++)
+        {
+            d = (double) s[i] - a[i];
+
+            v = (double) a[i] - c[i];
+
+            v = (v < s_abs[i]) ? s_abs[i] : ((v > Ub[i]) ? Ub[i] : v);
+
+            d2 = v - a[i];
+
+            c[i] = c[i] + d2;
+
+            a[i] = v;
+
+            s[i] = v;
+
+            l[i % APD_KERN_W] = l[i % APD_KERN_W] + d * d + d2 * d2;
+        }
+
+        return f_apd_lane_sum (l);
+    }
+
+
+
+
+    APD_KERN_AVX2
+    double APD_RF(f_apd_sum_sq_avx2) ( const tAPD_Real* x, \
+
+                                       const long n )
+    {
+        long i;
+
+        long j;
+
+        double l[APD_KERN_W];
+
+        __m256d acc[2] = {_mm256_setzero_pd(), _mm256_setzero_pd()};
+
+        __m256d y;
+
+
+        for (i=0; i+APD_KERN_W<=n; i=i+APD_KERN_W)
+        {
+            for (j=0; j<APD_KERN_W; j=j+4)
+            {
+                y = APD_RF(f_apd_ld_avx2) (x+i+j);
+
+                acc[j/4] = _mm256_add_pd(acc[j/4], _mm256_mul_pd(y, y));
+            }
+        }
+
+        _mm256_storeu_pd(l, acc[0]);
+
+        _mm256_storeu_pd(l+4, acc[1]);
+
+
+        for (; i<n; i++)
+
+            l[i % APD_KERN_W] = l[i % APD_KERN_W] + (double) x[i] * x[i];
+
+        return f_apd_lane_sum (l);
+    }
+
+
+
+
+    /* (4) AVX-512 KERNELS */
+
+    /* The lanes 0-7 are held in one register of 8 doubles. Otherwise, as the AVX2
+     * kernels. */
+
+    #ifdef APD_SINGLE
+
+        APD_KERN_AVX512 static inline __m512d f_apd_ld_avx512_f (const float* p)
+            { return _mm512_cvtps_pd(_mm256_loadu_ps(p)); }
+
+        APD_KERN_AVX512 static inline void f_apd_st_avx512_f (float* p, \
+                                                             const __m512d x)
+            { _mm256_storeu_ps(p, _mm512_cvtpd_ps(x)); }
+
+        APD_KERN_AVX512 static inline __m512d f_apd_rnd_avx512_f (const __m512d x)
+            { return _mm512_cvtps_pd(_mm512_cvtpd_ps(x)); }
+
+    #else
+
+        APD_KERN_AVX512 static inline __m512d f_apd_ld_avx512 (const double* p)
+            { return _mm512_loadu_pd(p); }
+
+        APD_KERN_AVX512 static inline void f_apd_st_avx512 (double* p, \
+                                                           const __m512d x)
+            { _mm512_storeu_pd(p, x); }
+
+        APD_KERN_AVX512 static inline __m512d f_apd_rnd_avx512 (const __m512d x)
+            { return x; }
+
+    #endif
+
+    APD_KERN_AVX512 static inline
+    __m512d APD_RF(f_apd_pcd_avx512) (const __m512d x, const tAPD_Real* s_abs)
+        { return _mm512_max_pd(APD_RF(f_apd_ld_avx512) (s_abs), x); }
+
+    APD_KERN_AVX512 static inline
+    __m512d APD_RF(f_apd_pcd_ub_avx512) (const __m512d x, \
+                                         const tAPD_Real* s_abs, \
+                                         const tAPD_Real* Ub)
+    {
+        __m512d sa = APD_RF(f_apd_ld_avx512) (s_abs);
+
+        return _mm512_mask_blend_pd(_mm512_cmp_pd_mask(x, sa, _CMP_LT_OQ), \
+                                    _mm512_min_pd(APD_RF(f_apd_ld_avx512) (Ub), x), \
+                                    sa);
+    }
+
+
+
+
+    APD_KERN_AVX512
+    double APD_RF(f_apd_cd_basic_avx512) ( tAPD_Real* s, \
+
+                                           const tAPD_Real* s_abs, \
+
+                                           const long n )
+    {
+        long i;
+
+        double l[APD_KERN_W];
+
+        double v;
+
+        double d;
+
+        __m512d acc = _mm512_setzero_pd();
+
+        __m512d x;
+
+        __m512d y;
+
+
+        for (i=0; i+APD_KERN_W<=n; i=i+APD_KERN_W)
+        {
+            x = APD_RF(f_apd_ld_avx512) (s+i);
+
+            y = APD_RF(f_apd_pcd_avx512) (x, s_abs+i);
+
+            APD_RF(f_apd_st_avx512) (s+i, y);
+
+            x = _mm512_sub_pd(y, x);
+
+            acc = _mm512_add_pd(acc, _mm512_mul_pd(x, x));
+        }
+
+        _mm512_storeu_pd(l, acc);
+
+
+        for (; i<n; i++)
+        {
+            v = (s[i] < s_abs[i]) ? s_abs[i] : s[i];
+
+            d = v - s[i];
+
+            s[i] = v;
+
+            l[i % APD_KERN_W] = l[i % APD_KERN_W] + d * d;
+        }
+
+        return f_apd_lane_sum (l);
+    }
+
+
+
+
+    APD_KERN_AVX512
+    double APD_RF(f_apd_cd_basic_ub_avx512) ( tAPD_Real* s, \
+
+                                              const tAPD_Real* s_abs, \
+
+                                              const tAPD_Real* Ub, \
+
+                                              const long n )
+    {
+        long i;
+
+        double l[APD_KERN_W];
+
+        double v;
+
+        double d;
+
+        __m512d acc = _mm512_setzero_pd();
+
+        __m512d x;
+
+        __m512d y;
+
+
+        for (i=0; i+APD_KERN_W<=n; i=i+APD_KERN_W)
+        {
+            x = APD_RF(f_apd_ld_avx512) (s+i);
+
+            y = APD_RF(f_apd_pcd_ub_avx512) (x, s_abs+i, Ub+i);
+
+            APD_RF(f_apd_st_avx512) (s+i, y);
+
+            x = _mm512_sub_pd(y, x);
+
+            acc = _mm512_add_pd(acc, _mm512_mul_pd(x, x));
+        }
+
+        _mm512_storeu_pd(l, acc);
+
+
+        for (; i<n; i++)
+        {
+            v = (s[i] < s_abs[i]) ? s_abs[i] : ((s[i] > Ub[i]) ? Ub[i] : s[i]);
+
+            d = v - s[i];
+
+            s[i] = v;
+
+            l[i % APD_KERN_W] = l[i % APD_KERN_W] + d * d;
+        }
+
+        return f_apd_lane_sum (l);
+    }
+
+
+
+
+    APD_KERN_AVX512
+    double APD_RF(f_apd_cd_accelerated_avx512) ( tAPD_Real* s, \
+
+                                                 const tAPD_Real* s_abs, \
+
+                                                 tAPD_Real* a, \
+
+                                                 tAPD_Real* b, \
+
+                                                 const double lambda, \
+
+                                                 const long n )
+    {
+        long i;
+
+        double l[APD_KERN_W];
+
+        double v;
+
+        __m512d acc = _mm512_setzero_pd();
+
+        __m512d x;
+
+        __m512d y;
+
+        __m512d lam = _mm512_set1_pd(lambda);
+
+
+        for (i=0; i+APD_KERN_W<=n; i=i+APD_KERN_W)
+        {
+            x = _mm512_add_pd(APD_RF(f_apd_ld_avx512) (a+i), \
+                              _mm512_mul_pd(lam, APD_RF(f_apd_ld_avx512) (b+i)));
+
+            x = APD_RF(f_apd_rnd_avx512) (x);
+
+            APD_RF(f_apd_st_avx512) (a+i, x);
+
+            y = APD_RF(f_apd_pcd_avx512) (x, s_abs+i);
+
+            APD_RF(f_apd_st_avx512) (s+i, y);
+
+            x = _mm512_sub_pd(y, x);
+
+            x = APD_RF(f_apd_rnd_avx512) (x);
+
+            APD_RF(f_apd_st_avx512) (b+i, x);
+
+            acc = _mm512_add_pd(acc, _mm512_mul_pd(x, x));
+        }
+
+        _mm512_storeu_pd(l, acc);
+
+
+        for (; i<n; i++)
+        {
+            a[i] = a[i] + lambda * b[i];
+
+            v = (a[i] < s_abs[i]) ? s_abs[i] : a[i];
+
+            s[i] = v;
+
+            b[i] = v - a[i];
+
+            l[i % APD_KERN_W] = l[i % APD_KERN_W] + (double) b[i] * b[i];
+        }
+
+        return f_apd_lane_sum (l);
+    }
+
+
+
+
+    APD_KERN_AVX512
+    double APD_RF(f_apd_cd_accelerated_ub_avx512) ( tAPD_Real* s, \
+
+                                                    const tAPD_Real* s_abs, \
+
+                                                    const tAPD_Real* Ub, \
+
+                                                    tAPD_Real* a, \
+
+                                                    tAPD_Real* b, \
+
+                                                    const double lambda, \
+
+                                                    const long n )
+    {
+        long i;
+
+        double l[APD_KERN_W];
+
+        double v;
+
+        __m512d acc = _mm512_setzero_pd();
+
+        __m512d x;
+
+        __m512d y;
+
+        __m512d lam = _mm512_set1_pd(lambda);
+
+
+        for (i=0; i+APD_KERN_W<=n; i=i+APD_KERN_W)
+        {
+            x = _mm512_add_pd(APD_RF(f_apd_ld_avx512) (a+i), \
+                              _mm512_mul_pd(lam, APD_RF(f_apd_ld_avx512) (b+i)));
+
+            x = APD_RF(f_apd_rnd_avx512) (x);
+
+            APD_RF(f_apd_st_avx512) (a+i, x);
+
+            y = APD_RF(f_apd_pcd_ub_avx512) (x, s_abs+i, Ub+i);
+
+            APD_RF(f_apd_st_avx512) (s+i, y);
+
+            x = _mm512_sub_pd(y, x);
+
+            x = APD_RF(f_apd_rnd_avx512) (x);
+
+            APD_RF(f_apd_st_avx512) (b+i, x);
+
+            acc = _mm512_add_pd(acc, _mm512_mul_pd(x, x));
+        }
+
+        _mm512_storeu_pd(l, acc);
+
+
+        for (; i<n; i++)
+        {
+            a[i] = a[i] + lambda * b[i];
+
+            v = (a[i] < s_abs[i]) ? s_abs[i] : ((a[i] > Ub[i]) ? Ub[i] : a[i]);
+
+            s[i] = v;
+
+            b[i] = v - a[i];
+
+            l[i % APD_KERN_W] = l[i % APD_KERN_W] + (double) b[i] * b[i];
+        }
+
+        return f_apd_lane_sum (l);
+    }
+
+
+
+
+    APD_KERN_AVX512
+    double APD_RF(f_apd_cd_projected_avx512) ( tAPD_Real* s, \
+
+                                               const tAPD_Real* s_abs, \
+
+                                               tAPD_Real* a, \
+
+                                               tAPD_Real* c, \
+
+                                               const long n )
+    {
+        long i;
+
+        double l[APD_KERN_W];
+
+        double v;
+
+        double d;
+
+        double d2;
+
+        __m512d acc = _mm512_setzero_pd();
+
+        __m512d x;
+
+        __m512d y;
+
+        __m512d z;
+
+        __m512d w;
+
+
+        for (i=0; i+APD_KERN_W<=n; i=i+APD_KERN_W)
+        {
+            x = APD_RF(f_apd_ld_avx512) (a+i);
+
+            z = _mm512_sub_pd(APD_RF(f_apd_ld_avx512) (s+i), x);
+
+            w = APD_RF(f_apd_ld_avx512) (c+i);
+
+            y = APD_RF(f_apd_pcd_avx512) (_mm512_sub_pd(x, w), s_abs+i);
+
+            x = _mm512_sub_pd(y, x);
+
+            APD_RF(f_apd_st_avx512) (c+i, _mm512_add_pd(w, x));
+
+            APD_RF(f_apd_st_avx512) (a+i, y);
+
+            APD_RF(f_apd_st_avx512) (s+i, y);
+
+            acc = _mm512_add_pd(acc, _mm512_mul_pd(z, z));
+
+            acc = _mm512_add_pd(acc, _mm512_mul_pd(x, x));
+        }
+
+        _mm512_storeu_pd(l, acc);
+
+
+        for (; i<n; i++)
+        {
+            d = (double) s[i] - a[i];
+
+            v = (double) a[i] - c[i];
+
+            v = (v < s_abs[i]) ? s_abs[i] : v;
+
+            d2 = v - a[i];
+
+            c[i] = c[i] + d2;
+
+            a[i] = v;
+
+            s[i] = v;
+
+            l[i % APD_KERN_W] = l[i % APD_KERN_W] + d * d + d2 * d2;
+        }
+
+        return f_apd_lane_sum (l);
+    }
+
+
+
+
+    APD_KERN_AVX512
+    double APD_RF(f_apd_cd_projected_ub_avx512) ( tAPD_Real* s, \
+
+                                                  const tAPD_Real* s_abs, \
+
+                                                  const tAPD_Real* Ub, \
+
+                                                  tAPD_Real* a, \
+
+                                                  tAPD_Real* c, \
+
+                                                  const long n )
+    {
+        long i;
+
+        double l[APD_KERN_W];
+
+        double v;
+
+        double d;
+
+        double d2;
+
+        __m512d acc = _mm512_setzero_pd();
+
+        __m512d x;
+
+        __m512d y;
+
+        __m512d z;
+
+        __m512d w;
+
+
+        for (i=0; i+APD_KERN_W<=n; i=i+APD_KERN_W)
+        {
+            x = APD_RF(f_apd_ld_avx512) (a+i);
+
+            z = _mm512_sub_pd(APD_RF(f_apd_ld_avx512) (s+i), x);
+
+            w = APD_RF(f_apd_ld_avx512) (c+i);
+
+            y = APD_RF(f_apd_pcd_ub_avx512) (_mm512_sub_pd(x, w), s_abs+i, Ub+i);
+
+            x = _mm512_sub_pd(y, x);
+
+            APD_RF(f_apd_st_avx512) (c+i, _mm512_add_pd(w, x));
+
+            APD_RF(f_apd_st_avx512) (a+i, y);
+
+            APD_RF(f_apd_st_avx512) (s+i, y);
+
+            acc = _mm512_add_pd(acc, _mm512_mul_pd(z, z));
+
+            acc = _mm512_add_pd(acc, _mm512_mul_pd(x, x));
+        }
+
+        _mm512_storeu_pd(l, acc);
+
+
+        for (; i<n; i++)
+        {
+            d = (double) s[i] - a[i];
+
+            v = (double) a[i] - c[i];
+
+            v = (v < s_abs[i]) ? s_abs[i] : ((v > Ub[i]) ? Ub[i] : v);
+
+            d2 = v - a[i];
+
+            c[i] = c[i] + d2;
+
+            a[i] = v;
+
+            s[i] = v;
+
+            l[i % APD_KERN_W] = l[i % APD_KERN_W] + d * d + d2 * d2;
+        }
+
+        return f_apd_lane_sum (l);
+    }
+
+
+
+
+    APD_KERN_AVX512
+    double APD_RF(f_apd_sum_sq_avx512) ( const tAPD_Real* x, \
+
+                                         const long n )
+    {
+        long i;
+
+        double l[APD_KERN_W];
+
+        __m512d acc = _mm512_setzero_pd();
+
+        __m512d y;
+
+
+        for (i=0; i+APD_KERN_W<=n; i=i+APD_KERN_W)
+        {
+            y = APD_RF(f_apd_ld_avx512) (x+i);
+
+            acc = _mm512_add_pd(acc, _mm512_mul_pd(y, y));
+        }
+
+        _mm512_storeu_pd(l, acc);
+
+
+        for (; i<n; i++)
+
+            l[i % APD_KERN_W] = l[i % APD_KERN_W] + (double) x[i] * x[i];
+
+        return f_apd_lane_sum (l);
+    }
+
+#endif
+
+
+
+
+/* (5) RUNTIME SELECTION OF THE KERNELS */
+
+static const struct APD_RF(strAPD_Kern) APD_RF(sgAPD_KERN_SCALAR) = { \
+        APD_RF(f_apd_cd_basic), APD_RF(f_apd_cd_basic_ub), \
+        APD_RF(f_apd_cd_accelerated), APD_RF(f_apd_cd_accelerated_ub), \
+        APD_RF(f_apd_cd_projected), APD_RF(f_apd_cd_projected_ub), \
+        APD_RF(f_apd_sum_sq), "scalar"};
+
+#ifdef APD_KERN_X86
+
+    static const struct APD_RF(strAPD_Kern) APD_RF(sgAPD_KERN_AVX2) = { \
+            APD_RF(f_apd_cd_basic_avx2), APD_RF(f_apd_cd_basic_ub_avx2), \
+            APD_RF(f_apd_cd_accelerated_avx2), APD_RF(f_apd_cd_accelerated_ub_avx2), \
+            APD_RF(f_apd_cd_projected_avx2), APD_RF(f_apd_cd_projected_ub_avx2), \
+            APD_RF(f_apd_sum_sq_avx2), "AVX2"};
+
+    static const struct APD_RF(strAPD_Kern) APD_RF(sgAPD_KERN_AVX512) = { \
+            APD_RF(f_apd_cd_basic_avx512), APD_RF(f_apd_cd_basic_ub_avx512), \
+            APD_RF(f_apd_cd_accelerated_avx512), \
+            APD_RF(f_apd_cd_accelerated_ub_avx512), \
+            APD_RF(f_apd_cd_projected_avx512), APD_RF(f_apd_cd_projected_ub_avx512), \
+            APD_RF(f_apd_sum_sq_avx512), "AVX-512"};
+
+#endif
+
+
+
+
+const struct APD_RF(strAPD_Kern)* APD_RF(f_apd_kernels) (const int level)
+{
+/* P U R P O S E
+ *
+ * Selects the kernels of the AP algorithms supported by the CPU (as reported by
+ * the CPUID instruction and the operating system).
+ */
+
+/* I N P U T   A R G U M E N T S
+ *
+ * [level] - highest allowed instruction set: 0 - scalar, 1 - AVX2, 2 - AVX-512.
+ */
+
+/* R E T U R N   V A L U E
+ *
+ * [kern] - pointer to the (static) table of the selected kernels.
+ */
+
+
+    #ifdef APD_KERN_X86
+
+        if (level >= 2 && __builtin_cpu_supports("avx512f"))
+
+            return &APD_RF(sgAPD_KERN_AVX512);
+
+        if (level >= 1 && __builtin_cpu_supports("avx2"))
+
+            return &APD_RF(sgAPD_KERN_AVX2);
+
+    #else
+
+        (void) level;
+
+    #endif
+
+
+    return &APD_RF(sgAPD_KERN_SCALAR);
+}
+
+
+
+
+#if defined(__clang__)
+
+    #pragma STDC FP_CONTRACT DEFAULT
+
+#elif defined(__GNUC__)
+
+    #pragma GCC pop_options
+
+#endif
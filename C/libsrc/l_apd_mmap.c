@@ -0,0 +1,806 @@
+/*                       C O P Y R I G H T   N O T I C E
+ *
+ * Copyright ©2021. Institute of Science and Technology Austria (IST Austria).
+ * All Rights Reserved. The underlying technology is protected by PCT Patent
+ * Application No. PCT/EP2021/054650.
+ *
+ * This file is part of the AP Demodulation library, which is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation in version 2.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY, without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE. See the GNU General Public License v2 for more details. You
+ * should have received a copy of the GNU General Public License v2 along with this
+ * program. If not, see https://www.gnu.org/licenses/.
+ *
+ * Contact the Technology Transfer Office, IST Austria, Am Campus 1,
+ * A-3400 Klosterneuburg, Austria, +43-(0)2243 9000, twist@ist.ac.at, for commercial
+ * licensing opportunities.
+ *
+ * See https://github.com/mgabriel-lt/ap-demodulation for the latest version of the
+ * code and user-friendly explanations on the working principle, domains of
+ * application, and advice on the usage of different AP Demodulation algorithms in
+ * practice.
+ */
+
+
+/* C O N T E N T S
+ *
+ * The out-of-core demodulation of 1D signals that do not fit into memory. The signal
+ * is read from a memory-mapped binary file and demodulated segment by segment in a
+ * stream (see l_apd_stream.c), and the modulator is written straight into a
+ * memory-mapped output file. Only windows of the files around the current segment
+ * are mapped at a time, and the next window of the signal file is read into memory
+ * by a reader thread while the current segment is demodulated, so that the resident
+ * memory is bounded by a budget given by the user:
+ *
+ * (1) APD_MMAP_BYTES, APD_MMAP_EDGE, and strAPD_Ahead,
+ *
+ * (2) f_apd_mmap_length,
+ *
+ * (3) f_apd_mmap_map,
+ *
+ * (4) f_apd_mmap_ahead,
+ *
+ * (5) f_apd_mmap_pull,
+ *
+ * (6) f_apd_demodulation_mmap.
+ *
+ * Memory mapping is not available on Windows, where f_apd_demodulation_mmap
+ * returns an error. If the macro APD_NO_PTHREADS is defined, the next window is
+ * only advised to the operating system to be read ahead.
+ */
+
+
+
+#include "h_apd.h"
+
+
+
+/* (1) MEMORY AND EDGES OF THE SEGMENTS */
+
+/* Resident memory per sample of a segment and channel: the stream (7 doubles, see
+ * f_apd_stream_create), the work arrays, mappings, and DFT of the multichannel plan
+ * (at most 9 doubles), and the mapped windows of the files (4 doubles) */
+
+#define APD_MMAP_BYTES (20*sizeof(double))
+
+
+/* Length of the discarded edges of a segment in units of Fs/(Pi*Fc*acc) samples,
+ * i.e., the distance at which the envelope 1/(Pi*Fc*t) of the sinc kernel of the
+ * projection onto Mw drops to the accuracy target acc */
+
+#define APD_MMAP_EDGE 1.0
+
+
+/* Read-ahead of a mapped window: the first byte of every page of the window is read
+ * (and the sum of these bytes kept, so that the reads are not optimized away) */
+
+struct strAPD_Ahead {
+
+                    const char*  p;
+
+                    size_t       len;
+
+                    long         pg;
+
+                    unsigned     sum;
+                };
+
+
+
+
+/* (2)-(6) FUNCTIONS OF THE OUT-OF-CORE DEMODULATION */
+
+long f_apd_mmap_length (const long L_max, const long L_min)
+{
+/* P U R P O S E
+ *
+ * Finds the largest segment length not larger than L_max whose prime factors are 2,
+ * 3, and 5 only (the fastest lengths of the DFT), or L_max if there is no such
+ * length not smaller than L_min.
+ */
+
+/* I N P U T   A R G U M E N T S
+ *
+ * [L_max] - largest allowed length (positive).
+ *
+ * [L_min] - smallest allowed length.
+ */
+
+/* O U T P U T   A R G U M E N T S
+ *
+ * None.
+ */
+
+/* R E T U R N   V A L U E
+ *
+ * [L] - segment length.
+ */
+
+/* N O N S T A N D A R D   F U N C T I O N S   U S E D
+ *
+ * None.
+ */
+
+
+    long L = 0;
+
+    long p2;
+
+    long p3;
+
+    long p5;
+
+
+    for (p5=1; p5<=L_max; p5=5*p5)
+
+        for (p3=p5; p3<=L_max; p3=3*p3)
+        {
+            for (p2=p3; 2*p2<=L_max; p2=2*p2);
+
+            if (p2 > L)
+
+                L = p2;
+        }
+
+
+    return (L >= L_min) ? L : L_max;
+}
+
+
+
+
+#ifndef _WIN32
+
+int f_apd_mmap_map ( const int fd, \
+
+                     const int prot, \
+
+                     const long pos, \
+
+                     const long n, \
+
+                     const long pg, \
+
+                     void** base, \
+
+                     size_t* len, \
+
+                     double** x )
+{
+/* P U R P O S E
+ *
+ * Maps the window of n doubles at the position pos of a file into memory (from the
+ * page in which the window starts).
+ */
+
+/* I N P U T   A R G U M E N T S
+ *
+ * [fd] - file descriptor.
+ *
+ * [prot] - protection of the mapping (PROT_READ or PROT_READ | PROT_WRITE).
+ *
+ * [pos], [n] - first double and number of doubles of the window (positive).
+ *
+ * [pg] - size of the memory pages (in bytes).
+ */
+
+/* O U T P U T   A R G U M E N T S
+ *
+ * [base], [len] - address and length of the mapping (to be unmapped by munmap).
+ *
+ * [x] - address of the first double of the window.
+ */
+
+/* R E T U R N   V A L U E
+ *
+ * [exitflag] - exit flag. Any positive value indicates an error (for numerical and
+ *              textual definitions of the exit status, see l_ap_error_handling.c).
+ */
+
+/* N O N S T A N D A R D   F U N C T I O N S   U S E D
+ *
+ * None.
+ */
+
+
+    int exitflag = 0;
+
+    const off_t off = (off_t) pos * (off_t) sizeof(double);
+
+    const off_t off_pg = off - off % pg;
+
+
+    *len = (size_t) (off - off_pg) + n*sizeof(double);
+
+    *base = mmap(NULL, *len, prot, MAP_SHARED, fd, off_pg);
+
+    if (*base == MAP_FAILED)
+    {
+        *base = NULL;
+
+        f_apd_set_error(APD_ERR_ID_MMF,__LINE__,APD_ERR_FILE);
+
+        f_apd_get_error (&exitflag, NULL, NULL, NULL);
+
+        return exitflag;
+    }
+
+    *x = (double*) ((char*) *base + (off - off_pg));
+
+
+    return exitflag;
+}
+
+
+
+
+void* f_apd_mmap_ahead (void* arg)
+{
+/* P U R P O S E
+ *
+ * Reads a mapped window of a file into memory page by page (the body of the reader
+ * thread).
+ */
+
+/* I N P U T   A R G U M E N T S
+ *
+ * [arg] - read-ahead of the window (struct strAPD_Ahead*).
+ */
+
+/* O U T P U T   A R G U M E N T S
+ *
+ * [arg] - read-ahead with the sum of the first bytes of the pages.
+ */
+
+/* R E T U R N   V A L U E
+ *
+ * NULL.
+ */
+
+/* N O N S T A N D A R D   F U N C T I O N S   U S E D
+ *
+ * None.
+ */
+
+
+    struct strAPD_Ahead *A = (struct strAPD_Ahead*) arg;
+
+    size_t i;
+
+    unsigned sum = 0;
+
+
+    for (i=0; i<(A->len); i=i+A->pg)
+
+        sum = sum + (unsigned char) A->p[i];
+
+    A->sum = sum;
+
+
+    return NULL;
+}
+
+
+
+
+int f_apd_mmap_pull ( struct strAPD_Stream* S, \
+
+                      const int fd, \
+
+                      const long n, \
+
+                      const long n_ch, \
+
+                      const long n_max, \
+
+                      const long pg, \
+
+                      void** base, \
+
+                      size_t* len, \
+
+                      double** m, \
+
+                      long* pos_w, \
+
+                      long* n_w, \
+
+                      long* pos_m )
+{
+/* P U R P O S E
+ *
+ * Pulls the output of a stream into the mapped window of the modulator file that
+ * follows the last output. The window stays mapped across the pulls and is mapped
+ * again (at the first frame not yet written) only when it is full.
+ */
+
+/* I N P U T   A R G U M E N T S
+ *
+ * [S] - stream.
+ *
+ * [fd] - file descriptor of the modulator file.
+ *
+ * [n], [n_ch] - numbers of frames and channels of the modulator file.
+ *
+ * [n_max] - largest number of frames of the window.
+ *
+ * [pg] - size of the memory pages (in bytes).
+ *
+ * [base], [len], [m] - mapping of the window (see f_apd_mmap_map; NULL if no
+ *                      window is mapped).
+ *
+ * [pos_w], [n_w] - first frame and number of frames of the window.
+ *
+ * [pos_m] - number of frames written so far.
+ */
+
+/* O U T P U T   A R G U M E N T S
+ *
+ * [S] - stream without the pulled output.
+ *
+ * [base], [len], [m], [pos_w], [n_w] - mapping of the current window.
+ *
+ * [pos_m] - number of frames written, increased by the pulled frames.
+ */
+
+/* R E T U R N   V A L U E
+ *
+ * [exitflag] - exit flag. Any positive value indicates an error (for numerical and
+ *              textual definitions of the exit status, see l_ap_error_handling.c).
+ */
+
+/* N O N S T A N D A R D   F U N C T I O N S   U S E D
+ *
+ * (1) f_apd_mmap_map, (2) f_apd_stream_pull.
+ */
+
+
+    int exitflag = 0;
+
+    long n_out;
+
+
+    if (*pos_m == n)
+
+        return exitflag;
+
+    if (*pos_m == *pos_w + *n_w)
+    {
+        if (*base != NULL)
+
+            munmap(*base, *len);
+
+        *base = NULL;
+
+        *pos_w = *pos_m;
+
+        *n_w = (n - *pos_m < n_max) ? n - *pos_m : n_max;
+
+        exitflag = f_apd_mmap_map (fd, PROT_READ | PROT_WRITE, (*pos_w)*n_ch, \
+                                   (*n_w)*n_ch, pg, base, len, m);
+
+        if (exitflag != APD_ERR_ID_NON)
+
+            return exitflag;
+    }
+
+    f_apd_stream_pull (S, *m + (*pos_m - *pos_w)*n_ch, *pos_w + *n_w - *pos_m, \
+                       &n_out);
+
+    *pos_m = *pos_m + n_out;
+
+
+    return exitflag;
+}
+
+#endif
+
+
+
+
+int f_apd_demodulation_mmap ( const char* file_s, \
+
+                              const char* file_m, \
+
+                              const struct strAPD_Par* Par, \
+
+                              const long n_ch, \
+
+                              const double acc, \
+
+                              const long mem, \
+
+                              const struct strAPD_Opt* opt, \
+
+                              long* L_seg )
+{
+/* P U R P O S E
+ *
+ * Demodulates a 1D signal stored in a file, which may be larger than the available
+ * memory, in overlapping segments, and writes the modulator into another file. The
+ * segments are demodulated in a stream with cold starts (see f_apd_stream_create),
+ * so that the modulator matches f_apd_demodulation of the whole signal up to the
+ * accuracy target away from the ends of the signal. The edges of the segments are
+ * chosen from Par.Fc[0] and the accuracy target, and the segments are as long as
+ * the memory budget allows. If the whole signal fits into the budget, it is
+ * demodulated as one segment.
+ */
+
+/* I N P U T   A R G U M E N T S
+ *
+ * [file_s] - name of the binary file with the signal: Par.Ns[0] frames of n_ch
+ *            doubles (interleaved channels, native byte order).
+ *
+ * [file_m] - name of the binary file for the modulator (in the layout of file_s).
+ *            The file is created or overwritten.
+ *
+ * [Par] - pointer to the structure with demodulation parameters (see
+ *         f_apd_demodulation). Par.D must be 1, and Par.Ns[0] is the number of
+ *         frames of the signal. The fields .im and .ie are not used.
+ *
+ * [n_ch] - number of channels (positive).
+ *
+ * [acc] - accuracy target (0 < acc < 1): the boundary effects of the segments,
+ *         relative to the modulator, that may reach the output. The discarded edges
+ *         of the segments are about Par.Fs[0]/(Pi*Par.Fc[0]*acc) samples long.
+ *
+ * [mem] - memory budget (in bytes): the bound on the resident memory used by the
+ *         demodulation, which determines the segment length.
+ *
+ * [opt] - options of the plan of the segments (see f_apd_stream_create) or NULL
+ *         for the defaults (see f_apd_get_options).
+ */
+
+/* O U T P U T   A R G U M E N T S
+ *
+ * [L_seg] - segment length (this is the address of an externally defined scalar
+ *           variable, or NULL).
+ */
+
+/* R E T U R N   V A L U E
+ *
+ * [exitflag] - exit flag. Any positive value indicates an error (for numerical and
+ *              textual definitions of the exit status, see l_ap_error_handling.c).
+ *
+ *              Upon an error, all memory dynamically allocated in this function or
+ *              functions called by this function is freed, and the files are
+ *              closed (file_m may be incomplete).
+ */
+
+/* N O N S T A N D A R D   F U N C T I O N S   U S E D
+ *
+ * (1) f_apd_mmap_length, (2) f_apd_mmap_map, (3) f_apd_mmap_ahead,
+ * (4) f_apd_mmap_pull, (5) f_apd_stream_init, (6) f_apd_stream_push,
+ * (7) f_apd_stream_flush, (8) f_apd_stream_destroy.
+ */
+
+
+    /* Definitions and initializations */
+
+    int exitflag = 0;
+
+    f_apd_set_error (exitflag, __LINE__, APD_ERR_FILE);
+
+
+    long n;
+
+    long L;
+
+    long L_max;
+
+    long e;
+
+    long hop;
+
+    long xf;
+
+    struct strAPD_Par Par_b;
+
+
+
+    /* Validation of the arguments */
+
+    if (Par->D != 1 || n_ch < 1 || !(acc > 0 && acc < 1) || mem < 1 || \
+            !(Par->Fs[0] > 0) || !(Par->Fc[0] > 0) || Par->Ns[0] < 1)
+    {
+        f_apd_set_error(APD_ERR_ID_MM,__LINE__,APD_ERR_FILE);
+
+        f_apd_get_error (&exitflag, NULL, NULL, NULL);
+
+        return exitflag;
+    }
+
+    n = Par->Ns[0];
+
+
+
+    /* Layout of the segments: the whole signal, or segments of the length L with
+     * edges of e samples, a crossfade of e samples, and the hop L-3e >= e */
+
+    L_max = mem / (long) (n_ch*APD_MMAP_BYTES);
+
+    e = (long) ceil(APD_MMAP_EDGE * Par->Fs[0] / (M_PI * Par->Fc[0] * acc));
+
+    if (n <= L_max)
+    {
+        L = n;
+
+        hop = n;
+
+        xf = 0;
+    }
+
+    else
+    {
+        if (L_max < 4*e)
+        {
+            f_apd_set_error(APD_ERR_ID_MMB,__LINE__,APD_ERR_FILE);
+
+            f_apd_get_error (&exitflag, NULL, NULL, NULL);
+
+            return exitflag;
+        }
+
+        L = f_apd_mmap_length (L_max, 4*e);
+
+        xf = e;
+
+        hop = L - 2*e - xf;
+    }
+
+    if (L_seg != NULL)
+
+        *L_seg = L;
+
+
+
+#ifdef _WIN32
+
+    f_apd_set_error(APD_ERR_ID_MMF,__LINE__,APD_ERR_FILE);
+
+    f_apd_get_error (&exitflag, NULL, NULL, NULL);
+
+    return exitflag;
+
+#else
+
+    const long pg = sysconf(_SC_PAGESIZE);
+
+    int fd_s = -1;
+
+    int fd_m = -1;
+
+    struct stat st;
+
+    struct strAPD_Stream *S = NULL;
+
+    long pos_s = 0;
+
+    long pos_m = 0;
+
+    long pos_w = 0;
+
+    long n_w = 0;
+
+    long c;
+
+    long c_nx;
+
+    long n_in;
+
+    long n_out;
+
+    void *b_s = NULL;
+
+    void *b_nx = NULL;
+
+    void *b_m = NULL;
+
+    size_t len_s = 0;
+
+    size_t len_nx = 0;
+
+    size_t len_m = 0;
+
+    double *x = NULL;
+
+    double *x_nx = NULL;
+
+    double *m = NULL;
+
+    #ifndef APD_NO_PTHREADS
+
+        struct strAPD_Ahead A;
+
+        pthread_t th;
+
+        int rd = 0;
+
+    #endif
+
+
+
+    /* Files: the signal (at least n frames) and the modulator (n frames) */
+
+    fd_s = open(file_s, O_RDONLY);
+
+    fd_m = open(file_m, O_RDWR | O_CREAT | O_TRUNC, 0644);
+
+    if (fd_s < 0 || fd_m < 0 || fstat(fd_s, &st) != 0 || \
+            st.st_size < (off_t) n * n_ch * (off_t) sizeof(double) || \
+            ftruncate(fd_m, (off_t) n * n_ch * (off_t) sizeof(double)) != 0)
+    {
+        f_apd_set_error(APD_ERR_ID_MMF,__LINE__,APD_ERR_FILE); goto failed;}
+
+
+
+    /* Stream of the segments */
+
+    Par_b = *Par;
+
+    Par_b.Ns[0] = L;
+
+    exitflag = f_apd_stream_init (&Par_b, n_ch, hop, xf, 0, 0, opt, &S);
+
+    if (exitflag != APD_ERR_ID_NON) goto finish;
+
+
+
+    /* Demodulation: the signal is pushed in chunks of hop frames. The window of the
+     * next chunk is mapped and read by the reader thread while the current chunk is
+     * pushed (and the completed segment demodulated), and the output is pulled into
+     * a window of 2L frames of the modulator file, which is mapped again when it
+     * is full */
+
+    c = (hop < n) ? hop : n;
+
+    exitflag = f_apd_mmap_map (fd_s, PROT_READ, 0, c*n_ch, pg, &b_s, &len_s, &x);
+
+    if (exitflag != APD_ERR_ID_NON) goto finish;
+
+    while (pos_s < n)
+    {
+        c_nx = (n - pos_s - c < hop) ? n - pos_s - c : hop;
+
+        if (c_nx > 0)
+        {
+            exitflag = f_apd_mmap_map (fd_s, PROT_READ, (pos_s+c)*n_ch, c_nx*n_ch, \
+                                       pg, &b_nx, &len_nx, &x_nx);
+
+            if (exitflag != APD_ERR_ID_NON) goto finish;
+
+            #ifdef POSIX_MADV_WILLNEED
+
+                posix_madvise(b_nx, len_nx, POSIX_MADV_WILLNEED);
+
+            #endif
+
+            #ifndef APD_NO_PTHREADS
+
+                A.p = (const char*) b_nx;
+
+                A.len = len_nx;
+
+                A.pg = pg;
+
+                rd = (pthread_create (&th, NULL, f_apd_mmap_ahead, &A) == 0);
+
+            #endif
+        }
+
+        n_in = 0;
+
+        while (n_in < c)
+        {
+            exitflag = f_apd_stream_push (S, x + n_in*n_ch, c - n_in, &n_out);
+
+            if (exitflag != APD_ERR_ID_NON) goto finish;
+
+            n_in = n_in + n_out;
+
+
+            /* Output of the completed segments */
+
+            exitflag = f_apd_mmap_pull (S, fd_m, n, n_ch, 2*L, pg, &b_m, &len_m, \
+                                        &m, &pos_w, &n_w, &pos_m);
+
+            if (exitflag != APD_ERR_ID_NON) goto finish;
+        }
+
+        #ifndef APD_NO_PTHREADS
+
+            if (rd != 0)
+
+                pthread_join (th, NULL);
+
+            rd = 0;
+
+        #endif
+
+        munmap(b_s, len_s);
+
+        pos_s = pos_s + c;
+
+        b_s = b_nx;
+
+        len_s = len_nx;
+
+        x = x_nx;
+
+        b_nx = NULL;
+
+        c = (n - pos_s < hop) ? n - pos_s : hop;
+    }
+
+
+
+    /* Last segment */
+
+    exitflag = f_apd_stream_flush (S);
+
+    if (exitflag != APD_ERR_ID_NON) goto finish;
+
+    while (pos_m < n)
+    {
+        n_in = pos_m;
+
+        exitflag = f_apd_mmap_pull (S, fd_m, n, n_ch, 2*L, pg, &b_m, &len_m, &m, \
+                                    &pos_w, &n_w, &pos_m);
+
+        if (exitflag != APD_ERR_ID_NON) goto finish;
+
+        if (pos_m == n_in)
+
+            break;
+    }
+
+
+
+    /* Output & Memory deallocation */
+
+    finish:
+
+        #ifndef APD_NO_PTHREADS
+
+            if (rd != 0)
+
+                pthread_join (th, NULL);
+
+        #endif
+
+        if (b_s != NULL)
+
+            munmap(b_s, len_s);
+
+        if (b_nx != NULL)
+
+            munmap(b_nx, len_nx);
+
+        if (b_m != NULL)
+
+            munmap(b_m, len_m);
+
+        if (fd_s >= 0)
+
+            close(fd_s);
+
+        if (fd_m >= 0)
+
+            close(fd_m);
+
+        f_apd_stream_destroy(S);
+
+        return exitflag;
+
+    failed:
+
+        f_apd_get_error (&exitflag, NULL, NULL, NULL);
+
+        goto finish;
+
+#endif
+
+}
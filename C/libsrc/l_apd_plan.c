@@ -0,0 +1,1858 @@
+
+/*                       C O P Y R I G H T   N O T I C E
+ *
+ * Copyright ©2021. Institute of Science and Technology Austria (IST Austria).
+ * All Rights Reserved. The underlying technology is protected by PCT Patent
+ * Application No. PCT/EP2021/054650.
+ *
+ * This file is part of the AP Demodulation library, which is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation in version 2.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY, without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE. See the GNU General Public License v2 for more details. You
+ * should have received a copy of the GNU General Public License v2 along with this
+ * program. If not, see https://www.gnu.org/licenses/.
+ *
+ * Contact the Technology Transfer Office, IST Austria, Am Campus 1,
+ * A-3400 Klosterneuburg, Austria, +43-(0)2243 9000, twist@ist.ac.at, for commercial
+ * licensing opportunities.
+ *
+ * See https://github.com/mgabriel-lt/ap-demodulation for the latest version of the
+ * code and user-friendly explanations on the working principle, domains of
+ * application, and advice on the usage of different AP Demodulation algorithms in
+ * practice.
+ */
+
+
+/* C O N T E N T S
+ *
+ * The demodulation plan, which separates the setup of the AP Demodulation (input
+ * validation, interpolation mapping, memory allocation, and DFT initialization) from
+ * the demodulation itself, so that many signals of the same shape and with the same
+ * parameters can be demodulated without repeating the setup. A multichannel plan
+ * demodulates several channels of the same shape in one execution, with batched
+ * projections onto Mw:
+ *
+ * (1) APD_WS_ALIGN and strAPD_Plan,
+ *
+ * (2) f_apd_plan_destroy,
+ *
+ * (3) f_apd_plan_dims, f_apd_plan_take, and f_apd_plan_layout,
+ *
+ * (4) f_apd_plan_init, f_apd_plan_create, f_apd_plan_create_multichannel,
+ *     f_apd_plan_workspace_size, and f_apd_plan_create_ws,
+ *
+ * (5) f_apd_plan_match,
+ *
+ * (6) f_apd_plan_run, f_apd_plan_execute, f_apd_plan_execute_typed, and
+ *     f_apd_plan_execute_warm.
+ *
+ * The plan structure and all its arrays are carved from one memory block aligned to
+ * APD_WS_ALIGN bytes, which is either allocated by the plan or provided by the user
+ * (see f_apd_plan_create_ws). Only the DFT (descriptors, twiddle factors, and
+ * buffers of the DFT backend) is allocated separately.
+ */
+
+
+
+#include "h_apd.h"
+
+
+
+/* (1) DEMODULATION PLAN */
+
+/* Alignment of the memory block of the plan and of every array in it (in bytes) */
+
+#define APD_WS_ALIGN 64
+
+
+struct strAPD_Plan {
+
+                    struct strAPD_Par Par;     // copy of the parameters (.Nx, .ns,
+                                               // .im, and .ie owned by the plan)
+
+                    long         Nx[3];
+
+                    long         St[3];        // strides of the signal (see
+                                               // f_apd_plan_create)
+
+                    long         Il[3];        // interleaved channels of s, Ub,
+                                               // and the modulators (.Il of the
+                                               // options)
+
+                    long         nx;
+
+                    long         nx_2;
+
+                    long         iL[3];
+
+                    long         iR[3];
+
+                    int          Ub_flag;
+
+                    long         n_ch;
+
+                    const double* t;           // sampling coordinates given to
+                                               // f_apd_plan_create (not owned)
+
+                    long*        ix_map;       // NULL if the signal is sampled
+                                               // uniformly (see f_apd_s_Ub_load)
+                    long*        iw;
+
+                    long         nw;
+
+                    int          prec;         // precision of the work arrays
+                                               // (see f_apd_plan_create)
+
+                    void*        s;            // work arrays of doubles or floats
+                                               // (of doubles in mixed precision)
+                    void*        Ub;
+
+                    void*        s_abs;
+
+                    void*        w1;
+
+                    void*        w2;
+
+                    double*      pw;           // sums of squares of the channels
+                                               // projected onto Mw (AP-A)
+
+                    struct strAPD_Chan* ch;
+
+                    long*        act;
+
+                    struct strAPD_DFT dft;
+
+                    struct strAPD_DFT dft_d;   // DFT of the double-precision
+                                               // phase (mixed precision)
+
+                    int          dft_sh;       // dft_d shares the FFT plans of
+                                               // dft (not freed separately)
+
+                    int          dft_di;       // dft_d is initialized (at the
+                                               // first promotion if not shared)
+
+                    int          state;        // precision of the work arrays
+                                               // holding the state of the last
+                                               // execution (-1 if none)
+
+                    void*        mem;          // memory block allocated by the
+                                               // plan (NULL for a workspace)
+                   };
+
+
+
+
+/* (2)-(6) FUNCTIONS OF THE DEMODULATION PLAN */
+
+void f_apd_plan_destroy (struct strAPD_Plan* plan)
+{
+/* P U R P O S E
+ *
+ * Frees all memory and DFT descriptors (plans) held by the demodulation plan. The
+ * workspace of a plan created by f_apd_plan_create_ws is not freed (it may be
+ * reused or freed by the user after this call).
+ */
+
+/* I N P U T   A R G U M E N T S
+ *
+ * [plan] - demodulation plan created by f_apd_plan_create (or NULL).
+ */
+
+/* O U T P U T   A R G U M E N T S
+ *
+ * None.
+ */
+
+/* R E T U R N   V A L U E
+ *
+ * None.
+ */
+
+/* N O N S T A N D A R D   F U N C T I O N S   U S E D
+ *
+ * (1) f_apd_dft_free.
+ */
+
+    void *mem;
+
+
+    if (plan == NULL)
+
+        return;
+
+    mem = plan->mem;
+
+    f_apd_dft_free (&(plan->dft));
+
+    if (plan->dft_sh == 0 && plan->dft_di != 0)
+
+        f_apd_dft_free (&(plan->dft_d));
+
+    free(mem);
+}
+
+
+
+
+void f_apd_plan_dims ( const struct strAPD_Par* Par, \
+
+                       const double* t, \
+
+                       const int Ub_flag, \
+
+                       const long n_ch, \
+
+                       const struct strAPD_Opt* opt, \
+
+                       struct strAPD_Plan* P )
+{
+/* P U R P O S E
+ *
+ * Sets the parameters, dimensions, and cutoff indexes of a demodulation plan, i.e.,
+ * all fields of the plan structure that determine the sizes of its arrays. The
+ * arrays, the DFT, and the memory block are left unset.
+ */
+
+/* I N P U T   A R G U M E N T S
+ *
+ * [Par], [t], [Ub_flag], [n_ch] - see f_apd_plan_init (Par validated).
+ *
+ * [opt] - options of the plan resolved by f_apd_options.
+ */
+
+/* O U T P U T   A R G U M E N T S
+ *
+ * [P] - plan structure.
+ */
+
+/* R E T U R N   V A L U E
+ *
+ * None.
+ */
+
+/* N O N S T A N D A R D   F U N C T I O N S   U S E D
+ *
+ * None.
+ */
+
+
+    long i;
+
+
+    memset(P, 0, sizeof(struct strAPD_Plan));
+
+    P->Par = *Par;
+
+    P->Par.im = NULL;
+
+    P->Par.ie = NULL;
+
+    P->Ub_flag = (Ub_flag != 0);
+
+    P->n_ch = n_ch;
+
+    P->t = t;
+
+    P->prec = opt->Pr;
+
+    P->state = -1;
+
+    for (i=0; i<3; i++)
+
+        P->Il[i] = opt->Il[i];
+
+
+
+    /* Dimensions and numbers of sample points of the actual signal to be
+     * demodulated (nx) and of the original signal (ns) */
+
+    P->Par.Nx = P->Nx;
+
+    P->nx = 1;
+
+    P->Par.ns = (t != NULL) ? Par->Ns[0] : 1;
+
+    for (i=0; i<(Par->D); i++)
+    {
+        P->Nx[i] = (t != NULL) ? Par->Nr[i] : Par->Ns[i];
+
+        P->nx = P->nx * P->Nx[i];
+
+        if (t == NULL)
+
+            P->Par.ns = P->Par.ns * Par->Ns[i];
+    }
+
+    P->nx_2 = (P->nx / P->Nx[Par->D-1]) * (P->Nx[Par->D-1]+2-(P->Nx[Par->D-1]%2));
+
+
+
+    /* Indexes of the left and right cutoff frequencies */
+
+    for (i=0; i<(Par->D); i++)
+    {
+        P->iL[i] = 1 + (long) ceil(Par->Fc[i] / (Par->Fs[i] / P->Nx[i]));
+
+        P->iR[i] = P->Nx[i] - P->iL[i];
+    }
+}
+
+
+
+
+static inline void* f_apd_plan_take (char* base, size_t* off, const size_t n)
+{
+/* Address of an array of n bytes at the offset off of the memory block base (NULL
+ * if base is NULL), and the offset of the next array (aligned to APD_WS_ALIGN) */
+
+    void *p = (base != NULL) ? (void*) (base + *off) : NULL;
+
+    *off = *off + (n + APD_WS_ALIGN - 1) / APD_WS_ALIGN * APD_WS_ALIGN;
+
+    return p;
+}
+
+
+
+
+size_t f_apd_plan_layout ( const struct strAPD_Plan* Q, \
+
+                           const long n_im, \
+
+                           const long n_ie, \
+
+                           char* base, \
+
+                           struct strAPD_Plan** plan )
+{
+/* P U R P O S E
+ *
+ * Computes the size of the memory block of a demodulation plan (the plan structure
+ * followed by all its arrays, each aligned to APD_WS_ALIGN bytes) and, if the block
+ * is given, places the plan structure and its arrays in the block.
+ */
+
+/* I N P U T   A R G U M E N T S
+ *
+ * [Q] - plan structure set by f_apd_plan_dims.
+ *
+ * [n_im], [n_ie] - numbers of elements of Par.im and Par.ie (including the first
+ *                  element).
+ *
+ * [base] - memory block aligned to APD_WS_ALIGN bytes or NULL (size only).
+ */
+
+/* O U T P U T   A R G U M E N T S
+ *
+ * [plan] - address of the pointer to the plan placed at the start of the block (a
+ *          copy of Q with the addresses of the arrays set) or NULL (if base is
+ *          NULL). The arrays are not initialized.
+ */
+
+/* R E T U R N   V A L U E
+ *
+ * [size] - size of the memory block (in bytes).
+ */
+
+/* N O N S T A N D A R D   F U N C T I O N S   U S E D
+ *
+ * (1) f_apd_plan_take.
+ */
+
+
+    size_t off = 0;
+
+    const size_t n_w = (Q->n_ch)*(Q->nx_2)* \
+                       ((Q->prec == APD_PREC_SINGLE) ? sizeof(float) : sizeof(double));
+
+    struct strAPD_Plan A;
+
+    struct strAPD_Plan *P = &A;
+
+
+    if (base != NULL)
+    {
+        P = (struct strAPD_Plan*) f_apd_plan_take (base, &off, \
+                                                   sizeof(struct strAPD_Plan));
+
+        *P = *Q;
+
+        P->Par.Nx = P->Nx;
+    }
+
+    else
+
+        f_apd_plan_take (base, &off, sizeof(struct strAPD_Plan));
+
+
+
+    /* Parameters and mapping between the original signal and the DFT grid */
+
+    P->Par.im = (long*) f_apd_plan_take (base, &off, n_im*sizeof(long));
+
+    P->Par.ie = (long*) f_apd_plan_take (base, &off, n_ie*sizeof(long));
+
+    if (Q->t != NULL)
+    {
+        P->ix_map = (long*) f_apd_plan_take (base, &off, (Q->Par.ns)*sizeof(long));
+
+        P->iw = (long*) f_apd_plan_take (base, &off, (Q->Par.ns)*sizeof(long));
+    }
+
+
+
+    /* Work arrays of the AP algorithms (doubles or floats) and the states of the
+     * channels (s and s_abs adjacent, see f_apd_plan_init) */
+
+    P->s = f_apd_plan_take (base, &off, n_w);
+
+    P->s_abs = f_apd_plan_take (base, &off, n_w);
+
+    if (Q->Ub_flag)
+
+        P->Ub = f_apd_plan_take (base, &off, n_w);
+
+    if (Q->Par.Al == 'A' || Q->Par.Al == 'P')
+    {
+        P->w1 = f_apd_plan_take (base, &off, n_w);
+
+        P->w2 = f_apd_plan_take (base, &off, n_w);
+    }
+
+    if (Q->Par.Al == 'A')
+
+        P->pw = (double*) f_apd_plan_take (base, &off, (Q->n_ch)*sizeof(double));
+
+    P->ch = (struct strAPD_Chan*) f_apd_plan_take (base, &off, \
+                                  (Q->n_ch)*sizeof(struct strAPD_Chan));
+
+    P->act = (long*) f_apd_plan_take (base, &off, (Q->n_ch)*sizeof(long));
+
+
+    if (plan != NULL)
+
+        *plan = (base != NULL) ? P : NULL;
+
+
+    return off;
+}
+
+
+
+
+int f_apd_plan_init ( const struct strAPD_Par* Par, \
+
+                      const double* t, \
+
+                      const int Ub_flag, \
+
+                      const long n_ch, \
+
+                      const int n_thr, \
+
+                      const struct strAPD_Opt* opt, \
+
+                      void* work, \
+
+                      const size_t size, \
+
+                      struct strAPD_Plan** plan )
+{
+/* P U R P O S E
+ *
+ * Creates a demodulation plan (see f_apd_plan_create) for n_ch channels whose DFT
+ * computations use at most n_thr CPU threads, in a memory block allocated here or
+ * in a workspace provided by the user.
+ */
+
+/* I N P U T   A R G U M E N T S
+ *
+ * [Par], [t], [Ub_flag] - see f_apd_plan_create.
+ *
+ * [n_ch] - number of channels (see f_apd_plan_create_multichannel).
+ *
+ * [n_thr] - maximum number of CPU threads used by each DFT computation (see
+ *           f_apd_dft_init). If n_thr < 1, the default of the DFT backend is used.
+ *
+ * [opt] - options of the plan (see f_apd_plan_create) or NULL.
+ *
+ * [work], [size] - workspace and its size (see f_apd_plan_create_ws), or NULL and
+ *                  0 (the memory block is allocated).
+ */
+
+/* O U T P U T   A R G U M E N T S
+ *
+ * [plan] - address of the pointer to the created plan (NULL upon an error). The
+ *          plan must be freed by f_apd_plan_destroy.
+ */
+
+/* R E T U R N   V A L U E
+ *
+ * [exitflag] - exit flag. Any positive value indicates an error (for numerical and
+ *              textual definitions of the exit status, see l_ap_error_handling.c).
+ * 
+ *              Upon an error, all memory dynamically allocated in this function or
+ *              functions called by this function is freed.
+ */
+
+/* N O N S T A N D A R D   F U N C T I O N S   U S E D
+ *
+ * (1) f_apd_input_validation, (2) f_apd_plan_dims, (3) f_apd_plan_layout,
+ *
+ * (4) f_apd_interpolation, (5) f_apd_ix_remap, (6) f_apd_dft_init,
+ *
+ * (7) f_apd_dft_prune, (8) f_apd_plan_destroy, (9) f_apd_stats_reset,
+ *
+ * (10) f_apd_time, (11) f_apd_stats_phase, (12) f_apd_layout_strides,
+ *
+ * (13) f_apd_options.
+ */
+    
+    
+    /* Definitions and initializations */
+    
+    int exitflag = 0;
+
+    f_apd_set_error (exitflag, __LINE__, APD_ERR_FILE);
+
+
+    size_t bytes;
+
+    void *mem = NULL;
+
+    char *base;
+
+    struct strAPD_Plan Q;
+
+    struct strAPD_Plan *P = NULL;
+
+    struct strAPD_Opt O;
+
+    double t0;
+
+
+    *plan = NULL;
+
+    f_apd_stats_reset (APD_STATS_VALID, APD_STATS_DECOMP);
+
+    t0 = f_apd_time();
+
+
+
+    /* Validation of the parameters, sampling coordinates, and options */
+
+    exitflag = f_apd_input_validation (NULL, Par, NULL, t);
+    
+    if (exitflag != APD_ERR_ID_NON) goto finish;
+
+    exitflag = f_apd_options (opt, &O);
+
+    if (exitflag != APD_ERR_ID_NON) goto finish;
+
+    t0 = f_apd_stats_phase (APD_STATS_VALID, t0);
+
+
+
+    /* Memory block (allocated with a margin for its alignment, or the workspace)
+     * and the plan with its arrays placed in it */
+
+    f_apd_plan_dims (Par, t, Ub_flag, n_ch, &O, &Q);
+
+    if (f_apd_layout_strides (Par, t, &O, Q.St) == 0)
+    {
+        f_apd_set_error(APD_ERR_ID_LAY,__LINE__,APD_ERR_FILE); goto failed;}
+
+    if ((O.Il[0] > 1 && n_ch > O.Il[0]) || (O.Il[1] > 1 && n_ch > O.Il[1]) || \
+            (O.Il[2] > 1 && n_ch > O.Il[2]))
+    {
+        f_apd_set_error(APD_ERR_ID_IL,__LINE__,APD_ERR_FILE); goto failed;}
+
+    bytes = f_apd_plan_layout (&Q, Par->im[0]+1, Par->ie[0]+1, NULL, NULL);
+
+    if (work == NULL)
+    {
+        mem = malloc(bytes + APD_WS_ALIGN);
+
+        if (mem==NULL)
+        {
+            f_apd_set_error(APD_ERR_ID_MEM,__LINE__,APD_ERR_FILE); goto failed;}
+
+        base = (char*) mem + (APD_WS_ALIGN - (uintptr_t) mem % APD_WS_ALIGN) % \
+               APD_WS_ALIGN;
+    }
+
+    else
+    {
+        if ((uintptr_t) work % APD_WS_ALIGN != 0 || size < bytes)
+        {
+            f_apd_set_error(APD_ERR_ID_WSP,__LINE__,APD_ERR_FILE); goto failed;}
+
+        base = (char*) work;
+    }
+
+    f_apd_plan_layout (&Q, Par->im[0]+1, Par->ie[0]+1, base, &P);
+
+    P->mem = mem;
+
+    memcpy(P->Par.im, Par->im, (Par->im[0]+1)*sizeof(long));
+
+    memcpy(P->Par.ie, Par->ie, (Par->ie[0]+1)*sizeof(long));
+
+    sgAPD_STATS.bytes = (work == NULL) ? bytes + APD_WS_ALIGN : 0;
+
+    t0 = f_apd_stats_phase (APD_STATS_ALLOC, t0);
+
+
+
+    /* Mapping between the original signal and the DFT grid (interpolation; a
+     * uniformly sampled signal is mapped by its strides, see f_apd_s_Ub_load). The
+     * table of grid point owners of the interpolation (nx longs) is kept in the
+     * work arrays s and s_abs, which are adjacent in the memory block and not used
+     * before the first execution, so that no memory of the grid size is allocated
+     * besides the memory block */
+
+    if (t != NULL)
+    {
+        exitflag = f_apd_interpolation (&(P->Par), t, (long*) P->s, P->ix_map, \
+                                        P->iw, &(P->nw));
+
+        if (exitflag != APD_ERR_ID_NON) goto finish;
+
+        f_apd_ix_remap (Par->D, P->Nx, P->Par.ns, P->ix_map);
+    }
+
+    else
+
+        P->nw = P->Par.ns;
+
+    t0 = f_apd_stats_phase (APD_STATS_INTERP, t0);
+
+
+
+    /* DFT of the projection onto Mw (in mixed precision, a single-precision DFT
+     * and a double-precision DFT). The built-in and pruned FFTs compute in double
+     * precision for arrays of both precisions, so that the double-precision phase
+     * shares their plans (twiddles and scratch arrays) with the single-precision
+     * phase. A separate double-precision DFT of oneMKL is initialized only when a
+     * channel is first promoted to double precision (see f_apd_plan_run), so that
+     * plans whose channels all finish in single precision never allocate it */
+
+    exitflag = f_apd_dft_init (Par->D, P->Nx, n_thr, n_ch, \
+            (P->prec == APD_PREC_DOUBLE) ? APD_PREC_DOUBLE : APD_PREC_SINGLE, \
+            &(P->dft));
+
+    if (exitflag != APD_ERR_ID_NON) goto finish;
+
+    exitflag = f_apd_dft_prune (&(P->dft), Par->D, P->Nx, P->iL);
+
+    if (exitflag != APD_ERR_ID_NON) goto finish;
+
+
+    if (P->prec == APD_PREC_MIXED && \
+            (P->dft.bk != APD_DFT_MKL || P->dft.pfft != NULL))
+    {
+        P->dft_d = P->dft;
+
+        P->dft_d.prec = APD_PREC_DOUBLE;
+
+        P->dft_sh = 1;
+
+        P->dft_di = 1;
+    }
+
+    f_apd_stats_phase (APD_STATS_DFT_INIT, t0);
+
+
+
+    /* Output & Memory deallocation */
+
+    finish:
+
+        if (exitflag == APD_ERR_ID_NON)
+
+            *plan = P;
+
+        else if (P != NULL)
+
+            f_apd_plan_destroy(P);
+
+        else
+
+            free(mem);
+
+        return exitflag;
+
+    failed:
+
+        f_apd_get_error (&exitflag, NULL, NULL, NULL);
+
+        goto finish;
+
+}
+
+
+
+
+int f_apd_plan_create ( const struct strAPD_Par* Par, \
+
+                        const double* t, \
+
+                        const int Ub_flag, \
+
+                        const struct strAPD_Opt* opt, \
+
+                        struct strAPD_Plan** plan )
+{
+/* P U R P O S E
+ *
+ * Creates a demodulation plan: validates the parameters, prepares the mapping of
+ * the input signal onto the DFT grid (including the interpolation of nonuniformly
+ * sampled signals), allocates all work arrays, and initializes the DFT. The plan
+ * can then be executed by f_apd_plan_execute any number of times without any
+ * further memory allocation.
+ */
+
+/* I N P U T   A R G U M E N T S
+ *
+ * [Par] - pointer to the structure with demodulation parameters (see
+ *         f_apd_demodulation). The fields .Nx and .ns are not used or modified. The
+ *         structure is copied into the plan, so that it can be changed or freed
+ *         after this call.
+ *
+ * [t] - sampling coordinates of the input signal (see f_apd_demodulation) or NULL.
+ *       All signals demodulated with the plan share these sampling coordinates.
+ *
+ * [Ub_flag] - if nonzero, the plan can be executed with an upper bound on the
+ *             modulator, Ub. Otherwise, only Ub = NULL is allowed.
+ *
+ * [opt] - pointer to the structure with the options of the plan, which are fixed
+ *         at its creation (the structure is copied, so that it can be changed or
+ *         freed after this call), or NULL for the defaults:
+ *
+ *         .Pr - precision of the work arrays of the AP algorithms. Possible
+ *               options are: APD_PREC_DOUBLE - double precision; APD_PREC_SINGLE -
+ *               single precision; APD_PREC_MIXED - single precision followed by
+ *               double precision (the default is APD_PRECISION, see h_apd.h). In
+ *               single precision, the signal, the modulator estimates, and the
+ *               auxiliary arrays are stored as floats, which halves the memory of
+ *               the plan and the memory traffic of the iterations, while the
+ *               elementwise arithmetic and all sums are computed in double
+ *               precision. In mixed precision, every channel is iterated in
+ *               single precision until the drop of its infeasibility error per
+ *               iteration falls to the float resolution (see APD_MIX_FLOOR and
+ *               APD_MIX_NSTALL in h_apd.h), but at most until the last quarter of
+ *               the maximum number of iterations (APD_MIX_TAIL), and in double
+ *               precision afterwards (see f_apd_get_precision). The arrays of a
+ *               mixed-precision plan are allocated for doubles and converted in
+ *               place, and its double-precision DFT of oneMKL (if not shared) is
+ *               initialized at the first switch to double precision. {Type: int}
+ *
+ *         .Ly - layout of the input and output arrays of uniformly sampled
+ *               signals (the signal, the upper bound, the initial modulator, and
+ *               the modulator estimates). Possible options are: APD_LAYOUT_COL -
+ *               column-major order, the first index running fastest (default, the
+ *               order of MATLAB); APD_LAYOUT_ROW - row-major order, the last index
+ *               running fastest (the order of C and NumPy); APD_LAYOUT_STRIDED -
+ *               strides given by .St. If the last dimension of the layout is
+ *               contiguous, the signal is copied onto the DFT grid row by row and
+ *               the modulator is copied back in the same way; otherwise, both are
+ *               transposed in tiles. The layout of nonuniformly sampled signals is
+ *               given by their sampling coordinates. {Type: int}
+ *
+ *         .St - strides of the dimensions 1, ..., Par.D of the arrays in elements
+ *               for .Ly = APD_LAYOUT_STRIDED (otherwise ignored; the elements
+ *               beyond Par.D are not used). The strides must describe a dense
+ *               layout, i.e., a permutation of the dimensions of the signal
+ *               (sorted by size, the strides are 1, N_a, N_a*N_b, ..., where N_a,
+ *               N_b, ... are the numbers of sample points of the dimensions in the
+ *               same order). {Type: long array with 3 elements}
+ *
+ *         .Il - numbers of channels interleaved in the signal and the upper
+ *               bound, s and Ub, and in the modulators, m0 and out_m (.Il[0],
+ *               .Il[1], and .Il[2], respectively; 1 - no interleaving, default).
+ *               An interleaved array consists of frames of .Il[i] elements, one
+ *               per channel (e.g., L R L R ... for .Il[i] = 2), so that
+ *               consecutive sample points of a channel are .Il[i] elements apart
+ *               (the strides of the layout are multiplied by .Il[i]). A channel
+ *               is demodulated by passing the address of its first element, and
+ *               the channels of a multichannel plan are the first n_ch channels
+ *               of the frames. Every modulator estimate of all channels of an
+ *               interleaved out_m occupies .Il[2]*Par.ns elements. An interleaved
+ *               signal can thus be demodulated into separate modulator arrays,
+ *               or into an interleaved one, without copies. {Type: long array
+ *               with 3 elements}
+ *
+ *         The defaults are output by f_apd_get_options, so that a structure can
+ *         be initialized by them and then modified.
+ */
+
+/* O U T P U T   A R G U M E N T S
+ *
+ * [plan] - address of the pointer to the created plan (NULL upon an error). The
+ *          plan must be freed by f_apd_plan_destroy.
+ */
+
+/* R E T U R N   V A L U E
+ *
+ * [exitflag] - exit flag. Any positive value indicates an error (for numerical and
+ *              textual definitions of the exit status, see l_ap_error_handling.c).
+ * 
+ *              Upon an error, all memory dynamically allocated in this function or
+ *              functions called by this function is freed.
+ */
+
+/* N O N S T A N D A R D   F U N C T I O N S   U S E D
+ *
+ * (1) f_apd_plan_init.
+ */
+
+    return f_apd_plan_init (Par, t, Ub_flag, 1, 0, opt, NULL, 0, plan);
+}
+
+
+
+
+int f_apd_plan_create_multichannel ( const struct strAPD_Par* Par, \
+
+                                     const double* t, \
+
+                                     const int Ub_flag, \
+
+                                     const long n_ch, \
+
+                                     const struct strAPD_Opt* opt, \
+
+                                     struct strAPD_Plan** plan )
+{
+/* P U R P O S E
+ *
+ * Creates a demodulation plan for multichannel signals, i.e., n_ch signals (e.g.,
+ * channels of one recording) with the same shape and parameters that are
+ * demodulated together. The projections onto Mw of all channels are computed by
+ * batched DFTs, while every channel is terminated independently (by its own
+ * infeasibility error and, for AP-A, its own factor lambda). The results of every
+ * channel are identical to those of a single-channel plan with the same DFT
+ * backend, up to the rounding differences of the batched Intel MKL DFT.
+ */
+
+/* I N P U T   A R G U M E N T S
+ *
+ * [Par], [t], [Ub_flag], [opt] - see f_apd_plan_create.
+ *
+ * [n_ch] - number of channels (positive).
+ */
+
+/* O U T P U T   A R G U M E N T S
+ *
+ * [plan] - address of the pointer to the created plan (NULL upon an error). The
+ *          plan must be freed by f_apd_plan_destroy. When the plan is executed by
+ *          f_apd_plan_execute, the arrays s, Ub, out_m, and out_e hold the n_ch
+ *          channels one after another (Par.ns, Par.ns, Par.im[0]*Par.ns, and
+ *          Par.ie[0] elements per channel, respectively), and iter is an array with
+ *          n_ch elements. The arrays whose channels are interleaved (see .Il of
+ *          opt) hold the first n_ch channels of the frames instead.
+ */
+
+/* R E T U R N   V A L U E
+ *
+ * [exitflag] - exit flag. Any positive value indicates an error (for numerical and
+ *              textual definitions of the exit status, see l_ap_error_handling.c).
+ * 
+ *              Upon an error, all memory dynamically allocated in this function or
+ *              functions called by this function is freed.
+ */
+
+/* N O N S T A N D A R D   F U N C T I O N S   U S E D
+ *
+ * (1) f_apd_plan_init.
+ */
+
+    if (n_ch < 1)
+    {
+        *plan = NULL;
+
+        f_apd_set_error(APD_ERR_ID_CH,__LINE__,APD_ERR_FILE);
+
+        return APD_ERR_ID_CH;
+    }
+
+    return f_apd_plan_init (Par, t, Ub_flag, n_ch, 0, opt, NULL, 0, plan);
+}
+
+
+
+
+int f_apd_plan_workspace_size ( const struct strAPD_Par* Par, \
+
+                                const double* t, \
+
+                                const int Ub_flag, \
+
+                                const long n_ch, \
+
+                                const struct strAPD_Opt* opt, \
+
+                                size_t* size )
+{
+/* P U R P O S E
+ *
+ * Computes the size of the workspace of a demodulation plan created by
+ * f_apd_plan_create_ws with the same arguments. The size depends on the precision
+ * of the options (for opt == NULL, on the default precision APD_PRECISION). It
+ * does not include the DFT of the backend, which is allocated by
+ * f_apd_plan_create_ws outside the workspace (see .bytes_dft of f_apd_estimate for
+ * the memory of the built-in and pruned FFTs).
+ */
+
+/* I N P U T   A R G U M E N T S
+ *
+ * [Par], [t], [Ub_flag], [opt] - see f_apd_plan_create.
+ *
+ * [n_ch] - number of channels (positive, 1 for a single-channel plan).
+ */
+
+/* O U T P U T   A R G U M E N T S
+ *
+ * [size] - size of the workspace in bytes (this is the address of an externally
+ *          defined scalar variable).
+ */
+
+/* R E T U R N   V A L U E
+ *
+ * [exitflag] - exit flag. Any positive value indicates an error (for numerical and
+ *              textual definitions of the exit status, see l_ap_error_handling.c).
+ */
+
+/* N O N S T A N D A R D   F U N C T I O N S   U S E D
+ *
+ * (1) f_apd_input_validation, (2) f_apd_plan_dims, (3) f_apd_plan_layout,
+ *
+ * (4) f_apd_options.
+ */
+
+
+    int exitflag = 0;
+
+    struct strAPD_Plan Q;
+
+    struct strAPD_Opt O;
+
+
+    *size = 0;
+
+    if (n_ch < 1)
+    {
+        f_apd_set_error(APD_ERR_ID_CH,__LINE__,APD_ERR_FILE);
+
+        f_apd_get_error (&exitflag, NULL, NULL, NULL);
+
+        return exitflag;
+    }
+
+    exitflag = f_apd_input_validation (NULL, Par, NULL, t);
+
+    if (exitflag != APD_ERR_ID_NON)
+
+        return exitflag;
+
+    exitflag = f_apd_options (opt, &O);
+
+    if (exitflag != APD_ERR_ID_NON)
+
+        return exitflag;
+
+
+    f_apd_plan_dims (Par, t, Ub_flag, n_ch, &O, &Q);
+
+    *size = f_apd_plan_layout (&Q, Par->im[0]+1, Par->ie[0]+1, NULL, NULL);
+
+
+    return exitflag;
+}
+
+
+
+
+int f_apd_plan_create_ws ( const struct strAPD_Par* Par, \
+
+                           const double* t, \
+
+                           const int Ub_flag, \
+
+                           const long n_ch, \
+
+                           const struct strAPD_Opt* opt, \
+
+                           void* work, \
+
+                           const size_t size, \
+
+                           struct strAPD_Plan** plan )
+{
+/* P U R P O S E
+ *
+ * Creates a demodulation plan (see f_apd_plan_create and
+ * f_apd_plan_create_multichannel) whose structure and arrays, i.e., all memory
+ * used by the AP algorithms, are placed in a workspace provided by the user. The
+ * workspace does not hold the DFT of the backend (the descriptors of oneMKL, or the
+ * plans, twiddle factors, and scratch arrays of the built-in and pruned FFTs),
+ * which this function still allocates on the heap, together with temporary arrays
+ * of the mapping of nonuniformly sampled signals that are freed before it returns.
+ * The DFT is not counted by f_apd_plan_workspace_size and is freed by
+ * f_apd_plan_destroy. The plan is then executed by f_apd_plan_execute and
+ * f_apd_plan_execute_warm without any memory allocation, except for the
+ * double-precision DFT of oneMKL that a mixed-precision plan initializes at its
+ * first switch to double precision (see f_apd_plan_create).
+ */
+
+/* I N P U T   A R G U M E N T S
+ *
+ * [Par], [t], [Ub_flag], [opt] - see f_apd_plan_create.
+ *
+ * [n_ch] - number of channels (positive, 1 for a single-channel plan).
+ *
+ * [work] - workspace aligned to 64 bytes (APD_WS_ALIGN). It must not be used
+ *          otherwise until the plan is destroyed.
+ *
+ * [size] - size of the workspace in bytes, at least that computed by
+ *          f_apd_plan_workspace_size.
+ */
+
+/* O U T P U T   A R G U M E N T S
+ *
+ * [plan] - address of the pointer to the created plan (NULL upon an error), which
+ *          points into the workspace. The plan must be freed by f_apd_plan_destroy
+ *          (which frees the DFT, but not the workspace).
+ */
+
+/* R E T U R N   V A L U E
+ *
+ * [exitflag] - exit flag. Any positive value indicates an error (for numerical and
+ *              textual definitions of the exit status, see l_ap_error_handling.c).
+ * 
+ *              Upon an error, all memory dynamically allocated in this function or
+ *              functions called by this function is freed.
+ */
+
+/* N O N S T A N D A R D   F U N C T I O N S   U S E D
+ *
+ * (1) f_apd_plan_init.
+ */
+
+    if (n_ch < 1)
+    {
+        *plan = NULL;
+
+        f_apd_set_error(APD_ERR_ID_CH,__LINE__,APD_ERR_FILE);
+
+        return APD_ERR_ID_CH;
+    }
+
+    if (work == NULL)
+    {
+        *plan = NULL;
+
+        f_apd_set_error(APD_ERR_ID_WSP,__LINE__,APD_ERR_FILE);
+
+        return APD_ERR_ID_WSP;
+    }
+
+    return f_apd_plan_init (Par, t, Ub_flag, n_ch, 0, opt, work, size, plan);
+}
+
+
+
+
+int f_apd_plan_match ( const struct strAPD_Plan* plan, \
+
+                       const struct strAPD_Par* Par, \
+
+                       const double* t, \
+
+                       const int Ub_flag, \
+
+                       const struct strAPD_Opt* opt )
+{
+/* P U R P O S E
+ *
+ * Checks whether the demodulation plan can be used to demodulate a signal with the
+ * given parameters, sampling coordinates, upper bound on the modulator, and
+ * options, i.e., whether f_apd_plan_create (Par, t, Ub_flag, opt, ...) would
+ * create an equivalent plan (in the layout of opt). Sampling coordinates are
+ * compared by their addresses only.
+ */
+
+/* I N P U T   A R G U M E N T S
+ *
+ * [plan] - demodulation plan created by f_apd_plan_create.
+ *
+ * [Par], [t], [Ub_flag] - see f_apd_plan_create.
+ *
+ * [opt] - options resolved by f_apd_options.
+ */
+
+/* O U T P U T   A R G U M E N T S
+ *
+ * None.
+ */
+
+/* R E T U R N   V A L U E
+ *
+ * [match] - 1 if the plan can be used, 0 otherwise.
+ */
+
+/* N O N S T A N D A R D   F U N C T I O N S   U S E D
+ *
+ * None.
+ */
+
+    long i;
+
+    long St[3];
+
+    const struct strAPD_Par *P = &(plan->Par);
+
+
+    if (P->Al != Par->Al || P->D != Par->D || P->Et != Par->Et || P->Ni != Par->Ni \
+            || P->Cp != Par->Cp || plan->t != t || (plan->Ub_flag == 0 && Ub_flag) \
+            || plan->n_ch != 1 || plan->prec != opt->Pr)
+
+        return 0;
+
+    if (Par->Al == 'A' && P->Br != Par->Br)
+
+        return 0;
+
+
+    for (i=0; i<(Par->D); i++)
+    {
+        if (P->Fs[i] != Par->Fs[i] || P->Fc[i] != Par->Fc[i])
+
+            return 0;
+
+        if ((t != NULL) ? (P->Nr[i] != Par->Nr[i]) : (P->Ns[i] != Par->Ns[i]))
+
+            return 0;
+    }
+
+    if (t != NULL && P->Ns[0] != Par->Ns[0])
+
+        return 0;
+
+    if (plan->Il[0] != opt->Il[0] || plan->Il[1] != opt->Il[1] || \
+            plan->Il[2] != opt->Il[2])
+
+        return 0;
+
+    f_apd_layout_strides (Par, t, opt, St);
+
+    for (i=0; i<(Par->D); i++)
+
+        if (plan->St[i] != St[i])
+
+            return 0;
+
+
+    if (P->im[0] != Par->im[0] || P->ie[0] != Par->ie[0])
+
+        return 0;
+
+    for (i=1; i<=(Par->im[0]); i++)
+
+        if (P->im[i] != Par->im[i])
+
+            return 0;
+
+    for (i=1; i<=(Par->ie[0]); i++)
+
+        if (P->ie[i] != Par->ie[i])
+
+            return 0;
+
+
+    return 1;
+}
+
+
+
+
+int f_apd_plan_run ( struct strAPD_Plan* plan, \
+
+                     const void* s, \
+
+                     const int type, \
+
+                     const double* Ub, \
+
+                     const double* m0, \
+
+                     const int init, \
+
+                     double* out_m, \
+
+                     double* out_e, \
+
+                     long* iter )
+{
+/* P U R P O S E
+ *
+ * Demodulates the input signal by using the demodulation plan, starting from the
+ * absolute-value signal, from an initial modulator, or from the state of the last
+ * execution of the plan (see f_apd_plan_execute and f_apd_plan_execute_warm). No
+ * memory is allocated in this function. The precision of the last iterations and
+ * the number of iterations in single precision are stored for f_apd_get_precision.
+ */
+
+/* I N P U T   A R G U M E N T S
+ *
+ * [plan] - demodulation plan created by f_apd_plan_create.
+ *
+ * [s] - input signal (see f_apd_demodulation). For a multichannel plan, the
+ *       channels of the signal are stored one after another or interleaved (see
+ *       f_apd_plan_create_multichannel).
+ *
+ * [type] - type of the elements of s (see f_apd_plan_execute_typed; APD_TYPE_F64
+ *          for a warm start). The signal and the upper bound of a cold start are
+ *          validated while they are placed on the grid (see f_apd_s_Ub_load).
+ *
+ * [Ub] - upper bound on the modulator (see f_apd_demodulation) or NULL. Ub can be
+ *        used only if the plan was created with a nonzero Ub_flag. For a
+ *        multichannel plan, it has the same layout as s (with its own number of
+ *        interleaved channels, see f_apd_plan_create).
+ *
+ * [m0] - initial modulator with the same layout as out_m (APD_INIT_M0) or NULL.
+ *
+ * [init] - initial estimates of the AP algorithm: APD_INIT_COLD, APD_INIT_M0, or
+ *          APD_INIT_STATE (see f_apd_basic).
+ */
+
+/* O U T P U T   A R G U M E N T S
+ *
+ * [out_m], [out_e], [iter] - see f_apd_demodulation. For a multichannel plan, see
+ *                             f_apd_plan_create_multichannel.
+ */
+
+/* R E T U R N   V A L U E
+ *
+ * [exitflag] - exit flag. Any positive value indicates an error (for numerical and
+ *              textual definitions of the exit status, see l_ap_error_handling.c).
+ */
+
+/* N O N S T A N D A R D   F U N C T I O N S   U S E D
+ *
+ * (1) f_apd_s_Ub_validation, (2) f_apd_s_Ub_load, (3) f_apd_basic,
+ *
+ * (4) f_apd_accelerated, (5) f_apd_projected, (6) f_apd_compression,
+ *
+ * (7) f_apd_s_Ub_load_f, f_apd_basic_f, f_apd_accelerated_f, f_apd_projected_f,
+ *
+ * (8) f_apd_promote, f_apd_demote, and f_apd_m0_validation,
+ *
+ * (9) f_apd_stats_reset, f_apd_time, and f_apd_stats_phase, (10) f_apd_s_at,
+ *
+ * (11) f_apd_scaled.
+ */
+    
+    
+    /* Definitions and initializations */
+    
+    int exitflag = 0;
+
+    f_apd_set_error (exitflag, __LINE__, APD_ERR_FILE);
+
+
+    struct strAPD_Plan *P = plan;
+
+    const struct strAPD_Par *Par = &(plan->Par);
+
+    void *pr_Ub = (Ub != NULL) ? P->Ub : NULL;
+
+    int err = APD_ERR_ID_NON;
+
+    int err_k;
+
+    long k;
+
+    int mix;
+
+    int prec;
+
+    long iter_sw;
+
+    double *s_abs_k;
+
+    double *s_d;
+
+    float *s_f;
+
+    double t0;
+
+    /* Offsets of the channels in s, Ub, and the modulators (adjacent if they are
+     * interleaved, see f_apd_plan_create) */
+
+    const long o_s = (P->Il[0] > 1) ? 1 : Par->ns;
+
+    const long o_u = (P->Il[1] > 1) ? 1 : Par->ns;
+
+    const long o_m = (P->Il[2] > 1) ? 1 : Par->ns;
+
+    /* Channels that fill the interleaved frames of all arrays are validated in one
+     * pass over the contiguous arrays */
+
+    const int il_full = (P->Il[0] > 1 && P->Il[0] == P->n_ch && \
+                         P->Il[1] == P->n_ch && P->Il[2] == P->n_ch);
+
+    const long n_il = (Par->ns) * (P->n_ch);
+
+
+    f_apd_stats_reset (APD_STATS_CHECK, APD_STATS_DECOMP);
+
+    t0 = f_apd_time();
+
+
+
+    /* Validation of the input data */
+
+    if (Ub != NULL && P->Ub_flag == 0)
+    {
+        f_apd_set_error(APD_ERR_ID_PL,__LINE__,APD_ERR_FILE); goto failed;}
+
+    for (k=0; k<((il_full) ? 1 : P->n_ch); k++)
+    {
+        if (init != APD_INIT_COLD)
+        {
+            exitflag = f_apd_s_Ub_validation ((const double*) s + k*o_s, \
+                    (Ub != NULL) ? Ub + k*o_u : NULL, (il_full) ? n_il : Par->ns, \
+                    (il_full) ? 1 : P->Il[0], (il_full) ? 1 : P->Il[1]);
+
+            if (exitflag != APD_ERR_ID_NON) goto finish;
+        }
+
+        exitflag = f_apd_m0_validation ((m0 != NULL) ? m0 + k*o_m : NULL, \
+                (il_full) ? n_il : Par->ns, (il_full) ? 1 : P->Il[2]);
+
+        if (exitflag != APD_ERR_ID_NON) goto finish;
+    }
+
+    if (init == APD_INIT_STATE && P->state < 0)
+    {
+        f_apd_set_error(APD_ERR_ID_WS,__LINE__,APD_ERR_FILE); goto failed;}
+
+    t0 = f_apd_stats_phase (APD_STATS_CHECK, t0);
+
+
+
+    /* The state of a mixed-precision plan that was promoted to double precision is
+     * converted back into floats for the single-precision phase (the signal is
+     * loaded again, see below) */
+
+    if (init == APD_INIT_STATE && P->prec == APD_PREC_MIXED && \
+            P->state == APD_PREC_DOUBLE)
+    {
+        f_apd_demote (P->s, (P->n_ch)*(P->nx_2));
+
+        if (P->w1 != NULL)
+        {
+            f_apd_demote (P->w1, (P->n_ch)*(P->nx_2));
+
+            f_apd_demote (P->w2, (P->n_ch)*(P->nx_2));
+        }
+    }
+
+    P->state = -1;
+
+
+
+    /* Conversion, compression, interpolation, and placement on the DFT grid (in
+     * single precision also in the first phase of the mixed precision). The signal
+     * is placed in s_abs. For a cold start, its absolute value is taken there in
+     * place, and its maximum is stored in the state of the channel, so that no
+     * copy of the signal is staged in s. For a warm start, the initial modulator
+     * is placed in s */
+
+    if (P->prec != APD_PREC_DOUBLE)
+
+        for (k=0; k<(P->n_ch); k++)
+        {
+            s_f = (float*) P->s_abs + k*(P->nx_2);
+
+            err_k = f_apd_s_Ub_load_f (f_apd_s_at (s, type, k*o_s), type, \
+                    (Ub != NULL) ? Ub + k*o_u : NULL, \
+                    P->ix_map, P->iw, P->nw, Par->D, P->Nx, P->St, P->Il[0], \
+                    P->Il[1], (Par->Cp > 1) ? 1/(Par->Cp) : 1, P->dft.n_thr, \
+                    s_f, (Ub != NULL) ? (float*) P->Ub + k*(P->nx_2) : NULL, \
+                    (init == APD_INIT_COLD) ? s_f : NULL, \
+                    (init == APD_INIT_COLD) ? &(P->ch[k].max_s_abs) : NULL);
+
+            if (err == APD_ERR_ID_NON || err_k == APD_ERR_ID_S)
+
+                err = err_k;
+
+            if (init == APD_INIT_M0)
+
+                f_apd_s_Ub_load_f (m0 + k*o_m, APD_TYPE_F64, NULL, P->ix_map, \
+                        P->iw, P->nw, Par->D, P->Nx, P->St, P->Il[2], 1, \
+                        (Par->Cp > 1) ? 1/(Par->Cp) : 1, P->dft.n_thr, \
+                        (float*) P->s + k*(P->nx_2), NULL, NULL, NULL);
+        }
+
+    else
+
+        for (k=0; k<(P->n_ch); k++)
+        {
+            s_d = (double*) P->s_abs + k*(P->nx_2);
+
+            err_k = f_apd_s_Ub_load (f_apd_s_at (s, type, k*o_s), type, \
+                    (Ub != NULL) ? Ub + k*o_u : NULL, \
+                    P->ix_map, P->iw, P->nw, Par->D, P->Nx, P->St, P->Il[0], \
+                    P->Il[1], (Par->Cp > 1) ? 1/(Par->Cp) : 1, P->dft.n_thr, \
+                    s_d, (Ub != NULL) ? (double*) P->Ub + k*(P->nx_2) : NULL, \
+                    (init == APD_INIT_COLD) ? s_d : NULL, \
+                    (init == APD_INIT_COLD) ? &(P->ch[k].max_s_abs) : NULL);
+
+            if (err == APD_ERR_ID_NON || err_k == APD_ERR_ID_S)
+
+                err = err_k;
+
+            if (init == APD_INIT_M0)
+
+                f_apd_s_Ub_load (m0 + k*o_m, APD_TYPE_F64, NULL, P->ix_map, \
+                        P->iw, P->nw, Par->D, P->Nx, P->St, P->Il[2], 1, \
+                        (Par->Cp > 1) ? 1/(Par->Cp) : 1, P->dft.n_thr, \
+                        (double*) P->s + k*(P->nx_2), NULL, NULL, NULL);
+        }
+
+    if (err != APD_ERR_ID_NON)
+    {
+        f_apd_set_error(err,__LINE__,APD_ERR_FILE); goto failed;}
+
+    t0 = f_apd_stats_phase (APD_STATS_LOAD, t0);
+    
+    
+    
+    /* Demodulation (in the precision of the plan or, in mixed precision, first in
+     * single precision until the errors of the channels stall) */
+
+    mix = (P->prec == APD_PREC_MIXED) ? APD_MIX_SINGLE : APD_MIX_NONE;
+    
+    if (P->prec != APD_PREC_DOUBLE && Par->Al == 'B')
+    
+        exitflag = f_apd_basic_f (P->s, Par, pr_Ub, P->ix_map, P->St, P->Il[2], \
+                P->iL, P->iR, &(P->dft), P->s_abs, P->n_ch, P->ch, P->act, mix, \
+                init, out_m, out_e, iter);
+
+    else if (P->prec != APD_PREC_DOUBLE && Par->Al == 'A')
+
+        exitflag = f_apd_accelerated_f (P->s, Par, pr_Ub, P->ix_map, P->St, \
+                P->Il[2], P->iL, P->iR, &(P->dft), P->s_abs, P->w1, P->w2, P->pw, \
+                P->n_ch, P->ch, P->act, mix, init, out_m, out_e, iter);
+
+    else if (P->prec != APD_PREC_DOUBLE)
+
+        exitflag = f_apd_projected_f (P->s, Par, pr_Ub, P->ix_map, P->St, P->Il[2], \
+                P->iL, P->iR, &(P->dft), P->s_abs, P->w1, P->w2, P->n_ch, P->ch, \
+                P->act, mix, init, out_m, out_e, iter);
+
+    else if (Par->Al == 'B')
+    
+        exitflag = f_apd_basic (P->s, Par, pr_Ub, P->ix_map, P->St, P->Il[2], \
+                P->iL, P->iR, &(P->dft), P->s_abs, P->n_ch, P->ch, P->act, mix, \
+                init, out_m, out_e, iter);
+    
+    else if (Par->Al == 'A')
+        
+        exitflag = f_apd_accelerated (P->s, Par, pr_Ub, P->ix_map, P->St, P->Il[2], \
+                P->iL, P->iR, &(P->dft), P->s_abs, P->w1, P->w2, P->pw, P->n_ch, \
+                P->ch, P->act, mix, init, out_m, out_e, iter);
+    
+    else
+        
+        exitflag = f_apd_projected (P->s, Par, pr_Ub, P->ix_map, P->St, P->Il[2], \
+                P->iL, P->iR, &(P->dft), P->s_abs, P->w1, P->w2, P->n_ch, P->ch, \
+                P->act, mix, init, out_m, out_e, iter);
+    
+    if (exitflag != APD_ERR_ID_NON) goto finish;
+
+
+
+    /* Precision of the last iterations and the number of iterations in single
+     * precision (see f_apd_get_precision) */
+
+    prec = (P->prec == APD_PREC_DOUBLE) ? APD_PREC_DOUBLE : APD_PREC_SINGLE;
+
+    iter_sw = (P->prec == APD_PREC_DOUBLE) ? 0 : iter[0];
+
+    for (k=0; k<(P->n_ch); k++)
+    {
+        if (P->prec == APD_PREC_MIXED && P->ch[k].mix != 0)
+
+            prec = APD_PREC_DOUBLE;
+
+        if (P->prec != APD_PREC_DOUBLE && iter[k] < iter_sw)
+
+            iter_sw = iter[k];
+    }
+
+
+
+    /* Double-precision phase of the mixed precision: the arrays of the modulator
+     * and of the auxiliary variables are converted into doubles, while the signal
+     * and the upper bound of the stalled channels are loaded again from the input
+     * in double precision (the absolute value in place in s_abs, normalized by the
+     * maximum of the single-precision phase). The stalled channels are then
+     * iterated further */
+
+    if (P->prec == APD_PREC_MIXED && prec == APD_PREC_DOUBLE)
+    {
+        if (P->dft_di == 0)
+        {
+            exitflag = f_apd_dft_init (Par->D, P->Nx, P->dft.n_thr, P->n_ch, \
+                                       APD_PREC_DOUBLE, &(P->dft_d));
+
+            if (exitflag == APD_ERR_ID_NON)
+
+                exitflag = f_apd_dft_prune (&(P->dft_d), Par->D, P->Nx, P->iL);
+
+            if (exitflag != APD_ERR_ID_NON)
+            {
+                f_apd_dft_free (&(P->dft_d));
+
+                goto finish;
+            }
+
+            P->dft_di = 1;
+        }
+
+        f_apd_promote (P->s, (P->n_ch)*(P->nx_2));
+
+        if (P->w1 != NULL)
+        {
+            f_apd_promote (P->w1, (P->n_ch)*(P->nx_2));
+
+            f_apd_promote (P->w2, (P->n_ch)*(P->nx_2));
+        }
+
+
+        for (k=0; k<(P->n_ch); k++)
+        {
+            if (P->ch[k].mix == 0)
+
+                continue;
+
+            s_abs_k = (double*) P->s_abs + k*(P->nx_2);
+
+            f_apd_s_Ub_load (f_apd_s_at (s, type, k*o_s), type, \
+                    (Ub != NULL) ? Ub + k*o_u : NULL, \
+                    P->ix_map, P->iw, P->nw, Par->D, P->Nx, P->St, P->Il[0], \
+                    P->Il[1], (Par->Cp > 1) ? 1/(Par->Cp) : 1, P->dft.n_thr, \
+                    s_abs_k, (Ub != NULL) ? (double*) P->Ub + k*(P->nx_2) : NULL, \
+                    s_abs_k, NULL);
+
+            f_apd_scaled (s_abs_k, P->nx_2, P->ch[k].max_s_abs);
+        }
+
+
+        if (Par->Al == 'B')
+
+            exitflag = f_apd_basic (P->s, Par, pr_Ub, P->ix_map, P->St, P->Il[2], \
+                    P->iL, P->iR, &(P->dft_d), P->s_abs, P->n_ch, P->ch, P->act, \
+                    APD_MIX_DOUBLE, APD_INIT_COLD, out_m, out_e, iter);
+
+        else if (Par->Al == 'A')
+
+            exitflag = f_apd_accelerated (P->s, Par, pr_Ub, P->ix_map, P->St, \
+                    P->Il[2], P->iL, P->iR, &(P->dft_d), P->s_abs, P->w1, P->w2, \
+                    P->pw, P->n_ch, P->ch, P->act, APD_MIX_DOUBLE, APD_INIT_COLD, \
+                    out_m, out_e, iter);
+
+        else
+
+            exitflag = f_apd_projected (P->s, Par, pr_Ub, P->ix_map, P->St, \
+                    P->Il[2], P->iL, P->iR, &(P->dft_d), P->s_abs, P->w1, P->w2, \
+                    P->n_ch, P->ch, P->act, APD_MIX_DOUBLE, APD_INIT_COLD, out_m, \
+                    out_e, iter);
+
+        if (exitflag != APD_ERR_ID_NON) goto finish;
+    }
+
+    sgAPD_PREC_LAST = prec;
+
+    sgAPD_PREC_ITER_SW = iter_sw;
+
+    P->state = prec;
+
+
+    /* Statistics of the iterations (see f_apd_get_stats) */
+
+    t0 = f_apd_stats_phase (APD_STATS_ITER, t0);
+
+    for (k=0; k<(P->n_ch); k++)
+
+        if (iter[k] > sgAPD_STATS.iter)
+
+            sgAPD_STATS.iter = iter[k];
+
+    sgAPD_STATS.t_iter = (sgAPD_STATS.iter > 0) ? \
+                         sgAPD_STATS.t[APD_STATS_ITER] / sgAPD_STATS.iter : 0;
+
+    sgAPD_STATS.lambda = (Par->Al == 'A') ? P->ch[0].lambda : 0;
+
+    
+
+    /* Decompression */
+    
+    if (Par->Cp > 1)
+    {
+        if (P->Il[2] == 1)
+
+            f_apd_compression (out_m, (P->n_ch)*(Par->ns)*(Par->im[0]), 1, \
+                               Par->Cp);
+
+        else
+
+            for (k=0; k<(P->n_ch)*(Par->im[0]); k++)
+
+                f_apd_compression (out_m + (k%(P->n_ch)) + \
+                        (k/(P->n_ch))*(Par->ns)*(P->Il[2]), Par->ns, P->Il[2], \
+                        Par->Cp);
+
+        f_apd_stats_phase (APD_STATS_DECOMP, t0);
+    }
+
+
+
+    /* Output */
+
+    finish:
+
+        return exitflag;
+
+    failed:
+
+        f_apd_get_error (&exitflag, NULL, NULL, NULL);
+
+        goto finish;
+
+}
+
+
+
+
+int f_apd_plan_execute ( struct strAPD_Plan* plan, \
+
+                         const double* s, \
+
+                         const double* Ub, \
+
+                         double* out_m, \
+
+                         double* out_e, \
+
+                         long* iter )
+{
+/* P U R P O S E
+ *
+ * Demodulates the input signal by using the demodulation plan. No memory is
+ * allocated in this function. The precision of the last iterations and the number
+ * of iterations in single precision are stored for f_apd_get_precision.
+ */
+
+/* I N P U T   A R G U M E N T S
+ *
+ * [plan] - demodulation plan created by f_apd_plan_create.
+ *
+ * [s] - input signal (see f_apd_demodulation). For a multichannel plan, the
+ *       channels of the signal are stored one after another or interleaved (see
+ *       f_apd_plan_create_multichannel).
+ *
+ * [Ub] - upper bound on the modulator (see f_apd_demodulation) or NULL. Ub can be
+ *        used only if the plan was created with a nonzero Ub_flag. For a
+ *        multichannel plan, it has the same layout as s.
+ */
+
+/* O U T P U T   A R G U M E N T S
+ *
+ * [out_m], [out_e], [iter] - see f_apd_demodulation. For a multichannel plan, see
+ *                             f_apd_plan_create_multichannel.
+ */
+
+/* R E T U R N   V A L U E
+ *
+ * [exitflag] - exit flag. Any positive value indicates an error (for numerical and
+ *              textual definitions of the exit status, see l_ap_error_handling.c).
+ *              The signal and the upper bound are validated while they are placed
+ *              on the DFT grid, so that the state of the plan is not kept for
+ *              f_apd_plan_execute_warm if they are invalid.
+ */
+
+/* N O N S T A N D A R D   F U N C T I O N S   U S E D
+ *
+ * (1) f_apd_plan_run.
+ */
+
+
+    return f_apd_plan_run (plan, s, APD_TYPE_F64, Ub, NULL, APD_INIT_COLD, out_m, \
+                           out_e, iter);
+
+}
+
+
+
+
+int f_apd_plan_execute_typed ( struct strAPD_Plan* plan, \
+
+                               const void* s, \
+
+                               const int type, \
+
+                               const double* Ub, \
+
+                               double* out_m, \
+
+                               double* out_e, \
+
+                               long* iter )
+{
+/* P U R P O S E
+ *
+ * Demodulates the input signal of the given element type by using the
+ * demodulation plan, e.g., 16-bit PCM audio without a copy of the signal in
+ * doubles. The elements of the signal are converted into doubles while they are
+ * placed on the DFT grid, in one pass that also validates them, compresses them,
+ * and computes the absolute-value signal and its maximum (see f_apd_s_Ub_load).
+ * The modulator is output in doubles in the units of the signal (integers are
+ * not rescaled). No memory is allocated in this function.
+ */
+
+/* I N P U T   A R G U M E N T S
+ *
+ * [plan] - demodulation plan created by f_apd_plan_create or
+ *          f_apd_plan_create_multichannel.
+ *
+ * [s] - input signal in the layout of f_apd_plan_execute.
+ *
+ * [type] - type of the elements of s. Possible options are: APD_TYPE_F64 -
+ *          double (as f_apd_plan_execute); APD_TYPE_F32 - float; APD_TYPE_I16 -
+ *          16-bit integer (int16_t); APD_TYPE_I32 - 32-bit integer (int32_t).
+ *
+ * [Ub] - upper bound on the modulator in doubles (see f_apd_plan_execute) or NULL.
+ */
+
+/* O U T P U T   A R G U M E N T S
+ *
+ * [out_m], [out_e], [iter] - see f_apd_plan_execute.
+ */
+
+/* R E T U R N   V A L U E
+ *
+ * [exitflag] - exit flag. Any positive value indicates an error (for numerical and
+ *              textual definitions of the exit status, see l_ap_error_handling.c).
+ *              The state of the plan is not kept for f_apd_plan_execute_warm if the
+ *              signal or the upper bound is invalid (see f_apd_plan_execute).
+ */
+
+/* N O N S T A N D A R D   F U N C T I O N S   U S E D
+ *
+ * (1) f_apd_plan_run.
+ */
+
+
+    int exitflag = 0;
+
+    f_apd_set_error (exitflag, __LINE__, APD_ERR_FILE);
+
+
+    if (type != APD_TYPE_F64 && type != APD_TYPE_F32 && type != APD_TYPE_I16 && \
+            type != APD_TYPE_I32)
+    {
+        f_apd_set_error(APD_ERR_ID_TYP,__LINE__,APD_ERR_FILE); goto failed;}
+
+    exitflag = f_apd_plan_run (plan, s, type, Ub, NULL, APD_INIT_COLD, out_m, \
+                               out_e, iter);
+
+
+
+    /* Output */
+
+    finish:
+
+        return exitflag;
+
+    failed:
+
+        f_apd_get_error (&exitflag, NULL, NULL, NULL);
+
+        goto finish;
+
+}
+
+
+
+
+int f_apd_plan_execute_warm ( struct strAPD_Plan* plan, \
+
+                              const double* s, \
+
+                              const double* Ub, \
+
+                              const double* m0, \
+
+                              double* out_m, \
+
+                              double* out_e, \
+
+                              long* iter )
+{
+/* P U R P O S E
+ *
+ * Demodulates the input signal by using the demodulation plan with a warm start:
+ * the AP algorithm starts from the initial modulator m0 or, if m0 is NULL, from the
+ * state of the last successful execution of the plan (the modulator and the
+ * auxiliary variables of AP-A and AP-P). The initial estimates are scaled to the
+ * maximum of the absolute-value signal, which is used for the normalization of the
+ * AP algorithms. A warm start from a modulator close to the solution (e.g., that of
+ * an overlapping window of a long signal) needs fewer iterations to reach the
+ * infeasibility error tolerance Par.Et. No memory is allocated in this function.
+ */
+
+/* I N P U T   A R G U M E N T S
+ *
+ * [plan], [s], [Ub] - see f_apd_plan_execute.
+ *
+ * [m0] - initial modulator with the same layout as s (nonnegative, in the units of
+ *        the signal, i.e., without compression) or NULL. If m0 is NULL, the plan
+ *        must have been executed successfully before. For AP-A, the first step
+ *        from the initial modulator is a projection onto Mw without
+ *        extrapolation (lambda = 1). AP-A typically reaches the tolerance in a
+ *        few iterations from a cold start, so that a warm start then saves no
+ *        iterations and costs the placement of m0 (see benchmark_warm.c). For
+ *        AP-P, the initial modulator replaces the zero signal as the point
+ *        projected onto the intersection of Mw and Cd (the auxiliary variable c
+ *        is zero).
+ */
+
+/* O U T P U T   A R G U M E N T S
+ *
+ * [out_m], [out_e], [iter] - see f_apd_plan_execute. The infeasibility error of
+ *                             iteration 0 is that of the initial modulator.
+ */
+
+/* R E T U R N   V A L U E
+ *
+ * [exitflag] - exit flag. Any positive value indicates an error (for numerical and
+ *              textual definitions of the exit status, see l_ap_error_handling.c).
+ */
+
+/* N O N S T A N D A R D   F U N C T I O N S   U S E D
+ *
+ * (1) f_apd_plan_run.
+ */
+
+
+    return f_apd_plan_run (plan, s, APD_TYPE_F64, Ub, m0, (m0 != NULL) ? \
+                           APD_INIT_M0 : APD_INIT_STATE, out_m, out_e, iter);
+
+}
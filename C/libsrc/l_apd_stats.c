@@ -0,0 +1,380 @@
+/*                       C O P Y R I G H T   N O T I C E
+ *
+ * Copyright ©2021. Institute of Science and Technology Austria (IST Austria).
+ * All Rights Reserved. The underlying technology is protected by PCT Patent
+ * Application No. PCT/EP2021/054650.
+ *
+ * This file is part of the AP Demodulation library, which is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation in version 2.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY, without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE. See the GNU General Public License v2 for more details. You
+ * should have received a copy of the GNU General Public License v2 along with this
+ * program. If not, see https://www.gnu.org/licenses/.
+ *
+ * Contact the Technology Transfer Office, IST Austria, Am Campus 1,
+ * A-3400 Klosterneuburg, Austria, +43-(0)2243 9000, twist@ist.ac.at, for commercial
+ * licensing opportunities.
+ *
+ * See https://github.com/mgabriel-lt/ap-demodulation for the latest version of the
+ * code and user-friendly explanations on the working principle, domains of
+ * application, and advice on the usage of different AP Demodulation algorithms in
+ * practice.
+ */
+
+
+/* C O N T E N T S
+ *
+ * Statistics of the last demodulation in the calling thread: the wall time of its
+ * phases, the number of DFTs, the memory allocated, the number of iterations, and
+ * the final factor lambda of AP-A. The statistics are collected by every plan
+ * creation (the setup phases) and plan execution (the remaining phases), and
+ * therefore by every call of f_apd_demodulation:
+ *
+ * (1) sgAPD_STATS and sgAPD_STATS_NAME,
+ *
+ * (2) f_apd_time, f_apd_stats_reset, and f_apd_stats_phase,
+ *
+ * (3) f_apd_get_stats and f_apd_write_trace.
+ */
+
+
+
+#include "h_apd.h"
+
+
+
+/* (1) STATIC GLOBAL VARIABLES OF THE STATISTICS */
+
+/* Statistics of the last demodulation in the calling thread (one per thread). The
+ * start times of the phases that did not run are negative */
+
+static APD_TLS struct strAPD_Stats sgAPD_STATS = {{0}, {-1, -1, -1, -1, -1, -1, \
+                                                  -1, -1, -1}, 0, 0, 0, 0, 0};
+
+
+/* Names of the phases (see APD_STATS_*) in the trace */
+
+static const char *sgAPD_STATS_NAME[APD_STATS_N] = {"validation", "allocation", \
+        "interpolation", "dft_init", "check", "load", "iterations", "dft", \
+        "decompression"};
+
+
+
+
+/* (2)-(3) FUNCTIONS OF THE STATISTICS */
+
+double f_apd_time (void)
+{
+/* P U R P O S E
+ *
+ * Returns the wall-clock time in seconds (from an arbitrary origin).
+ */
+
+    #if defined(_OPENMP)
+
+        return omp_get_wtime();
+
+    #elif defined(TIME_UTC)
+
+        struct timespec ts;
+
+        timespec_get(&ts, TIME_UTC);
+
+        return ts.tv_sec + 1e-9 * ts.tv_nsec;
+
+    #else
+
+        return (double) clock() / CLOCKS_PER_SEC;
+
+    #endif
+}
+
+
+
+
+void f_apd_stats_reset (const int first, const int last)
+{
+/* P U R P O S E
+ *
+ * Clears the phases first, ..., last of the statistics of the calling thread
+ * together with the counters collected in these phases (the memory allocated in
+ * the setup phases, the number of DFTs, iterations, and lambda in the others).
+ */
+
+/* I N P U T   A R G U M E N T S
+ *
+ * [first], [last] - first and last phase (see APD_STATS_*).
+ */
+
+/* O U T P U T   A R G U M E N T S
+ *
+ * None.
+ */
+
+/* R E T U R N   V A L U E
+ *
+ * None.
+ */
+
+/* N O N S T A N D A R D   F U N C T I O N S   U S E D
+ *
+ * None.
+ */
+
+    int i;
+
+
+    for (i=first; i<=last; i++)
+    {
+        sgAPD_STATS.t[i] = 0;
+
+        sgAPD_STATS.ts[i] = -1;
+    }
+
+    if (first <= APD_STATS_ALLOC)
+
+        sgAPD_STATS.bytes = 0;
+
+    if (last >= APD_STATS_ITER)
+    {
+        sgAPD_STATS.n_dft = 0;
+
+        sgAPD_STATS.iter = 0;
+
+        sgAPD_STATS.t_iter = 0;
+
+        sgAPD_STATS.lambda = 0;
+    }
+}
+
+
+
+
+double f_apd_stats_phase (const int phase, const double t0)
+{
+/* P U R P O S E
+ *
+ * Adds the time elapsed since t0 to a phase of the statistics of the calling
+ * thread (the start time of the phase is that of its first part).
+ */
+
+/* I N P U T   A R G U M E N T S
+ *
+ * [phase] - phase (see APD_STATS_*).
+ *
+ * [t0] - start time of the part of the phase (see f_apd_time).
+ */
+
+/* O U T P U T   A R G U M E N T S
+ *
+ * None.
+ */
+
+/* R E T U R N   V A L U E
+ *
+ * [t1] - current time (the start time of the next phase).
+ */
+
+/* N O N S T A N D A R D   F U N C T I O N S   U S E D
+ *
+ * (1) f_apd_time.
+ */
+
+    const double t1 = f_apd_time();
+
+
+    if (sgAPD_STATS.ts[phase] < 0)
+
+        sgAPD_STATS.ts[phase] = t0;
+
+    sgAPD_STATS.t[phase] = sgAPD_STATS.t[phase] + (t1 - t0);
+
+
+    return t1;
+}
+
+
+
+
+void f_apd_get_stats (struct strAPD_Stats* stats)
+{
+/* P U R P O S E
+ *
+ * Outputs the statistics of the last demodulation in the calling thread. The
+ * setup phases (validation, allocation, interpolation, and DFT initialization)
+ * refer to the last plan created in the calling thread, the other phases to the
+ * last execution of a plan (both refer to the last call of f_apd_demodulation).
+ */
+
+/* I N P U T   A R G U M E N T S
+ *
+ * None.
+ */
+
+/* O U T P U T   A R G U M E N T S
+ *
+ * [stats] - statistics (this is the address of an externally defined structure):
+ *
+ *           .t - wall time of every phase in seconds (element APD_STATS_* of the
+ *                phase): APD_STATS_VALID - validation of the parameters;
+ *                APD_STATS_ALLOC - memory allocation; APD_STATS_INTERP - mapping
+ *                of the signal onto the DFT grid (interpolation of nonuniformly
+ *                sampled signals); APD_STATS_DFT_INIT - initialization of the DFT;
+ *                APD_STATS_CHECK - validation of the input data; APD_STATS_LOAD -
+ *                compression and placement of the signal on the DFT grid;
+ *                APD_STATS_ITER - iterations of the AP algorithm (including the
+ *                projections onto Cd and the output of the estimates);
+ *                APD_STATS_DFT - projections onto Mw (part of the iterations);
+ *                APD_STATS_DECOMP - decompression of the output.
+ *
+ *           .ts - start time of every phase in seconds (see .t; the origin is
+ *                 arbitrary, negative if the phase did not run).
+ *
+ *           .n_dft - number of DFTs (forward and backward transforms of one
+ *                    channel) computed in the iterations.
+ *
+ *           .bytes - memory allocated by the plan (the memory block of the plan,
+ *                    without the DFT of the backend; 0 for a workspace, see
+ *                    f_apd_plan_create_ws).
+ *
+ *           .iter - number of iterations (the largest one among the channels).
+ *
+ *           .t_iter - average time per iteration in seconds.
+ *
+ *           .lambda - factor lambda of the last iteration of AP-A (of the first
+ *                     channel; 0 for the other algorithms).
+ */
+
+/* R E T U R N   V A L U E
+ *
+ * None.
+ */
+
+/* N O N S T A N D A R D   F U N C T I O N S   U S E D
+ *
+ * None.
+ */
+
+    *stats = sgAPD_STATS;
+}
+
+
+
+
+int f_apd_write_trace (const char* file)
+{
+/* P U R P O S E
+ *
+ * Writes the phases of the last demodulation in the calling thread (see
+ * f_apd_get_stats) to a file in the Chrome trace-event format (JSON), which can be
+ * opened by trace viewers such as chrome://tracing or Perfetto. Every phase is a
+ * complete event in microseconds from the start of the first phase; the
+ * projections onto Mw and the counters are given as arguments of the iterations.
+ */
+
+/* I N P U T   A R G U M E N T S
+ *
+ * [file] - name of the file (created or overwritten).
+ */
+
+/* O U T P U T   A R G U M E N T S
+ *
+ * None.
+ */
+
+/* R E T U R N   V A L U E
+ *
+ * [exitflag] - exit flag. Any positive value indicates an error (for numerical and
+ *              textual definitions of the exit status, see l_ap_error_handling.c).
+ */
+
+/* N O N S T A N D A R D   F U N C T I O N S   U S E D
+ *
+ * None.
+ */
+
+
+    int exitflag = 0;
+
+    f_apd_set_error (exitflag, __LINE__, APD_ERR_FILE);
+
+
+    const struct strAPD_Stats *S = &sgAPD_STATS;
+
+    int i;
+
+    int n = 0;
+
+    double t_org = -1;
+
+    FILE *f;
+
+
+
+    /* Origin of the time (the start of the first phase) */
+
+    for (i=0; i<APD_STATS_N; i++)
+
+        if (S->ts[i] >= 0 && (t_org < 0 || S->ts[i] < t_org))
+
+            t_org = S->ts[i];
+
+
+
+    /* Complete events of the phases (the projections onto Mw are an argument of
+     * the iterations) */
+
+    f = fopen(file, "w");
+
+    if (f == NULL)
+    {
+        f_apd_set_error(APD_ERR_ID_TR,__LINE__,APD_ERR_FILE);
+
+        f_apd_get_error (&exitflag, NULL, NULL, NULL);
+
+        return exitflag;
+    }
+
+    fprintf(f, "{\"traceEvents\":[");
+
+    for (i=0; i<APD_STATS_N; i++)
+    {
+        if (S->ts[i] < 0 || i == APD_STATS_DFT)
+
+            continue;
+
+        fprintf(f, "%s\n{\"name\":\"%s\",\"cat\":\"apd\",\"ph\":\"X\",\"pid\":1," \
+                "\"tid\":1,\"ts\":%.3f,\"dur\":%.3f", (n > 0) ? "," : "", \
+                sgAPD_STATS_NAME[i], 1e6*(S->ts[i] - t_org), 1e6*(S->t[i]));
+
+        if (i == APD_STATS_ITER)
+
+            fprintf(f, ",\"args\":{\"iter\":%ld,\"t_iter_us\":%.3f,\"dft_us\":" \
+                    "%.3f,\"n_dft\":%ld,\"lambda\":%.17g}", S->iter, \
+                    1e6*(S->t_iter), 1e6*(S->t[APD_STATS_DFT]), S->n_dft, \
+                    S->lambda);
+
+        else if (i == APD_STATS_ALLOC)
+
+            fprintf(f, ",\"args\":{\"bytes\":%.0f}", (double) S->bytes);
+
+        fprintf(f, "}");
+
+        n = n + 1;
+    }
+
+    fprintf(f, "\n],\"displayTimeUnit\":\"ms\"}\n");
+
+    if (fclose(f) != 0)
+    {
+        f_apd_set_error(APD_ERR_ID_TR,__LINE__,APD_ERR_FILE);
+
+        f_apd_get_error (&exitflag, NULL, NULL, NULL);
+    }
+
+
+    return exitflag;
+}
@@ -0,0 +1,974 @@
+
+/*                       C O P Y R I G H T   N O T I C E
+ *
+ * Copyright ©2021. Institute of Science and Technology Austria (IST Austria).
+ * All Rights Reserved. The underlying technology is protected by PCT Patent
+ * Application No. PCT/EP2021/054650.
+ *
+ * This file is part of the AP Demodulation library, which is free software: you can
+ * redistribute it and/or modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation in version 2.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY, without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE. See the GNU General Public License v2 for more details. You
+ * should have received a copy of the GNU General Public License v2 along with this
+ * program. If not, see https://www.gnu.org/licenses/.
+ *
+ * Contact the Technology Transfer Office, IST Austria, Am Campus 1,
+ * A-3400 Klosterneuburg, Austria, +43-(0)2243 9000, twist@ist.ac.at, for commercial
+ * licensing opportunities.
+ *
+ * See https://github.com/mgabriel-lt/ap-demodulation for the latest version of the
+ * code and user-friendly explanations on the working principle, domains of
+ * application, and advice on the usage of different AP Demodulation algorithms in
+ * practice.
+ */
+
+
+/* C O N T E N T S
+ *
+ * The streaming (online) demodulation of 1D signals, which are pushed and pulled in
+ * chunks of arbitrary length. The signal is demodulated in overlapping blocks of
+ * Par.Ns[0] samples shifted by a fixed hop. Every block is started from the
+ * absolute-value signal or from the modulator of the previous block (warm start,
+ * see f_apd_plan_execute_warm). The edges of every block, which are distorted by
+ * the periodic boundary conditions of the DFT, are discarded, and the outputs of
+ * consecutive blocks are crossfaded linearly. The memory of a stream is constant,
+ * and the latency is bounded by the block length:
+ *
+ * (1) strAPD_Stream,
+ *
+ * (2) f_apd_stream_destroy,
+ *
+ * (3) f_apd_stream_init and f_apd_stream_create,
+ *
+ * (4) f_apd_stream_block,
+ *
+ * (5) f_apd_stream_push, f_apd_stream_pull, and f_apd_stream_flush.
+ *
+ * The layout of the blocks of a stream with the block length L, the hop H, and the
+ * crossfade length X (e = (L-H-X)/2 is the length of the discarded edges):
+ *
+ *   block b:     |-- e --|-- X --|---- H-X ----|-- X --|-- e --|
+ *                         ramp up    weight 1    ramp down
+ *   block b+1:                   <---- H ---->|-- e --|-- X --|---- H-X ---- ...
+ *
+ * Block b starts at the sample b*H of the stream and outputs the samples
+ * [b*H+e, b*H+e+H) (the first block also outputs its first e samples, and the last
+ * block, computed by f_apd_stream_flush, all remaining samples).
+ */
+
+
+
+#include "h_apd.h"
+
+
+
+/* (1) STREAM */
+
+struct strAPD_Stream {
+
+                    struct strAPD_Plan* plan;  // multichannel plan of the blocks
+
+                    long         n_ch;
+
+                    long         L;            // block length (Par.Ns[0])
+
+                    long         hop;
+
+                    long         xf;           // crossfade length
+
+                    long         edge;         // discarded edge (e, see above)
+
+                    int          warm;         // warm start of the blocks
+
+                    long         n_blk;        // blocks since the creation or
+                                               // the last flush
+                    long         n_x;          // samples of every channel in x
+
+                    long         n_y;          // samples of every channel in y
+
+                    double*      x;            // input (L+hop samples per
+                                               // channel, x[0] is the first
+                                               // sample of the last block)
+                    double*      s;            // block (L samples per channel)
+
+                    double*      m;            // modulator of the last block
+
+                    double*      m0;           // initial modulator of a block
+
+                    double*      y;            // output ready to be pulled
+                                               // (2L samples per channel)
+                    double*      tail;         // ramp-down part of the last
+                                               // block (xf samples per channel)
+                    double*      e;
+
+                    long*        iter;
+
+                   };
+
+
+
+
+/* Minimum length of the discarded edges of a block in units of Fs/(Pi*Fc) samples,
+ * i.e., the distance at which the envelope 1/(Pi*Fc*t) of the sinc kernel of the
+ * projection onto Mw drops to 1 (see APD_MMAP_EDGE in l_apd_mmap.c) */
+
+#define APD_STREAM_EDGE 1.0
+
+
+
+
+/* (2)-(5) FUNCTIONS OF THE STREAMING DEMODULATION */
+
+void f_apd_stream_destroy (struct strAPD_Stream* stream)
+{
+/* P U R P O S E
+ *
+ * Frees all memory held by the stream.
+ */
+
+/* I N P U T   A R G U M E N T S
+ *
+ * [stream] - stream created by f_apd_stream_create (or NULL).
+ */
+
+/* O U T P U T   A R G U M E N T S
+ *
+ * None.
+ */
+
+/* R E T U R N   V A L U E
+ *
+ * None.
+ */
+
+/* N O N S T A N D A R D   F U N C T I O N S   U S E D
+ *
+ * (1) f_apd_plan_destroy.
+ */
+
+    if (stream == NULL)
+
+        return;
+
+    f_apd_plan_destroy(stream->plan);
+
+    free(stream->x);
+
+    free(stream->s);
+
+    free(stream->m);
+
+    free(stream->m0);
+
+    free(stream->y);
+
+    free(stream->tail);
+
+    free(stream->e);
+
+    free(stream->iter);
+
+    free(stream);
+}
+
+
+
+
+int f_apd_stream_init ( const struct strAPD_Par* Par, \
+
+                        const long n_ch, \
+
+                        const long hop, \
+
+                        const long xfade, \
+
+                        const int warm, \
+
+                        const long e_min, \
+
+                        const struct strAPD_Opt* opt, \
+
+                        struct strAPD_Stream** stream )
+{
+/* P U R P O S E
+ *
+ * Creates a stream (see f_apd_stream_create) whose discarded edges are at least
+ * e_min samples long.
+ */
+
+/* I N P U T   A R G U M E N T S
+ *
+ * [Par], [n_ch], [hop], [xfade], [warm], [opt] - see f_apd_stream_create.
+ *
+ * [e_min] - minimum length of the discarded edges, e = (Par.Ns[0]-hop-xfade)/2
+ *           (0 for a stream whose blocks cover the whole signal, see
+ *           f_apd_demodulation_mmap).
+ */
+
+/* O U T P U T   A R G U M E N T S
+ *
+ * [stream] - see f_apd_stream_create.
+ */
+
+/* R E T U R N   V A L U E
+ *
+ * [exitflag] - exit flag. Any positive value indicates an error (for numerical and
+ *              textual definitions of the exit status, see l_ap_error_handling.c).
+ * 
+ *              Upon an error, all memory dynamically allocated in this function or
+ *              functions called by this function is freed.
+ */
+
+/* N O N S T A N D A R D   F U N C T I O N S   U S E D
+ *
+ * (1) f_apd_plan_init, (2) f_apd_stream_destroy, (3) f_apd_options.
+ */
+    
+    
+    /* Definitions and initializations */
+    
+    int exitflag = 0;
+
+    f_apd_set_error (exitflag, __LINE__, APD_ERR_FILE);
+
+
+    long L;
+
+    long im[2];
+
+    long ie[2];
+
+    struct strAPD_Par Par_b;
+
+    struct strAPD_Opt O;
+
+    struct strAPD_Stream *S = NULL;
+
+
+    *stream = NULL;
+
+
+
+    /* Validation of the layout of the blocks */
+
+    if (Par->D != 1 || hop < 1 || xfade < 0 || \
+            Par->Ns[0] - hop - xfade < 2*e_min)
+    {
+        f_apd_set_error(APD_ERR_ID_ST,__LINE__,APD_ERR_FILE); goto failed;}
+
+    exitflag = f_apd_options (opt, &O);
+
+    if (exitflag != APD_ERR_ID_NON) goto finish;
+
+    L = Par->Ns[0];
+
+
+
+    /* Multichannel plan of the blocks (only the final modulator and error of every
+     * block are saved) */
+
+    S = (struct strAPD_Stream*) calloc(1, sizeof(struct strAPD_Stream));
+
+    if (S==NULL)
+    {
+        f_apd_set_error(APD_ERR_ID_MEM,__LINE__,APD_ERR_FILE); goto failed;}
+
+
+    Par_b = *Par;
+
+    im[0] = 1;
+
+    im[1] = Par->Ni;
+
+    ie[0] = 1;
+
+    ie[1] = Par->Ni;
+
+    Par_b.im = im;
+
+    Par_b.ie = ie;
+
+    /* Multichannel plan of the blocks, whose channels are stored one after another
+     * (independently of the interleaving given in the options) */
+
+    O.Il[0] = 1; O.Il[1] = 1; O.Il[2] = 1;
+
+    exitflag = f_apd_plan_init (&Par_b, NULL, 0, n_ch, 0, &O, NULL, 0, \
+                                &(S->plan));
+
+    if (exitflag != APD_ERR_ID_NON) goto finish;
+
+
+    S->n_ch = n_ch;
+
+    S->L = L;
+
+    S->hop = hop;
+
+    S->xf = xfade;
+
+    S->edge = (L - hop - xfade) / 2;
+
+    S->warm = (warm != 0 && Par->Al != 'A');
+
+
+
+    /* Memory allocation */
+
+    S->x = (double*) calloc(n_ch*(L+hop), sizeof(double));
+
+    S->s = (double*) malloc(n_ch*L*sizeof(double));
+
+    S->m = (double*) malloc(n_ch*L*sizeof(double));
+
+    S->m0 = (double*) malloc(n_ch*L*sizeof(double));
+
+    S->y = (double*) malloc(n_ch*2*L*sizeof(double));
+
+    S->tail = (double*) malloc((n_ch*xfade+1)*sizeof(double));
+
+    S->e = (double*) malloc(n_ch*sizeof(double));
+
+    S->iter = (long*) malloc(n_ch*sizeof(long));
+
+    if (S->x==NULL || S->s==NULL || S->m==NULL || S->m0==NULL || S->y==NULL || \
+            S->tail==NULL || S->e==NULL || S->iter==NULL)
+    {
+        f_apd_set_error(APD_ERR_ID_MEM,__LINE__,APD_ERR_FILE); goto failed;}
+
+
+
+    /* Output & Memory deallocation */
+
+    finish:
+
+        if (exitflag == APD_ERR_ID_NON)
+
+            *stream = S;
+
+        else
+
+            f_apd_stream_destroy(S);
+
+        return exitflag;
+
+    failed:
+
+        f_apd_get_error (&exitflag, NULL, NULL, NULL);
+
+        goto finish;
+
+}
+
+
+
+
+int f_apd_stream_create ( const struct strAPD_Par* Par, \
+
+                          const long n_ch, \
+
+                          const long hop, \
+
+                          const long xfade, \
+
+                          const int warm, \
+
+                          const struct strAPD_Opt* opt, \
+
+                          struct strAPD_Stream** stream )
+{
+/* P U R P O S E
+ *
+ * Creates a stream for the online demodulation of n_ch channels of a 1D signal in
+ * overlapping blocks of Par.Ns[0] samples shifted by hop samples (see
+ * f_apd_stream_push). The edges of e = (Par.Ns[0]-hop-xfade)/2 samples of every
+ * block are discarded, and the outputs of consecutive blocks are crossfaded over
+ * xfade samples. The edges should be long enough to cover the boundary effects of
+ * the demodulation (see the documentation), and they must be at least
+ * APD_STREAM_EDGE*Par.Fs[0]/(Pi*Par.Fc[0]) samples (and at least one sample)
+ * long. All memory is allocated in this function.
+ */
+
+/* I N P U T   A R G U M E N T S
+ *
+ * [Par] - pointer to the structure with demodulation parameters (see
+ *         f_apd_demodulation). Par.D must be 1, and Par.Ns[0] is the block length.
+ *         The fields .im and .ie are not used (the final modulator of every block
+ *         is computed). The structure is copied into the stream.
+ *
+ * [n_ch] - number of channels (positive).
+ *
+ * [hop] - shift of consecutive blocks, i.e., the number of samples output per
+ *         block (positive).
+ *
+ * [xfade] - length of the crossfade of consecutive blocks (nonnegative,
+ *           hop + xfade + 2*e <= Par.Ns[0] with the minimum edge e above).
+ *
+ * [warm] - if nonzero, every block is started from the modulator of the previous
+ *          block on their overlap (without the edges of the previous block), which
+ *          needs fewer iterations. Since the AP algorithms stop at a tolerance, the
+ *          modulator then depends on the previous blocks and may differ from that
+ *          of a cold start by more than the tolerance. Otherwise, every block is
+ *          started from the absolute-value signal (cold start), and the output
+ *          matches f_apd_demodulation of the whole signal away from its ends up to
+ *          a boundary error, which decreases with the length e of the edges and
+ *          may exceed the tolerance Par.Et for short edges. The warm start is not
+ *          used for AP-A (Par.Al = 'A'), which converges in a few iterations from
+ *          either start, so that a warm start does not save time but increases
+ *          the difference from f_apd_demodulation. AP-P needs thousands of
+ *          iterations per block at tight tolerances and may not keep up with
+ *          real time even with warm starts (see benchmark_stream.c).
+ *
+ * [opt] - options of the plan of the blocks (see f_apd_plan_create) or NULL for
+ *         the defaults (see f_apd_get_options). The numbers of interleaved
+ *         channels are ignored (the stream stores its channels one after
+ *         another).
+ */
+
+/* O U T P U T   A R G U M E N T S
+ *
+ * [stream] - address of the pointer to the created stream (NULL upon an error).
+ *            The stream must be freed by f_apd_stream_destroy.
+ */
+
+/* R E T U R N   V A L U E
+ *
+ * [exitflag] - exit flag. Any positive value indicates an error (for numerical and
+ *              textual definitions of the exit status, see l_ap_error_handling.c).
+ * 
+ *              Upon an error, all memory dynamically allocated in this function or
+ *              functions called by this function is freed.
+ */
+
+/* N O N S T A N D A R D   F U N C T I O N S   U S E D
+ *
+ * (1) f_apd_stream_init.
+ */
+
+    double e_min = 0;
+
+
+    /* Minimum edge from the cutoff frequency (invalid frequencies are reported by
+     * the validation of the parameters) */
+
+    if (Par->Fs[0] > 0 && Par->Fc[0] > 0)
+
+        e_min = fmax(1, fmin(ceil(APD_STREAM_EDGE * Par->Fs[0] / \
+                                  (M_PI * Par->Fc[0])), Par->Ns[0]));
+
+
+    return f_apd_stream_init (Par, n_ch, hop, xfade, warm, (long) e_min, opt, \
+                              stream);
+}
+
+
+
+
+int f_apd_stream_block ( struct strAPD_Stream* stream, \
+
+                         const long q, \
+
+                         const long d, \
+
+                         const long i0, \
+
+                         const long n_out )
+{
+/* P U R P O S E
+ *
+ * Demodulates the block x[q, q+L) of every channel, started from the absolute-value
+ * signal (the first block or a stream without warm start) or from the modulator of
+ * the last block shifted by d samples without its edges, completed by the absolute
+ * value of the signal (so that the boundary effects of the last block do not reach
+ * the output), and appends the samples [i0, i0+n_out) of the modulator of the
+ * block, crossfaded with the tail of the last block, to the output. The ramp-down
+ * part of the block that follows the output samples is stored as the tail of the
+ * block. A block that is not shifted (d = 0) with respect to the last block is not
+ * demodulated again (its modulator is that of the last block).
+ */
+
+/* I N P U T   A R G U M E N T S
+ *
+ * [stream] - stream with at least n_out free samples of the output.
+ *
+ * [q] - offset of the block in the input.
+ *
+ * [d] - shift of the block with respect to the last block.
+ *
+ * [i0], [n_out] - first sample and number of the output samples of the block.
+ */
+
+/* O U T P U T   A R G U M E N T S
+ *
+ * [stream] - stream with the modulator of the block, the appended output, and the
+ *            tail of the block.
+ */
+
+/* R E T U R N   V A L U E
+ *
+ * [exitflag] - exit flag. Any positive value indicates an error (for numerical and
+ *              textual definitions of the exit status, see l_ap_error_handling.c).
+ */
+
+/* N O N S T A N D A R D   F U N C T I O N S   U S E D
+ *
+ * (1) f_apd_plan_execute, (2) f_apd_plan_execute_warm.
+ */
+    
+    
+    /* Definitions and initializations */
+
+    int exitflag = 0;
+
+    struct strAPD_Stream *S = stream;
+
+    const long L = S->L;
+
+    const long xf = S->xf;
+
+    long i;
+
+    long k;
+
+    double w;
+
+    double *m_k;
+
+    double *y_k;
+
+
+
+    /* Unshifted block (the last block of a flushed stream that ends with a complete
+     * block): the modulator of the last block is reused */
+
+    if (S->n_blk > 0 && d == 0)
+
+        goto output;
+
+
+
+    /* Block and initial modulator */
+
+    for (k=0; k<(S->n_ch); k++)
+    {
+        memcpy(S->s + k*L, S->x + k*(L+S->hop) + q, L*sizeof(double));
+
+        if (S->n_blk > 0 && S->warm != 0)
+
+            for (i=0; i<L; i++)
+
+                S->m0[k*L+i] = (i+d >= S->edge && i+d < L - S->edge) ? \
+                               S->m[k*L+i+d] : fabs(S->s[k*L+i]);
+    }
+
+
+
+    /* Demodulation */
+
+    if (S->n_blk == 0 || S->warm == 0)
+
+        exitflag = f_apd_plan_execute (S->plan, S->s, NULL, S->m, S->e, S->iter);
+
+    else
+
+        exitflag = f_apd_plan_execute_warm (S->plan, S->s, NULL, S->m0, S->m, \
+                                            S->e, S->iter);
+
+    if (exitflag != APD_ERR_ID_NON)
+
+        return exitflag;
+
+
+
+    /* Output (crossfaded with the tail of the last block, weights (j+1)/(X+1) and
+     * 1-(j+1)/(X+1) of the sample j of the crossfade) and tail */
+
+    output:
+
+    for (k=0; k<(S->n_ch); k++)
+    {
+        m_k = S->m + k*L;
+
+        y_k = S->y + k*2*L + S->n_y;
+
+        for (i=0; i<n_out; i++)
+        {
+            y_k[i] = m_k[i0+i];
+
+            if (S->n_blk > 0 && i < xf)
+            {
+                w = (double) (i+1) / (xf+1);
+
+                y_k[i] = S->tail[k*xf+i] + w * y_k[i];
+            }
+        }
+
+        if (i0 + n_out + xf <= L)
+
+            for (i=0; i<xf; i++)
+            {
+                w = (double) (i+1) / (xf+1);
+
+                S->tail[k*xf+i] = (1 - w) * m_k[i0+n_out+i];
+            }
+    }
+
+    S->n_y = S->n_y + n_out;
+
+    S->n_blk = S->n_blk + 1;
+
+
+    return exitflag;
+}
+
+
+
+
+int f_apd_stream_push ( struct strAPD_Stream* stream, \
+
+                        const double* x, \
+
+                        const long n, \
+
+                        long* n_in )
+{
+/* P U R P O S E
+ *
+ * Feeds samples into the stream and demodulates every block completed by them.
+ * The samples are accepted as long as the output of the completed blocks fits
+ * into the stream (up to 2*Par.Ns[0] samples of every channel wait to be pulled).
+ * The latency of the stream is Par.Ns[0]-e samples: the modulator of a sample is
+ * ready once the block in which it is output is complete.
+ */
+
+/* I N P U T   A R G U M E N T S
+ *
+ * [stream] - stream created by f_apd_stream_create.
+ *
+ * [x] - n frames of the signal, i.e., n samples of every channel, the channels of
+ *       every frame stored one after another (interleaved as in audio data).
+ *
+ * [n] - number of frames.
+ */
+
+/* O U T P U T   A R G U M E N T S
+ *
+ * [stream] - stream with the accepted frames and the output of the completed
+ *            blocks.
+ *
+ * [n_in] - number of frames accepted (this is the address of an externally defined
+ *          scalar variable). If n_in[0] < n, the output must be pulled (see
+ *          f_apd_stream_pull) before the rest of the frames is pushed.
+ */
+
+/* R E T U R N   V A L U E
+ *
+ * [exitflag] - exit flag. Any positive value indicates an error (for numerical and
+ *              textual definitions of the exit status, see l_ap_error_handling.c).
+ */
+
+/* N O N S T A N D A R D   F U N C T I O N S   U S E D
+ *
+ * (1) f_apd_stream_block.
+ */
+    
+    
+    /* Definitions and initializations */
+    
+    int exitflag = 0;
+
+    f_apd_set_error (exitflag, __LINE__, APD_ERR_FILE);
+
+
+    struct strAPD_Stream *S = stream;
+
+    const long L = S->L;
+
+    const long H = S->hop;
+
+    long i;
+
+    long j;
+
+    long k;
+
+    long c;
+
+    long n_trig;
+
+    double *x_k;
+
+
+    *n_in = 0;
+
+
+
+    while (1)
+    {
+        /* Demodulation of a completed block (the first block is complete with L
+         * samples, every next one with H samples more, after which the input is
+         * shifted by H samples) */
+
+        n_trig = (S->n_blk == 0) ? L : L + H;
+
+        if (S->n_x == n_trig)
+        {
+            if (S->n_y > L)
+
+                break;
+
+            if (S->n_blk == 0)
+
+                exitflag = f_apd_stream_block (S, 0, 0, 0, S->edge + H);
+
+            else
+            {
+                for (k=0; k<(S->n_ch); k++)
+                {
+                    x_k = S->x + k*(L+H);
+
+                    memmove(x_k, x_k + H, L*sizeof(double));
+                }
+
+                S->n_x = L;
+
+                exitflag = f_apd_stream_block (S, 0, H, S->edge, H);
+            }
+
+            if (exitflag != APD_ERR_ID_NON) goto finish;
+
+            continue;
+        }
+
+        if (*n_in == n)
+
+            break;
+
+
+
+        /* Validation and deinterleaving of the frames that complete the block */
+
+        c = (n - *n_in < n_trig - S->n_x) ? n - *n_in : n_trig - S->n_x;
+
+        for (i=0; i<c*(S->n_ch); i++)
+        {
+            if ( !isfinite(x[(*n_in)*(S->n_ch)+i]) )
+            {
+                f_apd_set_error(APD_ERR_ID_S,__LINE__,APD_ERR_FILE); goto failed;}
+        }
+
+        for (j=0; j<c; j++)
+
+            for (k=0; k<(S->n_ch); k++)
+
+                S->x[k*(L+H) + S->n_x + j] = x[(*n_in + j)*(S->n_ch) + k];
+
+        S->n_x = S->n_x + c;
+
+        *n_in = *n_in + c;
+    }
+
+
+
+    /* Output */
+
+    finish:
+
+        return exitflag;
+
+    failed:
+
+        f_apd_get_error (&exitflag, NULL, NULL, NULL);
+
+        goto finish;
+
+}
+
+
+
+
+int f_apd_stream_pull ( struct strAPD_Stream* stream, \
+
+                        double* m, \
+
+                        const long n, \
+
+                        long* n_out )
+{
+/* P U R P O S E
+ *
+ * Takes up to n frames of the modulator out of the stream.
+ */
+
+/* I N P U T   A R G U M E N T S
+ *
+ * [stream] - stream created by f_apd_stream_create.
+ *
+ * [n] - maximum number of frames.
+ */
+
+/* O U T P U T   A R G U M E N T S
+ *
+ * [m] - n_out[0] frames of the modulator (interleaved as the frames of
+ *       f_apd_stream_push; memory allocated externally).
+ *
+ * [n_out] - number of frames output (this is the address of an externally defined
+ *           scalar variable).
+ */
+
+/* R E T U R N   V A L U E
+ *
+ * [exitflag] - exit flag. Any positive value indicates an error (for numerical and
+ *              textual definitions of the exit status, see l_ap_error_handling.c).
+ */
+
+/* N O N S T A N D A R D   F U N C T I O N S   U S E D
+ *
+ * None.
+ */
+    
+    
+    /* Definitions and initializations */
+
+    struct strAPD_Stream *S = stream;
+
+    long j;
+
+    long k;
+
+    long c;
+
+    double *y_k;
+
+
+
+    /* Interleaving of the output and removal from the stream */
+
+    c = (n < S->n_y) ? n : S->n_y;
+
+    for (k=0; k<(S->n_ch); k++)
+    {
+        y_k = S->y + k*2*(S->L);
+
+        for (j=0; j<c; j++)
+
+            m[j*(S->n_ch) + k] = y_k[j];
+
+        memmove(y_k, y_k + c, (S->n_y - c)*sizeof(double));
+    }
+
+    S->n_y = S->n_y - c;
+
+    *n_out = c;
+
+
+    return 0;
+}
+
+
+
+
+int f_apd_stream_flush (struct strAPD_Stream* stream)
+{
+/* P U R P O S E
+ *
+ * Demodulates the last block of the stream, which ends at the last pushed frame,
+ * and appends all remaining samples of the modulator to the output. If fewer than
+ * Par.Ns[0] frames were pushed, the block is padded with zeros. The stream is then
+ * ready for a new signal, while the output is still to be pulled.
+ */
+
+/* I N P U T   A R G U M E N T S
+ *
+ * [stream] - stream created by f_apd_stream_create. The remaining samples must fit
+ *            into the output of the stream (they always do if all output was
+ *            pulled before).
+ */
+
+/* O U T P U T   A R G U M E N T S
+ *
+ * [stream] - stream with the remaining samples of the modulator in its output.
+ */
+
+/* R E T U R N   V A L U E
+ *
+ * [exitflag] - exit flag. Any positive value indicates an error (for numerical and
+ *              textual definitions of the exit status, see l_ap_error_handling.c).
+ */
+
+/* N O N S T A N D A R D   F U N C T I O N S   U S E D
+ *
+ * (1) f_apd_stream_block.
+ */
+    
+    
+    /* Definitions and initializations */
+    
+    int exitflag = 0;
+
+    f_apd_set_error (exitflag, __LINE__, APD_ERR_FILE);
+
+
+    struct strAPD_Stream *S = stream;
+
+    const long L = S->L;
+
+    const long H = S->hop;
+
+    long k;
+
+    long n_rem;
+
+
+    n_rem = (S->n_blk == 0) ? S->n_x : S->n_x - S->edge - H;
+
+    if (n_rem > 2*L - S->n_y)
+    {
+        f_apd_set_error(APD_ERR_ID_SF,__LINE__,APD_ERR_FILE); goto failed;}
+
+
+
+    /* Last block: the zero-padded input (no block completed) or the last L input
+     * samples, shifted by d = n_x - L <= H samples with respect to the last block
+     * and output from the end of the output of the last block (none if the last
+     * block already output all samples) */
+
+    if (S->n_blk == 0 && S->n_x > 0)
+    {
+        for (k=0; k<(S->n_ch); k++)
+
+            memset(S->x + k*(L+H) + S->n_x, 0, (L - S->n_x)*sizeof(double));
+
+        exitflag = f_apd_stream_block (S, 0, 0, 0, n_rem);
+    }
+
+    else if (S->n_blk > 0 && n_rem > 0)
+
+        exitflag = f_apd_stream_block (S, S->n_x - L, S->n_x - L, \
+                                       S->edge + H - (S->n_x - L), n_rem);
+
+    if (exitflag != APD_ERR_ID_NON) goto finish;
+
+
+    S->n_blk = 0;
+
+    S->n_x = 0;
+
+
+
+    /* Output */
+
+    finish:
+
+        return exitflag;
+
+    failed:
+
+        f_apd_get_error (&exitflag, NULL, NULL, NULL);
+
+        goto finish;
+
+}